@@ -0,0 +1,42 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef> // for size_t
+#include <cstdint>
+
+#include "VisionaryType.h"
+
+namespace visionary {
+
+/// Data sets the device sends on the blob stream (see VisionaryControl::getBlobStreamConfig()).
+///
+/// Data sets which are not consumed should be disabled at the source: they cost network bandwidth and receive time
+/// even if the data handler skips them.
+struct BlobStreamConfig
+{
+  /// Image maps: Z, RGBA and state (Visionary-S) or distance, intensity and state (Visionary-T Mini).
+  bool depthMap = true;
+  /// Polar 2D data set: one distance and confidence value per angle (Visionary-T Mini only).
+  bool polar2D = false;
+  /// Cartesian data set: point cloud computed on the device (Visionary-T Mini only).
+  bool cartesian = false;
+};
+
+/// Returns an upper estimate of the blob size in bytes for the nominal image size of a product type.
+///
+/// Includes the blob framing, the XML segment and the header and footer of each data set, so the result can be passed
+/// to SocketOptions::blobStream(). The cartesian data set is assumed to contain one point per pixel.
+///
+/// \param[in] visionaryType product type of the device.
+/// \param[in] config        data sets sent by the device.
+///
+/// \returns the estimated blob size in bytes.
+///
+/// \throws std::runtime_error if the visionary type is unknown.
+std::size_t estimateFrameSize(VisionaryType visionaryType, const BlobStreamConfig& config = BlobStreamConfig());
+
+} // namespace visionary
@@ -0,0 +1,107 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <chrono>
+#include <cstddef> // for size_t
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace visionary {
+
+/// Current estimate of the relation between the device clock and the host clock.
+struct ClockSyncEstimate
+{
+  /// true as soon as at least one sample was added.
+  bool valid;
+  /// number of samples used since the last reset.
+  std::uint64_t numSamples;
+  /// host steady clock time (since its epoch) minus device time (since the Unix epoch) at the latest sample.
+  std::chrono::nanoseconds offset;
+  /// rate difference of the device clock relative to the host clock in parts per million.
+  double driftPpm;
+};
+
+/// Estimates offset and drift of the device clock relative to the host steady clock.
+///
+/// The estimator is fed with pairs of (device timestamp, host receive time). Each receive time is the device time plus
+/// the offset plus a positive transport delay. To suppress the delay the samples are grouped into buckets of device
+/// time, only the sample with the smallest delay of each bucket is kept and a line is fitted through the minima of the
+/// most recent buckets (running minimum-delay linear fit).
+///
+/// The converted timestamps therefore still contain the minimal transport latency of the link, which is constant, but
+/// not its variations. A device clock jump (e.g. NTP correction on the device) resets the estimator.
+///
+/// All functions are thread-safe.
+class ClockSynchronizer
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /// Constructor
+  ///
+  /// \param[in] bucketDuration  device time span from which the minimum delay sample is taken.
+  /// \param[in] numBuckets      number of buckets used for the linear fit (defines the adaption time).
+  /// \param[in] maxResidual     deviation from the current fit after which the estimator is reset.
+  explicit ClockSynchronizer(std::chrono::milliseconds bucketDuration = std::chrono::seconds(1),
+                             std::size_t               numBuckets     = 60u,
+                             std::chrono::milliseconds maxResidual    = std::chrono::seconds(2));
+
+  /// Adds a sample.
+  ///
+  /// \param[in] deviceTimeMs device timestamp in milliseconds since the Unix epoch, see VisionaryData::getTimestampMS()
+  /// \param[in] hostTime     host time when the frame started to arrive.
+  void addSample(std::uint64_t deviceTimeMs, Clock::time_point hostTime);
+
+  /// Converts a device timestamp into the host steady clock domain.
+  ///
+  /// \param[in] deviceTimeMs device timestamp in milliseconds since the Unix epoch.
+  ///
+  /// \returns the estimated host time; the clock epoch if no sample was added yet.
+  Clock::time_point toHostTime(std::uint64_t deviceTimeMs) const;
+
+  /// Returns the current estimate.
+  ClockSyncEstimate getEstimate() const;
+
+  /// Discards all samples.
+  void reset();
+
+private:
+  struct Point
+  {
+    double x; // device time relative to the reference in ms
+    double y; // host minus device time relative to the reference in ms
+  };
+
+  void   resetLocked();
+  void   fitLocked();
+  double offsetAtLocked(double x) const;
+
+  const double      m_bucketDurationMs;
+  const std::size_t m_numBuckets;
+  const double      m_maxResidualMs;
+
+  mutable std::mutex m_mutex;
+
+  bool              m_hasReference;
+  std::uint64_t     m_refDeviceMs;
+  Clock::time_point m_refHost;
+  std::uint64_t     m_numSamples;
+  double            m_lastX;
+
+  // completed buckets as ring buffer, plus the running minimum of the current bucket
+  std::vector<Point> m_buckets;
+  std::size_t        m_bucketHead;
+  double             m_currentBucketStart;
+  Point              m_currentMin;
+
+  // fitted offset(x) = m_intercept + m_slope * x
+  double m_intercept;
+  double m_slope;
+};
+
+} // namespace visionary
@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace visionary {
+
+/// Passively collected liveness and quality indicators of a connection.
+///
+/// Collecting them does not send anything to the device. The TCP fields are only filled where the platform provides
+/// TCP_INFO (Linux), see hasTcpInfo.
+struct ConnectionHealth
+{
+  using Clock = std::chrono::steady_clock;
+
+  /// The connection is open and no receive error or close by the peer has been seen.
+  bool connected = false;
+
+  /// Time at which data was last returned by a receive call, default constructed if nothing was received yet.
+  Clock::time_point lastReceiveTime;
+
+  /// The requested SocketOptions::receiveBufferSize exceeded the system limit and was not applied.
+  ///
+  /// The kernel autotuning sizes the receive buffer instead.
+  bool receiveBufferLimited = false;
+
+  /// Current size of the kernel receive buffer (SO_RCVBUF) in bytes, 0 if unknown (filled on Linux only).
+  std::size_t receiveBufferSize = 0u;
+
+  /// The TCP fields below are valid.
+  bool hasTcpInfo = false;
+
+  /// Smoothed round trip time and its variance as estimated by the sender side of the socket.
+  std::chrono::microseconds rtt         = std::chrono::microseconds(0);
+  std::chrono::microseconds rttVariance = std::chrono::microseconds(0);
+
+  /// Round trip time estimated by the receiver side, more meaningful for a connection which only receives data.
+  std::chrono::microseconds receiveRtt = std::chrono::microseconds(0);
+
+  /// Time at which the kernel last received data on the socket (millisecond resolution).
+  ///
+  /// Contrary to lastReceiveTime this includes data which was not read yet, e.g. while a large frame is received.
+  Clock::time_point lastKernelReceiveTime;
+
+  /// Number of segments retransmitted over the lifetime of the connection.
+  std::uint32_t totalRetransmits = 0u;
+
+  /// Number of retransmission timeouts in a row without acknowledgement, non-zero while the peer does not respond.
+  std::uint32_t pendingRetransmits = 0u;
+
+  /// Number of unanswered keepalive probes.
+  std::uint32_t keepAliveProbes = 0u;
+
+  /// Returns whether the connection is open and data was received within \a maxSilence.
+  ///
+  /// \param[in] maxSilence maximum accepted time without received data, e.g. a few frame periods.
+  /// \param[in] now        the current time.
+  bool isAlive(std::chrono::milliseconds maxSilence, Clock::time_point now = Clock::now()) const;
+};
+
+} // namespace visionary
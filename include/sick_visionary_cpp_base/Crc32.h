@@ -0,0 +1,55 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef> // for size_t
+#include <cstdint>
+
+namespace visionary {
+
+/// CRC-32 variants.
+namespace CrcAlgorithm {
+enum Enum
+{
+  NONE = 0, ///< no CRC
+  CRC32,    ///< CRC-32 (IEEE 802.3, polynomial 0x04C11DB7, as used by zlib and Ethernet)
+  CRC32C    ///< CRC-32C (Castagnoli, polynomial 0x1EDC6F41, as used by iSCSI and ext4)
+};
+}
+
+/// CRC-32 computation.
+///
+/// CRC-32C uses the SSE4.2 crc32 instruction on x86-64 and the ARMv8 CRC extension where available, CRC-32 the ARMv8
+/// CRC extension. Otherwise a slicing-by-8 table implementation is used.
+class Crc32
+{
+public:
+  /// Computes the CRC of a memory block.
+  ///
+  /// The CRC of data passed in several pieces is computed by passing the result of the previous piece as \a crc.
+  ///
+  /// \param[in] algorithm  the CRC variant; CrcAlgorithm::NONE returns 0.
+  /// \param[in] pData      start of the data.
+  /// \param[in] size       size of the data in bytes.
+  /// \param[in] crc        CRC of the preceding data, 0 to start a new computation.
+  ///
+  /// \returns the CRC (with the usual initial value and final inversion applied).
+  static std::uint32_t compute(CrcAlgorithm::Enum algorithm,
+                               const void*        pData,
+                               std::size_t        size,
+                               std::uint32_t      crc = 0u);
+
+  /// Computes the CRC like compute(), always with the table implementation.
+  static std::uint32_t computeSoftware(CrcAlgorithm::Enum algorithm,
+                                       const void*        pData,
+                                       std::size_t        size,
+                                       std::uint32_t      crc = 0u);
+
+  /// Returns true if the CRC variant is computed with CPU instructions on this machine.
+  static bool isHardwareAccelerated(CrcAlgorithm::Enum algorithm);
+};
+
+} // namespace visionary
@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef> // for size_t
+#include <cstdint>
+
+namespace visionary {
+
+/// Stages of DepthFilter::apply(), every stage is disabled by default.
+///
+/// The thresholds are given in the units of the depth map, see VisionaryData::getScaleZ().
+struct DepthFilterConfig
+{
+  /// Confidence masking: pixels with any of these bits set in the state map are invalidated. 0 disables the check.
+  std::uint16_t stateMask = 0u;
+
+  /// Confidence masking: pixels with a lower intensity (Visionary-T Mini) are invalidated. 0 disables the check.
+  std::uint16_t minIntensity = 0u;
+
+  /// Flying pixel removal: jump relative to the depth of the pixel, e.g. 0.05 for 5 %. 0 disables the relative part.
+  float jumpRatio = 0.0f;
+
+  /// Flying pixel removal: smallest jump in depth units. The stage is disabled if this and jumpRatio are both 0.
+  std::uint16_t minJump = 0u;
+
+  /// Hole filling: number of valid pixels (1 to 8) among the 8 neighbours an invalid pixel needs to be filled.
+  /// 0 disables the stage.
+  unsigned holeFillNeighbors = 0u;
+
+  /// Hole filling: largest difference between the valid neighbours; holes on depth edges are not filled.
+  std::uint16_t holeFillMaxSpread = 0xFFFFu;
+
+  /// Median window: 3 (3x3), 5 (5x5) or 0 to disable the stage.
+  unsigned medianSize = 0u;
+
+  /// Number of threads each stage runs on, 0 for one per hardware thread. Small maps use fewer threads.
+  unsigned numThreads = 0u;
+
+  /// Returns true if at least one stage is enabled.
+  bool isEnabled() const;
+
+  /// Returns true if the median size and the hole filling neighbour count are supported, see DepthFilter::apply().
+  bool isValid() const;
+};
+
+/// Filters for 16 bit depth maps (Z or radial distance), applied before the point cloud is generated.
+///
+/// Invalid pixels have the value 0, as in the maps of the devices. Every stage reads its input and writes its output
+/// map, so the result does not depend on the processing order; the rows are split into bands which are processed in
+/// parallel, and the pixels within a row are processed 16 at a time with AVX2 where available. Pixels at the image
+/// border which lack a full neighbourhood are kept as they are.
+class DepthFilter
+{
+public:
+  /// Applies the enabled stages of the configuration in place: confidence masking, flying pixel removal, hole
+  /// filling and finally the median.
+  ///
+  /// \param[in]     config      the stages and their parameters.
+  /// \param[in,out] pDepth      the depth map, row by row.
+  /// \param[in]     width       number of columns.
+  /// \param[in]     height      number of rows.
+  /// \param[in]     pState      the state map for the confidence masking, nullptr if not available.
+  /// \param[in]     pIntensity  the intensity map for the confidence masking, nullptr if not available.
+  ///
+  /// \throws std::invalid_argument if the median size or the hole filling neighbour count is not supported.
+  static void apply(const DepthFilterConfig& config,
+                    std::uint16_t*           pDepth,
+                    std::uint32_t            width,
+                    std::uint32_t            height,
+                    const std::uint16_t*     pState     = nullptr,
+                    const std::uint16_t*     pIntensity = nullptr);
+
+  /// Invalidates pixels with a low confidence.
+  ///
+  /// \param[in,out] pDepth        the depth map.
+  /// \param[in]     numPixels     number of pixels of the maps.
+  /// \param[in]     pState        the state map, nullptr to skip the state check.
+  /// \param[in]     stateMask     pixels with any of these state bits set are invalidated.
+  /// \param[in]     pIntensity    the intensity map, nullptr to skip the intensity check.
+  /// \param[in]     minIntensity  pixels with a lower intensity are invalidated.
+  static void maskByConfidence(std::uint16_t*       pDepth,
+                               std::size_t          numPixels,
+                               const std::uint16_t* pState,
+                               std::uint16_t        stateMask,
+                               const std::uint16_t* pIntensity,
+                               std::uint16_t        minIntensity);
+
+  /// Removes flying pixels, the mixed depths measured between foreground and background at depth edges.
+  ///
+  /// A pixel is invalidated if it differs from both opposite neighbours of any of the four directions (horizontal,
+  /// vertical and the two diagonals) by more than max(minJump, jumpRatio * depth). Invalid neighbours count as jumps,
+  /// so isolated single pixels are removed as well, while the pixels on either side of a true edge are kept.
+  ///
+  /// \param[in]  pInput     the depth map.
+  /// \param[out] pOutput    the filtered depth map, must not overlap the input.
+  /// \param[in]  width      number of columns.
+  /// \param[in]  height     number of rows.
+  /// \param[in]  minJump    smallest jump in depth units.
+  /// \param[in]  jumpRatio  jump relative to the depth of the pixel.
+  /// \param[in]  numThreads number of threads, 0 for one per hardware thread.
+  static void removeFlyingPixels(const std::uint16_t* pInput,
+                                 std::uint16_t*       pOutput,
+                                 std::uint32_t        width,
+                                 std::uint32_t        height,
+                                 std::uint16_t        minJump,
+                                 float                jumpRatio,
+                                 unsigned             numThreads = 0u);
+
+  /// Fills small holes.
+  ///
+  /// An invalid pixel with at least minNeighbors valid pixels among its 8 neighbours gets the mean of the smallest
+  /// and the largest of them, provided they differ by at most maxSpread.
+  ///
+  /// \param[in]  pInput        the depth map.
+  /// \param[out] pOutput       the filtered depth map, must not overlap the input.
+  /// \param[in]  width         number of columns.
+  /// \param[in]  height        number of rows.
+  /// \param[in]  minNeighbors  number of valid neighbours needed, 1 to 8.
+  /// \param[in]  maxSpread     largest difference between the valid neighbours.
+  /// \param[in]  numThreads    number of threads, 0 for one per hardware thread.
+  ///
+  /// \throws std::invalid_argument if minNeighbors is not within 1 to 8.
+  static void fillHoles(const std::uint16_t* pInput,
+                        std::uint16_t*       pOutput,
+                        std::uint32_t        width,
+                        std::uint32_t        height,
+                        unsigned             minNeighbors,
+                        std::uint16_t        maxSpread,
+                        unsigned             numThreads = 0u);
+
+  /// Replaces each valid pixel by the median of its 3x3 or 5x5 neighbourhood.
+  ///
+  /// Invalid pixels stay invalid. Invalid neighbours count as 0, so valid pixels with mostly invalid neighbours
+  /// become invalid.
+  ///
+  /// \param[in]  pInput      the depth map.
+  /// \param[out] pOutput     the filtered depth map, must not overlap the input.
+  /// \param[in]  width       number of columns.
+  /// \param[in]  height      number of rows.
+  /// \param[in]  size        3 or 5.
+  /// \param[in]  numThreads  number of threads, 0 for one per hardware thread.
+  ///
+  /// \throws std::invalid_argument if the size is not supported.
+  static void median(const std::uint16_t* pInput,
+                     std::uint16_t*       pOutput,
+                     std::uint32_t        width,
+                     std::uint32_t        height,
+                     unsigned             size,
+                     unsigned             numThreads = 0u);
+
+private:
+  // No instantiations
+  DepthFilter();
+  virtual ~DepthFilter();
+};
+
+} // namespace visionary
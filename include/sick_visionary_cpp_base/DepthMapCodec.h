@@ -0,0 +1,58 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef> // for size_t
+#include <cstdint>
+#include <vector>
+
+namespace visionary {
+
+/// Lossless compression of 16 bit maps like getZMap(), getDistanceMap(), getIntensityMap() and getStateMap().
+///
+/// Each pixel is predicted from its left, upper and upper left neighbours (left + up - upper left), which is exact on
+/// planar surfaces. The prediction errors are packed in blocks of 64 values with the bit width of the largest error of
+/// the block, so runs of invalid (zero) pixels cost one byte per block. Decoding only needs shifts, masks and adds.
+///
+/// The encoded map starts with a 12 byte header (magic, format version, width and height); all values are little
+/// endian.
+class DepthMapCodec
+{
+public:
+  /// Returns the largest possible size of an encoded map.
+  ///
+  /// \param[in] width  number of columns.
+  /// \param[in] height number of rows.
+  static std::size_t maxEncodedSize(std::uint32_t width, std::uint32_t height);
+
+  /// Encodes a map.
+  ///
+  /// \param[in]  pMap    the map, row by row.
+  /// \param[in]  width   number of columns.
+  /// \param[in]  height  number of rows.
+  /// \param[out] encoded the encoded map; the capacity is reused.
+  static void encode(const std::uint16_t*       pMap,
+                     std::uint32_t              width,
+                     std::uint32_t              height,
+                     std::vector<std::uint8_t>& encoded);
+
+  /// Decodes a map.
+  ///
+  /// \param[in]  pData  the encoded map.
+  /// \param[in]  size   size of the encoded map in bytes.
+  /// \param[out] map    the decoded map, row by row; the capacity is reused.
+  /// \param[out] width  number of columns.
+  /// \param[out] height number of rows.
+  ///
+  /// \returns true if successful, false if the data is truncated or not an encoded map.
+  static bool decode(const std::uint8_t*         pData,
+                     std::size_t                 size,
+                     std::vector<std::uint16_t>& map,
+                     std::uint32_t&              width,
+                     std::uint32_t&              height);
+};
+
+} // namespace visionary
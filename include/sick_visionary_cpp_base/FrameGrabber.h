@@ -31,8 +31,10 @@ public:
   FrameGrabber(VisionaryControl&         visionaryControl,
                const std::string&        hostname,
                std::uint16_t             port,
-               std::chrono::milliseconds timeout)
-    : FrameGrabberBase(visionaryControl, hostname, port, timeout)
+               std::chrono::milliseconds timeout,
+               const SocketOptions&      socketOptions   = SocketOptions(),
+               const PipelineOptions&    pipelineOptions = PipelineOptions())
+    : FrameGrabberBase(visionaryControl, hostname, port, timeout, socketOptions, pipelineOptions)
   {
   }
 
@@ -59,7 +61,7 @@ public:
 
     auto pTypedDataHandler = std::move(std::static_pointer_cast<VisionaryData>(pDataHandler));
 
-    const auto retVal = genGetNextFrame(pTypedDataHandler, timeout);
+    const auto retVal = genGetNextFrame(pTypedDataHandler, false, timeout);
 
     pDataHandler = std::move(std::static_pointer_cast<DataType>(pTypedDataHandler));
 
@@ -10,9 +10,15 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <mutex>
 #include <thread>
+#include <vector>
 
+#include "FrameTiming.h"
+#include "PipelineOptions.h"
+#include "ReconnectPolicy.h"
 #include "VisionaryDataStream.h"
 
 namespace visionary {
@@ -28,13 +34,17 @@ public:
   /// \param[in] hostname name or IP address of the Visionary sensor.
   /// \param[in] port port of the Visionary sensor.
   /// \param[in] timeout timeout for Connection
+  /// \param[in] socketOptions socket tuning options, applied on every (re-)connect.
+  /// \param[in] pipelineOptions threading of the receive pipeline, by default receiving and parsing in one thread.
   ///
   /// \throws std::runtime_error if the visionary type in VisionaryControl is unknown.
   /// \throws std::runtime_error if the connection could not be established.
   FrameGrabberBase(VisionaryControl&         visionaryControl,
                    const std::string&        hostname,
                    std::uint16_t             port,
-                   std::chrono::milliseconds timeout);
+                   std::chrono::milliseconds timeout,
+                   const SocketOptions&      socketOptions   = SocketOptions(),
+                   const PipelineOptions&    pipelineOptions = PipelineOptions());
 
   /// Destructor
   ///
@@ -63,10 +73,111 @@ public:
   /// \param[out] pDataHandler Pointer to the data handler that will be filled with the next frame.
   bool genGetCurrentFrame(std::shared_ptr<VisionaryData>& pDataHandler);
 
+  /// Returns the latency histogram of a receive pipeline stage.
+  ///
+  /// Each histogram holds the time from the previous stage to \a stage for every consumed frame, e.g.
+  /// FrameStage::XML_PARSED holds the time spent between the last received byte and the end of the XML parsing.
+  /// The histogram of FrameStage::FIRST_BYTE_RECEIVED stays empty, see getTotalLatency().
+  /// The histograms can be read from any thread while the grabber is running.
+  ///
+  /// \param[in] stage the pipeline stage
+  ///
+  /// \note Latencies are only recorded if the library was built with VISIONARY_BASE_ENABLE_LATENCY_TRACE.
+  const LatencyHistogram& getStageLatency(FrameStage::Enum stage) const;
+
+  /// Returns the latency histogram from the first received byte until the frame was consumed.
+  ///
+  /// \note Latencies are only recorded if the library was built with VISIONARY_BASE_ENABLE_LATENCY_TRACE.
+  const LatencyHistogram& getTotalLatency() const;
+
+  /// Returns a snapshot of the stream statistics.
+  ///
+  /// Besides the receive and parse counters of the data stream, the grabber reports frames which were replaced by a
+  /// newer frame before they were fetched (framesDropped), reconnects and, with parse threads, the number of blobs
+  /// waiting to be parsed (backlog). Can be called from any thread.
+  StreamStatistics getStatistics() const;
+
+  /// Clears the stream statistics.
+  void resetStatistics();
+
+  /// Returns the current estimate of the device clock relative to the host steady clock.
+  ///
+  /// The frames delivered by the grabber carry their device timestamp converted with this estimate,
+  /// see VisionaryData::getHostTimestamp(). Can be called from any thread.
+  ClockSyncEstimate getClockSyncEstimate() const;
+
+  /// Callback type for connection state changes.
+  using ConnectionStateCallback = std::function<void(ConnectionState::Enum state)>;
+
+  /// Sets the stall detection and reconnect behaviour.
+  ///
+  /// Can be called at any time; the grabber thread picks up the new policy with the next frame.
+  ///
+  /// \param[in] policy the reconnect policy.
+  void setReconnectPolicy(const ReconnectPolicy& policy);
+
+  /// Returns the current reconnect policy.
+  ReconnectPolicy getReconnectPolicy() const;
+
+  /// Sets a callback which is invoked on every connection state change.
+  ///
+  /// The callback is invoked from the grabber thread and must not block. Pass an empty function to remove it.
+  ///
+  /// \param[in] callback the function to call with the new state.
+  void setConnectionStateCallback(ConnectionStateCallback callback);
+
+  /// Returns the current connection state.
+  ConnectionState::Enum getConnectionState() const;
+
+  /// Returns the passive health indicators of the blob connection.
+  ///
+  /// The grabber thread refreshes them after every received frame or receive timeout, so polling them costs no more
+  /// than a copy. Can be called from any thread, see VisionaryDataStream::getConnectionHealth().
+  ConnectionHealth getConnectionHealth() const;
+
 private:
   /// Thread function that runs the grabber loop.
   void run();
 
+  /// Tries to re-establish the connection after waiting for the backoff delay.
+  ///
+  /// \returns false if the grabber is stopped during the wait.
+  bool reconnect(const ReconnectPolicy& policy, unsigned attempt, double random01);
+
+  /// Receives and parses the next frame in the grabber thread and hands it off.
+  bool receiveFrame();
+
+  /// Receives the next blob and queues it for the parse threads.
+  bool receiveRawFrame();
+
+  /// Thread function of a parse thread.
+  void runParser(std::shared_ptr<VisionaryData> pDataHandler);
+
+  /// Applies the extraction settings of the pipeline options to a data handler.
+  ///
+  /// Called for the handlers of the grabber and for every handler the application passes in, since these take part
+  /// in the parsing after the exchange.
+  void applyPipelineOptions(VisionaryData& dataHandler) const;
+
+  /// Applies PipelineOptions::depthFilter to the received frame.
+  ///
+  /// \returns false if the filtering failed; the frame is then not handed off.
+  bool filterFrame(VisionaryData& dataHandler) const;
+
+  /// Hands the received frame over to the consumer side.
+  ///
+  /// \param[in,out] pDataHandler the data handler holding the frame, exchanged with the previously handed off one.
+  void publishFrame(std::shared_ptr<VisionaryData>& pDataHandler);
+
+  /// Stores the new state and invokes the callback if the state changed.
+  void setConnectionState(ConnectionState::Enum state);
+
+  /// Takes a snapshot of the connection health for getConnectionHealth().
+  void updateConnectionHealth();
+
+  /// Marks the frame as consumed and adds its pipeline timestamps to the latency histograms.
+  void recordFrameLatency(VisionaryData& data);
+
   const VisionaryControl& m_visionaryControl;
   std::atomic<bool>       m_isRunning;
 
@@ -74,6 +185,8 @@ private:
   const std::string               m_hostnameThreadRead;
   const std::uint16_t             m_portThreadRead;
   const std::chrono::milliseconds m_timeoutThreadRead;
+  const SocketOptions             m_socketOptionsThreadRead;
+  const PipelineOptions           m_pipelineOptionsThreadRead;
 
   /// variables that must not be changed concurrent to the receive thread.
   bool                                 m_connectedThreadPrivate;
@@ -86,8 +199,41 @@ private:
 
   std::thread m_grabberThread;
 
+  /// raw blobs passed from the grabber thread to the parse threads, synchronized by m_pipelineMutex.
+  using RawFramePtr = std::unique_ptr<VisionaryDataStream::RawFrame>;
+  struct QueuedRawFrame
+  {
+    std::uint64_t sequence;
+    RawFramePtr   pFrame;
+  };
+  std::vector<std::thread>   m_parseThreads;
+  std::mutex                 m_pipelineMutex;
+  std::condition_variable    m_rawFrameFreeCv;
+  std::condition_variable    m_rawFrameQueuedCv;
+  std::condition_variable    m_rawFrameTurnCv;
+  std::vector<RawFramePtr>   m_freeRawFrames;
+  std::deque<QueuedRawFrame> m_rawFrameQueue;
+  std::uint64_t              m_nextReceiveSequence;
+  std::uint64_t              m_nextPublishSequence;
+
+  /// wakes the grabber thread from a reconnect backoff when the grabber is stopped.
+  std::mutex              m_stopMutex;
+  std::condition_variable m_stopCv;
+
+  /// configuration and status shared with the receive thread, synchronized by m_configMutex.
+  mutable std::mutex      m_configMutex;
+  ReconnectPolicy         m_reconnectPolicy;
+  ConnectionStateCallback m_connectionStateCallback;
+  ConnectionHealth        m_connectionHealth;
+
+  std::atomic<int> m_connectionState;
+
   /// communicates when m_threadShared.frameAvailable is changed by the thread.
   std::condition_variable m_frameAvailableCv;
+
+  /// latency histograms, written by the consumer side, readable from any thread.
+  LatencyHistogram m_stageLatency[FrameStage::NUM_STAGES];
+  LatencyHistogram m_totalLatency;
 };
 
 } // namespace visionary
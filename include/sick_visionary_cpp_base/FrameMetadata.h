@@ -0,0 +1,33 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace visionary {
+
+/// Metadata from the header of the binary segment, available before the maps are extracted.
+struct FrameMetadata
+{
+  /// version of the binary data set.
+  std::uint16_t dataSetVersion;
+  /// frame number; assigned by the device from data set version 2 on, counted by the data handler before.
+  std::uint32_t frameNum;
+  /// device timestamp in milliseconds (UTC).
+  std::uint64_t timestampMS;
+  /// data quality reported by the device (data set version 2 and above, 0 otherwise).
+  std::uint8_t dataQuality;
+  /// device status reported by the device (data set version 2 and above, 0 otherwise).
+  std::uint8_t deviceStatus;
+};
+
+/// Predicate deciding whether a frame is extracted, see VisionaryData::setFrameFilter().
+///
+/// Returns true to keep the frame, false to reject it.
+using FrameFilter = std::function<bool(const FrameMetadata& metadata)>;
+
+} // namespace visionary
@@ -0,0 +1,179 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PointCloudPlyWriter.h"
+#include "PointXYZ.h"
+#include "VisionaryData.h"
+#include "VisionaryDataStream.h"
+
+namespace visionary {
+
+/// File formats written by the FrameRecorder.
+namespace RecordFormat {
+enum Enum
+{
+  PLY_BINARY = 0, ///< binary little endian PLY point cloud
+  PLY_ASCII,      ///< ASCII PLY point cloud
+  RAW_BLOB        ///< blob as received from the device, including the framing and the length
+};
+}
+
+/// Settings of a FrameRecorder.
+struct RecorderOptions
+{
+  /// Existing directory the files are written to.
+  std::string directory = ".";
+  /// Files are named <prefix>_<record number>.<ply|blob>, the record number counts the accepted records.
+  std::string prefix = "frame";
+  /// Format of point cloud records, PLY_BINARY or PLY_ASCII.
+  RecordFormat::Enum pointCloudFormat = RecordFormat::PLY_BINARY;
+  /// Presentation of invalid points in PLY files.
+  InvalidPointPresentation presentation = INVALID_AS_NAN;
+  /// Number of records which can be queued or written at the same time; further records are dropped.
+  ///
+  /// Each record keeps its buffers, so the memory of a full queue is allocated once and reused.
+  std::size_t queueCapacity = 8u;
+  /// Number of threads writing the files.
+  std::size_t writerThreads = 1u;
+};
+
+/// Counters of a FrameRecorder.
+struct RecorderStatistics
+{
+  std::uint64_t recordsAccepted; ///< records queued for writing
+  std::uint64_t recordsWritten;  ///< records written successfully
+  std::uint64_t recordsDropped;  ///< records dropped because the queue was full
+  std::uint64_t writeErrors;     ///< records which could not be written
+  std::size_t   queueDepth;      ///< records queued or being written
+  std::size_t   maxQueueDepth;   ///< maximum of queueDepth
+};
+
+/// Writes point clouds and raw blobs to files in background threads.
+///
+/// The record functions copy the data into a preallocated queue entry and return immediately, so a slow disk does not
+/// block the receive loop. If all queue entries are in use, the record is dropped and counted in
+/// RecorderStatistics::recordsDropped instead of waiting for the disk.
+class FrameRecorder
+{
+public:
+  /// Starts the writer threads.
+  ///
+  /// \param[in] options settings of the recorder.
+  explicit FrameRecorder(const RecorderOptions& options = RecorderOptions());
+
+  /// Writes the queued records and stops the writer threads.
+  ~FrameRecorder();
+
+  FrameRecorder(const FrameRecorder&)            = delete;
+  FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+  /// Queues a point cloud.
+  ///
+  /// \param[in] points       the points to write.
+  /// \param[in] rgbaMap      RGBA colors of the points, ignored unless it has the same length as points.
+  /// \param[in] intensityMap intensities of the points, ignored unless it has the same length as points.
+  ///
+  /// \returns true if the record was queued, false if it was dropped.
+  bool recordPointCloud(const std::vector<PointXYZ>&      points,
+                        const std::vector<std::uint32_t>& rgbaMap      = std::vector<std::uint32_t>(),
+                        const std::vector<std::uint16_t>& intensityMap = std::vector<std::uint16_t>());
+
+  /// Queues the point cloud of a frame with its RGBA (Visionary-S) or intensity (Visionary-T Mini) values.
+  ///
+  /// The point cloud is generated in the calling thread into the buffers of the queue entry.
+  ///
+  /// \param[in] data data handler holding the frame.
+  ///
+  /// \returns true if the record was queued, false if it was dropped.
+  bool recordFrame(VisionaryData& data);
+
+  /// Queues a blob as received by VisionaryDataStream::receiveRawFrame().
+  ///
+  /// The file contains the blob framing and length in front of the buffer, as sent by the device.
+  ///
+  /// \param[in] buffer the blob starting at the protocol version, see VisionaryDataStream::RawFrame::buffer.
+  ///
+  /// \returns true if the record was queued, false if it was dropped.
+  bool recordRawFrame(const VisionaryDataStream::ByteBuffer& buffer);
+
+  /// Waits until all queued records are written.
+  void flush();
+
+  /// Returns a snapshot of the counters.
+  RecorderStatistics getStatistics() const;
+
+  /// Reads a blob file written for a raw frame record.
+  ///
+  /// Parse the blob with VisionaryDataStream::parseRawFrame() into the data handler of the recording device, then
+  /// generatePointCloud() and the map getters give the same results as for the received frame.
+  ///
+  /// \param[in]  filename the blob file.
+  /// \param[out] buffer   the blob starting at the protocol version, see VisionaryDataStream::RawFrame::buffer.
+  ///
+  /// \returns false if the file cannot be read or does not contain a complete blob.
+  static bool readRawFrame(const std::string& filename, VisionaryDataStream::ByteBuffer& buffer);
+
+private:
+  struct Record
+  {
+    RecordFormat::Enum              format;
+    std::uint64_t                   number;
+    std::vector<PointXYZ>           points;
+    std::vector<std::uint32_t>      rgbaMap;
+    std::vector<std::uint16_t>      intensityMap;
+    VisionaryDataStream::ByteBuffer blob;
+  };
+  using RecordPtr = std::unique_ptr<Record>;
+
+  /// Takes a free queue entry or counts a dropped record.
+  RecordPtr acquireRecord();
+
+  /// Takes a free queue entry, fills it and queues it.
+  ///
+  /// If filling throws, the entry goes back to the free entries and the exception is passed on.
+  ///
+  /// \returns false if the record was dropped.
+  template <typename FillFunction>
+  bool fillAndQueueRecord(FillFunction fill);
+
+  /// Queues a filled entry for the writer threads.
+  void queueRecord(RecordPtr pRecord);
+
+  /// Returns an entry which was not queued to the free entries.
+  void releaseRecord(RecordPtr pRecord);
+
+  /// Thread function of a writer thread.
+  void runWriter();
+
+  /// Writes the file of a record.
+  bool writeRecord(const Record& record) const;
+
+  const RecorderOptions m_options;
+
+  /// queue entries and counters, synchronized by m_mutex.
+  mutable std::mutex      m_mutex;
+  std::condition_variable m_queuedCv;
+  std::condition_variable m_idleCv;
+  std::vector<RecordPtr>  m_freeRecords;
+  std::deque<RecordPtr>   m_queue;
+  bool                    m_isRunning;
+  std::uint64_t           m_nextNumber;
+  RecorderStatistics      m_statistics;
+
+  std::vector<std::thread> m_writerThreads;
+};
+
+} // namespace visionary
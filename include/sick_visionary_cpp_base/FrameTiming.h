@@ -0,0 +1,107 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef> // for size_t
+#include <cstdint>
+
+namespace visionary {
+
+/// Stages of the receive pipeline for which per-frame timestamps are taken.
+namespace FrameStage {
+enum Enum
+{
+  FIRST_BYTE_RECEIVED = 0, ///< start of the blob has been received
+  LAST_BYTE_RECEIVED,      ///< the complete blob has been received
+  XML_PARSED,              ///< the XML metadata segment has been parsed
+  BINARY_PARSED,           ///< the binary segment has been parsed, the maps are available
+  HANDED_OFF,              ///< the frame was handed over by the grabber thread
+  CONSUMED,                ///< the frame was taken by the application (getNextFrame/getCurrentFrame)
+  NUM_STAGES
+};
+}
+
+/// Per-frame pipeline timestamps (steady clock).
+///
+/// The timestamps are only recorded when the library is built with the CMake option
+/// VISIONARY_BASE_ENABLE_LATENCY_TRACE. Otherwise the recording compiles away and all entries stay at the clock epoch.
+struct FrameTimestamps
+{
+  using Clock     = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  TimePoint stage[FrameStage::NUM_STAGES];
+
+  /// Returns the time spent between two stages.
+  Clock::duration between(FrameStage::Enum from, FrameStage::Enum to) const
+  {
+    return stage[to] - stage[from];
+  }
+};
+
+/// Returns whether the library was built with per-frame latency tracing.
+bool isLatencyTraceEnabled();
+
+/// Summary of a latency distribution.
+struct LatencySummary
+{
+  std::uint64_t            count;
+  std::chrono::nanoseconds min;
+  std::chrono::nanoseconds mean;
+  std::chrono::nanoseconds p50;
+  std::chrono::nanoseconds p90;
+  std::chrono::nanoseconds p99;
+  std::chrono::nanoseconds max;
+};
+
+/// Lock-free latency histogram.
+///
+/// Log-linear buckets with 16 sub-buckets per power of two (relative error < 6.25%) from 1ns up to ~18min.
+/// Values can be recorded and read concurrently from any thread; readers see a consistent-enough view for monitoring.
+class LatencyHistogram
+{
+public:
+  LatencyHistogram();
+
+  LatencyHistogram(const LatencyHistogram&)            = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  /// Adds a sample. Negative durations are counted as zero.
+  void record(std::chrono::nanoseconds value);
+
+  /// Clears all samples.
+  void reset();
+
+  /// Returns the number of recorded samples.
+  std::uint64_t getCount() const;
+
+  /// Returns the (approximate) value below which the fraction \a quantile of the samples lie.
+  ///
+  /// \param[in] quantile fraction in the range [0, 1], e.g. 0.99 for the 99th percentile
+  std::chrono::nanoseconds getPercentile(double quantile) const;
+
+  /// Returns count, min, mean, p50, p90, p99 and max at once.
+  LatencySummary getSummary() const;
+
+private:
+  static constexpr std::size_t kSubBucketBits = 4u;
+  static constexpr std::size_t kSubBuckets    = 1u << kSubBucketBits;
+  static constexpr std::size_t kMaxMsb        = 40u;
+  static constexpr std::size_t kNumBuckets    = (kMaxMsb - kSubBucketBits + 2u) * kSubBuckets;
+
+  static std::size_t   bucketIndex(std::uint64_t value);
+  static std::uint64_t bucketMidpoint(std::size_t index);
+
+  std::atomic<std::uint64_t> m_buckets[kNumBuckets];
+  std::atomic<std::uint64_t> m_count;
+  std::atomic<std::uint64_t> m_sum;
+  std::atomic<std::uint64_t> m_min;
+  std::atomic<std::uint64_t> m_max;
+};
+
+} // namespace visionary
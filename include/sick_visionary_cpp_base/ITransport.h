@@ -5,10 +5,14 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <vector>
 
+#include "ConnectionHealth.h"
+
 #if !defined(_WIN32)
 // we assume something Linux'ish here
 #  include <sys/types.h> // for ssize_t
@@ -67,6 +71,86 @@ public:
   /// \return number of received bytes or (-1) on error
   virtual recv_return_t read(ByteBuffer& buffer, std::size_t nBytesToReceive) = 0;
 
+  /// Receive data into caller provided memory
+  ///
+  /// Receive at most \a maxBytesToReceive bytes, returns as soon as some data is available. Allows to receive a large
+  /// message piece by piece into its final location.
+  ///
+  /// \param[in] pBuffer memory for at least \a maxBytesToReceive bytes.
+  /// \param[in] maxBytesToReceive maximum number of bytes to receive.
+  ///
+  /// \return number of received bytes or (-1) on error
+  virtual recv_return_t recvInto(std::uint8_t* pBuffer, std::size_t maxBytesToReceive)
+  {
+    ByteBuffer          buffer;
+    const recv_return_t retval = recv(buffer, maxBytesToReceive);
+    if (retval > 0)
+    {
+      std::copy(buffer.begin(), buffer.begin() + retval, pBuffer);
+    }
+    return retval;
+  }
+
+  /// Sets the maximum time a recv or read call waits for data
+  ///
+  /// \param[in] timeout the receive timeout.
+  ///
+  /// \retval true the timeout was applied
+  /// \retval false the transport does not support changing the timeout
+  virtual bool setReceiveTimeout(std::chrono::milliseconds timeout)
+  {
+    (void)timeout;
+    return false;
+  }
+
+  /// Returns whether the last recv or read call failed because of the receive timeout
+  ///
+  /// Allows to tell a silent but healthy connection from a broken one.
+  virtual bool hasReceiveTimedOut() const
+  {
+    return false;
+  }
+
+  /// Enables or disables receive timestamps taken by the operating system
+  ///
+  /// \param[in] enable true to request a timestamp for every received packet.
+  ///
+  /// \retval true the setting was applied
+  /// \retval false receive timestamps are not supported by the transport or the platform
+  virtual bool setReceiveTimestamping(bool enable)
+  {
+    return !enable;
+  }
+
+  /// Returns the receive timestamp of the data returned by the last recv or read call
+  ///
+  /// For a read spanning several packets this is the timestamp of the last packet.
+  ///
+  /// \param[out] timestamp receive time converted into the host steady clock domain.
+  ///
+  /// \retval true a timestamp is available
+  /// \retval false receive timestamps are disabled or not supported
+  virtual bool getLastReceiveTimestamp(std::chrono::steady_clock::time_point& timestamp) const
+  {
+    (void)timestamp;
+    return false;
+  }
+
+  /// Collects the passive health indicators of the connection
+  ///
+  /// Does not communicate with the peer, so it is cheap enough to be called for every frame.
+  ///
+  /// \param[in,out] health the indicators supported by the transport are filled in. The connected flag is set by the
+  ///                       caller; the transport clears it if it knows the connection is no longer established.
+  ///
+  /// \retval true the transport filled in its indicators
+  /// \retval false the transport does not provide health indicators
+  virtual bool getConnectionHealth(ConnectionHealth& health) const
+  {
+    (void)health;
+    return false;
+  }
+
 protected:
   virtual send_return_t send(const char* pData, size_t size) = 0;
 };
@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef> // for size_t
+#include <cstdint>
+
+namespace visionary {
+
+namespace PngCompression {
+/// Compression of the image data of PNG files.
+enum Enum
+{
+  STORED, ///< uncompressed, the fastest; the files are slightly larger than the map
+  FAST    ///< prediction filter and Huffman coding of the residuals and their zero runs, about a third of STORED
+};
+} // namespace PngCompression
+
+namespace ColorMap {
+/// Color maps of the preview images.
+enum Enum
+{
+  GRAY,  ///< black to white
+  JET,   ///< blue, cyan, yellow to red
+  TURBO  ///< perceptually smooth variant of JET (Google Turbo)
+};
+} // namespace ColorMap
+
+/// Writes 16 bit maps (depth, intensity or state) as image files.
+///
+/// The maps are written as they are, e.g. getDistanceMap() or getIntensityMap() together with getWidth() and
+/// getHeight(). PGM and PNG files keep all 16 bits and can be opened with common image tools and libraries (e.g.
+/// OpenCV's imread with IMREAD_UNCHANGED); the previews are 8 bit color images for viewing.
+class ImageWriter
+{
+public:
+  ImageWriter(const ImageWriter&)                  = delete;
+  const ImageWriter& operator=(const ImageWriter&) = delete;
+
+  /// Writes a map as binary 16 bit PGM (P5) file.
+  ///
+  /// \param[in] filename  the file to write.
+  /// \param[in] pMap      the map, row by row.
+  /// \param[in] width     number of columns.
+  /// \param[in] height    number of rows.
+  ///
+  /// \returns true if successful, false if the file cannot be written.
+  static bool WriteFormatPGM(const char*          filename,
+                             const std::uint16_t* pMap,
+                             std::uint32_t        width,
+                             std::uint32_t        height);
+
+  /// Writes a map as 16 bit grayscale PNG file.
+  ///
+  /// \param[in] filename     the file to write.
+  /// \param[in] pMap         the map, row by row.
+  /// \param[in] width        number of columns.
+  /// \param[in] height       number of rows.
+  /// \param[in] compression  compression of the image data.
+  ///
+  /// \returns true if successful, false if the file cannot be written.
+  static bool WriteFormatPNG(const char*          filename,
+                             const std::uint16_t* pMap,
+                             std::uint32_t        width,
+                             std::uint32_t        height,
+                             PngCompression::Enum compression = PngCompression::FAST);
+
+  /// Writes a color mapped 8 bit RGB preview of a map as PNG file.
+  ///
+  /// \param[in] filename     the file to write.
+  /// \param[in] pMap         the map, row by row.
+  /// \param[in] width        number of columns.
+  /// \param[in] height       number of rows.
+  /// \param[in] minValue     value mapped to the first color; smaller values are clamped.
+  /// \param[in] maxValue     value mapped to the last color; larger values are clamped.
+  /// \param[in] colorMap     the colors.
+  /// \param[in] compression  compression of the image data.
+  ///
+  /// \returns true if successful, false if the file cannot be written.
+  static bool WritePreviewPNG(const char*          filename,
+                              const std::uint16_t* pMap,
+                              std::uint32_t        width,
+                              std::uint32_t        height,
+                              std::uint16_t        minValue,
+                              std::uint16_t        maxValue,
+                              ColorMap::Enum       colorMap    = ColorMap::TURBO,
+                              PngCompression::Enum compression = PngCompression::FAST);
+
+  /// Converts a map into 8 bit RGB colors.
+  ///
+  /// The range [minValue, maxValue] is mapped linearly onto the 256 colors of the color map. Pixels with value 0 (no
+  /// data in depth maps) are black. Uses AVX2 where available.
+  ///
+  /// \param[in]  pMap       the map.
+  /// \param[in]  numPixels  number of pixels of the map.
+  /// \param[in]  minValue   value mapped to the first color; smaller values are clamped.
+  /// \param[in]  maxValue   value mapped to the last color; larger values are clamped.
+  /// \param[in]  colorMap   the colors.
+  /// \param[out] pRgb       3 * numPixels bytes receiving red, green and blue of each pixel.
+  static void applyColorMap(const std::uint16_t* pMap,
+                            std::size_t          numPixels,
+                            std::uint16_t        minValue,
+                            std::uint16_t        maxValue,
+                            ColorMap::Enum       colorMap,
+                            std::uint8_t*        pRgb);
+
+private:
+  // No instantiations
+  ImageWriter();
+  virtual ~ImageWriter();
+};
+
+} // namespace visionary
@@ -0,0 +1,24 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstdint>
+
+namespace visionary {
+
+/// Image maps extracted from the binary segment, combined as bit mask (see VisionaryData::setMapSelection()).
+namespace MapSelection {
+enum Enum : std::uint32_t
+{
+  NONE      = 0u,
+  DEPTH     = 1u << 0, ///< Z map (Visionary-S) or radial distance map (Visionary-T Mini)
+  INTENSITY = 1u << 1, ///< RGBA map (Visionary-S) or intensity map (Visionary-T Mini)
+  STATE     = 1u << 2, ///< confidence/state map
+  ALL       = DEPTH | INTENSITY | STATE
+};
+}
+
+} // namespace visionary
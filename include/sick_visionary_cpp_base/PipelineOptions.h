@@ -0,0 +1,61 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef> // for size_t
+#include <cstdint>
+
+#include "Crc32.h"
+#include "DepthFilter.h"
+#include "FrameMetadata.h"
+#include "MapSelection.h"
+
+namespace visionary {
+
+/// Threading and parsing of the receive pipeline of the frame grabber.
+struct PipelineOptions
+{
+  /// Number of threads parsing the received blobs.
+  ///
+  /// With 0 the grabber thread receives and parses each blob itself, so the next blob waits in the socket buffer while
+  /// the previous one is parsed. Otherwise the grabber thread only drains the socket into raw buffers and the parse
+  /// threads turn them into data handlers. The frames are handed off in the order they were received.
+  unsigned parseThreads = 0u;
+
+  /// Number of raw blob buffers, limits the number of received blobs waiting to be parsed.
+  ///
+  /// If all buffers are in use the grabber thread waits and further data backs up in the socket buffer.
+  std::size_t rawBuffers = 4u;
+
+  /// Parses each blob while it is received, see VisionaryDataStream::setIncrementalParsing().
+  ///
+  /// Only applies without parse threads: the grabber thread then copies the image data into the data handler while
+  /// the rest of the blob arrives, which shortens the time from the last byte to the available frame.
+  bool incrementalParsing = false;
+
+  /// Maps extracted from the received blobs, see VisionaryData::setMapSelection().
+  ///
+  /// Applied to every data handler of the grabber.
+  std::uint32_t mapSelection = MapSelection::ALL;
+
+  /// Rejects frames before their maps are extracted, see VisionaryData::setFrameFilter().
+  ///
+  /// Applied to every data handler of the grabber; rejected frames are not handed to the application. With parse
+  /// threads the filter is called concurrently from all of them.
+  FrameFilter frameFilter;
+
+  /// Validates the CRC of every received blob, see VisionaryData::setCrcValidation().
+  CrcAlgorithm::Enum crcValidation = CrcAlgorithm::NONE;
+
+  /// Filters the depth map of every frame before it is handed to the application, see VisionaryData::filterDepthMap().
+  ///
+  /// With parse threads the frames are filtered concurrently in the parse threads; set DepthFilterConfig::numThreads
+  /// to 1 then, so the parse threads do not compete for the cores. The grabber throws std::invalid_argument on
+  /// construction if the configuration is not valid; a frame whose filtering fails counts as parsed and dropped.
+  DepthFilterConfig depthFilter;
+};
+
+} // namespace visionary
@@ -0,0 +1,94 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef> // for size_t
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace visionary {
+
+namespace PointFieldType {
+/// Data type of a point field, the values are those of the ROS sensor_msgs/PointField constants.
+enum Enum
+{
+  INT8    = 1,
+  UINT8   = 2,
+  INT16   = 3,
+  UINT16  = 4,
+  INT32   = 5,
+  UINT32  = 6,
+  FLOAT32 = 7,
+  FLOAT64 = 8
+};
+} // namespace PointFieldType
+
+/// Description of one field of a packed point, as in a ROS sensor_msgs/PointField.
+struct PointField
+{
+  /// name of the field.
+  std::string name;
+  /// byte offset of the field within the point.
+  std::uint32_t offset;
+  /// data type of the field.
+  PointFieldType::Enum datatype;
+  /// number of elements of the field.
+  std::uint32_t count;
+};
+
+/// Memory layout of the points written by VisionaryData::generatePackedPointCloud().
+///
+/// Every point occupies pointStep bytes: x, y and z as consecutive float32 in meters, optionally followed or preceded
+/// by an intensity and an RGBA field. Bytes which are not covered by a field are padding and are not written. All
+/// values are stored in the byte order of the host, like a PointCloud2 message with is_bigendian false on little
+/// endian hosts.
+///
+/// The defaults give the common 16 byte layout x, y, z, padding.
+struct PointCloudLayout
+{
+  /// Size of one point in bytes, point_step of the message.
+  std::uint32_t pointStep = 16u;
+
+  /// Byte offset of x; y and z follow at +4 and +8.
+  std::uint32_t xyzOffset = 0u;
+
+  /// Writes the "intensity" field from VisionaryData::getIntensityMap().
+  ///
+  /// Frames without intensities write 0.
+  bool hasIntensity = false;
+
+  /// Byte offset of the intensity field.
+  std::uint32_t intensityOffset = 12u;
+
+  /// Data type of the intensity field, PointFieldType::UINT16 or PointFieldType::FLOAT32 (the unscaled value).
+  PointFieldType::Enum intensityType = PointFieldType::FLOAT32;
+
+  /// Writes the "rgba" field from VisionaryData::getRGBAMap().
+  ///
+  /// The color is packed into a uint32 as 0xAARRGGBB, which is what ROS tools expect of an "rgb" or "rgba" field.
+  /// Frames without colors write 0xFFFFFFFF.
+  bool hasRgba = false;
+
+  /// Byte offset of the rgba field.
+  std::uint32_t rgbaOffset = 16u;
+
+  /// Leaves out invalid points instead of writing them with NaN coordinates, is_dense of the message.
+  ///
+  /// A dense cloud is unorganized: its points are written one after another and the message has a height of 1.
+  bool isDense = false;
+
+  /// Returns true if all fields are within pointStep, do not overlap and the intensity type is supported.
+  bool isValid() const;
+
+  /// Returns the field descriptors of the layout, the fields of the message.
+  std::vector<PointField> getFields() const;
+
+  /// Returns the number of bytes needed for numPoints points.
+  std::size_t getBufferSize(std::size_t numPoints) const;
+};
+
+} // namespace visionary
@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "PointCloudPlyWriter.h" // for InvalidPointPresentation
+#include "PointXYZ.h"
+
+namespace visionary {
+
+/// Encodings of the data part of a PCD file.
+namespace PcdEncoding {
+enum Enum
+{
+  ASCII = 0,        ///< one text line per point
+  BINARY,           ///< the fields of each point one after another
+  BINARY_COMPRESSED ///< all values of a field one after another, compressed with LZF
+};
+}
+
+/// Class for writing point clouds to PCD files of the Point Cloud Library, see
+/// https://pointclouds.org/documentation/tutorials/pcd_file_format.html
+///
+/// Clouds are written organized: the WIDTH and HEIGHT of the file are the image size, so neighbouring pixels stay
+/// neighbours. With INVALID_SKIP the invalid points are left out and the cloud is written unorganized (HEIGHT 1).
+/// RGBA colors are written as field "rgb" (PCL packing 0x00RRGGBB), intensities as field "intensity" in [0, 1].
+class PointCloudPcdWriter
+{
+public:
+  PointCloudPcdWriter(const PointCloudPcdWriter&)                  = delete;
+  const PointCloudPcdWriter& operator=(const PointCloudPcdWriter&) = delete;
+
+  /// Saves a point cloud to a PCD file.
+  ///
+  /// \param[in] filename     the file to save the point cloud to.
+  /// \param[in] points       the points to save, row by row.
+  /// \param[in] width        number of points per row.
+  /// \param[in] height       number of rows.
+  /// \param[in] encoding     encoding of the data part.
+  /// \param[in] presentation how invalid points are written.
+  ///
+  /// \returns true if the file was written, false if the file cannot be written or width * height does not match the
+  ///          number of points.
+  static bool WriteFormatPCD(const char*                  filename,
+                             const std::vector<PointXYZ>& points,
+                             std::uint32_t                width,
+                             std::uint32_t                height,
+                             PcdEncoding::Enum            encoding,
+                             InvalidPointPresentation     presentation = INVALID_AS_NAN);
+
+  /// Saves a point cloud with RGBA colors and/or intensities to a PCD file.
+  ///
+  /// \param[in] filename     the file to save the point cloud to.
+  /// \param[in] points       the points to save, row by row.
+  /// \param[in] rgbaMap      RGBA colors of the points, only written if it has the same length as points.
+  /// \param[in] intensityMap intensities of the points, only written if it has the same length as points.
+  /// \param[in] width        number of points per row.
+  /// \param[in] height       number of rows.
+  /// \param[in] encoding     encoding of the data part.
+  /// \param[in] presentation how invalid points are written.
+  ///
+  /// \returns true if the file was written, false if the file cannot be written or width * height does not match the
+  ///          number of points.
+  static bool WriteFormatPCD(const char*                  filename,
+                             const std::vector<PointXYZ>& points,
+                             const std::vector<uint32_t>& rgbaMap,
+                             const std::vector<uint16_t>& intensityMap,
+                             std::uint32_t                width,
+                             std::uint32_t                height,
+                             PcdEncoding::Enum            encoding,
+                             InvalidPointPresentation     presentation = INVALID_AS_NAN);
+
+private:
+  // No instantiations
+  PointCloudPcdWriter();
+  virtual ~PointCloudPcdWriter();
+};
+
+} // namespace visionary
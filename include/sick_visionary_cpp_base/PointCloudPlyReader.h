@@ -0,0 +1,59 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "PointXYZ.h"
+
+namespace visionary {
+
+/// Reads point clouds from PLY files, as written by PointCloudPlyWriter.
+///
+/// The points are returned in the same containers as VisionaryData::generatePointCloud() fills, so offline tools can
+/// run the code of the online processing. Supported are the ascii, binary_little_endian and binary_big_endian formats
+/// with the vertex element as first element and scalar x, y and z properties of any PLY type; further elements (e.g.
+/// faces) are ignored.
+///
+/// The file is memory mapped. Binary files with float x, y and z only are copied into the points in one block, ascii
+/// files are parsed in parallel on all hardware threads.
+class PointCloudPlyReader
+{
+public:
+  PointCloudPlyReader(const PointCloudPlyReader&)                  = delete;
+  const PointCloudPlyReader& operator=(const PointCloudPlyReader&) = delete;
+
+  /// Reads the points of a PLY file.
+  ///
+  /// \param[in]  filename the file to read.
+  /// \param[out] points   the points; resized to the number of vertices.
+  ///
+  /// \returns true if successful, false if the file cannot be read or is not a supported PLY file.
+  static bool ReadFormatPLY(const char* filename, std::vector<PointXYZ>& points);
+
+  /// Reads the points of a PLY file with their colors and intensities.
+  ///
+  /// \param[in]  filename     the file to read.
+  /// \param[out] points       the points; resized to the number of vertices.
+  /// \param[out] rgbaMap      RGBA colors from the red, green, blue (and alpha) properties, empty if the file has none.
+  ///                          A missing alpha is set to 255.
+  /// \param[out] intensityMap intensities from the intensity property, empty if the file has none. Float intensities
+  ///                          are scaled from [0, 1] to [0, 65535] like PointCloudPlyWriter writes them.
+  ///
+  /// \returns true if successful, false if the file cannot be read or is not a supported PLY file.
+  static bool ReadFormatPLY(const char*                 filename,
+                            std::vector<PointXYZ>&      points,
+                            std::vector<std::uint32_t>& rgbaMap,
+                            std::vector<std::uint16_t>& intensityMap);
+
+private:
+  // No instantiations
+  PointCloudPlyReader();
+  virtual ~PointCloudPlyReader();
+};
+
+} // namespace visionary
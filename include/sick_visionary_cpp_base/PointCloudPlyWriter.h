@@ -25,6 +25,9 @@ enum InvalidPointPresentation
 };
 
 /// <summary>Class for writing point clouds to PLY files.</summary>
+///
+/// ASCII files contain the shortest representation of each float that reads back to the same value. The vertices are
+/// formatted in parallel on all hardware threads.
 class PointCloudPlyWriter
 {
 public:
@@ -0,0 +1,56 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <chrono>
+
+namespace visionary {
+
+/// Connection states reported by the frame grabber.
+namespace ConnectionState {
+enum Enum
+{
+  CONNECTED = 0, ///< the blob connection is established
+  STALLED,       ///< no frame was received within the watchdog timeout, the connection is re-established
+  DISCONNECTED,  ///< the connection was lost or a connection attempt failed
+  RECONNECTING   ///< a connection attempt is in progress
+};
+}
+
+/// Stall detection and reconnect behaviour of the frame grabber.
+struct ReconnectPolicy
+{
+  /// Delay before the second connection attempt; the first attempt is made immediately.
+  std::chrono::milliseconds initialBackoff = std::chrono::milliseconds(50);
+  /// Upper limit of the delay between connection attempts.
+  std::chrono::milliseconds maxBackoff = std::chrono::seconds(2);
+  /// Factor the delay grows with each further attempt.
+  double backoffMultiplier = 2.0;
+  /// Random variation of each delay as fraction of the delay (0.2 means +-20%), spreads the reconnects of several
+  /// grabbers.
+  double jitter = 0.2;
+
+  /// Enables the watchdog which treats a missing frame as stalled connection.
+  ///
+  /// The watchdog timeout follows the measured frame period, so a stall is detected after a few frame periods instead
+  /// of the full socket timeout. Only enable it for continuously streaming devices: in triggered or stopped
+  /// acquisition the missing frames are expected.
+  bool watchdog = false;
+  /// Watchdog timeout in multiples of the measured frame period.
+  double watchdogPeriods = 3.0;
+  /// Lower limit of the watchdog timeout.
+  std::chrono::milliseconds minWatchdogTimeout = std::chrono::milliseconds(20);
+
+  /// Returns the delay before a connection attempt.
+  ///
+  /// \param[in] attempt  number of the attempt since the connection was lost, starting at 0.
+  /// \param[in] random01 uniformly distributed random value in [0, 1) used for the jitter.
+  ///
+  /// \returns zero for the first attempt, afterwards the exponentially growing, jittered delay.
+  std::chrono::milliseconds getBackoff(unsigned attempt, double random01) const;
+};
+
+} // namespace visionary
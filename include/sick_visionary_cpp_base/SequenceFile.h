@@ -0,0 +1,249 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef> // for size_t
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "VisionaryData.h"
+#include "VisionaryType.h"
+
+namespace visionary {
+
+class MappedFile;
+
+/// Compression of the 16 bit maps in a sequence file.
+namespace SequenceCompression {
+enum Enum
+{
+  NONE = 0,       ///< maps are stored as they are
+  DEPTH_MAP_CODEC ///< 16 bit maps are compressed with DepthMapCodec, the RGBA map is stored as it is
+};
+}
+
+/// Index entry of a frame in a sequence file.
+struct SequenceFrameInfo
+{
+  /// frame number as reported by VisionaryData::getFrameNum().
+  std::uint32_t frameNum;
+  /// version of the binary data set.
+  std::uint16_t dataSetVersion;
+  /// device timestamp in device format, see VisionaryData::getTimestamp().
+  std::uint64_t timestamp;
+  /// device timestamp in milliseconds (UTC).
+  std::uint64_t timestampMS;
+  /// data quality reported by the device.
+  std::uint8_t dataQuality;
+  /// device status reported by the device.
+  std::uint8_t deviceStatus;
+};
+
+/// A frame read from a sequence file.
+///
+/// Provides the maps, camera parameters and timestamps of the recorded frame through the VisionaryData interface, so
+/// code written for received frames (e.g. generatePointCloud()) works on recordings as well.
+class SequenceFrameData : public VisionaryData
+{
+public:
+  SequenceFrameData();
+  ~SequenceFrameData() override;
+
+  /// Returns the type of the device which recorded the frame.
+  VisionaryType::Enum getVisionaryType() const;
+
+  /// Returns the depth map: the Z map of a Visionary-S or the radial distance map of a Visionary-T Mini.
+  ///
+  /// Multiply with getScaleZ() to get millimeters.
+  const std::vector<std::uint16_t>& getDepthMap() const;
+
+  /// Returns the intensity map (Visionary-T Mini), empty if not recorded.
+  const std::vector<std::uint16_t>& getIntensityMap() const override;
+
+  /// Returns the RGBA map (Visionary-S), empty if not recorded.
+  const std::vector<std::uint32_t>& getRGBAMap() const override;
+
+  /// Returns the state map, empty if not recorded.
+  const std::vector<std::uint16_t>& getStateMap() const;
+
+  /// Calculate and return the Point Cloud in the camera perspective. Units are in meters.
+  void generatePointCloud(std::vector<PointXYZ>& pointCloud) override;
+
+  /// Calculate the Point Cloud in the camera perspective into a buffer with the given layout. Units are in meters.
+  std::size_t generatePackedPointCloud(const PointCloudLayout& layout, void* pBuffer, std::size_t bufferSize) override;
+
+  /// Filters the depth map in place before the point cloud is generated.
+  bool filterDepthMap(const DepthFilterConfig& config) override;
+
+protected:
+  /// Recorded frames are not received from a data stream, always returns false.
+  bool parseXML(const std::string& xmlString, std::uint32_t changeCounter) override;
+
+  /// Recorded frames are not received from a data stream, always returns false.
+  bool parseBinaryData(std::vector<uint8_t>::iterator itBuf, std::size_t size) override;
+
+private:
+  friend class SequenceReader;
+
+  VisionaryType::Enum        m_visionaryType;
+  std::vector<std::uint16_t> m_depthMap;
+  std::vector<std::uint16_t> m_intensityMap;
+  std::vector<std::uint32_t> m_rgbaMap;
+  std::vector<std::uint16_t> m_stateMap;
+};
+
+/// Writes frames into a single sequence file with a frame index.
+///
+/// The file starts with a header holding the device type and the camera parameters, followed by one record per frame
+/// with its metadata and maps. The index of all frames is appended by close(). If a recording is not closed (e.g. the
+/// process crashed), SequenceReader rebuilds the index from the frame records.
+///
+/// The device type, image size and camera parameters are taken from the first frame; frames of a different device
+/// type or size are rejected.
+class SequenceWriter
+{
+public:
+  SequenceWriter();
+
+  /// Closes the file, see close().
+  ~SequenceWriter();
+
+  SequenceWriter(const SequenceWriter&)            = delete;
+  SequenceWriter& operator=(const SequenceWriter&) = delete;
+
+  /// Creates a sequence file, an existing file is overwritten.
+  ///
+  /// \param[in] filename    path of the file.
+  /// \param[in] compression compression of the 16 bit maps.
+  ///
+  /// \returns true if the file was created.
+  bool open(const std::string& filename, SequenceCompression::Enum compression = SequenceCompression::DEPTH_MAP_CODEC);
+
+  /// Appends a frame.
+  ///
+  /// \param[in] frame a VisionarySData, VisionaryTMiniData or SequenceFrameData; maps which were not extracted (see
+  ///                  VisionaryData::setMapSelection()) are not recorded.
+  ///
+  /// \returns false if the file is not open, the frame does not match the first frame or cannot be written.
+  bool append(const VisionaryData& frame);
+
+  /// Writes the index and closes the file.
+  ///
+  /// \returns false if the file was not open or could not be written completely.
+  bool close();
+
+  /// Returns true if a file is open.
+  bool isOpen() const;
+
+  /// Returns the number of frames written.
+  std::size_t getFrameCount() const;
+
+private:
+  bool writeHeader(const VisionaryData& frame, VisionaryType::Enum type);
+  void appendMap(std::uint8_t mapId, const std::vector<std::uint16_t>& map);
+  void appendMap(std::uint8_t mapId, const std::vector<std::uint32_t>& map);
+
+  std::ofstream             m_stream;
+  SequenceCompression::Enum m_compression;
+  bool                      m_headerWritten;
+  VisionaryType::Enum       m_visionaryType;
+  int                       m_width;
+  int                       m_height;
+  std::uint64_t             m_offset;
+  std::vector<std::uint8_t> m_index;
+  std::vector<std::uint8_t> m_record;
+  std::vector<std::uint8_t> m_encoded;
+};
+
+/// Reads a sequence file written by SequenceWriter.
+///
+/// The file is memory mapped: opening reads only the header and the index, each frame is located through the index
+/// in constant time and only its pages are loaded. A SequenceReader can be used by several threads at the same time.
+class SequenceReader
+{
+public:
+  SequenceReader();
+  ~SequenceReader();
+
+  SequenceReader(const SequenceReader&)            = delete;
+  SequenceReader& operator=(const SequenceReader&) = delete;
+
+  /// Opens a sequence file, a previously opened file is closed.
+  ///
+  /// \param[in] filename path of the file.
+  ///
+  /// \returns false if the file cannot be mapped or is not a sequence file.
+  bool open(const std::string& filename);
+
+  /// Closes the file.
+  void close();
+
+  /// Returns true if a file is open.
+  bool isOpen() const;
+
+  /// Returns true if the file was not closed by the writer and the index was rebuilt from the frame records.
+  ///
+  /// A truncated last frame is not part of the rebuilt index.
+  bool isIndexRecovered() const;
+
+  /// Returns the number of frames.
+  std::size_t getFrameCount() const;
+
+  /// Returns the type of the recording device.
+  VisionaryType::Enum getVisionaryType() const;
+
+  /// Returns the camera parameters of the recording.
+  const CameraParameters& getCameraParameters() const;
+
+  /// Returns the factor converting the depth map values into millimeters.
+  float getScaleZ() const;
+
+  /// Returns the index entry of a frame.
+  ///
+  /// \param[in]  index number of the frame in the file, starting at 0.
+  /// \param[out] info  the index entry.
+  ///
+  /// \returns false if the index is out of range.
+  bool getFrameInfo(std::size_t index, SequenceFrameInfo& info) const;
+
+  /// Returns the first frame with a timestamp at or after the given time.
+  ///
+  /// Uses a binary search, so the timestamps must not decrease within the file.
+  ///
+  /// \param[in] timestampMS device timestamp in milliseconds (UTC).
+  ///
+  /// \returns the number of the frame, getFrameCount() if all frames are older.
+  std::size_t findFrame(std::uint64_t timestampMS) const;
+
+  /// Reads a frame.
+  ///
+  /// The maps of \a frame keep their capacity, so reading into the same object does not allocate once sized.
+  ///
+  /// \param[in]  index number of the frame in the file, starting at 0.
+  /// \param[out] frame the frame.
+  ///
+  /// \returns false if the index is out of range or the frame record is corrupt.
+  bool readFrame(std::size_t index, SequenceFrameData& frame) const;
+
+private:
+  bool readHeader();
+  bool recoverIndex();
+  bool readIndexEntry(std::size_t index, std::uint64_t& offset, std::uint32_t& size, SequenceFrameInfo& info) const;
+
+  std::unique_ptr<MappedFile> m_pFile;
+  VisionaryType::Enum         m_visionaryType;
+  CameraParameters            m_cameraParams;
+  float                       m_scaleZ;
+  const std::uint8_t*         m_pIndex;
+  std::size_t                 m_frameCount;
+  std::vector<std::uint8_t>   m_recoveredIndex;
+  bool                        m_indexRecovered;
+};
+
+} // namespace visionary
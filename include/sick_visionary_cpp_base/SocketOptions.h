@@ -0,0 +1,69 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <chrono>
+#include <cstddef> // for size_t
+
+namespace visionary {
+
+/// Tuning options applied to a TCP connection.
+///
+/// A default constructed object leaves every setting at the system default. Options which are not supported by the
+/// platform are silently ignored (TCP_QUICKACK, SO_BUSY_POLL, SO_PRIORITY and the keepalive timings are Linux
+/// specific).
+struct SocketOptions
+{
+  /// Size of the socket receive buffer (SO_RCVBUF) in bytes, 0 keeps the system default (and autotuning).
+  ///
+  /// On Linux the size is limited by net.core.rmem_max unless the process has CAP_NET_ADMIN. If the requested size
+  /// cannot be granted, the buffer is left to the kernel autotuning, which usually grows larger than rmem_max, and
+  /// ConnectionHealth::receiveBufferLimited is set.
+  std::size_t receiveBufferSize = 0u;
+
+  /// Disables the Nagle algorithm (TCP_NODELAY), so small requests are sent immediately.
+  bool noDelay = false;
+
+  /// Acknowledges received segments immediately instead of delaying the ACK (TCP_QUICKACK, Linux).
+  ///
+  /// The kernel clears the flag again after some time, so it is re-armed after each receive call.
+  bool quickAck = false;
+
+  /// Busy polling time of the receive queue in microseconds (SO_BUSY_POLL, Linux), 0 disables busy polling.
+  ///
+  /// Trades CPU time for lower receive latency; the network driver must support busy polling.
+  int busyPollMicroseconds = 0;
+
+  /// Priority of the packets of the socket (SO_PRIORITY, Linux), negative values keep the default.
+  int priority = -1;
+
+  /// Enables TCP keepalive probes (SO_KEEPALIVE) to detect dead connections while no data is exchanged.
+  bool keepAlive = false;
+  /// Idle time before the first keepalive probe is sent (TCP_KEEPIDLE).
+  std::chrono::seconds keepAliveIdle = std::chrono::seconds(5);
+  /// Time between keepalive probes (TCP_KEEPINTVL).
+  std::chrono::seconds keepAliveInterval = std::chrono::seconds(1);
+  /// Number of unanswered probes after which the connection is dropped (TCP_KEEPCNT).
+  int keepAliveCount = 3;
+
+  /// Enables kernel receive timestamps, see TcpSocket::setReceiveTimestamping().
+  bool receiveTimestamps = false;
+
+  /// Returns options suited for the request/response traffic of the control channel.
+  ///
+  /// Enables TCP_NODELAY, TCP_QUICKACK and keepalive.
+  static SocketOptions controlChannel();
+
+  /// Returns options suited for a blob data stream.
+  ///
+  /// Sizes the receive buffer to hold \a depth frames and enables keepalive.
+  ///
+  /// \param[in] frameSize size of a single blob in bytes.
+  /// \param[in] depth     number of frames the receive buffer shall hold.
+  static SocketOptions blobStream(std::size_t frameSize, std::size_t depth = 4u);
+};
+
+} // namespace visionary
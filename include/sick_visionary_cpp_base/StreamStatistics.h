@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace visionary {
+
+/// Snapshot of the health statistics of a blob data stream.
+///
+/// Rates are measured from the first received frame to the most recent one.
+struct StreamStatistics
+{
+  /// number of blobs received completely (framing, length and payload).
+  std::uint64_t framesReceived;
+  /// number of blobs which were parsed successfully.
+  std::uint64_t framesParsed;
+  /// number of blobs which were truncated or malformed and could not be parsed.
+  std::uint64_t framesFailed;
+  /// number of blobs rejected by the frame filter of the data handler (see VisionaryData::setFrameFilter()).
+  std::uint64_t framesRejected;
+  /// number of parsed frames that were replaced by a newer frame before the application fetched them, or whose depth
+  /// filtering failed (see PipelineOptions::depthFilter).
+  std::uint64_t framesDropped;
+  /// number of discontinuities in the device frame numbers (only detected for data set version >= 2).
+  std::uint64_t frameNumberGaps;
+  /// number of frames missing according to the device frame numbers (only detected for data set version >= 2).
+  std::uint64_t framesMissed;
+  /// number of successful reconnects after the connection was lost.
+  std::uint64_t reconnects;
+  /// number of blob bytes received including the framing.
+  std::uint64_t bytesReceived;
+  /// number of received blobs which are not yet parsed and handed off (only with parse threads, see PipelineOptions).
+  std::uint64_t backlog;
+  /// maximum backlog seen.
+  std::uint64_t maxBacklog;
+
+  /// frame rate derived from the last inter-frame interval.
+  double currentFps;
+  /// frame rate averaged since the first received frame.
+  double averageFps;
+  /// data rate averaged since the first received frame.
+  double bytesPerSecond;
+
+  /// smoothed variation of the inter-frame arrival interval (RFC 3550 style estimator).
+  std::chrono::nanoseconds jitter;
+};
+
+/// Lock-free collector for the statistics of a single stream.
+///
+/// onFrameReceived() and onFrameParsed() are meant to be called by a single thread each, which may be different
+/// threads; the other notification functions may be called from any thread. getStatistics() and reset() can be
+/// called from any thread at any time.
+class StreamStatisticsCollector
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  StreamStatisticsCollector();
+
+  StreamStatisticsCollector(const StreamStatisticsCollector&)            = delete;
+  StreamStatisticsCollector& operator=(const StreamStatisticsCollector&) = delete;
+
+  /// A blob was received completely.
+  ///
+  /// \param[in] numBytes    size of the blob including the framing.
+  /// \param[in] arrivalTime time the start of the blob was received.
+  void onFrameReceived(std::uint64_t numBytes, Clock::time_point arrivalTime);
+
+  /// A blob was parsed successfully.
+  ///
+  /// \param[in] dataSetVersion version of the binary data set, frame numbers are only checked for version 2 and above.
+  /// \param[in] frameNum       frame number of the parsed blob.
+  void onFrameParsed(std::uint16_t dataSetVersion, std::uint32_t frameNum);
+
+  /// A blob was truncated or malformed.
+  void onFrameFailed();
+
+  /// A blob was rejected by the frame filter.
+  ///
+  /// \param[in] dataSetVersion version of the binary data set.
+  /// \param[in] frameNum       frame number of the rejected blob, so it does not show up as gap.
+  void onFrameRejected(std::uint16_t dataSetVersion, std::uint32_t frameNum);
+
+  /// A parsed frame was discarded before it was consumed.
+  void onFrameDropped();
+
+  /// The connection was re-established.
+  void onReconnect();
+
+  /// The number of received blobs waiting to be parsed changed.
+  ///
+  /// \param[in] depth number of received blobs not yet parsed and handed off.
+  void onBacklog(std::uint64_t depth);
+
+  /// Returns a snapshot of the current statistics.
+  StreamStatistics getStatistics() const;
+
+  /// Clears all statistics.
+  void reset();
+
+private:
+  static std::int64_t toNs(Clock::time_point timePoint);
+
+  void trackFrameNumber(std::uint16_t dataSetVersion, std::uint32_t frameNum);
+
+  std::atomic<std::uint64_t> m_framesReceived;
+  std::atomic<std::uint64_t> m_framesParsed;
+  std::atomic<std::uint64_t> m_framesFailed;
+  std::atomic<std::uint64_t> m_framesRejected;
+  std::atomic<std::uint64_t> m_framesDropped;
+  std::atomic<std::uint64_t> m_frameNumberGaps;
+  std::atomic<std::uint64_t> m_framesMissed;
+  std::atomic<std::uint64_t> m_reconnects;
+  std::atomic<std::uint64_t> m_bytesReceived;
+  std::atomic<std::uint64_t> m_backlog;
+  std::atomic<std::uint64_t> m_maxBacklog;
+
+  // arrival times in ns of the steady clock, 0 if not set
+  std::atomic<std::int64_t> m_firstArrivalNs;
+  std::atomic<std::int64_t> m_lastArrivalNs;
+  std::atomic<std::int64_t> m_lastIntervalNs;
+  // the next arrival follows an outage and does not form an interval
+  std::atomic<bool> m_skipInterval;
+  // jitter in ns scaled by 16 (see RFC 3550 A.8)
+  std::atomic<std::int64_t> m_jitterScaledNs;
+
+  std::atomic<bool>          m_hasLastFrameNum;
+  std::atomic<std::uint32_t> m_lastFrameNum;
+};
+
+} // namespace visionary
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "ITransport.h"
+#include "SocketOptions.h"
 
 namespace visionary {
 
@@ -37,6 +38,23 @@ public:
   int connect(const std::string&        ipaddr,
               std::uint16_t             port,
               std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+  /// connect to a peer via TCP using tuned socket options
+  ///
+  /// The buffer size, priority, busy polling, no-delay and keepalive options are applied before the connection is
+  /// established (the receive buffer size determines the negotiated window scaling).
+  ///
+  /// \param[in] ipaddr string representation of the device ip address ("xx.xx.xx.xx")
+  /// \param[in] port number of the device port to connect to (in host byte order)
+  /// \param[in] timeout timeout for the connection
+  /// \param[in] options socket options to apply
+  ///
+  /// \retval 0 connect successful
+  /// \retval -1 connect failed
+  int connect(const std::string&        ipaddr,
+              std::uint16_t             port,
+              std::chrono::milliseconds timeout,
+              const SocketOptions&      options);
   int shutdown() override;
   int getLastError() override;
 
@@ -44,9 +62,54 @@ public:
   send_return_t send(const char* pData, size_t size) override;
   recv_return_t recv(ByteBuffer& buffer, std::size_t maxBytesToReceive) override;
   recv_return_t read(ByteBuffer& buffer, std::size_t nBytesToReceive) override;
+  recv_return_t recvInto(std::uint8_t* pBuffer, std::size_t maxBytesToReceive) override;
+
+  /// Enables kernel software receive timestamps (Linux only)
+  ///
+  /// Uses SO_TIMESTAMPING with software receive timestamps, falling back to SO_TIMESTAMPNS. The timestamps are read
+  /// from the control messages of recvmsg. Must be called after connect().
+  ///
+  /// \param[in] enable true to enable, false to disable the timestamps.
+  ///
+  /// \retval true the setting was applied
+  /// \retval false the socket option could not be set or the platform does not support it
+  bool setReceiveTimestamping(bool enable) override;
+  bool setReceiveTimeout(std::chrono::milliseconds timeout) override;
+  bool hasReceiveTimedOut() const override;
+  bool getLastReceiveTimestamp(std::chrono::steady_clock::time_point& timestamp) const override;
+
+  /// Fills in the time of the last received data and, on Linux, the TCP_INFO of the socket
+  bool getConnectionHealth(ConnectionHealth& health) const override;
+
+  /// Returns the largest receive buffer size an unprivileged process can set, in bytes
+  ///
+  /// \returns net.core.rmem_max on Linux, 0 if the limit is unknown or the platform has none.
+  static std::size_t getReceiveBufferLimit();
 
 private:
+  // receive into a raw buffer, using recvmsg to collect the timestamp if enabled
+  recv_return_t receive(char* pBuffer, std::size_t maxBytesToReceive);
+
+  // apply the options which must be set before connecting
+  void applyPreConnectOptions(const SocketOptions& options);
+
+  // set the receive buffer size, honoring the system limits; returns false if the size was not granted
+  bool applyReceiveBufferSize(std::size_t size);
+
+  // set TCP_QUICKACK again if requested
+  void rearmQuickAck();
+
+  // bookkeeping after each receive call
+  void onReceived(recv_return_t retval);
+
   std::unique_ptr<SockRecord> m_pSockRecord; // buffer for a SOCKET
+  bool                        m_rxTimestamping;
+  bool                        m_quickAck;
+  bool                        m_receiveTimedOut;
+  bool                        m_receiveBufferLimited;
+  std::int64_t                m_lastRxTimestampNs; // system clock, 0 if none
+
+  std::chrono::steady_clock::time_point m_lastReceiveTime;
 };
 
 } // namespace visionary
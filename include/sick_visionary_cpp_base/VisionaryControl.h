@@ -11,10 +11,13 @@
 #include <memory>
 #include <string>
 
+#include "BlobStreamConfig.h"
 #include "CoLaCommand.h"
 #include "ControlSession.h"
 #include "IAuthentication.h"
 #include "IProtocolHandler.h"
+#include "PipelineOptions.h"
+#include "SocketOptions.h"
 #include "TcpSocket.h"
 #include "VisionaryType.h"
 
@@ -59,6 +62,7 @@ public:
   /// \param[in] sessionTimeout Timeout for Session (only used for Cola2)
   /// \param[in] autoReconnect Auto reconnect when connection was lost
   /// \param[in] connectTimeout Timeout for Connection
+  /// \param[in] socketOptions socket tuning options for the control connection
   ///
   /// \retval true The connection to the sensor successfully was established.
   /// \retval false The connection attempt failed; the sensor is either
@@ -68,7 +72,8 @@ public:
   bool open(const std::string&        hostname,
             std::chrono::seconds      sessionTimeout = kSessionTimeout,
             bool                      autoReconnect  = true,
-            std::chrono::milliseconds connectTimeout = kSessionTimeout);
+            std::chrono::milliseconds connectTimeout = kSessionTimeout,
+            const SocketOptions&      socketOptions  = SocketOptions::controlChannel());
 
   /// Close a connection
   ///
@@ -123,6 +128,26 @@ public:
   /// <returns>True if successful, false otherwise.</returns>
   bool getDataStreamConfig();
 
+  /// Reads which data sets the device sends on the blob stream.
+  ///
+  /// The Visionary-S always sends its image maps, so the default BlobStreamConfig is returned without contacting the
+  /// device.
+  ///
+  /// \param[out] config data sets enabled on the device; unchanged if reading fails.
+  ///
+  /// \returns true if successful, false otherwise.
+  bool getBlobStreamConfig(BlobStreamConfig& config);
+
+  /// Enables or disables data sets of the blob stream on the device.
+  ///
+  /// Disabling data sets which are not consumed reduces the network bandwidth and the receive time. Writing requires a
+  /// login with a user level that may change the device configuration; the setting is not stored permanently.
+  ///
+  /// \param[in] config data sets the device shall send.
+  ///
+  /// \returns true if successful, false if writing fails or the device type does not support the configuration.
+  bool setBlobStreamConfig(const BlobStreamConfig& config);
+
   /// <summary>Send a <see cref="CoLaBCommand" /> to the device and waits for the result.</summary>
   /// <param name="command">Command to send</param>
   /// <returns>The response.</returns>
@@ -140,16 +165,40 @@ public:
 
   /// Creates and returns a new frame grabber instance
   ///
+  /// The blob connection uses SocketOptions::blobStream() sized by estimateFrameSize() for the data sets enabled on the
+  /// device (see getBlobStreamConfig()). If the estimate exceeds TcpSocket::getReceiveBufferLimit() and the process
+  /// may not exceed it, the kernel autotuning is kept and ConnectionHealth::receiveBufferLimited is set.
+  ///
+  /// \param[in] pipelineOptions threading of the receive pipeline, see PipelineOptions.
+  ///
+  /// \returns a new unique pointer to a FrameGrabberBase object.
+  ///
+  /// \throws std::runtime_error if the visionary type is unknown.
+  ///
+  /// \note Contacts the device to get the configured blob port.
+  std::unique_ptr<FrameGrabberBase> createFrameGrabber(const PipelineOptions& pipelineOptions = PipelineOptions());
+
+  /// Creates and returns a new frame grabber instance using the given socket and pipeline options
+  ///
+  /// The receive buffer size is requested as given; whether it was granted is reported by
+  /// ConnectionHealth::receiveBufferLimited.
+  ///
+  /// \param[in] socketOptions   socket tuning options for the blob connection.
+  /// \param[in] pipelineOptions threading of the receive pipeline, see PipelineOptions.
+  ///
   /// \returns a new unique pointer to a FrameGrabberBase object.
   ///
   /// \throws std::runtime_error if the visionary type is unknown.
   ///
   /// \note Contacts the device to get the configured blob port.
-  std::unique_ptr<FrameGrabberBase> createFrameGrabber();
+  std::unique_ptr<FrameGrabberBase> createFrameGrabber(const SocketOptions&   socketOptions,
+                                                       const PipelineOptions& pipelineOptions = PipelineOptions());
 
 private:
   std::string receiveCoLaResponse();
   CoLaCommand receiveCoLaCommand();
+  bool        readBoolVariable(const char* name, bool& value);
+  bool        writeBoolVariable(const char* name, bool value);
 
   std::unique_ptr<TcpSocket>        m_pTransport;
   std::unique_ptr<IProtocolHandler> m_pProtocolHandler;
@@ -162,6 +211,7 @@ private:
   std::chrono::seconds      m_sessionTimeout;
   std::chrono::milliseconds m_connectTimeout;
   bool                      m_autoReconnect;
+  SocketOptions             m_socketOptions;
 };
 
 } // namespace visionary
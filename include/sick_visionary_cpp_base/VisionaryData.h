@@ -6,11 +6,18 @@
 #ifndef VISIONARY_VISONARYDATA_H_INCLUDED
 #define VISIONARY_VISONARYDATA_H_INCLUDED
 
+#include <chrono>
 #include <cstddef> // for size_t
 #include <cstdint>
 #include <string>
 #include <vector>
 
+#include "Crc32.h"
+#include "DepthFilter.h"
+#include "FrameMetadata.h"
+#include "FrameTiming.h"
+#include "MapSelection.h"
+#include "PointCloudLayout.h"
 #include "PointXYZ.h"
 
 namespace visionary {
@@ -79,6 +86,34 @@ public:
   /// cloud.
   virtual void generatePointCloud(std::vector<PointXYZ>& pointCloud) = 0;
 
+  /// Calculate the Point Cloud in the camera perspective directly into a caller provided buffer. Units are in meters.
+  ///
+  /// The points are written in a single pass with the given layout, so the data buffer of a PointCloud2 message can
+  /// be filled without an intermediate point vector. The message fields are given by PointCloudLayout::getFields(),
+  /// the point step by PointCloudLayout::pointStep. An organized cloud has the height and width of the frame, a dense
+  /// cloud a height of 1 and the returned number of points as width.
+  ///
+  /// \param[in]  layout      - memory layout of the points.
+  /// \param[out] pBuffer     - the buffer to fill.
+  /// \param[in]  bufferSize  - size of the buffer in bytes; must hold all pixels of the frame, even for dense clouds.
+  ///
+  /// \returns the number of points written; 0 if the data handler does not support packed point clouds.
+  ///
+  /// \throws std::invalid_argument if the layout is not valid or the buffer is too small.
+  virtual std::size_t generatePackedPointCloud(const PointCloudLayout& layout, void* pBuffer, std::size_t bufferSize);
+
+  /// Filters the depth map in place, see DepthFilter::apply().
+  ///
+  /// Call it before generatePointCloud() or generatePackedPointCloud(), so the point cloud is computed once from the
+  /// filtered map. The confidence masking uses the state map and, if the device has one, the intensity map.
+  ///
+  /// \param[in] config  - the filter stages.
+  ///
+  /// \returns true if the depth map was filtered, false if the frame has no depth map.
+  ///
+  /// \throws std::invalid_argument if the configuration is not supported.
+  virtual bool filterDepthMap(const DepthFilterConfig& config);
+
   /// Transform the XYZ point cloud with the Cam2World matrix got from device
   ///
   /// \param[in,out] pointCloud  - Reference to the point cloud to be transformed. Contains the transformed point cloud
@@ -94,6 +129,12 @@ public:
   /// Returns the Byte length compared to data types
   std::uint32_t getFrameNum() const;
 
+  /// Returns the version of the last parsed binary data set.
+  ///
+  /// From version 2 on the frame number is assigned by the device and can be used to detect lost frames.
+  /// Returns 0 if no data set was parsed yet.
+  std::uint16_t getDataSetVersion() const;
+
   /// Returns the timestamp in device format.
   ///
   /// Bits of the devices timestamp:
@@ -115,16 +156,54 @@ public:
 
   /// Returns the timestamp in milliseconds (UTC).
   ///
+  /// The timestamp is decoded once when the frame is parsed.
+  ///
   /// \returns the timestamp in milliseconds (UTC).
   ///
   /// \note To get timestamp in device format call getTimestamp()
   std::uint64_t getTimestampMS() const;
 
+  /// Returns the device timestamp converted into the host steady clock domain.
+  ///
+  /// The conversion uses the clock offset and drift estimated by the receiving VisionaryDataStream
+  /// (see ClockSynchronizer), so frames of several devices can be related to each other and to host events.
+  ///
+  /// \returns the estimated host time of the device timestamp; the clock epoch if the frame was not received by a
+  ///          VisionaryDataStream.
+  std::chrono::steady_clock::time_point getHostTimestamp() const;
+
+  /// Sets the host domain timestamp of the frame.
+  ///
+  /// Called by VisionaryDataStream after the frame has been parsed.
+  ///
+  /// \param[in] timestamp the device timestamp converted into the host steady clock domain.
+  void setHostTimestamp(std::chrono::steady_clock::time_point timestamp);
+
+  /// Returns the time the kernel received the packet which completed this frame.
+  ///
+  /// Free of user space scheduling delays, see VisionaryDataStream::setReceiveTimestamping().
+  ///
+  /// \returns the receive time in the host steady clock domain; the clock epoch if kernel receive timestamps are
+  ///          disabled or not supported.
+  std::chrono::steady_clock::time_point getKernelReceiveTimestamp() const;
+
+  /// Sets the kernel receive timestamp of the frame.
+  ///
+  /// Called by VisionaryDataStream after the frame has been received.
+  ///
+  /// \param[in] timestamp the receive time in the host steady clock domain.
+  void setKernelReceiveTimestamp(std::chrono::steady_clock::time_point timestamp);
+
   /// Returns a reference to the camera parameter struct
   ///
   /// \returns a reference to the camera parameter struct.
   const CameraParameters& getCameraParameters() const;
 
+  /// Returns the factor converting the values of the depth map (Z or radial distance) into millimeters.
+  ///
+  /// \returns the size of one depth unit in millimeters, 0 if no metadata was parsed yet.
+  float getScaleZ() const;
+
   /// Returns an empty vector. Override in VisionarySData.h
   ///
   /// \returns an empty vector
@@ -135,6 +214,63 @@ public:
   /// \returns an empty vector
   virtual const std::vector<std::uint16_t>& getIntensityMap() const;
 
+  /// Returns the receive pipeline timestamps of this frame.
+  ///
+  /// \note The timestamps are only taken if the library was built with VISIONARY_BASE_ENABLE_LATENCY_TRACE,
+  ///       see isLatencyTraceEnabled().
+  const FrameTimestamps& getFrameTimestamps() const;
+
+  /// Sets the timestamp of a receive pipeline stage.
+  ///
+  /// Called by VisionaryDataStream and FrameGrabberBase while the frame passes the pipeline.
+  ///
+  /// \param[in] stage      the pipeline stage.
+  /// \param[in] timestamp  time when the stage was reached.
+  void setFrameTimestamp(FrameStage::Enum stage, FrameTimestamps::TimePoint timestamp);
+
+  /// Selects the maps extracted from the binary data part.
+  ///
+  /// Maps which are not selected are neither allocated nor copied and stay empty, which saves memory bandwidth if
+  /// only some of the maps are needed. Without the depth map no point cloud can be generated. Takes effect with the
+  /// next parsed frame.
+  ///
+  /// \param[in] selection  - combination of MapSelection flags, MapSelection::ALL by default.
+  void setMapSelection(std::uint32_t selection);
+
+  /// Returns the selected maps as combination of MapSelection flags.
+  std::uint32_t getMapSelection() const;
+
+  /// Sets a predicate which rejects frames before their maps are extracted.
+  ///
+  /// The filter is called with the metadata of the binary segment header. A rejected frame is not parsed any further,
+  /// parseBinaryData() and endBinaryData() return false and isFrameRejected() returns true. VisionaryDataStream counts
+  /// it in StreamStatistics::framesRejected instead of framesFailed.
+  ///
+  /// \param[in] filter  - returns true to keep a frame; an empty filter keeps all frames.
+  void setFrameFilter(FrameFilter filter);
+
+  /// Enables the validation of the CRC at the end of the binary data part.
+  ///
+  /// The CRC covers the binary data part from the length field up to the CRC field. Frames with a mismatching CRC
+  /// fail to parse. A stored CRC of 0 means the device did not compute one, such frames are accepted.
+  ///
+  /// \param[in] algorithm  - the CRC variant the device uses, CrcAlgorithm::NONE (default) disables the validation.
+  void setCrcValidation(CrcAlgorithm::Enum algorithm);
+
+  /// Returns the CRC variant used for validation, CrcAlgorithm::NONE if disabled.
+  CrcAlgorithm::Enum getCrcValidation() const;
+
+  /// Returns the metadata of the last parsed binary segment header.
+  const FrameMetadata& getFrameMetadata() const;
+
+  /// Returns true if the last frame was rejected by the frame filter.
+  bool isFrameRejected() const;
+
+  /// Clears the rejection of the previous frame.
+  ///
+  /// Called by VisionaryDataStream before a frame is parsed.
+  void resetFrameRejected();
+
   //-----------------------------------------------
   // functions for parsing received blob
 
@@ -159,7 +295,83 @@ public:
   /// \returns true when parsing was successful.
   virtual bool parseBinaryData(std::vector<uint8_t>::iterator inputBuffer, std::size_t length) = 0;
 
+  /// Starts parsing a binary data part which is passed in pieces while it is received.
+  ///
+  /// Data handlers which provide the destinations of their maps (see prepareMapDestinations()) copy the image data
+  /// as soon as it arrives; for all others the pieces are collected and parsed by parseBinaryData() in
+  /// endBinaryData().
+  ///
+  /// \param[in] length  - Length of the binary data part.
+  void beginBinaryData(std::size_t length);
+
+  /// Parses the next piece of the binary data part.
+  ///
+  /// The pieces must be passed in order, without gaps.
+  ///
+  /// \param[in] pData   - Pointer to the piece.
+  /// \param[in] size    - Size of the piece in bytes.
+  ///
+  /// \returns false when the data is malformed; further pieces are ignored.
+  bool continueBinaryData(const std::uint8_t* pData, std::size_t size);
+
+  /// Completes parsing a binary data part started with beginBinaryData().
+  ///
+  /// \returns true when parsing was successful.
+  bool endBinaryData();
+
 protected:
+  /// Destination of an image map within the binary data part.
+  struct MapDestination
+  {
+    /// start of the map memory, nullptr to skip a map which is not selected.
+    void* pData;
+    /// number of bytes of the map in the binary data part.
+    std::size_t numBytes;
+  };
+
+  /// Returns whether the data handler can parse the binary data part incrementally.
+  ///
+  /// Called by continueBinaryData() before the frame filter, so it must only check the metadata and leave the maps
+  /// alone. The default implementation returns false, then the binary data part is collected and parsed by
+  /// parseBinaryData().
+  virtual bool canPrepareMapDestinations() const;
+
+  /// Sizes the image maps for the incremental parsing and returns their destinations.
+  ///
+  /// Called by continueBinaryData() once the header of the binary data part was received and the frame was accepted,
+  /// only if canPrepareMapDestinations() returned true.
+  ///
+  /// \param[out] destinations - the maps in the order they appear in the binary data part.
+  ///
+  /// \returns false if the data handler cannot parse the data incrementally.
+  virtual bool prepareMapDestinations(std::vector<MapDestination>& destinations);
+
+  /// Sizes a map for the incremental parsing and appends its destination.
+  ///
+  /// A map which is not selected is released and its data skipped.
+  ///
+  /// \param[in,out] map          - the map.
+  /// \param[in]     selection    - selection flag of the map.
+  /// \param[in]     numPixel     - number of pixels of the map.
+  /// \param[out]    destinations - the destinations to append to.
+  template <typename T>
+  void addMapDestination(std::vector<T>&              map,
+                         MapSelection::Enum           selection,
+                         std::size_t                  numPixel,
+                         std::vector<MapDestination>& destinations)
+  {
+    if (isMapSelected(selection))
+    {
+      map.resize(numPixel);
+      destinations.push_back(MapDestination{map.data(), numPixel * sizeof(T)});
+    }
+    else
+    {
+      releaseMap(map);
+      destinations.push_back(MapDestination{nullptr, numPixel * sizeof(T)});
+    }
+  }
+
   // Device specific image types
   enum ImageType
   {
@@ -175,6 +387,41 @@ protected:
   /// \returns the size of the data type in bytes.
   static std::size_t getItemLength(const std::string& dataType);
 
+  /// Stores the metadata of the binary segment header and applies the frame filter.
+  ///
+  /// To be called by parseBinaryData() once the header was read, m_dataSetVersion, m_frameNum and the timestamp must
+  /// be set already.
+  ///
+  /// \param[in] dataQuality   - data quality from the extended header, 0 if there is none.
+  /// \param[in] deviceStatus  - device status from the extended header, 0 if there is none.
+  ///
+  /// \returns false if the frame is rejected, the maps must not be extracted then.
+  bool acceptFrame(std::uint8_t dataQuality, std::uint8_t deviceStatus);
+
+  /// Checks the CRC of a binary data part, see setCrcValidation().
+  ///
+  /// \param[in] pData      - start of the binary data part.
+  /// \param[in] size       - number of bytes up to the CRC field.
+  /// \param[in] storedCrc  - the CRC field.
+  ///
+  /// \returns false if the validation is enabled and the CRC does not match.
+  bool checkCrc(const std::uint8_t* pData, std::size_t size, std::uint32_t storedCrc) const;
+
+  /// Returns true if the map is selected for extraction, see setMapSelection().
+  bool isMapSelected(MapSelection::Enum map) const;
+
+  /// Releases the memory of a map which is not selected.
+  template <typename T>
+  static void releaseMap(std::vector<T>& map)
+  {
+    std::vector<T>().swap(map);
+  }
+
+  /// Sets the timestamp in blob format and decodes it into milliseconds.
+  ///
+  /// \param[in] blobTimestamp  - timestamp as received in the binary segment.
+  void setBlobTimestamp(std::uint64_t blobTimestamp);
+
   /// Pre-calculate lookup table for faster point-cloud conversion.
   ///
   /// This function pre-calculates the lookup table for the lens distortion correction,
@@ -197,6 +444,34 @@ protected:
                           const ImageType&                  imgType,
                           std::vector<PointXYZ>&            pointCloud);
 
+  /// Calculate the Point Cloud in the camera perspective into a buffer with the given layout.
+  ///
+  /// Units are in meters. Intensities and colors are taken from getIntensityMap() and getRGBAMap().
+  ///
+  /// \param[in]  map         - Image to be transformed
+  /// \param[in]  imgType     - Type of the image (needed for correct transformation)
+  /// \param[in]  layout      - memory layout of the points.
+  /// \param[out] pBuffer     - the buffer to fill.
+  /// \param[in]  bufferSize  - size of the buffer in bytes.
+  ///
+  /// \returns the number of points written.
+  std::size_t generatePackedPointCloud(const std::vector<std::uint16_t>& map,
+                                       const ImageType&                  imgType,
+                                       const PointCloudLayout&           layout,
+                                       void*                             pBuffer,
+                                       std::size_t                       bufferSize);
+
+  /// Filters a depth map of the frame, see filterDepthMap().
+  ///
+  /// \param[in]     config    - the filter stages.
+  /// \param[in,out] map       - the depth map.
+  /// \param[in]     stateMap  - the state map, ignored if not of the size of the depth map.
+  ///
+  /// \returns false if the depth map does not have the size of the frame.
+  bool filterDepthMap(const DepthFilterConfig&          config,
+                      std::vector<std::uint16_t>&       map,
+                      const std::vector<std::uint16_t>& stateMap);
+
   //-----------------------------------------------
   /// Camera parameters to be read from XML Metadata part
   CameraParameters m_cameraParams{};
@@ -213,18 +488,79 @@ protected:
   /// Dataset Version 2: framenumber received with dataset
   std::uint_fast32_t m_frameNum;
 
+  /// Maps extracted from the binary data part, combination of MapSelection flags
+  std::uint32_t m_mapSelection;
+
+  /// CRC variant used to validate the binary data part
+  CrcAlgorithm::Enum m_crcValidation;
+
+  /// Predicate rejecting frames before the maps are extracted
+  FrameFilter m_frameFilter;
+
+  /// Metadata of the last binary segment header
+  FrameMetadata m_frameMetadata;
+
+  /// The last frame was rejected by m_frameFilter
+  bool m_frameRejected;
+
+  /// Version of the last parsed binary data set
+  std::uint16_t m_dataSetVersion;
+
   /// Timestamp in blob format
   ///
   /// To get timestamp in milliseconds call getTimestampMS()
   std::uint64_t m_blobTimestamp;
 
+  /// Timestamp in milliseconds since the Unix epoch (UTC), decoded from m_blobTimestamp
+  std::uint64_t m_timestampMS;
+
+  /// Device timestamp in the host steady clock domain
+  std::chrono::steady_clock::time_point m_hostTimestamp;
+
+  /// Kernel receive time of the last packet of the frame in the host steady clock domain
+  std::chrono::steady_clock::time_point m_kernelReceiveTimestamp;
+
   /// Image type used for the camera lens correction pre-calculations.
   ImageType m_preCalcCamInfoType;
 
   // The look-up-tables containing pre-calculations
   std::vector<PointXYZ> m_preCalcCamInfo;
 
+  /// Receive pipeline timestamps
+  FrameTimestamps m_frameTimestamps;
+
 private:
+  // Phases of the incremental parsing of the binary data part
+  enum BinaryPhase
+  {
+    BINARY_HEADER,  // collecting the header
+    BINARY_MAPS,    // copying the maps to their destinations
+    BINARY_FOOTER,  // collecting the footer
+    BINARY_TRAILER, // ignoring data after the footer
+    BINARY_COLLECT, // collecting everything for parseBinaryData()
+    BINARY_FAILED   // malformed data, ignoring everything
+  };
+
+  // Parses the collected header and sets up the map destinations.
+  void startMaps();
+
+  // Adds a piece of the binary data part to the running CRC if the validation is enabled.
+  void updateCrc(const std::uint8_t* pData, std::size_t size);
+
+  // Compares a computed CRC with the stored one, see setCrcValidation().
+  bool compareCrc(std::uint32_t computedCrc, std::uint32_t storedCrc) const;
+
+  // State of the incremental parsing
+  BinaryPhase                 m_binaryPhase;
+  std::size_t                 m_binaryLength;
+  std::size_t                 m_binaryReceived;
+  std::uint32_t               m_binaryDataLength;
+  std::vector<std::uint8_t>   m_binaryCollected;
+  std::vector<MapDestination> m_mapDestinations;
+  std::size_t                 m_mapIndex;
+  std::size_t                 m_mapOffset;
+  std::uint32_t               m_binaryCrc;
+
   // Bitmasks to calculate the timestamp in milliseconds
   // Bits of the devices timestamp: 5 unused - 12 Year - 4 Month - 5 Day - 11 Timezone - 5 Hour - 6 Minute - 6 Seconds -
   // 10 Milliseconds
@@ -8,6 +8,9 @@
 #include <chrono>
 #include <memory>
 
+#include "ClockSynchronizer.h"
+#include "FrameTiming.h"
+#include "StreamStatistics.h"
 #include "TcpSocket.h"
 #include "VisionaryData.h"
 
@@ -18,6 +21,24 @@ class VisionaryDataStream
 public:
   using ByteBuffer = std::vector<std::uint8_t>;
 
+  /// A blob as received from the device, before it is parsed.
+  struct RawFrame
+  {
+    /// the blob starting at the protocol version (without the framing and the length).
+    ByteBuffer buffer;
+    /// receive time of the start of the blob (the kernel receive time if receive timestamps are enabled).
+    std::chrono::steady_clock::time_point arrivalTime;
+    /// kernel receive time of the end of the blob, default constructed if not available.
+    std::chrono::steady_clock::time_point kernelReceiveTime;
+    /// timestamps of the receive stages, copied to the data handler when parsed.
+    FrameTimestamps timestamps;
+
+    void setFrameTimestamp(FrameStage::Enum stage, FrameTimestamps::TimePoint timestamp)
+    {
+      timestamps.stage[stage] = timestamp;
+    }
+  };
+
   VisionaryDataStream(std::shared_ptr<VisionaryData> dataHandler);
   ~VisionaryDataStream();
 
@@ -27,6 +48,8 @@ public:
   /// \param[in] port     control command port of the sensor, usually 2112 for CoLa-B or 2122 for CoLa-2
   ///                     (given in host-byte order).
   /// \param[in] timeout  controls the socket timeout, default 5s
+  /// \param[in] options  socket tuning options, e.g. SocketOptions::blobStream(); by default the system settings are
+  ///                     kept.
   ///
   /// \retval true The connection to the sensor successfully was established.
   /// \retval false The connection attempt failed; the sensor is either
@@ -35,7 +58,8 @@ public:
   ///               - the protocol type or the port did not match. Please check your sensor documentation.
   bool open(const std::string&        hostname,
             std::uint16_t             port,
-            std::chrono::milliseconds timeout = std::chrono::seconds(5));
+            std::chrono::milliseconds timeout = std::chrono::seconds(5),
+            const SocketOptions&      options = SocketOptions());
 
   /// Sets a socket used for the connection to a Visionary sensor
   /// The socket must already be ready to use and opened.
@@ -51,6 +75,29 @@ public:
   /// that is not open. In this case this call is a no-op.
   void close();
 
+  /// Enables kernel receive timestamps on the connection
+  ///
+  /// The setting is kept for subsequent calls of open(). With receive timestamps enabled each frame carries the
+  /// kernel receive time of its last packet (VisionaryData::getKernelReceiveTimestamp()) and the statistics and the
+  /// clock synchronization use the kernel receive time of its first packet.
+  ///
+  /// \param[in] enable true to enable the timestamps.
+  ///
+  /// \retval true the setting was applied (or will be applied on open)
+  /// \retval false the transport does not support receive timestamps
+  bool setReceiveTimestamping(bool enable);
+
+  /// Enables parsing while the frame is still being received
+  ///
+  /// With incremental parsing getNextFrame() parses the XML segment as soon as it has arrived and copies the image
+  /// data into the maps of the data handler while the rest of the frame is received, so the frame is available
+  /// shortly after its last byte. Only getNextFrame() parses incrementally, receiveRawFrame() always receives the
+  /// complete blob. With incremental parsing the XML_PARSED and BINARY_PARSED stages may be recorded before
+  /// LAST_BYTE_RECEIVED.
+  ///
+  /// \param[in] enable true to parse incrementally.
+  void setIncrementalParsing(bool enable);
+
   bool syncCoLa() const;
 
   //-----------------------------------------------
@@ -58,17 +105,71 @@ public:
   // Returns true when valid frame completely received.
   bool getNextFrame();
 
+  /// Receives the next blob without parsing it
+  ///
+  /// getNextFrame() is the combination of receiveRawFrame(), parseRawFrame() and finishFrame(). Calling them
+  /// separately allows to receive the next blob while the previous ones are still parsed in other threads.
+  ///
+  /// \param[in,out] frame receives the blob; its buffer is reused, so pass the same objects again to avoid
+  ///                      allocations.
+  ///
+  /// \retval true a complete blob was received
+  /// \retval false the receive failed or timed out, see isConnectionLost()
+  bool receiveRawFrame(RawFrame& frame);
+
+  /// Parses a received blob into a data handler
+  ///
+  /// Does not access the state of the stream, so different blobs can be parsed concurrently into different data
+  /// handlers, also concurrently to receiveRawFrame().
+  ///
+  /// \param[in] frame       the received blob.
+  /// \param[in] dataHandler the data handler to fill.
+  ///
+  /// \retval true the blob was parsed successfully
+  bool parseRawFrame(RawFrame& frame, VisionaryData& dataHandler) const;
+
+  /// Completes a frame after parseRawFrame()
+  ///
+  /// Updates the statistics and the clock synchronization and sets the host timestamp of the data handler.
+  /// Must be called in the order the blobs were received, from one thread at a time.
+  ///
+  /// \param[in] frame       the received blob.
+  /// \param[in] parsed      the result of parseRawFrame().
+  /// \param[in] dataHandler the data handler the blob was parsed into.
+  void finishFrame(const RawFrame& frame, bool parsed, VisionaryData& dataHandler);
+
   /// Checks if connection is established
   ///
   /// \attention To check if the connection is estabilished data has to be
   ///  sent to the camera which means this is a costly operation. Should only be
-  ///  used when get getNextFrame fails.
+  ///  used when get getNextFrame fails. getConnectionHealth() is a passive alternative.
   ///
   /// \retval true The connection to the sensor is established.
   /// \retval false The connection to the sensor is lost. A reconnection by
   ///               calling close + open is necessary.
   bool isConnected() const;
 
+  /// Returns the passive health indicators of the connection
+  ///
+  /// Nothing is sent to the device: liveness is derived from the time data was last received and the TCP state
+  /// (including keepalive failures), the TCP_INFO adds round trip time and retransmission counters where available.
+  /// Cheap enough to be called after every frame; must not be called concurrently to getNextFrame().
+  ConnectionHealth getConnectionHealth() const;
+
+  /// Returns whether the last getNextFrame() call failed because the connection was closed or broken
+  ///
+  /// Contrary to isConnected() this does not communicate with the device. A receive timeout or malformed data do not
+  /// count as lost connection.
+  bool isConnectionLost() const;
+
+  /// Changes the receive timeout of the open connection
+  ///
+  /// \param[in] timeout the maximum time getNextFrame() waits for data.
+  ///
+  /// \retval true the timeout was applied
+  /// \retval false no connection is open or the transport does not support it
+  bool setReceiveTimeout(std::chrono::milliseconds timeout);
+
   /// Sets a new data handler
   ///
   /// \param[in] dataHandler a Datahandler.
@@ -79,13 +180,68 @@ public:
   /// \retval the dataHandler
   std::shared_ptr<VisionaryData> getDataHandler();
 
+  /// Returns a snapshot of the stream statistics.
+  ///
+  /// The statistics are kept across close() and open() and can be read from any thread.
+  StreamStatistics getStatistics() const;
+
+  /// Returns the collector of the stream statistics, e.g. to report dropped frames or reconnects.
+  StreamStatisticsCollector& getStatisticsCollector();
+
+  /// Returns the estimator of the device clock relative to the host steady clock.
+  ///
+  /// It is fed with every parsed frame and used to set VisionaryData::getHostTimestamp().
+  ClockSynchronizer& getClockSynchronizer();
+
 private:
   std::shared_ptr<VisionaryData> m_dataHandler;
   std::unique_ptr<ITransport>    m_pTransport;
+  StreamStatisticsCollector      m_statistics;
+  ClockSynchronizer              m_clockSynchronizer;
+  bool                           m_receiveTimestamping;
+  bool                           m_connectionLost;
+  bool                           m_incrementalParsing;
+
+  // receive buffers, kept across frames and reconnects
+  ByteBuffer m_lengthBuffer;
+  RawFrame   m_rawFrame;
+
+  // Applies the receive timestamp setting to the current transport.
+  bool applyReceiveTimestamping();
+
+  // Receives a package piece by piece into a buffer.
+  class PackageReceiver;
+
+  // Wait for the framing of the next blob and record its arrival.
+  // Returns true when the framing was received.
+  bool receiveFrameStart(RawFrame& frame);
+
+  // Receive the package length following the framing.
+  bool receivePackageLength(std::uint32_t& packageLength);
+
+  // Receive the remainder of a blob after the framing.
+  // Returns true when the blob was completely received.
+  bool receiveBlob(RawFrame& frame);
+
+  // Receive the remainder of a blob after the framing and parse it while it arrives.
+  // Returns true when the blob was completely received, \a parsed tells whether parsing was successful.
+  bool receiveAndParseBlob(RawFrame& frame, VisionaryData& dataHandler, bool& parsed);
+
+  // Record the end of a completely received blob.
+  void completeReceive(RawFrame& frame, std::uint32_t packageLength);
+
+  // Parse the parts of the package as soon as they are received.
+  // Returns true when parsing was successful.
+  static bool parseWhileReceiving(PackageReceiver& receiver, VisionaryData& dataHandler);
+
+  // Copy the receive timestamps of the blob to the data handler.
+  static void applyReceiveTimes(const RawFrame& frame, VisionaryData& dataHandler);
 
   // Parse the Segment-Binary-Data (Blob data without protocol version and packet type).
   // Returns true when parsing was successful.
-  bool parseSegmentBinaryData(const ByteBuffer::iterator itBuf, std::size_t bufferSize);
+  static bool parseSegmentBinaryData(VisionaryData&             dataHandler,
+                                     const ByteBuffer::iterator itBuf,
+                                     std::size_t                bufferSize);
 };
 
 } // namespace visionary
@@ -34,6 +34,12 @@ public:
   // Calculate and return the Point Cloud in the camera perspective. Units are in meters.
   void generatePointCloud(std::vector<PointXYZ>& pointCloud) override;
 
+  // Calculate the Point Cloud in the camera perspective into a buffer with the given layout. Units are in meters.
+  std::size_t generatePackedPointCloud(const PointCloudLayout& layout, void* pBuffer, std::size_t bufferSize) override;
+
+  // Filters the depth map in place before the point cloud is generated.
+  bool filterDepthMap(const DepthFilterConfig& config) override;
+
 protected:
   //-----------------------------------------------
   // functions for parsing received blob
@@ -47,6 +53,12 @@ protected:
   // Returns true when parsing was successful.
   bool parseBinaryData(std::vector<uint8_t>::iterator itBuf, std::size_t size) override;
 
+  // Check the metadata for the incremental parsing.
+  bool canPrepareMapDestinations() const override;
+
+  // Size the maps and return their destinations for the incremental parsing.
+  bool prepareMapDestinations(std::vector<MapDestination>& destinations) override;
+
 private:
   /// Byte depth of images
   std::size_t m_zByteDepth, m_rgbaByteDepth, m_confidenceByteDepth;
@@ -33,9 +33,35 @@ public:
   // Gets the state map
   const std::vector<std::uint16_t>& getStateMap() const;
 
+  // Gets the data sets contained in the blobs
+  const DataSetsActive& getDataSetsActive() const;
+
+  // Gets the distances of the polar 2D data set (empty if the data set is not active)
+  // The i-th value belongs to the angle getPolarStartAngle() + i * getPolarAngularResolution()
+  const std::vector<float>& getPolarDistanceData() const;
+
+  // Gets the confidences of the polar 2D data set (empty if the data set is not active)
+  const std::vector<float>& getPolarConfidenceData() const;
+
+  // Gets the angle of the first polar 2D value as sent by the device
+  float getPolarStartAngle() const;
+
+  // Gets the angle between two polar 2D values as sent by the device
+  float getPolarAngularResolution() const;
+
+  // Gets the points of the cartesian data set computed by the device (empty if the data set is not active)
+  // The points are computed on the device, so generatePointCloud() is not needed for them.
+  const std::vector<PointXYZC>& getCartesianData() const;
+
   // Calculate and return the Point Cloud in the camera perspective. Units are in meters.
   void generatePointCloud(std::vector<PointXYZ>& pointCloud) override;
 
+  // Calculate the Point Cloud in the camera perspective into a buffer with the given layout. Units are in meters.
+  std::size_t generatePackedPointCloud(const PointCloudLayout& layout, void* pBuffer, std::size_t bufferSize) override;
+
+  // Filters the depth map in place before the point cloud is generated.
+  bool filterDepthMap(const DepthFilterConfig& config) override;
+
   // factor to convert Radial distance map from fixed point to floating point
   static const float DISTANCE_MAP_UNIT;
 
@@ -53,7 +79,29 @@ protected:
   // Returns true when parsing was successful.
   bool parseBinaryData(std::vector<uint8_t>::iterator itBuf, std::size_t size) override;
 
+  // Check the metadata for the incremental parsing.
+  bool canPrepareMapDestinations() const override;
+
+  // Size the maps and return their destinations for the incremental parsing.
+  bool prepareMapDestinations(std::vector<MapDestination>& destinations) override;
+
 private:
+  // Parse the CRC and the length copy at the end of a data set.
+  bool parseDataSetFooter(std::vector<uint8_t>::iterator  itDataSet,
+                          std::vector<uint8_t>::iterator& itBuf,
+                          std::size_t&                    remainingSize,
+                          std::uint32_t                   length);
+
+  // Take the timestamp, frame number and version of a blob without depth map from its other data sets.
+  // Does not advance the buffer; the frame number is the scan counter of the polar 2D data set if present.
+  bool parseFrameInfoWithoutDepthMap(std::vector<uint8_t>::iterator itBuf, std::size_t remainingSize);
+
+  // Parse the polar 2D data set following the depth map data set.
+  bool parsePolar2DDataSet(std::vector<uint8_t>::iterator& itBuf, std::size_t& remainingSize);
+
+  // Parse the cartesian data set following the polar 2D data set.
+  bool parseCartesianDataSet(std::vector<uint8_t>::iterator& itBuf, std::size_t& remainingSize);
+
   // Indicator for the received data sets
   DataSetsActive m_dataSetsActive;
 
@@ -64,6 +112,16 @@ private:
   std::vector<std::uint16_t> m_distanceMap;
   std::vector<std::uint16_t> m_intensityMap;
   std::vector<std::uint16_t> m_stateMap;
+
+  // Polar 2D data set
+  std::size_t        m_numPolarValues;
+  float              m_polarStartAngle;
+  float              m_polarAngularResolution;
+  std::vector<float> m_polarDistanceData;
+  std::vector<float> m_polarConfidenceData;
+
+  // Cartesian data set
+  std::vector<PointXYZC> m_cartesianData;
 };
 
 } // namespace visionary
@@ -0,0 +1,79 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "BlobStreamConfig.h"
+
+#include <stdexcept>
+
+namespace visionary {
+
+namespace {
+
+// 4x STX, package length(32bit), protocol version(16bit), packet type(8bit), blob id(16bit), number of segments(16bit)
+// and offset and change counter(32bit each) of the XML and binary segment
+constexpr std::size_t kBlobFramingSize = 4u + 4u + 2u + 1u + 2u + 2u + 2u * (4u + 4u);
+// the XML description of all data sets stays well below this size
+constexpr std::size_t kXmlSegmentSize = 8u * 1024u;
+// Length(32bit) + TimeStamp(64bit) + Version(16bit) + FrameNumber(32bit) + DataQuality(8bit) + DeviceStatus(8bit)
+constexpr std::size_t kDepthMapHeaderSize = 4u + 8u + 2u + 4u + 1u + 1u;
+// CRC(32bit) + LengthCopy(32bit)
+constexpr std::size_t kDataSetFooterSize = 4u + 4u;
+// Length, TimeStamp, DeviceID, ScanCounter, SysCountScan, six floats and the four floats of the confidence values
+constexpr std::size_t kPolar2DHeaderSize = 4u + 8u + 2u + 4u + 4u + 6u * 4u + 4u * 4u;
+// Length(32bit) + TimeStamp(64bit) + Version(16bit) + NumPoints(32bit)
+constexpr std::size_t kCartesianHeaderSize = 4u + 8u + 2u + 4u;
+// X, Y, Z and confidence (float each)
+constexpr std::size_t kCartesianPointSize = 4u * 4u;
+
+struct NominalGeometry
+{
+  std::size_t width;
+  std::size_t height;
+  std::size_t bytesPerPixel; ///< sum over all image maps
+};
+
+NominalGeometry nominalGeometry(VisionaryType visionaryType)
+{
+  switch (visionaryType)
+  {
+    case VisionaryType::eVisionaryS:
+      // Z (16bit), RGBA (32bit) and state (16bit) maps
+      return NominalGeometry{640u, 512u, 2u + 4u + 2u};
+
+    case VisionaryType::eVisionaryTMini:
+      // distance, intensity and state maps (16bit each)
+      return NominalGeometry{512u, 424u, 2u + 2u + 2u};
+  }
+  throw std::runtime_error("Unknown Visionary type");
+}
+
+} // namespace
+
+std::size_t estimateFrameSize(VisionaryType visionaryType, const BlobStreamConfig& config)
+{
+  const NominalGeometry geometry  = nominalGeometry(visionaryType);
+  const std::size_t     numPixels = geometry.width * geometry.height;
+
+  std::size_t frameSize = kBlobFramingSize + kXmlSegmentSize;
+  if (config.depthMap)
+  {
+    frameSize += kDepthMapHeaderSize + numPixels * geometry.bytesPerPixel + kDataSetFooterSize;
+  }
+  if (visionaryType == VisionaryType::eVisionaryTMini)
+  {
+    if (config.polar2D)
+    {
+      // one distance and one confidence value (float each) per image column
+      frameSize += kPolar2DHeaderSize + 2u * geometry.width * sizeof(float) + kDataSetFooterSize;
+    }
+    if (config.cartesian)
+    {
+      frameSize += kCartesianHeaderSize + numPixels * kCartesianPointSize + kDataSetFooterSize;
+    }
+  }
+  return frameSize;
+}
+
+} // namespace visionary
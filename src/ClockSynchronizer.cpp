@@ -0,0 +1,159 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "ClockSynchronizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace visionary {
+
+ClockSynchronizer::ClockSynchronizer(std::chrono::milliseconds bucketDuration,
+                                     std::size_t               numBuckets,
+                                     std::chrono::milliseconds maxResidual)
+  : m_bucketDurationMs(static_cast<double>(bucketDuration.count()))
+  , m_numBuckets(std::max<std::size_t>(1u, numBuckets))
+  , m_maxResidualMs(static_cast<double>(maxResidual.count()))
+{
+  m_buckets.reserve(m_numBuckets);
+  resetLocked();
+}
+
+void ClockSynchronizer::addSample(std::uint64_t deviceTimeMs, Clock::time_point hostTime)
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+
+  if (m_hasReference)
+  {
+    const double x = static_cast<double>(static_cast<std::int64_t>(deviceTimeMs - m_refDeviceMs));
+    const double y =
+      std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(hostTime - m_refHost).count() - x;
+
+    // a receive time before the fitted line means a negative transport delay, a device time running backwards cannot
+    // be a delay either: in both cases the device clock was set
+    if (y < offsetAtLocked(x) - m_maxResidualMs || x < m_lastX - m_maxResidualMs)
+    {
+      resetLocked();
+    }
+    else
+    {
+      if (x >= m_currentBucketStart + m_bucketDurationMs)
+      {
+        if (m_buckets.size() < m_numBuckets)
+        {
+          m_buckets.push_back(m_currentMin);
+        }
+        else
+        {
+          m_buckets[m_bucketHead] = m_currentMin;
+          m_bucketHead            = (m_bucketHead + 1u) % m_numBuckets;
+        }
+        m_currentBucketStart = x;
+        m_currentMin         = Point{x, y};
+      }
+      else if (y < m_currentMin.y)
+      {
+        m_currentMin = Point{x, y};
+      }
+      m_lastX = x;
+      ++m_numSamples;
+      fitLocked();
+      return;
+    }
+  }
+
+  // first sample (or first after a reset) becomes the reference
+  m_hasReference = true;
+  m_refDeviceMs  = deviceTimeMs;
+  m_refHost      = hostTime;
+  m_numSamples   = 1u;
+  m_currentMin   = Point{0.0, 0.0};
+}
+
+void ClockSynchronizer::fitLocked()
+{
+  // least squares fit through the bucket minima including the running one
+  const double n  = static_cast<double>(m_buckets.size() + 1u);
+  double       mx = m_currentMin.x;
+  double       my = m_currentMin.y;
+  for (const auto& point : m_buckets)
+  {
+    mx += point.x;
+    my += point.y;
+  }
+  mx /= n;
+  my /= n;
+
+  double sxx = (m_currentMin.x - mx) * (m_currentMin.x - mx);
+  double sxy = (m_currentMin.x - mx) * (m_currentMin.y - my);
+  for (const auto& point : m_buckets)
+  {
+    sxx += (point.x - mx) * (point.x - mx);
+    sxy += (point.x - mx) * (point.y - my);
+  }
+
+  m_slope     = (sxx > 0.0) ? sxy / sxx : 0.0;
+  m_intercept = my - m_slope * mx;
+}
+
+double ClockSynchronizer::offsetAtLocked(double x) const
+{
+  return m_intercept + m_slope * x;
+}
+
+ClockSynchronizer::Clock::time_point ClockSynchronizer::toHostTime(std::uint64_t deviceTimeMs) const
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+
+  if (!m_hasReference)
+  {
+    return Clock::time_point();
+  }
+  const double x      = static_cast<double>(static_cast<std::int64_t>(deviceTimeMs - m_refDeviceMs));
+  const double hostMs = x + offsetAtLocked(x);
+  return m_refHost + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(hostMs));
+}
+
+ClockSyncEstimate ClockSynchronizer::getEstimate() const
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+
+  ClockSyncEstimate estimate{};
+  estimate.valid      = m_hasReference;
+  estimate.numSamples = m_hasReference ? m_numSamples : 0u;
+  if (m_hasReference)
+  {
+    const std::int64_t refHostNs   = static_cast<std::int64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(m_refHost.time_since_epoch()).count());
+    const std::int64_t refDeviceNs = static_cast<std::int64_t>(m_refDeviceMs) * 1000000;
+    estimate.offset                = std::chrono::nanoseconds(
+      refHostNs - refDeviceNs + static_cast<std::int64_t>(std::llround(offsetAtLocked(m_lastX) * 1.0e6)));
+    estimate.driftPpm = m_slope * 1.0e6;
+  }
+  return estimate;
+}
+
+void ClockSynchronizer::reset()
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+  resetLocked();
+}
+
+void ClockSynchronizer::resetLocked()
+{
+  m_hasReference = false;
+  m_refDeviceMs  = 0u;
+  m_refHost      = Clock::time_point();
+  m_numSamples   = 0u;
+  m_lastX        = 0.0;
+  m_buckets.clear();
+  m_bucketHead         = 0u;
+  m_currentBucketStart = 0.0;
+  m_currentMin         = Point{0.0, 0.0};
+  m_intercept          = 0.0;
+  m_slope              = 0.0;
+}
+
+} // namespace visionary
@@ -0,0 +1,21 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "ConnectionHealth.h"
+
+namespace visionary {
+
+bool ConnectionHealth::isAlive(std::chrono::milliseconds maxSilence, Clock::time_point now) const
+{
+  if (!connected)
+  {
+    return false;
+  }
+  const Clock::time_point last =
+    (hasTcpInfo && lastKernelReceiveTime > lastReceiveTime) ? lastKernelReceiveTime : lastReceiveTime;
+  return last != Clock::time_point() && now - last <= maxSilence;
+}
+
+} // namespace visionary
@@ -0,0 +1,273 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "Crc32.h"
+
+#include "VisionaryEndian.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#  define VISIONARY_CRC32C_SSE42
+#  include <nmmintrin.h>
+#  define VISIONARY_TARGET_SSE42 __attribute__((target("sse4.2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#  define VISIONARY_CRC32C_SSE42
+#  include <intrin.h>
+#  include <nmmintrin.h>
+#  define VISIONARY_TARGET_SSE42
+#endif
+
+#if defined(__ARM_FEATURE_CRC32)
+#  define VISIONARY_CRC32_ARMV8
+#  include <arm_acle.h>
+#endif
+
+namespace visionary {
+
+namespace {
+
+// reflected polynomials
+constexpr std::uint32_t kPolynomialCrc32  = 0xEDB88320u;
+constexpr std::uint32_t kPolynomialCrc32C = 0x82F63B78u;
+
+// lookup tables of the slicing-by-8 algorithm: entry [k][b] is the CRC of byte b followed by k zero bytes
+struct SlicingTables
+{
+  explicit SlicingTables(std::uint32_t polynomial)
+  {
+    for (std::uint32_t i = 0u; i < 256u; ++i)
+    {
+      std::uint32_t crc = i;
+      for (int bit = 0; bit < 8; ++bit)
+      {
+        crc = (crc & 1u) ? (crc >> 1) ^ polynomial : crc >> 1;
+      }
+      table[0][i] = crc;
+    }
+    for (std::uint32_t i = 0u; i < 256u; ++i)
+    {
+      for (int k = 1; k < 8; ++k)
+      {
+        table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFFu];
+      }
+    }
+  }
+
+  std::uint32_t table[8][256];
+};
+
+const SlicingTables& slicingTables(CrcAlgorithm::Enum algorithm)
+{
+  static const SlicingTables crc32Tables(kPolynomialCrc32);
+  static const SlicingTables crc32cTables(kPolynomialCrc32C);
+  return (algorithm == CrcAlgorithm::CRC32C) ? crc32cTables : crc32Tables;
+}
+
+// all update functions work on the CRC register, without initial value and final inversion
+std::uint32_t updateSlicingBy8(const SlicingTables& tables,
+                               std::uint32_t        crc,
+                               const std::uint8_t*  pData,
+                               std::size_t          size)
+{
+  const auto& t = tables.table;
+  while (size >= 8u)
+  {
+    const std::uint32_t low  = readUnalignLittleEndian<std::uint32_t>(pData) ^ crc;
+    const std::uint32_t high = readUnalignLittleEndian<std::uint32_t>(pData + 4);
+    crc = t[7][low & 0xFFu] ^ t[6][(low >> 8) & 0xFFu] ^ t[5][(low >> 16) & 0xFFu] ^ t[4][low >> 24]
+          ^ t[3][high & 0xFFu] ^ t[2][(high >> 8) & 0xFFu] ^ t[1][(high >> 16) & 0xFFu] ^ t[0][high >> 24];
+    pData += 8;
+    size -= 8u;
+  }
+  while (size > 0u)
+  {
+    crc = t[0][(crc ^ *pData) & 0xFFu] ^ (crc >> 8);
+    ++pData;
+    --size;
+  }
+  return crc;
+}
+
+#if defined(VISIONARY_CRC32C_SSE42)
+bool hasSse42()
+{
+#  if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 20)) != 0;
+#  else
+  return __builtin_cpu_supports("sse4.2") != 0;
+#  endif
+}
+
+VISIONARY_TARGET_SSE42 std::uint32_t updateSse42(std::uint32_t crc, const std::uint8_t* pData, std::size_t size)
+{
+  std::uint64_t crc64 = crc;
+  while (size >= 8u)
+  {
+    std::uint64_t value;
+    std::memcpy(&value, pData, sizeof(value));
+    crc64 = _mm_crc32_u64(crc64, value);
+    pData += 8;
+    size -= 8u;
+  }
+  crc = static_cast<std::uint32_t>(crc64);
+  while (size > 0u)
+  {
+    crc = _mm_crc32_u8(crc, *pData);
+    ++pData;
+    --size;
+  }
+  return crc;
+}
+
+// The crc32 instruction has a latency of three cycles but a throughput of one per cycle, so large buffers are
+// processed as three interleaved streams whose CRCs are combined afterwards.
+constexpr std::size_t kStreamLength = 4096u;
+
+// Linear operator shifting a CRC register over kStreamLength zero bytes, as lookup table per register byte.
+struct StreamShift
+{
+  VISIONARY_TARGET_SSE42 StreamShift()
+  {
+    std::uint32_t shiftedBit[32];
+    for (int bit = 0; bit < 32; ++bit)
+    {
+      std::uint64_t crc64 = std::uint64_t(1u) << bit;
+      for (std::size_t i = 0u; i < kStreamLength / 8u; ++i)
+      {
+        crc64 = _mm_crc32_u64(crc64, 0u);
+      }
+      shiftedBit[bit] = static_cast<std::uint32_t>(crc64);
+    }
+    for (int k = 0; k < 4; ++k)
+    {
+      for (std::uint32_t value = 0u; value < 256u; ++value)
+      {
+        std::uint32_t shifted = 0u;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+          if (value & (1u << bit))
+          {
+            shifted ^= shiftedBit[8 * k + bit];
+          }
+        }
+        table[k][value] = shifted;
+      }
+    }
+  }
+
+  std::uint32_t operator()(std::uint32_t crc) const
+  {
+    return table[0][crc & 0xFFu] ^ table[1][(crc >> 8) & 0xFFu] ^ table[2][(crc >> 16) & 0xFFu] ^ table[3][crc >> 24];
+  }
+
+  std::uint32_t table[4][256];
+};
+
+VISIONARY_TARGET_SSE42 std::uint32_t updateSse42Interleaved(std::uint32_t       crc,
+                                                            const std::uint8_t* pData,
+                                                            std::size_t         size)
+{
+  static const StreamShift shift;
+
+  while (size >= 3u * kStreamLength)
+  {
+    std::uint64_t crc0 = crc;
+    std::uint64_t crc1 = 0u;
+    std::uint64_t crc2 = 0u;
+    for (std::size_t i = 0u; i < kStreamLength; i += 8u)
+    {
+      std::uint64_t value0, value1, value2;
+      std::memcpy(&value0, pData + i, sizeof(value0));
+      std::memcpy(&value1, pData + kStreamLength + i, sizeof(value1));
+      std::memcpy(&value2, pData + 2u * kStreamLength + i, sizeof(value2));
+      crc0 = _mm_crc32_u64(crc0, value0);
+      crc1 = _mm_crc32_u64(crc1, value1);
+      crc2 = _mm_crc32_u64(crc2, value2);
+    }
+    // crc(c, A|B) = shift(crc(c, A)) ^ crc(0, B) for |B| = kStreamLength
+    crc = shift(shift(static_cast<std::uint32_t>(crc0)) ^ static_cast<std::uint32_t>(crc1))
+          ^ static_cast<std::uint32_t>(crc2);
+    pData += 3u * kStreamLength;
+    size -= 3u * kStreamLength;
+  }
+  return updateSse42(crc, pData, size);
+}
+#endif
+
+#if defined(VISIONARY_CRC32_ARMV8)
+std::uint32_t updateArmv8(CrcAlgorithm::Enum algorithm, std::uint32_t crc, const std::uint8_t* pData, std::size_t size)
+{
+  const bool castagnoli = (algorithm == CrcAlgorithm::CRC32C);
+  while (size >= 8u)
+  {
+    std::uint64_t value;
+    std::memcpy(&value, pData, sizeof(value));
+    crc = castagnoli ? __crc32cd(crc, value) : __crc32d(crc, value);
+    pData += 8;
+    size -= 8u;
+  }
+  while (size > 0u)
+  {
+    crc = castagnoli ? __crc32cb(crc, *pData) : __crc32b(crc, *pData);
+    ++pData;
+    --size;
+  }
+  return crc;
+}
+#endif
+
+} // namespace
+
+std::uint32_t Crc32::compute(CrcAlgorithm::Enum algorithm, const void* pData, std::size_t size, std::uint32_t crc)
+{
+  if (algorithm == CrcAlgorithm::NONE)
+  {
+    return 0u;
+  }
+  const auto* pBytes = static_cast<const std::uint8_t*>(pData);
+
+#if defined(VISIONARY_CRC32_ARMV8)
+  return ~updateArmv8(algorithm, ~crc, pBytes, size);
+#else
+#  if defined(VISIONARY_CRC32C_SSE42)
+  static const bool sse42 = hasSse42();
+  if (algorithm == CrcAlgorithm::CRC32C && sse42)
+  {
+    return ~updateSse42Interleaved(~crc, pBytes, size);
+  }
+#  endif
+  return ~updateSlicingBy8(slicingTables(algorithm), ~crc, pBytes, size);
+#endif
+}
+
+std::uint32_t Crc32::computeSoftware(CrcAlgorithm::Enum algorithm,
+                                     const void*        pData,
+                                     std::size_t        size,
+                                     std::uint32_t      crc)
+{
+  if (algorithm == CrcAlgorithm::NONE)
+  {
+    return 0u;
+  }
+  return ~updateSlicingBy8(slicingTables(algorithm), ~crc, static_cast<const std::uint8_t*>(pData), size);
+}
+
+bool Crc32::isHardwareAccelerated(CrcAlgorithm::Enum algorithm)
+{
+#if defined(VISIONARY_CRC32_ARMV8)
+  return algorithm != CrcAlgorithm::NONE;
+#elif defined(VISIONARY_CRC32C_SSE42)
+  static const bool sse42 = hasSse42();
+  return algorithm == CrcAlgorithm::CRC32C && sse42;
+#else
+  (void)algorithm;
+  return false;
+#endif
+}
+
+} // namespace visionary
@@ -0,0 +1,552 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "Deflate.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "VisionaryEndian.h"
+
+namespace visionary {
+
+namespace {
+
+constexpr std::uint32_t kAdlerModulus = 65521u;
+// largest number of bytes before the Adler-32 sums can overflow 32 bit
+constexpr std::size_t kAdlerMaxRun = 5552u;
+
+constexpr std::size_t kMaxStoredBlockSize = 65535u;
+// input bytes per Huffman block, each block adapts its codes to its own statistics
+constexpr std::size_t kHuffmanBlockSize = 256u * 1024u;
+// a dynamic block header and the last bits of a block take less than this
+constexpr std::size_t kBlockOverhead = 1024u;
+
+constexpr unsigned    kNumLiteralLengthCodes   = 286u;
+constexpr unsigned    kNumDistanceCodes        = 2u;
+constexpr unsigned    kNumCodeLengthCodes      = 19u;
+constexpr unsigned    kEndOfBlock              = 256u;
+constexpr unsigned    kMaxCodeLength           = 15u;
+constexpr unsigned    kMaxCodeLengthCodeLength = 7u;
+constexpr std::size_t kMinMatch                = 3u;
+constexpr std::size_t kMaxMatch                = 258u;
+
+// base lengths and extra bits of the length codes 257..285
+const std::uint16_t kLengthBase[29]  = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const std::uint8_t  kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                        2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+// order in which the code lengths of the code length code are stored
+const std::uint8_t kCodeLengthOrder[kNumCodeLengthCodes] = {
+  16u, 17u, 18u, 0u, 8u, 7u, 9u, 6u, 10u, 5u, 11u, 4u, 12u, 3u, 13u, 2u, 14u, 1u, 15u};
+
+// a code length token holds the symbol in the low 16 bits and the value of its extra bits above
+inline std::uint32_t makeToken(unsigned symbol, unsigned extra)
+{
+  return static_cast<std::uint32_t>(symbol | (extra << 16u));
+}
+
+// the data tokens are the literal bytes 0..255 and kRunToken + the length of a run
+constexpr unsigned kRunToken  = 256u;
+constexpr unsigned kNumTokens = kRunToken + kMaxMatch + 1u;
+
+// length code and value of the extra bits of each match length
+struct LengthCodes
+{
+  LengthCodes()
+  {
+    for (unsigned code = 0u; code < 29u; ++code)
+    {
+      const std::size_t end = std::min<std::size_t>(kLengthBase[code] + (1u << kLengthExtra[code]), kMaxMatch + 1u);
+      for (std::size_t length = kLengthBase[code]; length < end; ++length)
+      {
+        // 258 has a code of its own, which comes last
+        symbol[length] = static_cast<std::uint16_t>(257u + code);
+        extra[length]  = static_cast<std::uint8_t>(length - kLengthBase[code]);
+      }
+    }
+  }
+
+  std::uint16_t symbol[kMaxMatch + 1u];
+  std::uint8_t  extra[kMaxMatch + 1u];
+};
+
+const LengthCodes& lengthCodes()
+{
+  static const LengthCodes codes;
+  return codes;
+}
+
+/// Writes the bits of a deflate stream, least significant bit first.
+class BitWriter
+{
+public:
+  explicit BitWriter(std::vector<std::uint8_t>& output)
+    : m_output(output), m_position(output.size()), m_bits(0u), m_numBits(0u)
+  {
+  }
+
+  /// Makes room for at least numBytes more bytes.
+  void reserve(std::size_t numBytes)
+  {
+    if (m_output.size() < m_position + numBytes + 8u)
+    {
+      m_output.resize(m_position + numBytes + 8u);
+    }
+  }
+
+  /// Appends the lowest numBits bits of value, numBits <= 32 and value must not have higher bits set.
+  void put(std::uint32_t value, unsigned numBits)
+  {
+    add(value, numBits);
+    flush();
+  }
+
+  /// Appends bits like put() without storing them yet; at most 56 bits may be pending before the next flush().
+  void add(std::uint32_t value, unsigned numBits)
+  {
+    m_bits |= static_cast<std::uint64_t>(value) << m_numBits;
+    m_numBits += numBits;
+  }
+
+  /// Stores the complete bytes of the pending bits.
+  ///
+  /// The whole bit buffer is written every time and the position advanced by the complete bytes, which avoids a hard
+  /// to predict branch per code.
+  void flush()
+  {
+    writeUnalignLittleEndian<std::uint64_t>(m_output.data() + m_position, 8u, m_bits);
+    const unsigned numBytes = m_numBits >> 3u;
+    m_position += numBytes;
+    m_bits >>= 8u * numBytes;
+    m_numBits &= 7u;
+  }
+
+  /// Pads the stream with zero bits to a byte boundary.
+  void alignToByte()
+  {
+    if (m_numBits > 0u)
+    {
+      m_output[m_position++] = static_cast<std::uint8_t>(m_bits);
+      m_bits                 = 0u;
+      m_numBits              = 0u;
+    }
+  }
+
+  /// Appends bytes, the stream must be aligned to a byte boundary.
+  void putBytes(const std::uint8_t* pData, std::size_t size)
+  {
+    if (size == 0u)
+    {
+      return;
+    }
+    std::memcpy(m_output.data() + m_position, pData, size);
+    m_position += size;
+  }
+
+  /// Aligns the stream and trims the output to the written bytes.
+  void finish()
+  {
+    alignToByte();
+    m_output.resize(m_position);
+  }
+
+private:
+  std::vector<std::uint8_t>& m_output;
+  std::size_t                m_position;
+  std::uint64_t              m_bits;
+  unsigned                   m_numBits;
+};
+
+// Computes the code lengths of a Huffman code of at most maxLength bits. Symbols with a frequency of 0 get no code.
+void buildCodeLengths(const std::uint32_t* pFrequencies,
+                      unsigned             numSymbols,
+                      unsigned             maxLength,
+                      std::uint8_t*        pLengths)
+{
+  std::fill(pLengths, pLengths + numSymbols, std::uint8_t(0u));
+  // the frequency in the upper and the symbol in the lower bits, so a plain sort orders the leaves by frequency
+  std::vector<std::uint64_t> leaves;
+  for (unsigned symbol = 0u; symbol < numSymbols; ++symbol)
+  {
+    if (pFrequencies[symbol] > 0u)
+    {
+      leaves.push_back((static_cast<std::uint64_t>(pFrequencies[symbol]) << 16u) | symbol);
+    }
+  }
+  if (leaves.size() < 2u)
+  {
+    // a complete code needs two symbols, a second one is added which is never used
+    const unsigned used      = leaves.empty() ? 0u : static_cast<unsigned>(leaves[0] & 0xFFFFu);
+    pLengths[used]           = 1u;
+    pLengths[used ? 0u : 1u] = 1u;
+    return;
+  }
+
+  const std::size_t          numLeaves = leaves.size();
+  std::vector<std::uint64_t> weights(2u * numLeaves - 1u);
+  std::vector<std::size_t>   parents(2u * numLeaves - 1u);
+  std::vector<unsigned>      depths(2u * numLeaves - 1u);
+  for (;;)
+  {
+    std::sort(leaves.begin(), leaves.end());
+    for (std::size_t i = 0u; i < numLeaves; ++i)
+    {
+      weights[i] = leaves[i] >> 16u;
+    }
+
+    // the leaves and the inner nodes are both sorted by weight, so the two lightest nodes are at their fronts
+    std::size_t nextLeaf  = 0u;
+    std::size_t nextInner = numLeaves;
+    for (std::size_t node = numLeaves; node < weights.size(); ++node)
+    {
+      std::size_t children[2];
+      for (auto& child : children)
+      {
+        const bool takeLeaf = nextLeaf < numLeaves && (nextInner == node || weights[nextLeaf] <= weights[nextInner]);
+        child               = takeLeaf ? nextLeaf++ : nextInner++;
+      }
+      weights[node]        = weights[children[0]] + weights[children[1]];
+      parents[children[0]] = node;
+      parents[children[1]] = node;
+    }
+
+    unsigned maxDepth = 0u;
+    depths.back()     = 0u;
+    for (std::size_t node = weights.size() - 1u; node-- > 0u;)
+    {
+      depths[node] = depths[parents[node]] + 1u;
+      maxDepth     = std::max(maxDepth, depths[node]);
+    }
+    if (maxDepth <= maxLength)
+    {
+      break;
+    }
+    // flatten the distribution until the code fits, rare symbols keep a frequency of at least 1
+    for (auto& leaf : leaves)
+    {
+      leaf = ((((leaf >> 16u) + 1u) / 2u) << 16u) | (leaf & 0xFFFFu);
+    }
+  }
+  for (std::size_t i = 0u; i < numLeaves; ++i)
+  {
+    pLengths[leaves[i] & 0xFFFFu] = static_cast<std::uint8_t>(depths[i]);
+  }
+}
+
+// Assigns the canonical codes to the code lengths, bit reversed as they are written least significant bit first.
+void buildCodes(const std::uint8_t* pLengths, unsigned numSymbols, std::uint16_t* pCodes)
+{
+  unsigned counts[kMaxCodeLength + 1u] = {};
+  for (unsigned symbol = 0u; symbol < numSymbols; ++symbol)
+  {
+    ++counts[pLengths[symbol]];
+  }
+  counts[0] = 0u;
+
+  unsigned nextCodes[kMaxCodeLength + 1u] = {};
+  unsigned code                           = 0u;
+  for (unsigned bits = 1u; bits <= kMaxCodeLength; ++bits)
+  {
+    code            = (code + counts[bits - 1u]) << 1u;
+    nextCodes[bits] = code;
+  }
+
+  for (unsigned symbol = 0u; symbol < numSymbols; ++symbol)
+  {
+    const unsigned length = pLengths[symbol];
+    pCodes[symbol]        = 0u;
+    if (length > 0u)
+    {
+      unsigned value    = nextCodes[length]++;
+      unsigned reversed = 0u;
+      for (unsigned bit = 0u; bit < length; ++bit)
+      {
+        reversed = (reversed << 1u) | (value & 1u);
+        value >>= 1u;
+      }
+      pCodes[symbol] = static_cast<std::uint16_t>(reversed);
+    }
+  }
+}
+
+// Splits the code lengths of the literal/length and distance codes into code length symbols (tokens).
+void encodeCodeLengths(const std::uint8_t* pLengths, std::size_t numLengths, std::vector<std::uint32_t>& tokens)
+{
+  std::size_t i = 0u;
+  while (i < numLengths)
+  {
+    const unsigned length = pLengths[i];
+    std::size_t    run    = 1u;
+    while (i + run < numLengths && pLengths[i + run] == length)
+    {
+      ++run;
+    }
+    i += run;
+
+    if (length == 0u)
+    {
+      while (run >= 11u)
+      {
+        const std::size_t count = std::min<std::size_t>(run, 138u);
+        tokens.push_back(makeToken(18u, static_cast<unsigned>(count - 11u)));
+        run -= count;
+      }
+      if (run >= 3u)
+      {
+        tokens.push_back(makeToken(17u, static_cast<unsigned>(run - 3u)));
+        run = 0u;
+      }
+    }
+    else
+    {
+      tokens.push_back(makeToken(length, 0u));
+      --run;
+      while (run >= 3u)
+      {
+        const std::size_t count = std::min<std::size_t>(run, 6u);
+        tokens.push_back(makeToken(16u, static_cast<unsigned>(count - 3u)));
+        run -= count;
+      }
+    }
+    for (; run > 0u; --run)
+    {
+      tokens.push_back(makeToken(length, 0u));
+    }
+  }
+}
+
+// Turns the block [begin, end) of the input into literal and run tokens. Runs repeat the previous byte (distance 1),
+// which may be the last byte of the previous block.
+void tokenize(const std::uint8_t* pInput, std::size_t begin, std::size_t end, std::vector<std::uint16_t>& tokens)
+{
+  // at most one token per byte
+  tokens.resize(end - begin);
+  std::uint16_t* pToken = tokens.data();
+  std::size_t    i      = begin;
+  while (i < end)
+  {
+    // one comparison finds the start of a run of at least kMinMatch bytes
+    const std::uint32_t value = (i > 0u) ? pInput[i - 1u] : 0u;
+    if (i > 0u && end - i >= kMinMatch
+        && readUnalignLittleEndian<std::uint32_t>(pInput + i - 1u) == value * 0x01010101u)
+    {
+      const std::size_t limit = std::min(end - i, kMaxMatch);
+      std::size_t       run   = kMinMatch;
+      while (run < limit && pInput[i + run] == value)
+      {
+        ++run;
+      }
+      *pToken++ = static_cast<std::uint16_t>(kRunToken + run);
+      i += run;
+      continue;
+    }
+    *pToken++ = pInput[i];
+    ++i;
+  }
+  tokens.resize(static_cast<std::size_t>(pToken - tokens.data()));
+}
+
+void writeStoredBlocks(BitWriter& writer, const std::uint8_t* pInput, std::size_t inputSize)
+{
+  std::size_t offset = 0u;
+  do
+  {
+    const std::size_t size = std::min(inputSize - offset, kMaxStoredBlockSize);
+    const bool        last = offset + size == inputSize;
+    writer.reserve(size + kBlockOverhead);
+    writer.put(last ? 1u : 0u, 1u);
+    writer.put(0u, 2u);
+    writer.alignToByte();
+    std::uint8_t lengths[4];
+    writeUnalignLittleEndian<std::uint16_t>(lengths, 2u, static_cast<std::uint16_t>(size));
+    writeUnalignLittleEndian<std::uint16_t>(lengths + 2u, 2u, static_cast<std::uint16_t>(~size));
+    writer.putBytes(lengths, sizeof(lengths));
+    writer.putBytes(pInput + offset, size);
+    offset += size;
+  } while (offset < inputSize);
+}
+
+void writeHuffmanBlock(BitWriter& writer, const std::vector<std::uint16_t>& tokens, bool last)
+{
+  const LengthCodes& lengthCode = lengthCodes();
+
+  // literal/length code, the only distance is 1 (code 0); a second unused distance code completes the code
+  // four interleaved histograms, so repeated tokens do not wait for the previous increment of the same counter
+  std::vector<std::uint32_t> tokenFrequencies(4u * kNumTokens, 0u);
+  const std::size_t          numTokens = tokens.size();
+  std::size_t                i         = 0u;
+  for (; i + 4u <= numTokens; i += 4u)
+  {
+    ++tokenFrequencies[tokens[i]];
+    ++tokenFrequencies[kNumTokens + tokens[i + 1u]];
+    ++tokenFrequencies[2u * kNumTokens + tokens[i + 2u]];
+    ++tokenFrequencies[3u * kNumTokens + tokens[i + 3u]];
+  }
+  for (; i < numTokens; ++i)
+  {
+    ++tokenFrequencies[tokens[i]];
+  }
+  for (unsigned token = 0u; token < kNumTokens; ++token)
+  {
+    tokenFrequencies[token] += tokenFrequencies[kNumTokens + token] + tokenFrequencies[2u * kNumTokens + token]
+                               + tokenFrequencies[3u * kNumTokens + token];
+  }
+  std::uint32_t frequencies[kNumLiteralLengthCodes] = {};
+  std::copy(tokenFrequencies.begin(), tokenFrequencies.begin() + kRunToken, frequencies);
+  for (std::size_t length = kMinMatch; length <= kMaxMatch; ++length)
+  {
+    frequencies[lengthCode.symbol[length]] += tokenFrequencies[kRunToken + length];
+  }
+  frequencies[kEndOfBlock] = 1u;
+
+  std::uint8_t lengths[kNumLiteralLengthCodes + kNumDistanceCodes];
+  buildCodeLengths(frequencies, kNumLiteralLengthCodes, kMaxCodeLength, lengths);
+  lengths[kNumLiteralLengthCodes]      = 1u;
+  lengths[kNumLiteralLengthCodes + 1u] = 1u;
+  std::uint16_t codes[kNumLiteralLengthCodes];
+  buildCodes(lengths, kNumLiteralLengthCodes, codes);
+
+  unsigned numLiteralLengthCodes = kNumLiteralLengthCodes;
+  while (lengths[numLiteralLengthCodes - 1u] == 0u)
+  {
+    --numLiteralLengthCodes;
+  }
+  // the distance code lengths directly follow the used literal/length code lengths
+  std::memmove(lengths + numLiteralLengthCodes, lengths + kNumLiteralLengthCodes, kNumDistanceCodes);
+
+  std::vector<std::uint32_t> codeLengthTokens;
+  encodeCodeLengths(lengths, numLiteralLengthCodes + kNumDistanceCodes, codeLengthTokens);
+  std::uint32_t codeLengthFrequencies[kNumCodeLengthCodes] = {};
+  for (const std::uint32_t token : codeLengthTokens)
+  {
+    ++codeLengthFrequencies[token & 0xFFFFu];
+  }
+  std::uint8_t  codeLengthLengths[kNumCodeLengthCodes];
+  std::uint16_t codeLengthCodes[kNumCodeLengthCodes];
+  buildCodeLengths(codeLengthFrequencies, kNumCodeLengthCodes, kMaxCodeLengthCodeLength, codeLengthLengths);
+  buildCodes(codeLengthLengths, kNumCodeLengthCodes, codeLengthCodes);
+  unsigned numCodeLengthCodes = kNumCodeLengthCodes;
+  while (numCodeLengthCodes > 4u && codeLengthLengths[kCodeLengthOrder[numCodeLengthCodes - 1u]] == 0u)
+  {
+    --numCodeLengthCodes;
+  }
+
+  // block header
+  writer.put(last ? 1u : 0u, 1u);
+  writer.put(2u, 2u);
+  writer.put(numLiteralLengthCodes - 257u, 5u);
+  writer.put(kNumDistanceCodes - 1u, 5u);
+  writer.put(numCodeLengthCodes - 4u, 4u);
+  for (unsigned i = 0u; i < numCodeLengthCodes; ++i)
+  {
+    writer.put(codeLengthLengths[kCodeLengthOrder[i]], 3u);
+  }
+  static const unsigned kCodeLengthExtra[3] = {2u, 3u, 7u};
+  for (const std::uint32_t token : codeLengthTokens)
+  {
+    const unsigned symbol = token & 0xFFFFu;
+    writer.put(codeLengthCodes[symbol], codeLengthLengths[symbol]);
+    if (symbol >= 16u)
+    {
+      writer.put(token >> 16u, kCodeLengthExtra[symbol - 16u]);
+    }
+  }
+
+  // data: each token is written with one table entry holding its code and number of bits (low 8 bits); a run is its
+  // length code, the extra bits and distance code 0
+  std::uint32_t encodings[kNumTokens] = {};
+  for (unsigned literal = 0u; literal < kRunToken; ++literal)
+  {
+    encodings[literal] = (static_cast<std::uint32_t>(codes[literal]) << 8u) | lengths[literal];
+  }
+  for (std::size_t length = kMinMatch; length <= kMaxMatch; ++length)
+  {
+    const unsigned      symbol  = lengthCode.symbol[length];
+    const unsigned      numBits = lengths[symbol] + kLengthExtra[symbol - 257u] + 1u;
+    const std::uint32_t bits =
+      codes[symbol] | (static_cast<std::uint32_t>(lengthCode.extra[length]) << lengths[symbol]);
+    encodings[kRunToken + length] = (bits << 8u) | numBits;
+  }
+  // the exact size of the data is known now, so the output grows only by what is written
+  std::uint64_t numDataBits = lengths[kEndOfBlock];
+  for (unsigned token = 0u; token < kNumTokens; ++token)
+  {
+    numDataBits += static_cast<std::uint64_t>(tokenFrequencies[token]) * (encodings[token] & 0xFFu);
+  }
+  writer.reserve(static_cast<std::size_t>(numDataBits / 8u) + kBlockOverhead);
+
+  // a token takes at most 15 + 5 + 1 bits, so two of them fit into the pending bits before a flush
+  for (i = 0u; i + 2u <= numTokens; i += 2u)
+  {
+    const std::uint32_t first  = encodings[tokens[i]];
+    const std::uint32_t second = encodings[tokens[i + 1u]];
+    writer.add(first >> 8u, first & 0xFFu);
+    writer.put(second >> 8u, second & 0xFFu);
+  }
+  if (i < numTokens)
+  {
+    writer.put(encodings[tokens[i]] >> 8u, encodings[tokens[i]] & 0xFFu);
+  }
+  writer.put(codes[kEndOfBlock], lengths[kEndOfBlock]);
+}
+
+} // namespace
+
+std::uint32_t adler32(const std::uint8_t* pData, std::size_t size, std::uint32_t adler)
+{
+  std::uint32_t a = adler & 0xFFFFu;
+  std::uint32_t b = adler >> 16u;
+  while (size > 0u)
+  {
+    const std::size_t run = std::min(size, kAdlerMaxRun);
+    for (std::size_t i = 0u; i < run; ++i)
+    {
+      a += pData[i];
+      b += a;
+    }
+    a %= kAdlerModulus;
+    b %= kAdlerModulus;
+    pData += run;
+    size -= run;
+  }
+  return (b << 16u) | a;
+}
+
+void zlibCompress(const std::uint8_t*        pInput,
+                  std::size_t                inputSize,
+                  DeflateMode::Enum          mode,
+                  std::vector<std::uint8_t>& output)
+{
+  // 32K window, deflate, lowest compression level; the check bits make the header a multiple of 31
+  output.push_back(0x78u);
+  output.push_back(0x01u);
+
+  BitWriter writer(output);
+  if (mode == DeflateMode::STORED || inputSize == 0u)
+  {
+    writeStoredBlocks(writer, pInput, inputSize);
+  }
+  else
+  {
+    std::vector<std::uint16_t> tokens;
+    tokens.reserve(std::min(inputSize, kHuffmanBlockSize));
+    for (std::size_t begin = 0u; begin < inputSize; begin += kHuffmanBlockSize)
+    {
+      const std::size_t end = std::min(begin + kHuffmanBlockSize, inputSize);
+      tokenize(pInput, begin, end, tokens);
+      writer.reserve(kBlockOverhead);
+      writeHuffmanBlock(writer, tokens, end == inputSize);
+    }
+  }
+  writer.finish();
+
+  std::uint8_t checksum[4];
+  writeUnalignBigEndian<std::uint32_t>(checksum, 4u, adler32(pInput, inputSize));
+  output.insert(output.end(), checksum, checksum + sizeof(checksum));
+}
+
+} // namespace visionary
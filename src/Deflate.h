@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef> // for size_t
+#include <cstdint>
+#include <vector>
+
+namespace visionary {
+
+namespace DeflateMode {
+enum Enum
+{
+  STORED,     ///< uncompressed blocks, only the framing is added
+  HUFFMAN_RLE ///< Huffman coded literals and runs of repeated bytes, like the Z_RLE strategy of zlib
+};
+}
+
+/// Computes the Adler-32 checksum of the zlib format.
+///
+/// \param[in] pData    start of the data.
+/// \param[in] size     size of the data in bytes.
+/// \param[in] adler    checksum of the preceding data, 1 to start a new computation.
+std::uint32_t adler32(const std::uint8_t* pData, std::size_t size, std::uint32_t adler = 1u);
+
+/// Compresses a block into a zlib stream (RFC 1950 with deflate data, RFC 1951), as used by the IDAT data of PNG files.
+///
+/// Only the cheap parts of deflate are implemented: the matches are limited to runs of the previous byte, so the
+/// compression relies on a prediction filter turning the data into small values and zero runs beforehand. Every
+/// block gets its own Huffman codes.
+///
+/// \param[in]  pInput     data to compress.
+/// \param[in]  inputSize  number of bytes to compress.
+/// \param[in]  mode       stored or compressed blocks.
+/// \param[out] output     the zlib stream is appended.
+void zlibCompress(const std::uint8_t*        pInput,
+                  std::size_t                inputSize,
+                  DeflateMode::Enum          mode,
+                  std::vector<std::uint8_t>& output);
+
+} // namespace visionary
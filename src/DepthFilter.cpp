@@ -0,0 +1,573 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "DepthFilter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#  define VISIONARY_DEPTHFILTER_AVX2
+#  include <immintrin.h>
+#  define VISIONARY_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// fully unrolled selection networks keep all values in registers
+#if defined(__clang__)
+#  define VISIONARY_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#  define VISIONARY_UNROLL _Pragma("GCC unroll 128")
+#else
+#  define VISIONARY_UNROLL
+#endif
+
+namespace visionary {
+
+namespace {
+
+// a band of rows is worth a thread of its own from this size on
+constexpr std::size_t kMinBandPixels = 32u * 1024u;
+
+// Selection networks: after these compare/exchange steps the middle element holds the median. The 3x3 network is the
+// one of Paeth/Devillard, the 5x5 network is Batcher's odd-even merge sort reduced to the steps the median depends on.
+const std::uint8_t kMedian9Network[][2] = {{1, 2}, {4, 5}, {7, 8}, {0, 1}, {3, 4}, {6, 7}, {1, 2},
+                                           {4, 5}, {7, 8}, {0, 3}, {5, 8}, {4, 7}, {3, 6}, {1, 4},
+                                           {2, 5}, {4, 7}, {4, 2}, {6, 4}, {4, 2}};
+
+const std::uint8_t kMedian25Network[][2] = {
+  {0, 1},   {2, 3},   {4, 5},   {6, 7},   {8, 9},   {10, 11}, {12, 13}, {14, 15}, {16, 17}, {18, 19}, {20, 21},
+  {22, 23}, {0, 2},   {1, 3},   {4, 6},   {5, 7},   {8, 10},  {9, 11},  {12, 14}, {13, 15}, {16, 18}, {17, 19},
+  {20, 22}, {21, 23}, {1, 2},   {5, 6},   {9, 10},  {13, 14}, {17, 18}, {21, 22}, {0, 4},   {1, 5},   {2, 6},
+  {3, 7},   {8, 12},  {9, 13},  {10, 14}, {11, 15}, {16, 20}, {17, 21}, {18, 22}, {19, 23}, {2, 4},   {3, 5},
+  {10, 12}, {11, 13}, {18, 20}, {19, 21}, {1, 2},   {3, 4},   {5, 6},   {9, 10},  {11, 12}, {13, 14}, {17, 18},
+  {19, 20}, {21, 22}, {0, 8},   {1, 9},   {2, 10},  {3, 11},  {4, 12},  {5, 13},  {6, 14},  {7, 15},  {16, 24},
+  {4, 8},   {5, 9},   {6, 10},  {7, 11},  {20, 24}, {2, 4},   {3, 5},   {6, 8},   {7, 9},   {10, 12}, {11, 13},
+  {18, 20}, {19, 21}, {22, 24}, {1, 2},   {3, 4},   {5, 6},   {7, 8},   {9, 10},  {11, 12}, {13, 14}, {17, 18},
+  {19, 20}, {21, 22}, {23, 24}, {0, 16},  {1, 17},  {2, 18},  {3, 19},  {4, 20},  {5, 21},  {6, 22},  {7, 23},
+  {8, 24},  {8, 16},  {9, 17},  {10, 18}, {11, 19}, {12, 20}, {13, 21}, {6, 10},  {7, 11},  {12, 16}, {13, 17},
+  {10, 12}, {11, 13}, {11, 12}};
+
+constexpr std::size_t kMaxWindowSize = 25u;
+
+// Offsets of the pixels of a median window relative to its center.
+struct MedianWindow
+{
+  MedianWindow(unsigned size, std::uint32_t width) : radius(size / 2u)
+  {
+    std::size_t index = 0u;
+    for (int dy = -static_cast<int>(radius); dy <= static_cast<int>(radius); ++dy)
+    {
+      for (int dx = -static_cast<int>(radius); dx <= static_cast<int>(radius); ++dx)
+      {
+        offsets[index++] = static_cast<std::ptrdiff_t>(dy) * width + dx;
+      }
+    }
+  }
+
+  std::uint32_t  radius;
+  std::ptrdiff_t offsets[kMaxWindowSize];
+};
+
+// the 8 neighbours; the first 4 are the opposites of the last 4 in reverse order
+std::vector<std::ptrdiff_t> neighborOffsets(std::uint32_t width)
+{
+  const auto stride = static_cast<std::ptrdiff_t>(width);
+  return {-stride - 1, -stride, -stride + 1, -1, 1, stride - 1, stride, stride + 1};
+}
+
+// Splits the rows into bands and calls function(rowBegin, rowEnd) for each of them in parallel; the calling thread
+// takes the first band.
+template <typename Function>
+void forEachBand(std::uint32_t width, std::uint32_t height, unsigned numThreads, const Function& function)
+{
+  const std::size_t numPixels = static_cast<std::size_t>(width) * height;
+  const std::size_t maxBands  = (numThreads > 0u) ? numThreads : std::thread::hardware_concurrency();
+  const std::size_t numBands  = std::max<std::size_t>(
+    1u, std::min(std::min(maxBands, numPixels / kMinBandPixels), static_cast<std::size_t>(height)));
+  const std::size_t rowsPerBand = (height + numBands - 1u) / numBands;
+
+  std::vector<std::thread> threads;
+  for (std::size_t begin = rowsPerBand; begin < height; begin += rowsPerBand)
+  {
+    threads.emplace_back(function, begin, std::min<std::size_t>(begin + rowsPerBand, height));
+  }
+  function(std::size_t(0u), std::min<std::size_t>(rowsPerBand, height));
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+// Copies the border pixels of a row and returns false if the row has no inner pixels, i.e. is copied completely.
+bool copyBorder(const std::uint16_t* pInput,
+                std::uint16_t*       pOutput,
+                std::uint32_t        width,
+                std::uint32_t        height,
+                std::uint32_t        radius,
+                std::size_t          y)
+{
+  const std::size_t rowOffset = y * width;
+  if (y < radius || y + radius >= height || width <= 2u * radius)
+  {
+    std::memcpy(pOutput + rowOffset, pInput + rowOffset, width * sizeof(std::uint16_t));
+    return false;
+  }
+  std::memcpy(pOutput + rowOffset, pInput + rowOffset, radius * sizeof(std::uint16_t));
+  const std::size_t rightOffset = rowOffset + width - radius;
+  std::memcpy(pOutput + rightOffset, pInput + rightOffset, radius * sizeof(std::uint16_t));
+  return true;
+}
+
+std::uint16_t toFixedRatio(float ratio)
+{
+  // 0.16 fixed point, the threshold is the upper half of the product with the depth
+  return static_cast<std::uint16_t>(std::lround(std::min(std::max(ratio, 0.0f), 65535.0f / 65536.0f) * 65536.0f));
+}
+
+inline bool isJump(unsigned value, unsigned neighbor, unsigned threshold)
+{
+  return ((value > neighbor) ? value - neighbor : neighbor - value) > threshold;
+}
+
+template <std::size_t kNumPixels, std::size_t kNetworkSize>
+std::uint16_t medianAt(const std::uint16_t* pCenter,
+                       const MedianWindow&  window,
+                       const std::uint8_t (&network)[kNetworkSize][2])
+{
+  if (*pCenter == 0u)
+  {
+    return 0u;
+  }
+  std::uint16_t values[kNumPixels];
+  VISIONARY_UNROLL
+  for (std::size_t i = 0u; i < kNumPixels; ++i)
+  {
+    values[i] = pCenter[window.offsets[i]];
+  }
+  VISIONARY_UNROLL
+  for (std::size_t i = 0u; i < kNetworkSize; ++i)
+  {
+    std::uint16_t& a   = values[network[i][0]];
+    std::uint16_t& b   = values[network[i][1]];
+    const auto     low = std::min(a, b);
+    b                  = std::max(a, b);
+    a                  = low;
+  }
+  return values[kNumPixels / 2u];
+}
+
+inline std::uint16_t flyingPixelAt(const std::uint16_t*  pCenter,
+                                   const std::ptrdiff_t* pOffsets,
+                                   unsigned              minJump,
+                                   unsigned              ratio)
+{
+  const unsigned value     = *pCenter;
+  const unsigned threshold = std::max(minJump, (value * ratio) >> 16u);
+  for (std::size_t i = 0u; i < 4u; ++i)
+  {
+    if (isJump(value, pCenter[pOffsets[i]], threshold) && isJump(value, pCenter[pOffsets[7u - i]], threshold))
+    {
+      return 0u;
+    }
+  }
+  return static_cast<std::uint16_t>(value);
+}
+
+inline std::uint16_t holeFillAt(const std::uint16_t*  pCenter,
+                                const std::ptrdiff_t* pOffsets,
+                                unsigned              minNeighbors,
+                                unsigned              maxSpread)
+{
+  if (*pCenter != 0u)
+  {
+    return *pCenter;
+  }
+  unsigned count = 0u;
+  unsigned low   = 0xFFFFu;
+  unsigned high  = 0u;
+  for (std::size_t i = 0u; i < 8u; ++i)
+  {
+    const unsigned neighbor = pCenter[pOffsets[i]];
+    if (neighbor != 0u)
+    {
+      ++count;
+      low  = std::min(low, neighbor);
+      high = std::max(high, neighbor);
+    }
+  }
+  // rounded up like the vector average
+  return (count >= minNeighbors && high - low <= maxSpread) ? static_cast<std::uint16_t>((low + high + 1u) >> 1u) : 0u;
+}
+
+#if defined(VISIONARY_DEPTHFILTER_AVX2)
+bool hasAvx2()
+{
+  static const bool supported = __builtin_cpu_supports("avx2") != 0;
+  return supported;
+}
+
+VISIONARY_TARGET_AVX2 inline __m256i load(const std::uint16_t* pData)
+{
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pData));
+}
+
+// lanes where |a - b| <= threshold
+VISIONARY_TARGET_AVX2 inline __m256i withinThreshold(__m256i a, __m256i b, __m256i threshold)
+{
+  const __m256i difference = _mm256_or_si256(_mm256_subs_epu16(a, b), _mm256_subs_epu16(b, a));
+  return _mm256_cmpeq_epi16(_mm256_min_epu16(difference, threshold), difference);
+}
+
+// The AVX2 kernels process the pixels [begin, end) of a row 16 at a time and return the first pixel left over.
+
+template <std::size_t kNumPixels, std::size_t kNetworkSize>
+VISIONARY_TARGET_AVX2 inline void medianStepAvx2(const std::uint16_t* pCenter,
+                                                 const MedianWindow&  window,
+                                                 const std::uint8_t (&network)[kNetworkSize][2],
+                                                 std::uint16_t*       pOutput)
+{
+  __m256i values[kNumPixels];
+  VISIONARY_UNROLL
+  for (std::size_t i = 0u; i < kNumPixels; ++i)
+  {
+    values[i] = load(pCenter + window.offsets[i]);
+  }
+  VISIONARY_UNROLL
+  for (std::size_t i = 0u; i < kNetworkSize; ++i)
+  {
+    __m256i&      a   = values[network[i][0]];
+    __m256i&      b   = values[network[i][1]];
+    const __m256i low = _mm256_min_epu16(a, b);
+    b                 = _mm256_max_epu16(a, b);
+    a                 = low;
+  }
+  const __m256i invalid = _mm256_cmpeq_epi16(load(pCenter), _mm256_setzero_si256());
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(pOutput), _mm256_andnot_si256(invalid, values[kNumPixels / 2u]));
+}
+
+template <std::size_t kNumPixels, std::size_t kNetworkSize>
+VISIONARY_TARGET_AVX2 std::size_t medianRowAvx2(const std::uint16_t* pRow,
+                                                const MedianWindow&  window,
+                                                const std::uint8_t (&network)[kNetworkSize][2],
+                                                std::size_t          begin,
+                                                std::size_t          end,
+                                                std::uint16_t*       pOutput)
+{
+  std::size_t x = begin;
+  for (; x + 16u <= end; x += 16u)
+  {
+    medianStepAvx2<kNumPixels>(pRow + x, window, network, pOutput + x);
+  }
+  if (x < end && end - begin >= 16u)
+  {
+    // the last step overlaps the previous one, which is cheaper than the scalar code for the rest
+    medianStepAvx2<kNumPixels>(pRow + end - 16u, window, network, pOutput + end - 16u);
+    x = end;
+  }
+  return x;
+}
+
+VISIONARY_TARGET_AVX2 inline void flyingPixelStepAvx2(const std::uint16_t*  pCenter,
+                                                      const std::ptrdiff_t* pOffsets,
+                                                      __m256i               minJumps,
+                                                      __m256i               ratios,
+                                                      std::uint16_t*        pOutput)
+{
+  const __m256i value     = load(pCenter);
+  const __m256i threshold = _mm256_max_epu16(minJumps, _mm256_mulhi_epu16(value, ratios));
+  __m256i       keep      = _mm256_set1_epi16(-1);
+  for (std::size_t i = 0u; i < 4u; ++i)
+  {
+    keep = _mm256_and_si256(keep,
+                            _mm256_or_si256(withinThreshold(value, load(pCenter + pOffsets[i]), threshold),
+                                            withinThreshold(value, load(pCenter + pOffsets[7u - i]), threshold)));
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(pOutput), _mm256_and_si256(value, keep));
+}
+
+VISIONARY_TARGET_AVX2 std::size_t flyingPixelRowAvx2(const std::uint16_t*  pRow,
+                                                     const std::ptrdiff_t* pOffsets,
+                                                     std::uint16_t         minJump,
+                                                     std::uint16_t         ratio,
+                                                     std::size_t           begin,
+                                                     std::size_t           end,
+                                                     std::uint16_t*        pOutput)
+{
+  const __m256i minJumps = _mm256_set1_epi16(static_cast<short>(minJump));
+  const __m256i ratios   = _mm256_set1_epi16(static_cast<short>(ratio));
+  std::size_t   x        = begin;
+  for (; x + 16u <= end; x += 16u)
+  {
+    flyingPixelStepAvx2(pRow + x, pOffsets, minJumps, ratios, pOutput + x);
+  }
+  if (x < end && end - begin >= 16u)
+  {
+    flyingPixelStepAvx2(pRow + end - 16u, pOffsets, minJumps, ratios, pOutput + end - 16u);
+    x = end;
+  }
+  return x;
+}
+
+VISIONARY_TARGET_AVX2 inline void holeFillStepAvx2(const std::uint16_t*  pCenter,
+                                                   const std::ptrdiff_t* pOffsets,
+                                                   __m256i               fewNeighbors,
+                                                   __m256i               maxSpreads,
+                                                   std::uint16_t*        pOutput)
+{
+  const __m256i zero  = _mm256_setzero_si256();
+  const __m256i ones  = _mm256_set1_epi16(-1);
+  __m256i       count = zero;
+  __m256i       low   = ones;
+  __m256i       high  = zero;
+  for (std::size_t i = 0u; i < 8u; ++i)
+  {
+    const __m256i neighbor = load(pCenter + pOffsets[i]);
+    const __m256i invalid  = _mm256_cmpeq_epi16(neighbor, zero);
+    // the valid lanes are -1 in the inverted mask
+    count = _mm256_sub_epi16(count, _mm256_xor_si256(invalid, ones));
+    low   = _mm256_min_epu16(low, _mm256_or_si256(neighbor, invalid));
+    high  = _mm256_max_epu16(high, neighbor);
+  }
+  const __m256i value  = load(pCenter);
+  const __m256i spread = _mm256_subs_epu16(high, low);
+  const __m256i fill =
+    _mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi16(value, zero), _mm256_cmpgt_epi16(count, fewNeighbors)),
+                     _mm256_cmpeq_epi16(_mm256_min_epu16(spread, maxSpreads), spread));
+  const __m256i mean = _mm256_avg_epu16(low, high);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(pOutput), _mm256_blendv_epi8(value, mean, fill));
+}
+
+VISIONARY_TARGET_AVX2 std::size_t holeFillRowAvx2(const std::uint16_t*  pRow,
+                                                  const std::ptrdiff_t* pOffsets,
+                                                  unsigned              minNeighbors,
+                                                  std::uint16_t         maxSpread,
+                                                  std::size_t           begin,
+                                                  std::size_t           end,
+                                                  std::uint16_t*        pOutput)
+{
+  const __m256i fewNeighbors = _mm256_set1_epi16(static_cast<short>(minNeighbors - 1u));
+  const __m256i maxSpreads   = _mm256_set1_epi16(static_cast<short>(maxSpread));
+  std::size_t   x            = begin;
+  for (; x + 16u <= end; x += 16u)
+  {
+    holeFillStepAvx2(pRow + x, pOffsets, fewNeighbors, maxSpreads, pOutput + x);
+  }
+  if (x < end && end - begin >= 16u)
+  {
+    holeFillStepAvx2(pRow + end - 16u, pOffsets, fewNeighbors, maxSpreads, pOutput + end - 16u);
+    x = end;
+  }
+  return x;
+}
+#endif
+
+} // namespace
+
+bool DepthFilterConfig::isEnabled() const
+{
+  return stateMask != 0u || minIntensity != 0u || minJump != 0u || jumpRatio > 0.0f || holeFillNeighbors != 0u
+         || medianSize != 0u;
+}
+
+bool DepthFilterConfig::isValid() const
+{
+  return (medianSize == 0u || medianSize == 3u || medianSize == 5u) && holeFillNeighbors <= 8u;
+}
+
+void DepthFilter::apply(const DepthFilterConfig& config,
+                        std::uint16_t*           pDepth,
+                        std::uint32_t            width,
+                        std::uint32_t            height,
+                        const std::uint16_t*     pState,
+                        const std::uint16_t*     pIntensity)
+{
+  if (config.medianSize != 0u && config.medianSize != 3u && config.medianSize != 5u)
+  {
+    throw std::invalid_argument("Unsupported median size");
+  }
+  if (config.holeFillNeighbors > 8u)
+  {
+    throw std::invalid_argument("Unsupported number of hole filling neighbors");
+  }
+
+  const std::size_t numPixels = static_cast<std::size_t>(width) * height;
+  maskByConfidence(pDepth, numPixels, pState, config.stateMask, pIntensity, config.minIntensity);
+
+  const bool removeFlying = config.minJump != 0u || config.jumpRatio > 0.0f;
+  if (!removeFlying && config.holeFillNeighbors == 0u && config.medianSize == 0u)
+  {
+    return;
+  }
+
+  // the stages alternate between the map and a scratch map, which is kept for the next frame of the thread
+  static thread_local std::vector<std::uint16_t> scratch;
+  scratch.resize(numPixels);
+  std::uint16_t* pInput  = pDepth;
+  std::uint16_t* pOutput = scratch.data();
+  if (removeFlying)
+  {
+    removeFlyingPixels(pInput, pOutput, width, height, config.minJump, config.jumpRatio, config.numThreads);
+    std::swap(pInput, pOutput);
+  }
+  if (config.holeFillNeighbors != 0u)
+  {
+    fillHoles(pInput, pOutput, width, height, config.holeFillNeighbors, config.holeFillMaxSpread, config.numThreads);
+    std::swap(pInput, pOutput);
+  }
+  if (config.medianSize != 0u)
+  {
+    median(pInput, pOutput, width, height, config.medianSize, config.numThreads);
+    std::swap(pInput, pOutput);
+  }
+  if (pInput != pDepth)
+  {
+    std::memcpy(pDepth, pInput, numPixels * sizeof(std::uint16_t));
+  }
+}
+
+void DepthFilter::maskByConfidence(std::uint16_t*       pDepth,
+                                   std::size_t          numPixels,
+                                   const std::uint16_t* pState,
+                                   std::uint16_t        stateMask,
+                                   const std::uint16_t* pIntensity,
+                                   std::uint16_t        minIntensity)
+{
+  // branch free, so the compiler vectorizes the loops
+  if (pState != nullptr && stateMask != 0u)
+  {
+    for (std::size_t i = 0u; i < numPixels; ++i)
+    {
+      pDepth[i] = ((pState[i] & stateMask) != 0u) ? std::uint16_t(0u) : pDepth[i];
+    }
+  }
+  if (pIntensity != nullptr && minIntensity != 0u)
+  {
+    for (std::size_t i = 0u; i < numPixels; ++i)
+    {
+      pDepth[i] = (pIntensity[i] < minIntensity) ? std::uint16_t(0u) : pDepth[i];
+    }
+  }
+}
+
+void DepthFilter::removeFlyingPixels(const std::uint16_t* pInput,
+                                     std::uint16_t*       pOutput,
+                                     std::uint32_t        width,
+                                     std::uint32_t        height,
+                                     std::uint16_t        minJump,
+                                     float                jumpRatio,
+                                     unsigned             numThreads)
+{
+  const std::uint16_t               ratio   = toFixedRatio(jumpRatio);
+  const std::vector<std::ptrdiff_t> offsets = neighborOffsets(width);
+  forEachBand(width, height, numThreads, [&](std::size_t rowBegin, std::size_t rowEnd) {
+    for (std::size_t y = rowBegin; y < rowEnd; ++y)
+    {
+      if (!copyBorder(pInput, pOutput, width, height, 1u, y))
+      {
+        continue;
+      }
+      const std::uint16_t* pRow    = pInput + y * width;
+      std::uint16_t*       pOutRow = pOutput + y * width;
+      std::size_t          x       = 1u;
+#if defined(VISIONARY_DEPTHFILTER_AVX2)
+      if (hasAvx2())
+      {
+        x = flyingPixelRowAvx2(pRow, offsets.data(), minJump, ratio, x, width - 1u, pOutRow);
+      }
+#endif
+      for (; x < width - 1u; ++x)
+      {
+        pOutRow[x] = flyingPixelAt(pRow + x, offsets.data(), minJump, ratio);
+      }
+    }
+  });
+}
+
+void DepthFilter::fillHoles(const std::uint16_t* pInput,
+                            std::uint16_t*       pOutput,
+                            std::uint32_t        width,
+                            std::uint32_t        height,
+                            unsigned             minNeighbors,
+                            std::uint16_t        maxSpread,
+                            unsigned             numThreads)
+{
+  if (minNeighbors < 1u || minNeighbors > 8u)
+  {
+    throw std::invalid_argument("Unsupported number of hole filling neighbors");
+  }
+  const std::vector<std::ptrdiff_t> offsets = neighborOffsets(width);
+  forEachBand(width, height, numThreads, [&](std::size_t rowBegin, std::size_t rowEnd) {
+    for (std::size_t y = rowBegin; y < rowEnd; ++y)
+    {
+      if (!copyBorder(pInput, pOutput, width, height, 1u, y))
+      {
+        continue;
+      }
+      const std::uint16_t* pRow    = pInput + y * width;
+      std::uint16_t*       pOutRow = pOutput + y * width;
+      std::size_t          x       = 1u;
+#if defined(VISIONARY_DEPTHFILTER_AVX2)
+      if (hasAvx2())
+      {
+        x = holeFillRowAvx2(pRow, offsets.data(), minNeighbors, maxSpread, x, width - 1u, pOutRow);
+      }
+#endif
+      for (; x < width - 1u; ++x)
+      {
+        pOutRow[x] = holeFillAt(pRow + x, offsets.data(), minNeighbors, maxSpread);
+      }
+    }
+  });
+}
+
+void DepthFilter::median(const std::uint16_t* pInput,
+                         std::uint16_t*       pOutput,
+                         std::uint32_t        width,
+                         std::uint32_t        height,
+                         unsigned             size,
+                         unsigned             numThreads)
+{
+  if (size != 3u && size != 5u)
+  {
+    throw std::invalid_argument("Unsupported median size");
+  }
+  const MedianWindow window(size, width);
+  forEachBand(width, height, numThreads, [&](std::size_t rowBegin, std::size_t rowEnd) {
+    for (std::size_t y = rowBegin; y < rowEnd; ++y)
+    {
+      if (!copyBorder(pInput, pOutput, width, height, window.radius, y))
+      {
+        continue;
+      }
+      const std::uint16_t* pRow    = pInput + y * width;
+      std::uint16_t*       pOutRow = pOutput + y * width;
+      const std::size_t    end     = width - window.radius;
+      std::size_t          x       = window.radius;
+#if defined(VISIONARY_DEPTHFILTER_AVX2)
+      if (hasAvx2())
+      {
+        x = (size == 3u) ? medianRowAvx2<9u>(pRow, window, kMedian9Network, x, end, pOutRow)
+                         : medianRowAvx2<25u>(pRow, window, kMedian25Network, x, end, pOutRow);
+      }
+#endif
+      for (; x < end; ++x)
+      {
+        pOutRow[x] = (size == 3u) ? medianAt<9u>(pRow + x, window, kMedian9Network)
+                                  : medianAt<25u>(pRow + x, window, kMedian25Network);
+      }
+    }
+  });
+}
+
+DepthFilter::DepthFilter() = default;
+
+DepthFilter::~DepthFilter() = default;
+
+} // namespace visionary
@@ -0,0 +1,293 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "DepthMapCodec.h"
+
+#include "VisionaryEndian.h"
+
+namespace visionary {
+
+namespace {
+
+// header: magic "VDC", format version, width, height
+constexpr std::uint8_t kMagic[3]   = {'V', 'D', 'C'};
+constexpr std::uint8_t kVersion    = 1u;
+constexpr std::size_t  kHeaderSize = 12u;
+
+// residuals are packed in blocks of kBlockSize values, each block is a bit width byte (0..16) followed by
+// kBlockSize * width / 8 bytes holding the residuals LSB first
+constexpr std::size_t kBlockSize = 64u;
+constexpr unsigned    kMaxBits   = 16u;
+
+inline std::uint16_t zigzagEncode(std::uint16_t value)
+{
+  return static_cast<std::uint16_t>((value << 1) ^ ((value & 0x8000u) ? 0xffffu : 0u));
+}
+
+inline std::uint16_t zigzagDecode(std::uint16_t value)
+{
+  return static_cast<std::uint16_t>((value >> 1) ^ (0u - (value & 1u)));
+}
+
+inline std::size_t blockCount(std::size_t nPixels)
+{
+  return (nPixels + kBlockSize - 1u) / kBlockSize;
+}
+
+// Computes the zigzag coded prediction errors of one row; pUp is nullptr for the first row.
+void predictRow(const std::uint16_t* pRow, const std::uint16_t* pUp, std::uint32_t width, std::uint16_t* pResiduals)
+{
+  if (width == 0u)
+  {
+    return;
+  }
+  if (pUp == nullptr)
+  {
+    pResiduals[0] = zigzagEncode(pRow[0]);
+    for (std::uint32_t x = 1u; x < width; ++x)
+    {
+      pResiduals[x] = zigzagEncode(static_cast<std::uint16_t>(pRow[x] - pRow[x - 1u]));
+    }
+    return;
+  }
+  pResiduals[0] = zigzagEncode(static_cast<std::uint16_t>(pRow[0] - pUp[0]));
+  for (std::uint32_t x = 1u; x < width; ++x)
+  {
+    const std::uint16_t prediction = static_cast<std::uint16_t>(pRow[x - 1u] + pUp[x] - pUp[x - 1u]);
+    pResiduals[x]                  = zigzagEncode(static_cast<std::uint16_t>(pRow[x] - prediction));
+  }
+}
+
+// Inverse of predictRow, pRow holds the residuals on entry and the pixels on return.
+void reconstructRow(std::uint16_t* pRow, const std::uint16_t* pUp, std::uint32_t width)
+{
+  if (width == 0u)
+  {
+    return;
+  }
+  if (pUp == nullptr)
+  {
+    std::uint16_t left = zigzagDecode(pRow[0]);
+    pRow[0]            = left;
+    for (std::uint32_t x = 1u; x < width; ++x)
+    {
+      left    = static_cast<std::uint16_t>(left + zigzagDecode(pRow[x]));
+      pRow[x] = left;
+    }
+    return;
+  }
+  // the vertical gradient part does not depend on the output and vectorizes, leaving a prefix sum
+  pRow[0] = static_cast<std::uint16_t>(zigzagDecode(pRow[0]) + pUp[0]);
+  for (std::uint32_t x = 1u; x < width; ++x)
+  {
+    pRow[x] = static_cast<std::uint16_t>(zigzagDecode(pRow[x]) + pUp[x] - pUp[x - 1u]);
+  }
+  std::uint16_t left = pRow[0];
+  for (std::uint32_t x = 1u; x < width; ++x)
+  {
+    left    = static_cast<std::uint16_t>(left + pRow[x]);
+    pRow[x] = left;
+  }
+}
+
+unsigned bitWidth(const std::uint16_t* pValues)
+{
+  unsigned combined = 0u;
+  for (std::size_t i = 0u; i < kBlockSize; ++i)
+  {
+    combined |= pValues[i];
+  }
+  unsigned bits = 0u;
+  while (combined != 0u)
+  {
+    combined >>= 1;
+    ++bits;
+  }
+  return bits;
+}
+
+// Packs 32 values into kBits 32 bit words; every value is below 2^kBits.
+template <unsigned kBits>
+inline void packGroup(const std::uint16_t* pValues, std::uint8_t* pOut)
+{
+  std::uint64_t accumulator = 0u;
+  unsigned      filled      = 0u;
+  for (unsigned i = 0u; i < 32u; ++i)
+  {
+    accumulator |= static_cast<std::uint64_t>(pValues[i]) << filled;
+    filled += kBits;
+    if (filled >= 32u)
+    {
+      writeUnalignLittleEndian<std::uint32_t>(pOut, 4u, static_cast<std::uint32_t>(accumulator));
+      pOut += 4u;
+      accumulator >>= 32;
+      filled -= 32u;
+    }
+  }
+}
+
+template <unsigned kBits>
+inline void unpackGroup(const std::uint8_t* pIn, std::uint16_t* pValues)
+{
+  constexpr std::uint64_t kMask = (1u << kBits) - 1u;
+  // one spare word, so every value can be taken from a pair of words without branches
+  std::uint32_t words[kBits + 1u];
+  for (unsigned i = 0u; i < kBits; ++i)
+  {
+    words[i] = readUnalignLittleEndian<std::uint32_t>(pIn + 4u * i);
+  }
+  words[kBits] = 0u;
+  for (unsigned i = 0u; i < 32u; ++i)
+  {
+    const unsigned      bit  = i * kBits;
+    const std::uint64_t pair = (static_cast<std::uint64_t>(words[(bit >> 5) + 1u]) << 32) | words[bit >> 5];
+    pValues[i]               = static_cast<std::uint16_t>((pair >> (bit & 31u)) & kMask);
+  }
+}
+
+template <unsigned kBits>
+void packBlock(const std::uint16_t* pValues, std::uint8_t* pOut)
+{
+  packGroup<kBits>(pValues, pOut);
+  packGroup<kBits>(pValues + 32u, pOut + 4u * kBits);
+}
+
+template <unsigned kBits>
+void unpackBlock(const std::uint8_t* pIn, std::uint16_t* pValues)
+{
+  unpackGroup<kBits>(pIn, pValues);
+  unpackGroup<kBits>(pIn + 4u * kBits, pValues + 32u);
+}
+
+template <>
+void packBlock<0u>(const std::uint16_t*, std::uint8_t*)
+{
+}
+
+template <>
+void unpackBlock<0u>(const std::uint8_t*, std::uint16_t* pValues)
+{
+  for (std::size_t i = 0u; i < kBlockSize; ++i)
+  {
+    pValues[i] = 0u;
+  }
+}
+
+using PackFunction   = void (*)(const std::uint16_t*, std::uint8_t*);
+using UnpackFunction = void (*)(const std::uint8_t*, std::uint16_t*);
+
+// the bit width is a template parameter, so every variant compiles to straight shift and mask sequences
+const PackFunction kPackFunctions[kMaxBits + 1u] = {
+  packBlock<0u>,  packBlock<1u>,  packBlock<2u>,  packBlock<3u>,  packBlock<4u>,  packBlock<5u>,
+  packBlock<6u>,  packBlock<7u>,  packBlock<8u>,  packBlock<9u>,  packBlock<10u>, packBlock<11u>,
+  packBlock<12u>, packBlock<13u>, packBlock<14u>, packBlock<15u>, packBlock<16u>};
+
+const UnpackFunction kUnpackFunctions[kMaxBits + 1u] = {
+  unpackBlock<0u>,  unpackBlock<1u>,  unpackBlock<2u>,  unpackBlock<3u>,  unpackBlock<4u>,  unpackBlock<5u>,
+  unpackBlock<6u>,  unpackBlock<7u>,  unpackBlock<8u>,  unpackBlock<9u>,  unpackBlock<10u>, unpackBlock<11u>,
+  unpackBlock<12u>, unpackBlock<13u>, unpackBlock<14u>, unpackBlock<15u>, unpackBlock<16u>};
+
+} // namespace
+
+std::size_t DepthMapCodec::maxEncodedSize(std::uint32_t width, std::uint32_t height)
+{
+  const std::size_t nBlocks = blockCount(static_cast<std::size_t>(width) * height);
+  return kHeaderSize + nBlocks * (1u + kBlockSize * kMaxBits / 8u);
+}
+
+void DepthMapCodec::encode(const std::uint16_t*       pMap,
+                           std::uint32_t              width,
+                           std::uint32_t              height,
+                           std::vector<std::uint8_t>& encoded)
+{
+  const std::size_t nPixels = static_cast<std::size_t>(width) * height;
+  const std::size_t nBlocks = blockCount(nPixels);
+
+  // the padding of the last block is zero and does not widen it
+  std::vector<std::uint16_t> residuals(nBlocks * kBlockSize, 0u);
+  for (std::uint32_t y = 0u; y < height; ++y)
+  {
+    const std::uint16_t* pRow = pMap + static_cast<std::size_t>(y) * width;
+    predictRow(pRow, (y == 0u) ? nullptr : pRow - width, width, residuals.data() + static_cast<std::size_t>(y) * width);
+  }
+
+  encoded.resize(maxEncodedSize(width, height));
+  std::uint8_t* pOut = encoded.data();
+  pOut[0]            = kMagic[0];
+  pOut[1]            = kMagic[1];
+  pOut[2]            = kMagic[2];
+  pOut[3]            = kVersion;
+  writeUnalignLittleEndian<std::uint32_t>(pOut + 4u, 4u, width);
+  writeUnalignLittleEndian<std::uint32_t>(pOut + 8u, 4u, height);
+  pOut += kHeaderSize;
+
+  for (std::size_t block = 0u; block < nBlocks; ++block)
+  {
+    const std::uint16_t* pValues = residuals.data() + block * kBlockSize;
+    const unsigned       bits    = bitWidth(pValues);
+    *pOut++                      = static_cast<std::uint8_t>(bits);
+    kPackFunctions[bits](pValues, pOut);
+    pOut += kBlockSize * bits / 8u;
+  }
+  encoded.resize(static_cast<std::size_t>(pOut - encoded.data()));
+}
+
+bool DepthMapCodec::decode(const std::uint8_t*         pData,
+                           std::size_t                 size,
+                           std::vector<std::uint16_t>& map,
+                           std::uint32_t&              width,
+                           std::uint32_t&              height)
+{
+  if ((size < kHeaderSize) || (pData[0] != kMagic[0]) || (pData[1] != kMagic[1]) || (pData[2] != kMagic[2])
+      || (pData[3] != kVersion))
+  {
+    return false;
+  }
+  const std::uint32_t mapWidth  = readUnalignLittleEndian<std::uint32_t>(pData + 4u);
+  const std::uint32_t mapHeight = readUnalignLittleEndian<std::uint32_t>(pData + 8u);
+  const std::size_t   nPixels   = static_cast<std::size_t>(mapWidth) * mapHeight;
+  const std::size_t   nBlocks   = blockCount(nPixels);
+
+  // every block takes at least its bit width byte, which rejects absurd dimensions before allocating
+  if (nBlocks > size - kHeaderSize)
+  {
+    return false;
+  }
+
+  map.resize(nBlocks * kBlockSize);
+  const std::uint8_t* pIn  = pData + kHeaderSize;
+  const std::uint8_t* pEnd = pData + size;
+  for (std::size_t block = 0u; block < nBlocks; ++block)
+  {
+    const unsigned bits = *pIn++;
+    if (bits > kMaxBits)
+    {
+      return false;
+    }
+    const std::size_t blockBytes = kBlockSize * bits / 8u;
+    if (static_cast<std::size_t>(pEnd - pIn) < blockBytes)
+    {
+      return false;
+    }
+    kUnpackFunctions[bits](pIn, map.data() + block * kBlockSize);
+    pIn += blockBytes;
+  }
+  if (pIn != pEnd)
+  {
+    return false;
+  }
+
+  for (std::uint32_t y = 0u; y < mapHeight; ++y)
+  {
+    std::uint16_t* pRow = map.data() + static_cast<std::size_t>(y) * mapWidth;
+    reconstructRow(pRow, (y == 0u) ? nullptr : pRow - mapWidth, mapWidth);
+  }
+  map.resize(nPixels);
+  width  = mapWidth;
+  height = mapHeight;
+  return true;
+}
+
+} // namespace visionary
@@ -0,0 +1,369 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "FloatFormat.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace visionary {
+
+namespace {
+
+constexpr std::uint32_t kMantissaBits      = 23u;
+constexpr std::uint32_t kExponentBits      = 8u;
+constexpr std::int32_t  kExponentBias      = 127;
+constexpr std::int32_t  kPow5InvBitCount   = 59;
+constexpr std::int32_t  kPow5BitCount      = 61;
+constexpr std::uint32_t kPow5InvSplitCount = 31u;
+
+// floor(2^k / 5^i) + 1 with k = pow5Bits(i) - 1 + kPow5InvBitCount
+const std::uint64_t kPow5InvSplit[kPow5InvSplitCount] = {
+  576460752303423489u, 461168601842738791u, 368934881474191033u, 295147905179352826u, 472236648286964522u,
+  377789318629571618u, 302231454903657294u, 483570327845851670u, 386856262276681336u, 309485009821345069u,
+  495176015714152110u, 396140812571321688u, 316912650057057351u, 507060240091291761u, 405648192073033409u,
+  324518553658426727u, 519229685853482763u, 415383748682786211u, 332306998946228969u, 531691198313966350u,
+  425352958651173080u, 340282366920938464u, 544451787073501542u, 435561429658801234u, 348449143727040987u,
+  557518629963265579u, 446014903970612463u, 356811923176489971u, 570899077082383953u, 456719261665907162u,
+  365375409332725730u};
+
+// 5^i scaled to kPow5BitCount bits
+const std::uint64_t kPow5Split[47] = {
+  1152921504606846976u, 1441151880758558720u, 1801439850948198400u, 2251799813685248000u, 1407374883553280000u,
+  1759218604441600000u, 2199023255552000000u, 1374389534720000000u, 1717986918400000000u, 2147483648000000000u,
+  1342177280000000000u, 1677721600000000000u, 2097152000000000000u, 1310720000000000000u, 1638400000000000000u,
+  2048000000000000000u, 1280000000000000000u, 1600000000000000000u, 2000000000000000000u, 1250000000000000000u,
+  1562500000000000000u, 1953125000000000000u, 1220703125000000000u, 1525878906250000000u, 1907348632812500000u,
+  1192092895507812500u, 1490116119384765625u, 1862645149230957031u, 1164153218269348144u, 1455191522836685180u,
+  1818989403545856475u, 2273736754432320594u, 1421085471520200371u, 1776356839400250464u, 2220446049250313080u,
+  1387778780781445675u, 1734723475976807094u, 2168404344971008868u, 1355252715606880542u, 1694065894508600678u,
+  2117582368135750847u, 1323488980084844279u, 1654361225106055349u, 2067951531382569187u, 1292469707114105741u,
+  1615587133892632177u, 2019483917365790221u};
+
+// ceil(log2(5^e)) for e > 0, 1 for e == 0
+inline std::int32_t pow5Bits(std::int32_t e)
+{
+  return static_cast<std::int32_t>((static_cast<std::uint32_t>(e) * 1217359u) >> 19) + 1;
+}
+
+// floor(log10(2^e))
+inline std::uint32_t log10Pow2(std::int32_t e)
+{
+  return (static_cast<std::uint32_t>(e) * 78913u) >> 18;
+}
+
+// floor(log10(5^e))
+inline std::uint32_t log10Pow5(std::int32_t e)
+{
+  return (static_cast<std::uint32_t>(e) * 732923u) >> 20;
+}
+
+inline std::uint32_t pow5Factor(std::uint32_t value)
+{
+  std::uint32_t count = 0u;
+  while (value % 5u == 0u)
+  {
+    value /= 5u;
+    ++count;
+  }
+  return count;
+}
+
+inline bool multipleOfPowerOf5(std::uint32_t value, std::uint32_t p)
+{
+  return pow5Factor(value) >= p;
+}
+
+inline bool multipleOfPowerOf2(std::uint32_t value, std::uint32_t p)
+{
+  return (value & ((1u << p) - 1u)) == 0u;
+}
+
+inline std::uint32_t mulShift(std::uint32_t m, std::uint64_t factor, std::int32_t shift)
+{
+  const std::uint64_t bits0 = static_cast<std::uint64_t>(m) * static_cast<std::uint32_t>(factor);
+  const std::uint64_t bits1 = static_cast<std::uint64_t>(m) * static_cast<std::uint32_t>(factor >> 32);
+  const std::uint64_t sum   = (bits0 >> 32) + bits1;
+  return static_cast<std::uint32_t>(sum >> (shift - 32));
+}
+
+struct DecimalFloat
+{
+  std::uint32_t mantissa;
+  std::int32_t  exponent;
+};
+
+// shortest decimal mantissa and exponent of a finite, non-zero float
+DecimalFloat toDecimal(std::uint32_t ieeeMantissa, std::uint32_t ieeeExponent)
+{
+  std::int32_t  e2;
+  std::uint32_t m2;
+  if (ieeeExponent == 0u)
+  {
+    e2 = 1 - kExponentBias - static_cast<std::int32_t>(kMantissaBits) - 2;
+    m2 = ieeeMantissa;
+  }
+  else
+  {
+    e2 = static_cast<std::int32_t>(ieeeExponent) - kExponentBias - static_cast<std::int32_t>(kMantissaBits) - 2;
+    m2 = (1u << kMantissaBits) | ieeeMantissa;
+  }
+  const bool acceptBounds = (m2 & 1u) == 0u;
+
+  // the interval of decimal values rounding to this float
+  const std::uint32_t mv      = 4u * m2;
+  const std::uint32_t mp      = 4u * m2 + 2u;
+  const std::uint32_t mmShift = (ieeeMantissa != 0u || ieeeExponent <= 1u) ? 1u : 0u;
+  const std::uint32_t mm      = 4u * m2 - 1u - mmShift;
+
+  std::uint32_t vr, vp, vm;
+  std::int32_t  e10;
+  bool          vmIsTrailingZeros = false;
+  bool          vrIsTrailingZeros = false;
+  std::uint32_t lastRemovedDigit  = 0u;
+  if (e2 >= 0)
+  {
+    const std::uint32_t q = log10Pow2(e2);
+    e10                   = static_cast<std::int32_t>(q);
+    const std::int32_t k  = kPow5InvBitCount + pow5Bits(static_cast<std::int32_t>(q)) - 1;
+    const std::int32_t i  = -e2 + static_cast<std::int32_t>(q) + k;
+    vr                    = mulShift(mv, kPow5InvSplit[q], i);
+    vp                    = mulShift(mp, kPow5InvSplit[q], i);
+    vm                    = mulShift(mm, kPow5InvSplit[q], i);
+    if (q != 0u && (vp - 1u) / 10u <= vm / 10u)
+    {
+      // the last removed digit is needed for rounding if the loop below removes no digit
+      const std::int32_t l = kPow5InvBitCount + pow5Bits(static_cast<std::int32_t>(q - 1u)) - 1;
+      lastRemovedDigit     = mulShift(mv, kPow5InvSplit[q - 1u], -e2 + static_cast<std::int32_t>(q) - 1 + l) % 10u;
+    }
+    if (q <= 9u)
+    {
+      // only one of mp, mv and mm can be a multiple of 5, if any
+      if (mv % 5u == 0u)
+      {
+        vrIsTrailingZeros = multipleOfPowerOf5(mv, q);
+      }
+      else if (acceptBounds)
+      {
+        vmIsTrailingZeros = multipleOfPowerOf5(mm, q);
+      }
+      else
+      {
+        vp -= multipleOfPowerOf5(mp, q) ? 1u : 0u;
+      }
+    }
+  }
+  else
+  {
+    const std::uint32_t q = log10Pow5(-e2);
+    e10                   = static_cast<std::int32_t>(q) + e2;
+    const std::int32_t i  = -e2 - static_cast<std::int32_t>(q);
+    const std::int32_t k  = pow5Bits(i) - kPow5BitCount;
+    std::int32_t       j  = static_cast<std::int32_t>(q) - k;
+    vr                    = mulShift(mv, kPow5Split[i], j);
+    vp                    = mulShift(mp, kPow5Split[i], j);
+    vm                    = mulShift(mm, kPow5Split[i], j);
+    if (q != 0u && (vp - 1u) / 10u <= vm / 10u)
+    {
+      j                = static_cast<std::int32_t>(q) - 1 - (pow5Bits(i + 1) - kPow5BitCount);
+      lastRemovedDigit = mulShift(mv, kPow5Split[i + 1], j) % 10u;
+    }
+    if (q <= 1u)
+    {
+      // mv has at least q trailing zero bits
+      vrIsTrailingZeros = true;
+      if (acceptBounds)
+      {
+        vmIsTrailingZeros = mmShift == 1u;
+      }
+      else
+      {
+        --vp;
+      }
+    }
+    else if (q < 31u)
+    {
+      vrIsTrailingZeros = multipleOfPowerOf2(mv, q - 1u);
+    }
+  }
+
+  // remove the digits which are not needed to identify the value within the interval
+  std::int32_t  removed = 0;
+  std::uint32_t output;
+  if (vmIsTrailingZeros || vrIsTrailingZeros)
+  {
+    while (vp / 10u > vm / 10u)
+    {
+      vmIsTrailingZeros &= vm % 10u == 0u;
+      vrIsTrailingZeros &= lastRemovedDigit == 0u;
+      lastRemovedDigit = vr % 10u;
+      vr /= 10u;
+      vp /= 10u;
+      vm /= 10u;
+      ++removed;
+    }
+    if (vmIsTrailingZeros)
+    {
+      while (vm % 10u == 0u)
+      {
+        vrIsTrailingZeros &= lastRemovedDigit == 0u;
+        lastRemovedDigit = vr % 10u;
+        vr /= 10u;
+        vp /= 10u;
+        vm /= 10u;
+        ++removed;
+      }
+    }
+    if (vrIsTrailingZeros && lastRemovedDigit == 5u && vr % 2u == 0u)
+    {
+      // round half to even
+      lastRemovedDigit = 4u;
+    }
+    output = vr + (((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5u) ? 1u : 0u);
+  }
+  else
+  {
+    while (vp / 10u > vm / 10u)
+    {
+      lastRemovedDigit = vr % 10u;
+      vr /= 10u;
+      vp /= 10u;
+      vm /= 10u;
+      ++removed;
+    }
+    output = vr + ((vr == vm || lastRemovedDigit >= 5u) ? 1u : 0u);
+  }
+  return DecimalFloat{output, e10 + removed};
+}
+
+inline std::size_t numDigits(std::uint64_t value)
+{
+  std::size_t count = 1u;
+  while (value >= 10u)
+  {
+    value /= 10u;
+    ++count;
+  }
+  return count;
+}
+
+// writes the digits of value right aligned into pOut[0, count)
+inline void writeDigits(char* pOut, std::uint64_t value, std::size_t count)
+{
+  while (count > 0u)
+  {
+    pOut[--count] = static_cast<char>('0' + value % 10u);
+    value /= 10u;
+  }
+}
+
+} // namespace
+
+std::size_t formatShortest(char* pOut, float value)
+{
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const bool          sign         = (bits >> 31) != 0u;
+  const std::uint32_t ieeeMantissa = bits & ((1u << kMantissaBits) - 1u);
+  const std::uint32_t ieeeExponent = (bits >> kMantissaBits) & ((1u << kExponentBits) - 1u);
+
+  std::size_t size = 0u;
+  if (sign)
+  {
+    pOut[size++] = '-';
+  }
+  if (ieeeExponent == (1u << kExponentBits) - 1u)
+  {
+    std::memcpy(pOut + size, ieeeMantissa != 0u ? "nan" : "inf", 3u);
+    return size + 3u;
+  }
+  if (ieeeExponent == 0u && ieeeMantissa == 0u)
+  {
+    pOut[size++] = '0';
+    return size;
+  }
+
+  const DecimalFloat  decimal   = toDecimal(ieeeMantissa, ieeeExponent);
+  const std::size_t   length    = numDigits(decimal.mantissa);
+  const std::int32_t  numLength = static_cast<std::int32_t>(length);
+  const std::int32_t  sciExp    = decimal.exponent + numLength - 1;
+  const std::uint32_t absSciExp = static_cast<std::uint32_t>(sciExp < 0 ? -sciExp : sciExp);
+
+  // d[.ddd]e+XX with at least two exponent digits
+  const std::size_t sciSize = length + (length > 1u ? 1u : 0u) + 2u + (absSciExp >= 10u ? numDigits(absSciExp) : 2u);
+  std::size_t       fixedSize;
+  std::uint64_t     integerValue = 0u;
+  if (decimal.exponent > 0)
+  {
+    // without fractional digits the exact integer value is written instead of the shortest digits padded with zeros;
+    // values with more digits than the longest scientific notation are never written in fixed notation
+    if (numLength + decimal.exponent <= static_cast<std::int32_t>(kMaxFloatChars))
+    {
+      integerValue = static_cast<std::uint64_t>(sign ? -value : value);
+      fixedSize    = numDigits(integerValue);
+    }
+    else
+    {
+      fixedSize = length + static_cast<std::size_t>(decimal.exponent);
+    }
+  }
+  else if (decimal.exponent == 0)
+  {
+    fixedSize = length;
+  }
+  else if (numLength + decimal.exponent > 0)
+  {
+    fixedSize = length + 1u;
+  }
+  else
+  {
+    fixedSize = 2u + static_cast<std::size_t>(-decimal.exponent);
+  }
+
+  char* pNum = pOut + size;
+  if (fixedSize <= sciSize)
+  {
+    if (decimal.exponent > 0)
+    {
+      writeDigits(pNum, integerValue, fixedSize);
+    }
+    else if (decimal.exponent == 0)
+    {
+      writeDigits(pNum, decimal.mantissa, length);
+    }
+    else if (numLength + decimal.exponent > 0)
+    {
+      // decimal point within the digits
+      const std::size_t numIntegerDigits = static_cast<std::size_t>(numLength + decimal.exponent);
+      writeDigits(pNum + 1u, decimal.mantissa, length);
+      std::memmove(pNum, pNum + 1u, numIntegerDigits);
+      pNum[numIntegerDigits] = '.';
+    }
+    else
+    {
+      const std::size_t numLeadingZeros = static_cast<std::size_t>(-decimal.exponent) - length;
+      pNum[0]                           = '0';
+      pNum[1]                           = '.';
+      std::memset(pNum + 2u, '0', numLeadingZeros);
+      writeDigits(pNum + 2u + numLeadingZeros, decimal.mantissa, length);
+    }
+    return size + fixedSize;
+  }
+
+  writeDigits(pNum + 1u, decimal.mantissa, length);
+  pNum[0] = pNum[1];
+  std::size_t pos = 1u;
+  if (length > 1u)
+  {
+    pNum[1] = '.';
+    pos     = length + 1u;
+  }
+  pNum[pos++] = 'e';
+  pNum[pos++] = sciExp < 0 ? '-' : '+';
+  writeDigits(pNum + pos, absSciExp, sciSize - pos);
+  return size + sciSize;
+}
+
+} // namespace visionary
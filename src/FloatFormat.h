@@ -0,0 +1,28 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef> // for size_t
+
+namespace visionary {
+
+/// Maximum number of characters written by formatShortest().
+constexpr std::size_t kMaxFloatChars = 16u;
+
+/// Formats a float with the shortest decimal representation that converts back to the same value.
+///
+/// The digits are computed with the Ryu algorithm (Ulf Adams, PLDI 2018) and written in fixed or scientific notation,
+/// whichever is shorter (fixed on a tie), with the same result as std::to_chars of C++17: 0.5f gives "0.5", 1000.0f
+/// gives "1000" and 1.0e6f gives "1e+06". Integers in fixed notation are written exactly, e.g. "33554448" instead of
+/// "33554450". NaN and infinity are written as "nan" and "inf", negative values with a leading '-'.
+///
+/// \param[out] pOut  destination with room for at least kMaxFloatChars characters, no null terminator is written.
+/// \param[in]  value value to format.
+///
+/// \returns the number of characters written.
+std::size_t formatShortest(char* pOut, float value);
+
+} // namespace visionary
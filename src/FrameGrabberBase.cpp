@@ -5,89 +5,422 @@
 
 #include "FrameGrabberBase.h"
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <random>
+#include <stdexcept>
 
+#include "LatencyTrace.h"
 #include "VisionaryControl.h"
 
 namespace visionary {
 FrameGrabberBase::FrameGrabberBase(VisionaryControl&         visionaryControl,
                                    const std::string&        hostname,
                                    std::uint16_t             port,
-                                   std::chrono::milliseconds timeout)
+                                   std::chrono::milliseconds timeout,
+                                   const SocketOptions&      socketOptions,
+                                   const PipelineOptions&    pipelineOptions)
   : m_visionaryControl(visionaryControl)
   , m_isRunning(false)
   , m_hostnameThreadRead(hostname)
   , m_portThreadRead(port)
   , m_timeoutThreadRead(timeout)
+  , m_socketOptionsThreadRead(socketOptions)
+  , m_pipelineOptionsThreadRead(pipelineOptions)
   , m_connectedThreadPrivate(false)
   , m_pDataStreamThreadPrivate(nullptr)
   , m_frameAvailableThreadShared(false)
   , m_pDataHandlerThreadShared(nullptr)
+  , m_nextReceiveSequence(0u)
+  , m_nextPublishSequence(0u)
+  , m_connectionState(ConnectionState::DISCONNECTED)
 {
+  if (!m_pipelineOptionsThreadRead.depthFilter.isValid())
+  {
+    throw std::invalid_argument("Unsupported depth filter configuration");
+  }
+
   m_pDataHandlerThreadShared = genCreateDataHandler();
 
   m_pDataStreamThreadPrivate = std::unique_ptr<VisionaryDataStream>(new VisionaryDataStream(genCreateDataHandler()));
+  m_pDataStreamThreadPrivate->setIncrementalParsing(m_pipelineOptionsThreadRead.incrementalParsing);
 
-  m_connectedThreadPrivate =
-    m_pDataStreamThreadPrivate->open(m_hostnameThreadRead, m_portThreadRead, m_timeoutThreadRead);
+  m_connectedThreadPrivate = m_pDataStreamThreadPrivate->open(
+    m_hostnameThreadRead, m_portThreadRead, m_timeoutThreadRead, m_socketOptionsThreadRead);
 
   if (!m_connectedThreadPrivate)
   {
     throw std::runtime_error("Failed to connect");
   }
 
-  m_isRunning     = true;
+  m_connectionState = ConnectionState::CONNECTED;
+  updateConnectionHealth();
+
+  m_isRunning = true;
+  if (m_pipelineOptionsThreadRead.parseThreads > 0u)
+  {
+    for (std::size_t i = 0u; i < std::max<std::size_t>(1u, m_pipelineOptionsThreadRead.rawBuffers); ++i)
+    {
+      m_freeRawFrames.emplace_back(new VisionaryDataStream::RawFrame());
+    }
+    for (unsigned i = 0u; i < m_pipelineOptionsThreadRead.parseThreads; ++i)
+    {
+      m_parseThreads.emplace_back(&FrameGrabberBase::runParser, this, genCreateDataHandler());
+    }
+  }
   m_grabberThread = std::thread(&FrameGrabberBase::run, this);
 }
 
 std::shared_ptr<VisionaryData> FrameGrabberBase::genCreateDataHandler() const
 {
-  return m_visionaryControl.createDataHandler();
+  std::shared_ptr<VisionaryData> pDataHandler = m_visionaryControl.createDataHandler();
+  applyPipelineOptions(*pDataHandler);
+  return pDataHandler;
+}
+
+void FrameGrabberBase::applyPipelineOptions(VisionaryData& dataHandler) const
+{
+  dataHandler.setMapSelection(m_pipelineOptionsThreadRead.mapSelection);
+  dataHandler.setFrameFilter(m_pipelineOptionsThreadRead.frameFilter);
+  dataHandler.setCrcValidation(m_pipelineOptionsThreadRead.crcValidation);
 }
 
 FrameGrabberBase::~FrameGrabberBase()
 {
-  m_isRunning = false;
+  {
+    std::lock_guard<std::mutex> guard(m_stopMutex);
+    m_isRunning = false;
+  }
+  m_stopCv.notify_all();
+  {
+    // the waiting threads check m_isRunning under this mutex
+    std::lock_guard<std::mutex> guard(m_pipelineMutex);
+  }
+  m_rawFrameFreeCv.notify_all();
+  m_rawFrameQueuedCv.notify_all();
+  m_rawFrameTurnCv.notify_all();
+
   m_grabberThread.join();
+  for (auto& parseThread : m_parseThreads)
+  {
+    parseThread.join();
+  }
 }
 
 void FrameGrabberBase::run()
 {
+  using Clock = std::chrono::steady_clock;
+
+  std::mt19937                           random(std::random_device{}());
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+  // reconnect attempts since the last received frame
+  unsigned attempt = 0u;
+
+  // measured frame period (exponential moving average) and the watchdog timeout derived from it
+  Clock::duration           framePeriod(0);
+  Clock::time_point         lastFrameTime;
+  bool                      hasLastFrame = false;
+  Clock::time_point         lastActivity = Clock::now();
+  std::chrono::milliseconds watchdogTimeout(0);
+
   while (m_isRunning)
   {
+    const ReconnectPolicy policy = getReconnectPolicy();
+
     if (!m_connectedThreadPrivate)
     {
-      std::cerr << "Connection lost, reconnecting" << '\n';
-
-      m_pDataStreamThreadPrivate->close();
+      if (!reconnect(policy, attempt, uniform(random)))
+      {
+        break;
+      }
+      ++attempt;
+      if (!m_connectedThreadPrivate)
+      {
+        continue;
+      }
+      // the new socket starts with the configured timeout, the interval across the outage is no frame period
+      watchdogTimeout = std::chrono::milliseconds(0);
+      hasLastFrame    = false;
+      lastActivity    = Clock::now();
+    }
 
-      m_connectedThreadPrivate =
-        m_pDataStreamThreadPrivate->open(m_hostnameThreadRead, m_portThreadRead, m_timeoutThreadRead);
+    // adapt the receive timeout to the frame period
+    if (policy.watchdog && framePeriod > Clock::duration(0))
+    {
+      const auto timeout = std::min(
+        m_timeoutThreadRead,
+        std::max(policy.minWatchdogTimeout,
+                 std::chrono::duration_cast<std::chrono::milliseconds>(framePeriod * policy.watchdogPeriods)));
+      // only touch the socket if the timeout changed by more than 10%
+      if (timeout * 10 > watchdogTimeout * 11 || timeout * 11 < watchdogTimeout * 10)
+      {
+        m_pDataStreamThreadPrivate->setReceiveTimeout(timeout);
+        watchdogTimeout = timeout;
+      }
+    }
+    else if (watchdogTimeout > std::chrono::milliseconds(0))
+    {
+      m_pDataStreamThreadPrivate->setReceiveTimeout(m_timeoutThreadRead);
+      watchdogTimeout = std::chrono::milliseconds(0);
+    }
 
-      if (!m_connectedThreadPrivate)
+    if (m_parseThreads.empty() ? receiveFrame() : receiveRawFrame())
+    {
+      const auto now = Clock::now();
+      if (hasLastFrame)
       {
-        std::cerr << "Failed to connect to " << m_hostnameThreadRead << ':' << m_portThreadRead << '\n';
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        // moving average over about 8 frames
+        framePeriod = (framePeriod == Clock::duration(0)) ? now - lastFrameTime
+                                                           : framePeriod + (now - lastFrameTime - framePeriod) / 8;
       }
+      hasLastFrame  = true;
+      lastFrameTime = now;
+      lastActivity  = now;
+      attempt       = 0u;
+    }
+    else if (m_pDataStreamThreadPrivate->isConnectionLost())
+    {
+      std::cerr << "Connection lost, reconnecting" << '\n';
+      m_connectedThreadPrivate = false;
+      setConnectionState(ConnectionState::DISCONNECTED);
+    }
+    else if (watchdogTimeout > std::chrono::milliseconds(0) && Clock::now() - lastActivity >= watchdogTimeout)
+    {
+      std::cerr << "No frame received for " << watchdogTimeout.count() << "ms, reconnecting" << '\n';
+      m_connectedThreadPrivate = false;
+      setConnectionState(ConnectionState::STALLED);
+    }
+    updateConnectionHealth();
+  }
+}
+
+bool FrameGrabberBase::reconnect(const ReconnectPolicy& policy, unsigned attempt, double random01)
+{
+  const auto backoff = policy.getBackoff(attempt, random01);
+  if (backoff > std::chrono::milliseconds(0))
+  {
+    std::unique_lock<std::mutex> guard(m_stopMutex);
+    if (m_stopCv.wait_for(guard, backoff, [this] { return !m_isRunning; }))
+    {
+      return false;
+    }
+  }
+
+  setConnectionState(ConnectionState::RECONNECTING);
+
+  // the stream keeps its data handler (with the parsed metadata and lookup tables) and its receive buffers
+  m_pDataStreamThreadPrivate->close();
+  m_connectedThreadPrivate = m_pDataStreamThreadPrivate->open(
+    m_hostnameThreadRead, m_portThreadRead, m_timeoutThreadRead, m_socketOptionsThreadRead);
+
+  if (m_connectedThreadPrivate)
+  {
+    m_pDataStreamThreadPrivate->getStatisticsCollector().onReconnect();
+    setConnectionState(ConnectionState::CONNECTED);
+  }
+  else
+  {
+    std::cerr << "Failed to connect to " << m_hostnameThreadRead << ':' << m_portThreadRead << '\n';
+    setConnectionState(ConnectionState::DISCONNECTED);
+  }
+  updateConnectionHealth();
+  return true;
+}
+
+bool FrameGrabberBase::receiveFrame()
+{
+  if (!m_pDataStreamThreadPrivate->getNextFrame())
+  {
+    // a frame rejected by the frame filter still counts as received for the watchdog
+    return m_pDataStreamThreadPrivate->getDataHandler()->isFrameRejected();
+  }
+  auto pDataHandler = m_pDataStreamThreadPrivate->getDataHandler();
+  if (!filterFrame(*pDataHandler))
+  {
+    // the blob itself was fine and is already counted as parsed
+    m_pDataStreamThreadPrivate->getStatisticsCollector().onFrameDropped();
+    return true;
+  }
+  publishFrame(pDataHandler);
+  m_pDataStreamThreadPrivate->setDataHandler(pDataHandler);
+  return true;
+}
+
+bool FrameGrabberBase::receiveRawFrame()
+{
+  RawFramePtr pFrame;
+  {
+    std::unique_lock<std::mutex> guard(m_pipelineMutex);
+    m_rawFrameFreeCv.wait(guard, [this] { return !m_freeRawFrames.empty() || !m_isRunning; });
+    if (!m_isRunning)
+    {
+      return false;
+    }
+    pFrame = std::move(m_freeRawFrames.back());
+    m_freeRawFrames.pop_back();
+  }
+
+  const bool received = m_pDataStreamThreadPrivate->receiveRawFrame(*pFrame);
+
+  {
+    std::lock_guard<std::mutex> guard(m_pipelineMutex);
+    if (received)
+    {
+      m_rawFrameQueue.push_back(QueuedRawFrame{m_nextReceiveSequence++, std::move(pFrame)});
+      m_pDataStreamThreadPrivate->getStatisticsCollector().onBacklog(
+        std::max<std::size_t>(1u, m_pipelineOptionsThreadRead.rawBuffers) - m_freeRawFrames.size());
     }
-    if (m_connectedThreadPrivate)
+    else
+    {
+      m_freeRawFrames.push_back(std::move(pFrame));
+    }
+  }
+  if (received)
+  {
+    m_rawFrameQueuedCv.notify_one();
+  }
+  return received;
+}
+
+void FrameGrabberBase::runParser(std::shared_ptr<VisionaryData> pDataHandler)
+{
+  while (true)
+  {
+    QueuedRawFrame queued;
     {
-      if (m_pDataStreamThreadPrivate->getNextFrame())
+      std::unique_lock<std::mutex> guard(m_pipelineMutex);
+      m_rawFrameQueuedCv.wait(guard, [this] { return !m_rawFrameQueue.empty() || !m_isRunning; });
+      if (!m_isRunning)
       {
-        std::unique_lock<std::mutex> guard(m_mutex);
+        return;
+      }
+      queued = std::move(m_rawFrameQueue.front());
+      m_rawFrameQueue.pop_front();
+    }
 
-        m_frameAvailableThreadShared = true;
-        auto pOldDataHandler         = std::move(m_pDataHandlerThreadShared);
-        m_pDataHandlerThreadShared   = std::move(m_pDataStreamThreadPrivate->getDataHandler());
-        m_pDataStreamThreadPrivate->setDataHandler(pOldDataHandler);
+    // parsing is the expensive part and runs concurrently in all parse threads
+    const bool parsed   = m_pDataStreamThreadPrivate->parseRawFrame(*queued.pFrame, *pDataHandler);
+    const bool filtered = parsed && filterFrame(*pDataHandler);
 
-        m_frameAvailableCv.notify_one();
+    {
+      // the statistics, the clock synchronization and the consumer expect the frames in the received order
+      std::unique_lock<std::mutex> guard(m_pipelineMutex);
+      m_rawFrameTurnCv.wait(guard, [&] { return queued.sequence == m_nextPublishSequence || !m_isRunning; });
+      if (!m_isRunning)
+      {
+        return;
       }
+      m_pDataStreamThreadPrivate->finishFrame(*queued.pFrame, parsed, *pDataHandler);
+      if (filtered)
+      {
+        publishFrame(pDataHandler);
+      }
+      else if (parsed)
+      {
+        // counted like in receiveFrame(): the blob was parsed, only the frame is discarded
+        m_pDataStreamThreadPrivate->getStatisticsCollector().onFrameDropped();
+      }
+      ++m_nextPublishSequence;
+      m_freeRawFrames.push_back(std::move(queued.pFrame));
+      m_pDataStreamThreadPrivate->getStatisticsCollector().onBacklog(
+        std::max<std::size_t>(1u, m_pipelineOptionsThreadRead.rawBuffers) - m_freeRawFrames.size());
     }
+    m_rawFrameFreeCv.notify_one();
+    m_rawFrameTurnCv.notify_all();
+  }
+}
+
+bool FrameGrabberBase::filterFrame(VisionaryData& dataHandler) const
+{
+  if (!m_pipelineOptionsThreadRead.depthFilter.isEnabled())
+  {
+    return true;
+  }
+  try
+  {
+    dataHandler.filterDepthMap(m_pipelineOptionsThreadRead.depthFilter);
+  }
+  catch (const std::exception&)
+  {
+    // e.g. out of memory for the scratch map, the frame is counted as dropped by the caller
+    return false;
+  }
+  return true;
+}
+
+void FrameGrabberBase::publishFrame(std::shared_ptr<VisionaryData>& pDataHandler)
+{
+  std::unique_lock<std::mutex> guard(m_mutex);
+
+  if (m_frameAvailableThreadShared)
+  {
+    // the previous frame was not fetched in time
+    m_pDataStreamThreadPrivate->getStatisticsCollector().onFrameDropped();
+  }
+  m_frameAvailableThreadShared = true;
+  std::swap(pDataHandler, m_pDataHandlerThreadShared);
+  VISIONARY_TRACE_STAGE(m_pDataHandlerThreadShared, FrameStage::HANDED_OFF);
+
+  m_frameAvailableCv.notify_one();
+}
+
+void FrameGrabberBase::setConnectionState(ConnectionState::Enum state)
+{
+  if (m_connectionState.exchange(state) == state)
+  {
+    return;
+  }
+  ConnectionStateCallback callback;
+  {
+    std::lock_guard<std::mutex> guard(m_configMutex);
+    callback = m_connectionStateCallback;
+  }
+  if (callback)
+  {
+    callback(state);
   }
 }
 
+void FrameGrabberBase::setReconnectPolicy(const ReconnectPolicy& policy)
+{
+  std::lock_guard<std::mutex> guard(m_configMutex);
+  m_reconnectPolicy = policy;
+}
+
+ReconnectPolicy FrameGrabberBase::getReconnectPolicy() const
+{
+  std::lock_guard<std::mutex> guard(m_configMutex);
+  return m_reconnectPolicy;
+}
+
+void FrameGrabberBase::setConnectionStateCallback(ConnectionStateCallback callback)
+{
+  std::lock_guard<std::mutex> guard(m_configMutex);
+  m_connectionStateCallback = std::move(callback);
+}
+
+ConnectionState::Enum FrameGrabberBase::getConnectionState() const
+{
+  return static_cast<ConnectionState::Enum>(m_connectionState.load());
+}
+
+void FrameGrabberBase::updateConnectionHealth()
+{
+  ConnectionHealth health = m_pDataStreamThreadPrivate->getConnectionHealth();
+  health.connected        = health.connected && m_connectedThreadPrivate;
+
+  std::lock_guard<std::mutex> guard(m_configMutex);
+  m_connectionHealth = health;
+}
+
+ConnectionHealth FrameGrabberBase::getConnectionHealth() const
+{
+  std::lock_guard<std::mutex> guard(m_configMutex);
+  return m_connectionHealth;
+}
+
 bool FrameGrabberBase::genGetNextFrame(std::shared_ptr<VisionaryData>& pDataHandler,
                                        bool                            onlyNewer,
                                        std::chrono::milliseconds       timeout)
@@ -99,10 +432,11 @@ bool FrameGrabberBase::genGetNextFrame(std::shared_ptr<VisionaryData>& pDataHand
 
   std::unique_lock<std::mutex> guard(m_mutex);
 
-  if (onlyNewer)
+  if (onlyNewer && m_frameAvailableThreadShared)
   {
     // we ignore any already available frames
     m_frameAvailableThreadShared = false;
+    m_pDataStreamThreadPrivate->getStatisticsCollector().onFrameDropped();
   }
 
   m_frameAvailableCv.wait_for(guard, timeout, [this] { return m_frameAvailableThreadShared; });
@@ -111,11 +445,14 @@ bool FrameGrabberBase::genGetNextFrame(std::shared_ptr<VisionaryData>& pDataHand
   {
     m_frameAvailableThreadShared = false;
 
-    // exchange handlers
-    const auto tmp             = std::move(pDataHandler);
+    // exchange handlers, the handler of the caller is filled by the grabber from now on
+    const auto tmp = std::move(pDataHandler);
+    applyPipelineOptions(*tmp);
     pDataHandler               = std::move(m_pDataHandlerThreadShared);
     m_pDataHandlerThreadShared = tmp;
 
+    recordFrameLatency(*pDataHandler);
+
     return true;
   }
   return false;
@@ -134,14 +471,60 @@ bool FrameGrabberBase::genGetCurrentFrame(std::shared_ptr<VisionaryData>& pDataH
   {
     m_frameAvailableThreadShared = false;
 
-    // exchange handlers
-    const auto tmp             = std::move(pDataHandler);
+    // exchange handlers, the handler of the caller is filled by the grabber from now on
+    const auto tmp = std::move(pDataHandler);
+    applyPipelineOptions(*tmp);
     pDataHandler               = std::move(m_pDataHandlerThreadShared);
     m_pDataHandlerThreadShared = tmp;
 
+    recordFrameLatency(*pDataHandler);
+
     return true;
   }
   return false;
 }
 
+const LatencyHistogram& FrameGrabberBase::getStageLatency(FrameStage::Enum stage) const
+{
+  return m_stageLatency[stage];
+}
+
+const LatencyHistogram& FrameGrabberBase::getTotalLatency() const
+{
+  return m_totalLatency;
+}
+
+StreamStatistics FrameGrabberBase::getStatistics() const
+{
+  return m_pDataStreamThreadPrivate->getStatistics();
+}
+
+void FrameGrabberBase::resetStatistics()
+{
+  m_pDataStreamThreadPrivate->getStatisticsCollector().reset();
+}
+
+ClockSyncEstimate FrameGrabberBase::getClockSyncEstimate() const
+{
+  return m_pDataStreamThreadPrivate->getClockSynchronizer().getEstimate();
+}
+
+void FrameGrabberBase::recordFrameLatency(VisionaryData& data)
+{
+#ifdef VISIONARY_BASE_LATENCY_TRACE
+  VISIONARY_TRACE_STAGE_OF(data, FrameStage::CONSUMED);
+
+  const FrameTimestamps& timestamps = data.getFrameTimestamps();
+  for (int stage = FrameStage::LAST_BYTE_RECEIVED; stage < FrameStage::NUM_STAGES; ++stage)
+  {
+    m_stageLatency[stage].record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      timestamps.between(static_cast<FrameStage::Enum>(stage - 1), static_cast<FrameStage::Enum>(stage))));
+  }
+  m_totalLatency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    timestamps.between(FrameStage::FIRST_BYTE_RECEIVED, FrameStage::CONSUMED)));
+#else
+  (void)data;
+#endif
+}
+
 } // namespace visionary
@@ -0,0 +1,234 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "FrameRecorder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "MappedFile.h"
+#include "VisionaryEndian.h"
+
+namespace visionary {
+
+namespace {
+
+constexpr std::size_t kBlobFileHeaderSize = 8u;
+
+} // namespace
+
+FrameRecorder::FrameRecorder(const RecorderOptions& options)
+  : m_options(options), m_isRunning(true), m_nextNumber(0u), m_statistics()
+{
+  for (std::size_t i = 0u; i < std::max<std::size_t>(1u, m_options.queueCapacity); ++i)
+  {
+    m_freeRecords.emplace_back(new Record());
+  }
+  for (std::size_t i = 0u; i < std::max<std::size_t>(1u, m_options.writerThreads); ++i)
+  {
+    m_writerThreads.emplace_back(&FrameRecorder::runWriter, this);
+  }
+}
+
+FrameRecorder::~FrameRecorder()
+{
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_isRunning = false;
+  }
+  m_queuedCv.notify_all();
+
+  // the writer threads empty the queue before they exit
+  for (auto& writerThread : m_writerThreads)
+  {
+    writerThread.join();
+  }
+}
+
+template <typename FillFunction>
+bool FrameRecorder::fillAndQueueRecord(FillFunction fill)
+{
+  RecordPtr pRecord = acquireRecord();
+  if (!pRecord)
+  {
+    return false;
+  }
+  try
+  {
+    fill(*pRecord);
+  }
+  catch (...)
+  {
+    // e.g. out of memory while copying, the entry stays in the pool and flush() does not wait for it
+    releaseRecord(std::move(pRecord));
+    throw;
+  }
+  queueRecord(std::move(pRecord));
+  return true;
+}
+
+bool FrameRecorder::recordPointCloud(const std::vector<PointXYZ>&      points,
+                                     const std::vector<std::uint32_t>& rgbaMap,
+                                     const std::vector<std::uint16_t>& intensityMap)
+{
+  return fillAndQueueRecord([&](Record& record) {
+    record.format = m_options.pointCloudFormat;
+    // assign() reuses the capacity of the queue entry
+    record.points.assign(points.begin(), points.end());
+    record.rgbaMap.assign(rgbaMap.begin(), rgbaMap.end());
+    record.intensityMap.assign(intensityMap.begin(), intensityMap.end());
+  });
+}
+
+bool FrameRecorder::recordFrame(VisionaryData& data)
+{
+  return fillAndQueueRecord([&](Record& record) {
+    record.format = m_options.pointCloudFormat;
+    data.generatePointCloud(record.points);
+    record.rgbaMap.assign(data.getRGBAMap().begin(), data.getRGBAMap().end());
+    record.intensityMap.assign(data.getIntensityMap().begin(), data.getIntensityMap().end());
+  });
+}
+
+bool FrameRecorder::recordRawFrame(const VisionaryDataStream::ByteBuffer& buffer)
+{
+  return fillAndQueueRecord([&](Record& record) {
+    record.format = RecordFormat::RAW_BLOB;
+    record.blob.assign(buffer.begin(), buffer.end());
+  });
+}
+
+void FrameRecorder::flush()
+{
+  std::unique_lock<std::mutex> guard(m_mutex);
+  m_idleCv.wait(guard, [this] { return m_statistics.queueDepth == 0u; });
+}
+
+RecorderStatistics FrameRecorder::getStatistics() const
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+  return m_statistics;
+}
+
+FrameRecorder::RecordPtr FrameRecorder::acquireRecord()
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+  if (m_freeRecords.empty())
+  {
+    ++m_statistics.recordsDropped;
+    return RecordPtr();
+  }
+  RecordPtr pRecord = std::move(m_freeRecords.back());
+  m_freeRecords.pop_back();
+  pRecord->number = m_nextNumber++;
+  return pRecord;
+}
+
+void FrameRecorder::queueRecord(RecordPtr pRecord)
+{
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_queue.push_back(std::move(pRecord));
+    ++m_statistics.recordsAccepted;
+    ++m_statistics.queueDepth;
+    m_statistics.maxQueueDepth = std::max(m_statistics.maxQueueDepth, m_statistics.queueDepth);
+  }
+  m_queuedCv.notify_one();
+}
+
+void FrameRecorder::releaseRecord(RecordPtr pRecord)
+{
+  std::lock_guard<std::mutex> guard(m_mutex);
+  m_freeRecords.push_back(std::move(pRecord));
+}
+
+void FrameRecorder::runWriter()
+{
+  std::unique_lock<std::mutex> guard(m_mutex);
+  while (true)
+  {
+    m_queuedCv.wait(guard, [this] { return !m_queue.empty() || !m_isRunning; });
+    if (m_queue.empty())
+    {
+      // stopped and nothing left to write
+      return;
+    }
+    RecordPtr pRecord = std::move(m_queue.front());
+    m_queue.pop_front();
+
+    guard.unlock();
+    const bool success = writeRecord(*pRecord);
+    guard.lock();
+
+    if (success)
+    {
+      ++m_statistics.recordsWritten;
+    }
+    else
+    {
+      ++m_statistics.writeErrors;
+    }
+    m_freeRecords.push_back(std::move(pRecord));
+    --m_statistics.queueDepth;
+    if (m_statistics.queueDepth == 0u)
+    {
+      m_idleCv.notify_all();
+    }
+  }
+}
+
+bool FrameRecorder::writeRecord(const Record& record) const
+{
+  const bool isBlob = record.format == RecordFormat::RAW_BLOB;
+
+  char suffix[32];
+  std::snprintf(suffix,
+                sizeof(suffix),
+                "_%06llu.%s",
+                static_cast<unsigned long long>(record.number),
+                isBlob ? "blob" : "ply");
+  const std::string filename = m_options.directory + "/" + m_options.prefix + suffix;
+
+  if (!isBlob)
+  {
+    return PointCloudPlyWriter::WriteFormatPLY(filename.c_str(),
+                                               record.points,
+                                               record.rgbaMap,
+                                               record.intensityMap,
+                                               record.format == RecordFormat::PLY_BINARY,
+                                               m_options.presentation);
+  }
+
+  // 4x STX and the big endian length in front of the blob, like on the wire
+  std::uint8_t header[kBlobFileHeaderSize] = {0x02u, 0x02u, 0x02u, 0x02u};
+  writeUnalignBigEndian<std::uint32_t>(header + 4u, 4u, static_cast<std::uint32_t>(record.blob.size()));
+
+  std::ofstream stream(filename, std::ios_base::out | std::ios_base::binary);
+  stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+  stream.write(reinterpret_cast<const char*>(record.blob.data()), static_cast<std::streamsize>(record.blob.size()));
+  stream.close();
+  return !stream.fail();
+}
+
+bool FrameRecorder::readRawFrame(const std::string& filename, VisionaryDataStream::ByteBuffer& buffer)
+{
+  MappedFile file;
+  if (!file.open(filename) || (file.size() < kBlobFileHeaderSize))
+  {
+    return false;
+  }
+  const std::uint8_t kFraming[4] = {0x02u, 0x02u, 0x02u, 0x02u};
+  const std::size_t  blobSize    = readUnalignBigEndian<std::uint32_t>(file.data() + 4u);
+  if ((std::memcmp(file.data(), kFraming, sizeof(kFraming)) != 0) || (blobSize != file.size() - kBlobFileHeaderSize))
+  {
+    return false;
+  }
+  buffer.assign(file.data() + kBlobFileHeaderSize, file.data() + file.size());
+  return true;
+}
+
+} // namespace visionary
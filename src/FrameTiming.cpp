@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "FrameTiming.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace visionary {
+
+constexpr std::size_t LatencyHistogram::kSubBucketBits;
+constexpr std::size_t LatencyHistogram::kSubBuckets;
+constexpr std::size_t LatencyHistogram::kMaxMsb;
+constexpr std::size_t LatencyHistogram::kNumBuckets;
+
+bool isLatencyTraceEnabled()
+{
+#ifdef VISIONARY_BASE_LATENCY_TRACE
+  return true;
+#else
+  return false;
+#endif
+}
+
+namespace {
+
+std::size_t mostSignificantBit(std::uint64_t value)
+{
+  std::size_t msb = 0u;
+  for (std::size_t shift = 32u; shift > 0u; shift >>= 1u)
+  {
+    if (value >= (std::uint64_t(1u) << shift))
+    {
+      value >>= shift;
+      msb += shift;
+    }
+  }
+  return msb;
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram()
+{
+  reset();
+}
+
+std::size_t LatencyHistogram::bucketIndex(std::uint64_t value)
+{
+  if (value < kSubBuckets)
+  {
+    return static_cast<std::size_t>(value);
+  }
+  const std::size_t msb = mostSignificantBit(value);
+  if (msb > kMaxMsb)
+  {
+    return kNumBuckets - 1u;
+  }
+  const std::size_t shift = msb - kSubBucketBits;
+  const std::size_t sub   = static_cast<std::size_t>(value >> shift) & (kSubBuckets - 1u);
+  return (msb - kSubBucketBits + 1u) * kSubBuckets + sub;
+}
+
+std::uint64_t LatencyHistogram::bucketMidpoint(std::size_t index)
+{
+  if (index < kSubBuckets)
+  {
+    return index;
+  }
+  const std::size_t   msb   = index / kSubBuckets + kSubBucketBits - 1u;
+  const std::size_t   shift = msb - kSubBucketBits;
+  const std::uint64_t lower = static_cast<std::uint64_t>(kSubBuckets + index % kSubBuckets) << shift;
+  return lower + ((std::uint64_t(1u) << shift) >> 1u);
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds value)
+{
+  const std::uint64_t ns = value.count() > 0 ? static_cast<std::uint64_t>(value.count()) : 0u;
+
+  m_buckets[bucketIndex(ns)].fetch_add(1u, std::memory_order_relaxed);
+  m_sum.fetch_add(ns, std::memory_order_relaxed);
+
+  std::uint64_t current = m_min.load(std::memory_order_relaxed);
+  while (ns < current && !m_min.compare_exchange_weak(current, ns, std::memory_order_relaxed))
+  {
+  }
+  current = m_max.load(std::memory_order_relaxed);
+  while (ns > current && !m_max.compare_exchange_weak(current, ns, std::memory_order_relaxed))
+  {
+  }
+  // the count is incremented last, so readers never see a count without the sample
+  m_count.fetch_add(1u, std::memory_order_release);
+}
+
+void LatencyHistogram::reset()
+{
+  for (auto& bucket : m_buckets)
+  {
+    bucket.store(0u, std::memory_order_relaxed);
+  }
+  m_sum.store(0u, std::memory_order_relaxed);
+  m_min.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+  m_max.store(0u, std::memory_order_relaxed);
+  m_count.store(0u, std::memory_order_release);
+}
+
+std::uint64_t LatencyHistogram::getCount() const
+{
+  return m_count.load(std::memory_order_acquire);
+}
+
+std::chrono::nanoseconds LatencyHistogram::getPercentile(double quantile) const
+{
+  std::uint64_t total = 0u;
+  for (const auto& bucket : m_buckets)
+  {
+    total += bucket.load(std::memory_order_relaxed);
+  }
+  if (total == 0u)
+  {
+    return std::chrono::nanoseconds(0);
+  }
+  // the extremes are tracked exactly
+  if (quantile <= 0.0)
+  {
+    return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(m_min.load(std::memory_order_relaxed)));
+  }
+  if (quantile >= 1.0)
+  {
+    return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(m_max.load(std::memory_order_relaxed)));
+  }
+  const std::uint64_t rank  = std::max<std::uint64_t>(1u, static_cast<std::uint64_t>(quantile * total + 0.5));
+  std::uint64_t       count = 0u;
+  for (std::size_t i = 0u; i < kNumBuckets; ++i)
+  {
+    count += m_buckets[i].load(std::memory_order_relaxed);
+    if (count >= rank)
+    {
+      // clamp the bucket estimate into the observed value range
+      const std::uint64_t value = std::min(std::max(bucketMidpoint(i), m_min.load(std::memory_order_relaxed)),
+                                           m_max.load(std::memory_order_relaxed));
+      return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(value));
+    }
+  }
+  return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(m_max.load(std::memory_order_relaxed)));
+}
+
+LatencySummary LatencyHistogram::getSummary() const
+{
+  using ns = std::chrono::nanoseconds;
+
+  LatencySummary summary{};
+  summary.count = getCount();
+  if (summary.count == 0u)
+  {
+    return summary;
+  }
+  summary.min  = ns(static_cast<ns::rep>(m_min.load(std::memory_order_relaxed)));
+  summary.max  = ns(static_cast<ns::rep>(m_max.load(std::memory_order_relaxed)));
+  summary.mean = ns(static_cast<ns::rep>(m_sum.load(std::memory_order_relaxed) / summary.count));
+  summary.p50  = getPercentile(0.5);
+  summary.p90  = getPercentile(0.9);
+  summary.p99  = getPercentile(0.99);
+  return summary;
+}
+
+} // namespace visionary
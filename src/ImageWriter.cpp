@@ -0,0 +1,398 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "ImageWriter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Crc32.h"
+#include "Deflate.h"
+#include "VisionaryEndian.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#  define VISIONARY_COLORMAP_AVX2
+#  include <immintrin.h>
+#  define VISIONARY_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace visionary {
+
+namespace {
+
+constexpr std::size_t kNumColors = 256u;
+
+const std::uint8_t kPngSignature[8] = {0x89u, 'P', 'N', 'G', '\r', '\n', 0x1Au, '\n'};
+
+// PNG color types and filter types
+constexpr std::uint8_t kPngGray = 0u;
+constexpr std::uint8_t kPngRgb  = 2u;
+constexpr std::uint8_t kPngNone = 0u;
+constexpr std::uint8_t kPngSub  = 1u;
+
+// the color index is computed in 8.24 fixed point, which keeps all products within 32 bit
+constexpr unsigned      kScaleBits = 24u;
+constexpr std::uint32_t kRounding  = 1u << (kScaleBits - 1u);
+
+std::uint8_t toColorByte(double value)
+{
+  return static_cast<std::uint8_t>(std::lround(std::min(std::max(value, 0.0), 1.0) * 255.0));
+}
+
+// Colors of a color map. Entry 0 is black for the pixels without data, entries 1 to 256 are the color map. Each entry
+// holds red, green and blue in its first three bytes.
+struct ColorTable
+{
+  explicit ColorTable(ColorMap::Enum colorMap)
+  {
+    entries[0] = 0u;
+    for (std::size_t i = 0u; i < kNumColors; ++i)
+    {
+      const double t = static_cast<double>(i) / (kNumColors - 1u);
+      double       rgb[3];
+      switch (colorMap)
+      {
+        case ColorMap::JET:
+          rgb[0] = 1.5 - std::fabs(4.0 * t - 3.0);
+          rgb[1] = 1.5 - std::fabs(4.0 * t - 2.0);
+          rgb[2] = 1.5 - std::fabs(4.0 * t - 1.0);
+          break;
+        case ColorMap::TURBO:
+          // polynomial approximation of the Turbo color map by Anton Mikhailov (Apache 2.0)
+          rgb[0] = 0.13572138
+                   + t * (4.61539260 + t * (-42.66032258 + t * (132.13108234 + t * (-152.94239396 + t * 59.28637943))));
+          rgb[1] = 0.09140261
+                   + t * (2.19418839 + t * (4.84296658 + t * (-14.18503333 + t * (4.27729857 + t * 2.82956604))));
+          rgb[2] = 0.10667330
+                   + t * (12.64194608 + t * (-60.58204836 + t * (110.36276771 + t * (-89.90310912 + t * 27.34824973))));
+          break;
+        case ColorMap::GRAY:
+        default:
+          rgb[0] = t;
+          rgb[1] = t;
+          rgb[2] = t;
+          break;
+      }
+      const std::uint8_t bytes[4] = {toColorByte(rgb[0]), toColorByte(rgb[1]), toColorByte(rgb[2]), 0u};
+      std::memcpy(&entries[i + 1u], bytes, sizeof(bytes));
+    }
+  }
+
+  std::uint32_t entries[kNumColors + 1u];
+};
+
+const ColorTable& colorTable(ColorMap::Enum colorMap)
+{
+  static const ColorTable gray(ColorMap::GRAY);
+  static const ColorTable jet(ColorMap::JET);
+  static const ColorTable turbo(ColorMap::TURBO);
+  switch (colorMap)
+  {
+    case ColorMap::JET:
+      return jet;
+    case ColorMap::TURBO:
+      return turbo;
+    case ColorMap::GRAY:
+    default:
+      return gray;
+  }
+}
+
+// Linear mapping of the value range onto the color table.
+struct ColorScale
+{
+  ColorScale(std::uint16_t minimum, std::uint16_t maximum)
+    : minValue(minimum), maxValue(std::max(minimum, maximum)), scale(0u)
+  {
+    const std::uint64_t range = std::max<std::uint32_t>(maxValue - minValue, 1u);
+    scale = static_cast<std::uint32_t>(((kNumColors - 1u) << kScaleBits) / range);
+  }
+
+  // index into the color table: 0 for pixels without data, 1 + the color otherwise
+  std::uint32_t index(std::uint32_t value) const
+  {
+    if (value == 0u)
+    {
+      return 0u;
+    }
+    const std::uint32_t clamped = std::min(std::max(value, minValue), maxValue);
+    return 1u + (((clamped - minValue) * scale + kRounding) >> kScaleBits);
+  }
+
+  std::uint32_t minValue;
+  std::uint32_t maxValue;
+  std::uint32_t scale;
+};
+
+#if defined(VISIONARY_COLORMAP_AVX2)
+bool hasAvx2()
+{
+  return __builtin_cpu_supports("avx2") != 0;
+}
+
+// Converts eight pixels per step: the indices are computed in 32 bit lanes and the colors are gathered from the
+// table. Returns the number of converted pixels; the stores run 4 bytes ahead, so the last two pixels are left over.
+VISIONARY_TARGET_AVX2 std::size_t applyColorMapAvx2(const std::uint16_t* pMap,
+                                                    std::size_t          numPixels,
+                                                    const ColorScale&    colorScale,
+                                                    const std::uint32_t* pTable,
+                                                    std::uint8_t*        pRgb)
+{
+  const __m256i minValue = _mm256_set1_epi32(static_cast<int>(colorScale.minValue));
+  const __m256i maxValue = _mm256_set1_epi32(static_cast<int>(colorScale.maxValue));
+  const __m256i scale    = _mm256_set1_epi32(static_cast<int>(colorScale.scale));
+  const __m256i rounding = _mm256_set1_epi32(static_cast<int>(kRounding));
+  const __m256i one      = _mm256_set1_epi32(1);
+  const __m256i zero     = _mm256_setzero_si256();
+  // moves the first three bytes of the four colors of each lane into its first 12 bytes
+  const __m256i pack = _mm256_setr_epi8(
+    0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+  std::size_t i = 0u;
+  for (; i + 10u <= numPixels; i += 8u)
+  {
+    const __m256i values  = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pMap + i)));
+    const __m256i clamped = _mm256_min_epu32(_mm256_max_epu32(values, minValue), maxValue);
+    const __m256i scaled  = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(clamped, minValue), scale), rounding);
+    const __m256i index   = _mm256_andnot_si256(_mm256_cmpeq_epi32(values, zero),
+                                              _mm256_add_epi32(_mm256_srli_epi32(scaled, kScaleBits), one));
+    const __m256i colors = _mm256_i32gather_epi32(reinterpret_cast<const int*>(pTable), index, 4);
+    const __m256i packed = _mm256_shuffle_epi8(colors, pack);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pRgb + 3u * i), _mm256_castsi256_si128(packed));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pRgb + 3u * i + 12u), _mm256_extracti128_si256(packed, 1));
+  }
+  return i;
+}
+#endif
+
+// Converts a 16 bit map into PNG scanlines: a filter type byte per row followed by the big endian samples.
+// With prediction the Sub filter stores the difference of each byte to the same byte of the left pixel.
+void filterGray16(const std::uint16_t*       pMap,
+                  std::uint32_t              width,
+                  std::uint32_t              height,
+                  bool                       predict,
+                  std::vector<std::uint8_t>& scanlines)
+{
+  const std::size_t rowSize = 1u + 2u * static_cast<std::size_t>(width);
+  scanlines.resize(rowSize * height);
+  for (std::size_t y = 0u; y < height; ++y)
+  {
+    const std::uint16_t* pRow = pMap + y * width;
+    std::uint8_t*        pOut = &scanlines[y * rowSize];
+    *pOut++                   = predict ? kPngSub : kPngNone;
+    if (predict)
+    {
+      pOut[0] = static_cast<std::uint8_t>(pRow[0] >> 8u);
+      pOut[1] = static_cast<std::uint8_t>(pRow[0]);
+      for (std::size_t x = 1u; x < width; ++x)
+      {
+        const unsigned value = pRow[x];
+        const unsigned left  = pRow[x - 1u];
+        pOut[2u * x]         = static_cast<std::uint8_t>((value >> 8u) - (left >> 8u));
+        pOut[2u * x + 1u]    = static_cast<std::uint8_t>(value - left);
+      }
+    }
+    else
+    {
+      for (std::size_t x = 0u; x < width; ++x)
+      {
+        pOut[2u * x]      = static_cast<std::uint8_t>(pRow[x] >> 8u);
+        pOut[2u * x + 1u] = static_cast<std::uint8_t>(pRow[x]);
+      }
+    }
+  }
+}
+
+// Converts an RGB image into PNG scanlines like filterGray16().
+void filterRgb8(const std::uint8_t*        pRgb,
+                std::uint32_t              width,
+                std::uint32_t              height,
+                bool                       predict,
+                std::vector<std::uint8_t>& scanlines)
+{
+  const std::size_t rowBytes = 3u * static_cast<std::size_t>(width);
+  scanlines.resize((1u + rowBytes) * height);
+  for (std::size_t y = 0u; y < height; ++y)
+  {
+    const std::uint8_t* pRow = pRgb + y * rowBytes;
+    std::uint8_t*       pOut = &scanlines[y * (1u + rowBytes)];
+    *pOut++                  = predict ? kPngSub : kPngNone;
+    if (predict)
+    {
+      std::memcpy(pOut, pRow, std::min<std::size_t>(3u, rowBytes));
+      for (std::size_t i = 3u; i < rowBytes; ++i)
+      {
+        pOut[i] = static_cast<std::uint8_t>(pRow[i] - pRow[i - 3u]);
+      }
+    }
+    else
+    {
+      std::memcpy(pOut, pRow, rowBytes);
+    }
+  }
+}
+
+// Starts a PNG chunk and returns the offset of its type, to be passed to endChunk() after the data was appended.
+std::size_t beginChunk(std::vector<std::uint8_t>& png, const char* type)
+{
+  png.resize(png.size() + 4u);
+  const std::size_t typeOffset = png.size();
+  png.insert(png.end(), type, type + 4);
+  return typeOffset;
+}
+
+// Completes a chunk with its length and CRC.
+void endChunk(std::vector<std::uint8_t>& png, std::size_t typeOffset)
+{
+  const std::size_t dataSize = png.size() - typeOffset - 4u;
+  writeUnalignBigEndian<std::uint32_t>(&png[typeOffset - 4u], 4u, static_cast<std::uint32_t>(dataSize));
+  const std::uint32_t crc = Crc32::compute(CrcAlgorithm::CRC32, &png[typeOffset], png.size() - typeOffset);
+  png.resize(png.size() + 4u);
+  writeUnalignBigEndian<std::uint32_t>(&png[png.size() - 4u], 4u, crc);
+}
+
+// Assembles a PNG file from the filtered scanlines.
+void encodePng(std::uint32_t                    width,
+               std::uint32_t                    height,
+               std::uint8_t                     bitDepth,
+               std::uint8_t                     colorType,
+               const std::vector<std::uint8_t>& scanlines,
+               PngCompression::Enum             compression,
+               std::vector<std::uint8_t>&       png)
+{
+  // stored data needs 5 bytes per block of 64 KiB, compressed data is smaller
+  png.reserve(scanlines.size() + scanlines.size() / 8192u + 1024u);
+  png.assign(kPngSignature, kPngSignature + sizeof(kPngSignature));
+
+  std::size_t  chunk = beginChunk(png, "IHDR");
+  std::uint8_t header[13];
+  writeUnalignBigEndian<std::uint32_t>(header, 4u, width);
+  writeUnalignBigEndian<std::uint32_t>(header + 4u, 4u, height);
+  header[8]  = bitDepth;
+  header[9]  = colorType;
+  header[10] = 0u; // deflate
+  header[11] = 0u; // adaptive filtering
+  header[12] = 0u; // no interlace
+  png.insert(png.end(), header, header + sizeof(header));
+  endChunk(png, chunk);
+
+  chunk = beginChunk(png, "IDAT");
+  zlibCompress(scanlines.data(),
+               scanlines.size(),
+               (compression == PngCompression::STORED) ? DeflateMode::STORED : DeflateMode::HUFFMAN_RLE,
+               png);
+  endChunk(png, chunk);
+
+  endChunk(png, beginChunk(png, "IEND"));
+}
+
+bool writeFile(const char* filename, const std::vector<std::uint8_t>& content)
+{
+  std::ofstream stream(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!stream.is_open())
+  {
+    return false;
+  }
+  stream.write(reinterpret_cast<const char*>(content.data()), static_cast<std::streamsize>(content.size()));
+  return stream.good();
+}
+
+} // namespace
+
+bool ImageWriter::WriteFormatPGM(const char*          filename,
+                                 const std::uint16_t* pMap,
+                                 std::uint32_t        width,
+                                 std::uint32_t        height)
+{
+  if (width == 0u || height == 0u)
+  {
+    return false;
+  }
+  const std::string         header    = "P5\n" + std::to_string(width) + " " + std::to_string(height) + "\n65535\n";
+  const std::size_t         numPixels = static_cast<std::size_t>(width) * height;
+  std::vector<std::uint8_t> content(header.size() + 2u * numPixels);
+  std::memcpy(content.data(), header.data(), header.size());
+  std::uint8_t* pOut = content.data() + header.size();
+  for (std::size_t i = 0u; i < numPixels; ++i)
+  {
+    pOut[2u * i]      = static_cast<std::uint8_t>(pMap[i] >> 8u);
+    pOut[2u * i + 1u] = static_cast<std::uint8_t>(pMap[i]);
+  }
+  return writeFile(filename, content);
+}
+
+bool ImageWriter::WriteFormatPNG(const char*          filename,
+                                 const std::uint16_t* pMap,
+                                 std::uint32_t        width,
+                                 std::uint32_t        height,
+                                 PngCompression::Enum compression)
+{
+  if (width == 0u || height == 0u)
+  {
+    return false;
+  }
+  std::vector<std::uint8_t> scanlines;
+  filterGray16(pMap, width, height, compression != PngCompression::STORED, scanlines);
+  std::vector<std::uint8_t> png;
+  encodePng(width, height, 16u, kPngGray, scanlines, compression, png);
+  return writeFile(filename, png);
+}
+
+bool ImageWriter::WritePreviewPNG(const char*          filename,
+                                  const std::uint16_t* pMap,
+                                  std::uint32_t        width,
+                                  std::uint32_t        height,
+                                  std::uint16_t        minValue,
+                                  std::uint16_t        maxValue,
+                                  ColorMap::Enum       colorMap,
+                                  PngCompression::Enum compression)
+{
+  if (width == 0u || height == 0u)
+  {
+    return false;
+  }
+  const std::size_t         numPixels = static_cast<std::size_t>(width) * height;
+  std::vector<std::uint8_t> rgb(3u * numPixels);
+  applyColorMap(pMap, numPixels, minValue, maxValue, colorMap, rgb.data());
+  std::vector<std::uint8_t> scanlines;
+  filterRgb8(rgb.data(), width, height, compression != PngCompression::STORED, scanlines);
+  std::vector<std::uint8_t> png;
+  encodePng(width, height, 8u, kPngRgb, scanlines, compression, png);
+  return writeFile(filename, png);
+}
+
+void ImageWriter::applyColorMap(const std::uint16_t* pMap,
+                                std::size_t          numPixels,
+                                std::uint16_t        minValue,
+                                std::uint16_t        maxValue,
+                                ColorMap::Enum       colorMap,
+                                std::uint8_t*        pRgb)
+{
+  const ColorScale     colorScale(minValue, maxValue);
+  const std::uint32_t* pTable = colorTable(colorMap).entries;
+
+  std::size_t i = 0u;
+#if defined(VISIONARY_COLORMAP_AVX2)
+  static const bool useAvx2 = hasAvx2();
+  if (useAvx2)
+  {
+    i = applyColorMapAvx2(pMap, numPixels, colorScale, pTable, pRgb);
+  }
+#endif
+  for (; i < numPixels; ++i)
+  {
+    std::memcpy(pRgb + 3u * i, &pTable[colorScale.index(pMap[i])], 3u);
+  }
+}
+
+ImageWriter::ImageWriter() = default;
+
+ImageWriter::~ImageWriter() = default;
+
+} // namespace visionary
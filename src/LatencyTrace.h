@@ -0,0 +1,28 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <chrono>
+
+#include "FrameTiming.h"
+
+// Records a pipeline stage timestamp on the VisionaryData object \a pData points to (may be null).
+// Expands to nothing unless the library is built with VISIONARY_BASE_ENABLE_LATENCY_TRACE.
+#ifdef VISIONARY_BASE_LATENCY_TRACE
+#  define VISIONARY_TRACE_STAGE(pData, stage)                                                                         \
+    do                                                                                                                 \
+    {                                                                                                                  \
+      if (pData)                                                                                                       \
+      {                                                                                                                \
+        (pData)->setFrameTimestamp((stage), std::chrono::steady_clock::now());                                         \
+      }                                                                                                                \
+    } while (false)
+// Records a pipeline stage timestamp on \a object, which must provide setFrameTimestamp() like VisionaryData.
+#  define VISIONARY_TRACE_STAGE_OF(object, stage) (object).setFrameTimestamp((stage), std::chrono::steady_clock::now())
+#else
+#  define VISIONARY_TRACE_STAGE(pData, stage)     ((void)0)
+#  define VISIONARY_TRACE_STAGE_OF(object, stage) ((void)0)
+#endif
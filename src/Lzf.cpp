@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "Lzf.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace visionary {
+
+namespace {
+
+// A compressed block is a sequence of
+// - literal runs: control byte 000LLLLL followed by L + 1 literal bytes (1..32)
+// - back references: control byte LLLOOOOO, an extra length byte if LLL is 7, and the low offset byte;
+//   length + 2 bytes are copied from offset + 1 bytes before the output position
+constexpr std::size_t kMaxLiteralRun = 32u;
+constexpr std::size_t kMaxOffset     = 1u << 13;
+constexpr std::size_t kMaxMatch      = 7u + 255u + 2u;
+constexpr unsigned    kHashBits      = 14u;
+
+inline std::uint32_t hashTriple(const std::uint8_t* p)
+{
+  const std::uint32_t value = (static_cast<std::uint32_t>(p[0]) << 16) | (static_cast<std::uint32_t>(p[1]) << 8) | p[2];
+  return (value * 2654435761u) >> (32u - kHashBits);
+}
+
+} // namespace
+
+std::size_t lzfCompress(const std::uint8_t* pInput,
+                        std::size_t         inputSize,
+                        std::uint8_t*       pOutput,
+                        std::size_t         outputSize)
+{
+  // positions + 1 of the last occurrence of each hashed triple, 0 means none
+  std::vector<std::size_t> table(std::size_t(1u) << kHashBits, 0u);
+
+  std::size_t in  = 0u;
+  std::size_t out = 0u;
+
+  // a literal run is opened by reserving its control byte
+  std::size_t runStart  = 0u;
+  std::size_t runLength = 0u;
+
+  const auto appendLiteral = [&](std::uint8_t value) -> bool {
+    if (runLength == 0u)
+    {
+      if (out + 2u > outputSize)
+      {
+        return false;
+      }
+      runStart = out++;
+    }
+    else if (out + 1u > outputSize)
+    {
+      return false;
+    }
+    pOutput[out++] = value;
+    if (++runLength == kMaxLiteralRun)
+    {
+      pOutput[runStart] = static_cast<std::uint8_t>(runLength - 1u);
+      runLength         = 0u;
+    }
+    return true;
+  };
+  const auto closeRun = [&]() {
+    if (runLength > 0u)
+    {
+      pOutput[runStart] = static_cast<std::uint8_t>(runLength - 1u);
+      runLength         = 0u;
+    }
+  };
+
+  while (in + 2u < inputSize)
+  {
+    const std::uint32_t hash      = hashTriple(pInput + in);
+    const std::size_t   candidate = table[hash];
+    table[hash]                   = in + 1u;
+
+    if (candidate != 0u && in - (candidate - 1u) <= kMaxOffset
+        && std::memcmp(pInput + candidate - 1u, pInput + in, 3u) == 0)
+    {
+      const std::size_t ref      = candidate - 1u;
+      const std::size_t maxMatch = std::min(kMaxMatch, inputSize - in);
+      std::size_t       length   = 3u;
+      while (length < maxMatch && pInput[ref + length] == pInput[in + length])
+      {
+        ++length;
+      }
+
+      closeRun();
+      const std::size_t offset        = in - ref - 1u;
+      const std::size_t encodedLength = length - 2u;
+      if (out + (encodedLength < 7u ? 2u : 3u) > outputSize)
+      {
+        return 0u;
+      }
+      if (encodedLength < 7u)
+      {
+        pOutput[out++] = static_cast<std::uint8_t>((encodedLength << 5) | (offset >> 8));
+      }
+      else
+      {
+        pOutput[out++] = static_cast<std::uint8_t>((7u << 5) | (offset >> 8));
+        pOutput[out++] = static_cast<std::uint8_t>(encodedLength - 7u);
+      }
+      pOutput[out++] = static_cast<std::uint8_t>(offset & 0xffu);
+      in += length;
+    }
+    else if (!appendLiteral(pInput[in++]))
+    {
+      return 0u;
+    }
+  }
+  while (in < inputSize)
+  {
+    if (!appendLiteral(pInput[in++]))
+    {
+      return 0u;
+    }
+  }
+  closeRun();
+  return out;
+}
+
+std::size_t lzfDecompress(const std::uint8_t* pInput,
+                          std::size_t         inputSize,
+                          std::uint8_t*       pOutput,
+                          std::size_t         outputSize)
+{
+  std::size_t in  = 0u;
+  std::size_t out = 0u;
+  while (in < inputSize)
+  {
+    const std::size_t control = pInput[in++];
+    if (control < kMaxLiteralRun)
+    {
+      const std::size_t length = control + 1u;
+      if (in + length > inputSize || out + length > outputSize)
+      {
+        return 0u;
+      }
+      std::memcpy(pOutput + out, pInput + in, length);
+      in += length;
+      out += length;
+    }
+    else
+    {
+      std::size_t length = control >> 5;
+      if (length == 7u)
+      {
+        if (in >= inputSize)
+        {
+          return 0u;
+        }
+        length += pInput[in++];
+      }
+      if (in >= inputSize)
+      {
+        return 0u;
+      }
+      const std::size_t offset = ((control & 0x1fu) << 8) + pInput[in++] + 1u;
+      length += 2u;
+      if (offset > out || out + length > outputSize)
+      {
+        return 0u;
+      }
+      // the source may overlap the destination, so the bytes are copied one by one
+      for (std::size_t i = 0u; i < length; ++i, ++out)
+      {
+        pOutput[out] = pOutput[out - offset];
+      }
+    }
+  }
+  return out;
+}
+
+} // namespace visionary
@@ -0,0 +1,45 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef> // for size_t
+#include <cstdint>
+
+namespace visionary {
+
+/// Returns the output size lzfCompress() needs in the worst case (incompressible input).
+constexpr std::size_t lzfMaxCompressedSize(std::size_t inputSize)
+{
+  return inputSize + inputSize / 32u + 1u;
+}
+
+/// Compresses a block in the LZF format of liblzf, as used by the binary_compressed data of PCD files.
+///
+/// \param[in]  pInput      data to compress.
+/// \param[in]  inputSize   number of bytes to compress.
+/// \param[out] pOutput     destination of the compressed data.
+/// \param[in]  outputSize  capacity of the destination, lzfMaxCompressedSize() always suffices.
+///
+/// \returns the compressed size, 0 if the destination is too small.
+std::size_t lzfCompress(const std::uint8_t* pInput,
+                        std::size_t         inputSize,
+                        std::uint8_t*       pOutput,
+                        std::size_t         outputSize);
+
+/// Decompresses a block in the LZF format.
+///
+/// \param[in]  pInput     compressed data.
+/// \param[in]  inputSize  number of compressed bytes.
+/// \param[out] pOutput    destination of the decompressed data.
+/// \param[in]  outputSize capacity of the destination.
+///
+/// \returns the decompressed size, 0 if the data is corrupt or the destination is too small.
+std::size_t lzfDecompress(const std::uint8_t* pInput,
+                          std::size_t         inputSize,
+                          std::uint8_t*       pOutput,
+                          std::size_t         outputSize);
+
+} // namespace visionary
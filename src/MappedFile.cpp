@@ -0,0 +1,147 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace visionary {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : m_pData(nullptr), m_size(0u), m_isOpen(false), m_hFile(nullptr), m_hMapping(nullptr)
+{
+}
+
+bool MappedFile::open(const std::string& filename)
+{
+  close();
+  const HANDLE hFile = ::CreateFileA(filename.c_str(),
+                                     GENERIC_READ,
+                                     FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                     nullptr,
+                                     OPEN_EXISTING,
+                                     FILE_ATTRIBUTE_NORMAL,
+                                     nullptr);
+  if (hFile == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+  LARGE_INTEGER fileSize;
+  if (!::GetFileSizeEx(hFile, &fileSize))
+  {
+    ::CloseHandle(hFile);
+    return false;
+  }
+  m_hFile = hFile;
+  m_size  = static_cast<std::size_t>(fileSize.QuadPart);
+  if (m_size > 0u)
+  {
+    // a mapping of an empty file cannot be created
+    m_hMapping = ::CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_hMapping == nullptr)
+    {
+      close();
+      return false;
+    }
+    m_pData = static_cast<const std::uint8_t*>(::MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_pData == nullptr)
+    {
+      close();
+      return false;
+    }
+  }
+  m_isOpen = true;
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (m_pData != nullptr)
+  {
+    ::UnmapViewOfFile(m_pData);
+  }
+  if (m_hMapping != nullptr)
+  {
+    ::CloseHandle(m_hMapping);
+  }
+  if (m_hFile != nullptr)
+  {
+    ::CloseHandle(m_hFile);
+  }
+  m_pData    = nullptr;
+  m_size     = 0u;
+  m_isOpen   = false;
+  m_hFile    = nullptr;
+  m_hMapping = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile() : m_pData(nullptr), m_size(0u), m_isOpen(false)
+{
+}
+
+bool MappedFile::open(const std::string& filename)
+{
+  close();
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+  struct stat fileStat;
+  if (::fstat(fd, &fileStat) != 0)
+  {
+    ::close(fd);
+    return false;
+  }
+  const std::size_t fileSize = static_cast<std::size_t>(fileStat.st_size);
+  if (fileSize > 0u)
+  {
+    void* pMapping = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (pMapping == MAP_FAILED)
+    {
+      ::close(fd);
+      return false;
+    }
+    m_pData = static_cast<const std::uint8_t*>(pMapping);
+  }
+  // the mapping stays valid without the descriptor
+  ::close(fd);
+  m_size   = fileSize;
+  m_isOpen = true;
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (m_pData != nullptr)
+  {
+    ::munmap(const_cast<std::uint8_t*>(m_pData), m_size);
+  }
+  m_pData  = nullptr;
+  m_size   = 0u;
+  m_isOpen = false;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+} // namespace visionary
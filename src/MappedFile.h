@@ -0,0 +1,65 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef> // for size_t
+#include <cstdint>
+#include <string>
+
+namespace visionary {
+
+/// Read only memory mapping of a whole file.
+///
+/// The pages are loaded by the operating system on first access, so opening a large file is cheap and random access
+/// does not read the parts in between.
+class MappedFile
+{
+public:
+  MappedFile();
+  ~MappedFile();
+
+  MappedFile(const MappedFile&)            = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /// Maps a file, a previously mapped file is closed.
+  ///
+  /// \param[in] filename path of the file.
+  ///
+  /// \returns true if successful; an empty file is mapped successfully with size() 0.
+  bool open(const std::string& filename);
+
+  /// Unmaps the file.
+  void close();
+
+  /// Returns true if a file is mapped.
+  bool isOpen() const
+  {
+    return m_isOpen;
+  }
+
+  /// Returns the start of the mapping, nullptr for an empty file.
+  const std::uint8_t* data() const
+  {
+    return m_pData;
+  }
+
+  /// Returns the size of the file in bytes.
+  std::size_t size() const
+  {
+    return m_size;
+  }
+
+private:
+  const std::uint8_t* m_pData;
+  std::size_t         m_size;
+  bool                m_isOpen;
+#ifdef _WIN32
+  void* m_hFile;
+  void* m_hMapping;
+#endif
+};
+
+} // namespace visionary
@@ -0,0 +1,73 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "PointCloudLayout.h"
+
+#include <cstdint>
+
+namespace visionary {
+
+namespace {
+
+struct ByteRange
+{
+  std::uint32_t begin;
+  std::uint32_t end;
+};
+
+bool overlap(const ByteRange& lhs, const ByteRange& rhs)
+{
+  return lhs.begin < rhs.end && rhs.begin < lhs.end;
+}
+
+} // namespace
+
+bool PointCloudLayout::isValid() const
+{
+  if (hasIntensity && intensityType != PointFieldType::UINT16 && intensityType != PointFieldType::FLOAT32)
+  {
+    return false;
+  }
+
+  // computed in 64 bit, offsets near the uint32 limit must not wrap around
+  const std::size_t   intensitySize = (intensityType == PointFieldType::UINT16) ? sizeof(std::uint16_t) : sizeof(float);
+  const std::uint64_t xyzEnd        = static_cast<std::uint64_t>(xyzOffset) + 3u * sizeof(float);
+  const std::uint64_t intensityEnd  = static_cast<std::uint64_t>(intensityOffset) + intensitySize;
+  const std::uint64_t rgbaEnd       = static_cast<std::uint64_t>(rgbaOffset) + sizeof(std::uint32_t);
+  if (xyzEnd > pointStep || (hasIntensity && intensityEnd > pointStep) || (hasRgba && rgbaEnd > pointStep))
+  {
+    return false;
+  }
+
+  const ByteRange xyz{xyzOffset, static_cast<std::uint32_t>(xyzEnd)};
+  const ByteRange intensity{intensityOffset, static_cast<std::uint32_t>(intensityEnd)};
+  const ByteRange rgba{rgbaOffset, static_cast<std::uint32_t>(rgbaEnd)};
+  return !(hasIntensity && overlap(xyz, intensity)) && !(hasRgba && overlap(xyz, rgba))
+         && !(hasIntensity && hasRgba && overlap(intensity, rgba));
+}
+
+std::vector<PointField> PointCloudLayout::getFields() const
+{
+  std::vector<PointField> fields;
+  fields.push_back(PointField{"x", xyzOffset, PointFieldType::FLOAT32, 1u});
+  fields.push_back(PointField{"y", xyzOffset + 4u, PointFieldType::FLOAT32, 1u});
+  fields.push_back(PointField{"z", xyzOffset + 8u, PointFieldType::FLOAT32, 1u});
+  if (hasIntensity)
+  {
+    fields.push_back(PointField{"intensity", intensityOffset, intensityType, 1u});
+  }
+  if (hasRgba)
+  {
+    fields.push_back(PointField{"rgba", rgbaOffset, PointFieldType::UINT32, 1u});
+  }
+  return fields;
+}
+
+std::size_t PointCloudLayout::getBufferSize(std::size_t numPoints) const
+{
+  return numPoints * pointStep;
+}
+
+} // namespace visionary
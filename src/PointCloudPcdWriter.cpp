@@ -0,0 +1,317 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "PointCloudPcdWriter.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "FloatFormat.h"
+#include "Lzf.h"
+#include "PointCloudWriterUtils.h"
+#include "VisionaryEndian.h"
+
+namespace visionary {
+
+namespace {
+
+// upper limit of an ASCII point line: four floats, the packed color and the separators
+constexpr std::size_t kMaxPointLineSize = 4u * (kMaxFloatChars + 1u) + 11u;
+
+struct PcdFields
+{
+  bool hasColors;
+  bool hasIntensities;
+
+  std::size_t pointSize() const
+  {
+    return 3u * sizeof(float) + (hasColors ? sizeof(std::uint32_t) : 0u) + (hasIntensities ? sizeof(float) : 0u);
+  }
+};
+
+// PCL stores the color as 0x00RRGGBB, the RGBA map holds R, G, B and A in memory order
+inline std::uint32_t packRgb(std::uint32_t rgba)
+{
+  const auto bytes = reinterpret_cast<const std::uint8_t*>(&rgba);
+  return (static_cast<std::uint32_t>(bytes[0]) << 16) | (static_cast<std::uint32_t>(bytes[1]) << 8) | bytes[2];
+}
+
+inline float normalizeIntensity(std::uint16_t intensity)
+{
+  return static_cast<float>(intensity) / 65535.0f;
+}
+
+inline PointXYZ presentPoint(PointXYZ point, InvalidPointPresentation presentation)
+{
+  if (presentation == INVALID_AS_ZERO)
+  {
+    if (std::isnan(point.x))
+      point.x = 0.0f;
+    if (std::isnan(point.y))
+      point.y = 0.0f;
+    if (std::isnan(point.z))
+      point.z = 0.0f;
+  }
+  return point;
+}
+
+void writeHeader(FileWriteBuffer&  buffer,
+                 const PcdFields&  fields,
+                 std::size_t       width,
+                 std::size_t       height,
+                 PcdEncoding::Enum encoding)
+{
+  char line[128];
+
+  buffer.append("# .PCD v0.7 - Point Cloud Data file format\n");
+  buffer.append("VERSION 0.7\n");
+  std::snprintf(line,
+                sizeof(line),
+                "FIELDS x y z%s%s\nSIZE 4 4 4%s%s\nTYPE F F F%s%s\nCOUNT 1 1 1%s%s\n",
+                fields.hasColors ? " rgb" : "",
+                fields.hasIntensities ? " intensity" : "",
+                fields.hasColors ? " 4" : "",
+                fields.hasIntensities ? " 4" : "",
+                fields.hasColors ? " U" : "",
+                fields.hasIntensities ? " F" : "",
+                fields.hasColors ? " 1" : "",
+                fields.hasIntensities ? " 1" : "");
+  buffer.append(line);
+  std::snprintf(line,
+                sizeof(line),
+                "WIDTH %lu\nHEIGHT %lu\nVIEWPOINT 0 0 0 1 0 0 0\nPOINTS %lu\n",
+                static_cast<unsigned long>(width),
+                static_cast<unsigned long>(height),
+                static_cast<unsigned long>(width * height));
+  buffer.append(line);
+  switch (encoding)
+  {
+    case PcdEncoding::ASCII:
+      buffer.append("DATA ascii\n");
+      break;
+    case PcdEncoding::BINARY:
+      buffer.append("DATA binary\n");
+      break;
+    case PcdEncoding::BINARY_COMPRESSED:
+      buffer.append("DATA binary_compressed\n");
+      break;
+  }
+}
+
+void writeAsciiPoints(FileWriteBuffer&             buffer,
+                      const std::vector<PointXYZ>& points,
+                      const std::vector<uint32_t>& rgbaMap,
+                      const std::vector<uint16_t>& intensityMap,
+                      const PcdFields&             fields,
+                      InvalidPointPresentation     presentation)
+{
+  for (std::size_t i = 0u; i < points.size(); ++i)
+  {
+    if (presentation == INVALID_SKIP && !isValidPoint(points[i]))
+    {
+      continue;
+    }
+    const PointXYZ point = presentPoint(points[i], presentation);
+
+    char*       pOut = buffer.reserve(kMaxPointLineSize);
+    std::size_t size = formatShortest(pOut, point.x);
+    pOut[size++]     = ' ';
+    size += formatShortest(pOut + size, point.y);
+    pOut[size++] = ' ';
+    size += formatShortest(pOut + size, point.z);
+    if (fields.hasColors)
+    {
+      size += static_cast<std::size_t>(std::snprintf(
+        pOut + size, kMaxPointLineSize - size, " %lu", static_cast<unsigned long>(packRgb(rgbaMap[i]))));
+    }
+    if (fields.hasIntensities)
+    {
+      pOut[size++] = ' ';
+      size += formatShortest(pOut + size, normalizeIntensity(intensityMap[i]));
+    }
+    pOut[size++] = '\n';
+    buffer.commit(size);
+  }
+}
+
+// writes the fields of a point to pOut
+inline void encodeBinaryPoint(std::uint8_t*            pOut,
+                              const PointXYZ&          point,
+                              const uint32_t*          pRgba,
+                              const uint16_t*          pIntensity,
+                              InvalidPointPresentation presentation)
+{
+  const PointXYZ presented = presentPoint(point, presentation);
+  writeUnalignLittleEndian<float>(pOut, 4u, presented.x);
+  writeUnalignLittleEndian<float>(pOut + 4u, 4u, presented.y);
+  writeUnalignLittleEndian<float>(pOut + 8u, 4u, presented.z);
+  pOut += 12u;
+  if (pRgba != nullptr)
+  {
+    writeUnalignLittleEndian<std::uint32_t>(pOut, 4u, packRgb(*pRgba));
+    pOut += 4u;
+  }
+  if (pIntensity != nullptr)
+  {
+    writeUnalignLittleEndian<float>(pOut, 4u, normalizeIntensity(*pIntensity));
+  }
+}
+
+void writeBinaryPoints(FileWriteBuffer&             buffer,
+                       const std::vector<PointXYZ>& points,
+                       const std::vector<uint32_t>& rgbaMap,
+                       const std::vector<uint16_t>& intensityMap,
+                       const PcdFields&             fields,
+                       InvalidPointPresentation     presentation)
+{
+  if (presentation == INVALID_AS_NAN && !fields.hasColors && !fields.hasIntensities && endian::native == endian::little)
+  {
+    // the points already have the layout of the data part
+    buffer.append(points.data(), points.size() * sizeof(PointXYZ));
+    return;
+  }
+
+  const std::size_t pointSize = fields.pointSize();
+  for (std::size_t i = 0u; i < points.size(); ++i)
+  {
+    if (presentation == INVALID_SKIP && !isValidPoint(points[i]))
+    {
+      continue;
+    }
+    encodeBinaryPoint(reinterpret_cast<std::uint8_t*>(buffer.reserve(pointSize)),
+                      points[i],
+                      fields.hasColors ? &rgbaMap[i] : nullptr,
+                      fields.hasIntensities ? &intensityMap[i] : nullptr,
+                      presentation);
+    buffer.commit(pointSize);
+  }
+}
+
+bool writeCompressedPoints(FileWriteBuffer&             buffer,
+                           const std::vector<PointXYZ>& points,
+                           const std::vector<uint32_t>& rgbaMap,
+                           const std::vector<uint16_t>& intensityMap,
+                           const PcdFields&             fields,
+                           std::size_t                  numPoints,
+                           InvalidPointPresentation     presentation)
+{
+  // LZF compresses one block with all values of each field one after another, which has to be assembled first
+  const std::size_t         uncompressedSize = numPoints * fields.pointSize();
+  std::vector<std::uint8_t> fieldData(uncompressedSize);
+
+  std::uint8_t* pX         = fieldData.data();
+  std::uint8_t* pY         = pX + numPoints * sizeof(float);
+  std::uint8_t* pZ         = pY + numPoints * sizeof(float);
+  std::uint8_t* pRgb       = pZ + numPoints * sizeof(float);
+  std::uint8_t* pIntensity = pRgb + (fields.hasColors ? numPoints * sizeof(std::uint32_t) : 0u);
+
+  std::size_t index = 0u;
+  for (std::size_t i = 0u; i < points.size(); ++i)
+  {
+    if (presentation == INVALID_SKIP && !isValidPoint(points[i]))
+    {
+      continue;
+    }
+    const PointXYZ    point = presentPoint(points[i], presentation);
+    const std::size_t pos   = index * sizeof(float);
+    writeUnalignLittleEndian<float>(pX + pos, 4u, point.x);
+    writeUnalignLittleEndian<float>(pY + pos, 4u, point.y);
+    writeUnalignLittleEndian<float>(pZ + pos, 4u, point.z);
+    if (fields.hasColors)
+    {
+      writeUnalignLittleEndian<std::uint32_t>(pRgb + pos, 4u, packRgb(rgbaMap[i]));
+    }
+    if (fields.hasIntensities)
+    {
+      writeUnalignLittleEndian<float>(pIntensity + pos, 4u, normalizeIntensity(intensityMap[i]));
+    }
+    ++index;
+  }
+
+  std::vector<std::uint8_t> compressed(8u + lzfMaxCompressedSize(uncompressedSize));
+  const std::size_t         compressedSize =
+    lzfCompress(fieldData.data(), uncompressedSize, compressed.data() + 8u, compressed.size() - 8u);
+  if (compressedSize == 0u && uncompressedSize > 0u)
+  {
+    return false;
+  }
+  writeUnalignLittleEndian<std::uint32_t>(compressed.data(), 4u, static_cast<std::uint32_t>(compressedSize));
+  writeUnalignLittleEndian<std::uint32_t>(compressed.data() + 4u, 4u, static_cast<std::uint32_t>(uncompressedSize));
+  buffer.append(compressed.data(), 8u + compressedSize);
+  return true;
+}
+
+} // namespace
+
+bool PointCloudPcdWriter::WriteFormatPCD(const char*                  filename,
+                                         const std::vector<PointXYZ>& points,
+                                         std::uint32_t                width,
+                                         std::uint32_t                height,
+                                         PcdEncoding::Enum            encoding,
+                                         InvalidPointPresentation     presentation)
+{
+  return WriteFormatPCD(
+    filename, points, std::vector<uint32_t>(), std::vector<uint16_t>(), width, height, encoding, presentation);
+}
+
+bool PointCloudPcdWriter::WriteFormatPCD(const char*                  filename,
+                                         const std::vector<PointXYZ>& points,
+                                         const std::vector<uint32_t>& rgbaMap,
+                                         const std::vector<uint16_t>& intensityMap,
+                                         std::uint32_t                width,
+                                         std::uint32_t                height,
+                                         PcdEncoding::Enum            encoding,
+                                         InvalidPointPresentation     presentation)
+{
+  if (static_cast<std::size_t>(width) * height != points.size())
+  {
+    return false;
+  }
+  const PcdFields fields{points.size() == rgbaMap.size(), points.size() == intensityMap.size()};
+
+  const std::ios_base::openmode mode =
+    (encoding == PcdEncoding::ASCII) ? std::ios_base::out : (std::ios_base::out | std::ios_base::binary);
+  std::ofstream stream(filename, mode);
+  if (!stream.is_open())
+  {
+    return false;
+  }
+
+  // without the invalid points the cloud is no longer organized
+  const std::size_t numPoints = (presentation == INVALID_SKIP) ? countValidPoints(points) : points.size();
+
+  FileWriteBuffer buffer(stream);
+  writeHeader(buffer,
+              fields,
+              (presentation == INVALID_SKIP) ? numPoints : width,
+              (presentation == INVALID_SKIP) ? 1u : height,
+              encoding);
+
+  bool success = true;
+  switch (encoding)
+  {
+    case PcdEncoding::ASCII:
+      writeAsciiPoints(buffer, points, rgbaMap, intensityMap, fields, presentation);
+      break;
+    case PcdEncoding::BINARY:
+      writeBinaryPoints(buffer, points, rgbaMap, intensityMap, fields, presentation);
+      break;
+    case PcdEncoding::BINARY_COMPRESSED:
+      success = writeCompressedPoints(buffer, points, rgbaMap, intensityMap, fields, numPoints, presentation);
+      break;
+  }
+  buffer.flush();
+
+  stream.close();
+
+  return success && !stream.fail();
+}
+
+PointCloudPcdWriter::PointCloudPcdWriter() = default;
+
+PointCloudPcdWriter::~PointCloudPcdWriter() = default;
+} // namespace visionary
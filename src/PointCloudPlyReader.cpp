@@ -0,0 +1,536 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "PointCloudPlyReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "MappedFile.h"
+#include "VisionaryEndian.h"
+
+namespace visionary {
+
+namespace {
+
+// ascii data parts are split into one range per thread, but not into ranges smaller than this
+constexpr std::size_t kMinAsciiRangeSize = 256u * 1024u;
+// longest number accepted in ascii data parts
+constexpr std::size_t kMaxTokenSize = 63u;
+
+namespace PlyFormat {
+enum Enum
+{
+  ASCII,
+  BINARY_LITTLE_ENDIAN,
+  BINARY_BIG_ENDIAN
+};
+}
+
+namespace PlyType {
+enum Enum
+{
+  INT8,
+  UINT8,
+  INT16,
+  UINT16,
+  INT32,
+  UINT32,
+  FLOAT32,
+  FLOAT64
+};
+}
+
+// vertex properties the reader assigns
+namespace Field {
+enum Enum
+{
+  X = 0,
+  Y,
+  Z,
+  RED,
+  GREEN,
+  BLUE,
+  ALPHA,
+  INTENSITY,
+  COUNT
+};
+}
+
+struct PlyProperty
+{
+  PlyType::Enum type;
+  // offset within a binary vertex
+  std::size_t offset;
+};
+
+struct PlyHeader
+{
+  PlyFormat::Enum          format;
+  std::size_t              numVertices;
+  std::vector<PlyProperty> properties;
+  // size of a binary vertex
+  std::size_t stride;
+  // index of the property of each field, -1 if the vertex element does not have it
+  int field[Field::COUNT];
+  // offset of the data part in the file
+  std::size_t dataOffset;
+};
+
+bool parseType(const std::string& name, PlyType::Enum& type, std::size_t& size)
+{
+  struct TypeName
+  {
+    const char*   name;
+    PlyType::Enum type;
+    std::size_t   size;
+  };
+  static const TypeName kTypeNames[] = {
+    {"char", PlyType::INT8, 1u},      {"int8", PlyType::INT8, 1u},       {"uchar", PlyType::UINT8, 1u},
+    {"uint8", PlyType::UINT8, 1u},    {"short", PlyType::INT16, 2u},     {"int16", PlyType::INT16, 2u},
+    {"ushort", PlyType::UINT16, 2u},  {"uint16", PlyType::UINT16, 2u},   {"int", PlyType::INT32, 4u},
+    {"int32", PlyType::INT32, 4u},    {"uint", PlyType::UINT32, 4u},     {"uint32", PlyType::UINT32, 4u},
+    {"float", PlyType::FLOAT32, 4u},  {"float32", PlyType::FLOAT32, 4u}, {"double", PlyType::FLOAT64, 8u},
+    {"float64", PlyType::FLOAT64, 8u}};
+  for (const TypeName& typeName : kTypeNames)
+  {
+    if (name == typeName.name)
+    {
+      type = typeName.type;
+      size = typeName.size;
+      return true;
+    }
+  }
+  return false;
+}
+
+int fieldOfProperty(const std::string& name)
+{
+  static const char* const kFieldNames[Field::COUNT] = {
+    "x", "y", "z", "red", "green", "blue", "alpha", "intensity"};
+  for (int field = 0; field < Field::COUNT; ++field)
+  {
+    if (name == kFieldNames[field])
+    {
+      return field;
+    }
+  }
+  return -1;
+}
+
+bool parseHeader(const std::uint8_t* pData, std::size_t size, PlyHeader& header)
+{
+  header.numVertices = 0u;
+  header.properties.clear();
+  header.stride = 0u;
+  std::fill_n(header.field, static_cast<std::size_t>(Field::COUNT), -1);
+
+  bool        hasFormat  = false;
+  bool        inVertex   = false;
+  bool        vertexSeen = false;
+  std::size_t lineStart  = 0u;
+  std::size_t lineNumber = 0u;
+  const char* pText      = reinterpret_cast<const char*>(pData);
+  while (lineStart < size)
+  {
+    const void* pNewline = std::memchr(pText + lineStart, '\n', size - lineStart);
+    if (pNewline == nullptr)
+    {
+      return false;
+    }
+    const std::size_t lineEnd = static_cast<std::size_t>(static_cast<const char*>(pNewline) - pText);
+    std::string       line(pText + lineStart, lineEnd - lineStart);
+    if (!line.empty() && (line.back() == '\r'))
+    {
+      line.pop_back();
+    }
+    lineStart = lineEnd + 1u;
+
+    std::istringstream tokens(line);
+    std::string        keyword;
+    tokens >> keyword;
+    if (lineNumber++ == 0u)
+    {
+      if (keyword != "ply")
+      {
+        return false;
+      }
+    }
+    else if (keyword == "format")
+    {
+      std::string format;
+      tokens >> format;
+      if (format == "ascii")
+        header.format = PlyFormat::ASCII;
+      else if (format == "binary_little_endian")
+        header.format = PlyFormat::BINARY_LITTLE_ENDIAN;
+      else if (format == "binary_big_endian")
+        header.format = PlyFormat::BINARY_BIG_ENDIAN;
+      else
+        return false;
+      hasFormat = true;
+    }
+    else if (keyword == "element")
+    {
+      std::string   name;
+      unsigned long count = 0u;
+      if (!(tokens >> name >> count))
+      {
+        return false;
+      }
+      // the data of elements in front of the vertices would have to be skipped
+      inVertex = (name == "vertex");
+      if (!inVertex && !vertexSeen)
+      {
+        return false;
+      }
+      if (inVertex)
+      {
+        if (vertexSeen)
+        {
+          return false;
+        }
+        vertexSeen         = true;
+        header.numVertices = static_cast<std::size_t>(count);
+      }
+    }
+    else if (keyword == "property")
+    {
+      if (!inVertex)
+      {
+        continue;
+      }
+      std::string typeName;
+      std::string name;
+      if (!(tokens >> typeName >> name))
+      {
+        return false;
+      }
+      PlyProperty property;
+      std::size_t propertySize = 0u;
+      // list properties are not supported in vertices
+      if (!parseType(typeName, property.type, propertySize))
+      {
+        return false;
+      }
+      property.offset = header.stride;
+      header.stride += propertySize;
+
+      const int field = fieldOfProperty(name);
+      if ((field >= 0) && (header.field[field] < 0))
+      {
+        header.field[field] = static_cast<int>(header.properties.size());
+      }
+      header.properties.push_back(property);
+    }
+    else if (keyword == "end_header")
+    {
+      header.dataOffset = lineStart;
+      return hasFormat && vertexSeen && (header.field[Field::X] >= 0) && (header.field[Field::Y] >= 0)
+             && (header.field[Field::Z] >= 0);
+    }
+    else if ((keyword != "comment") && (keyword != "obj_info") && !keyword.empty())
+    {
+      return false;
+    }
+  }
+  return false;
+}
+
+template <typename T>
+double readBinaryValue(const std::uint8_t* pValue, bool bigEndian)
+{
+  return static_cast<double>(bigEndian ? readUnalignBigEndian<T>(pValue) : readUnalignLittleEndian<T>(pValue));
+}
+
+double readBinaryValue(const std::uint8_t* pValue, PlyType::Enum type, bool bigEndian)
+{
+  switch (type)
+  {
+    case PlyType::INT8:
+      return readBinaryValue<std::int8_t>(pValue, bigEndian);
+    case PlyType::UINT8:
+      return readBinaryValue<std::uint8_t>(pValue, bigEndian);
+    case PlyType::INT16:
+      return readBinaryValue<std::int16_t>(pValue, bigEndian);
+    case PlyType::UINT16:
+      return readBinaryValue<std::uint16_t>(pValue, bigEndian);
+    case PlyType::INT32:
+      return readBinaryValue<std::int32_t>(pValue, bigEndian);
+    case PlyType::UINT32:
+      return readBinaryValue<std::uint32_t>(pValue, bigEndian);
+    case PlyType::FLOAT32:
+      return readBinaryValue<float>(pValue, bigEndian);
+    case PlyType::FLOAT64:
+    default:
+      return readBinaryValue<double>(pValue, bigEndian);
+  }
+}
+
+// Parses the next whitespace separated number of an ascii line.
+bool parseAsciiValue(const char*& pCursor, const char* pLineEnd, PlyType::Enum type, double& value)
+{
+  while ((pCursor < pLineEnd) && ((*pCursor == ' ') || (*pCursor == '\t') || (*pCursor == '\r')))
+  {
+    ++pCursor;
+  }
+  const char* pTokenStart = pCursor;
+  while ((pCursor < pLineEnd) && (*pCursor != ' ') && (*pCursor != '\t') && (*pCursor != '\r'))
+  {
+    ++pCursor;
+  }
+  const std::size_t tokenSize = static_cast<std::size_t>(pCursor - pTokenStart);
+  if ((tokenSize == 0u) || (tokenSize > kMaxTokenSize))
+  {
+    return false;
+  }
+
+  // the mapped file is not null terminated
+  char token[kMaxTokenSize + 1u];
+  std::memcpy(token, pTokenStart, tokenSize);
+  token[tokenSize] = '\0';
+
+  char* pEnd = nullptr;
+  // floats are parsed as float, a detour over double could round differently
+  value = (type == PlyType::FLOAT32) ? static_cast<double>(std::strtof(token, &pEnd)) : std::strtod(token, &pEnd);
+  return pEnd == token + tokenSize;
+}
+
+struct VertexOutput
+{
+  PointXYZ*      pPoints;
+  std::uint32_t* pRgba;
+  std::uint16_t* pIntensity;
+  bool           floatIntensity;
+};
+
+std::uint8_t toColorComponent(double value)
+{
+  return static_cast<std::uint8_t>(std::min(255.0, std::max(0.0, std::round(value))));
+}
+
+// Stores the property values of a vertex.
+void assignVertex(const PlyHeader& header, const double* pValues, std::size_t index, const VertexOutput& output)
+{
+  PointXYZ& point = output.pPoints[index];
+  point.x         = static_cast<float>(pValues[header.field[Field::X]]);
+  point.y         = static_cast<float>(pValues[header.field[Field::Y]]);
+  point.z         = static_cast<float>(pValues[header.field[Field::Z]]);
+  if (output.pRgba != nullptr)
+  {
+    // same byte order in memory as written by PointCloudPlyWriter
+    const std::uint8_t rgba[4] = {
+      toColorComponent(pValues[header.field[Field::RED]]),
+      toColorComponent(pValues[header.field[Field::GREEN]]),
+      toColorComponent(pValues[header.field[Field::BLUE]]),
+      (header.field[Field::ALPHA] >= 0) ? toColorComponent(pValues[header.field[Field::ALPHA]]) : std::uint8_t(255u)};
+    std::memcpy(&output.pRgba[index], rgba, sizeof(rgba));
+  }
+  if (output.pIntensity != nullptr)
+  {
+    const double intensity = pValues[header.field[Field::INTENSITY]] * (output.floatIntensity ? 65535.0 : 1.0);
+    output.pIntensity[index] = static_cast<std::uint16_t>(std::min(65535.0, std::max(0.0, std::round(intensity))));
+  }
+}
+
+void readBinaryVertices(const std::uint8_t* pData, const PlyHeader& header, const VertexOutput& output)
+{
+  const bool          bigEndian = header.format == PlyFormat::BINARY_BIG_ENDIAN;
+  std::vector<double> values(header.properties.size());
+  for (std::size_t index = 0u; index < header.numVertices; ++index)
+  {
+    const std::uint8_t* pVertex = pData + index * header.stride;
+    for (std::size_t property = 0u; property < header.properties.size(); ++property)
+    {
+      values[property] =
+        readBinaryValue(pVertex + header.properties[property].offset, header.properties[property].type, bigEndian);
+    }
+    assignVertex(header, values.data(), index, output);
+  }
+}
+
+// Parses the ascii vertices in [pBegin, pEnd), starting with vertex number firstIndex.
+bool readAsciiVertices(const char*         pBegin,
+                       const char*         pEnd,
+                       std::size_t         firstIndex,
+                       const PlyHeader&    header,
+                       const VertexOutput& output)
+{
+  std::vector<double> values(header.properties.size());
+  std::size_t         index = firstIndex;
+  const char*         pLine = pBegin;
+  while ((pLine < pEnd) && (index < header.numVertices))
+  {
+    const void* pNewline = std::memchr(pLine, '\n', static_cast<std::size_t>(pEnd - pLine));
+    const char* pLineEnd = (pNewline != nullptr) ? static_cast<const char*>(pNewline) : pEnd;
+    const char* pCursor  = pLine;
+    for (std::size_t property = 0u; property < header.properties.size(); ++property)
+    {
+      if (!parseAsciiValue(pCursor, pLineEnd, header.properties[property].type, values[property]))
+      {
+        return false;
+      }
+    }
+    assignVertex(header, values.data(), index, output);
+    ++index;
+    pLine = pLineEnd + 1;
+  }
+  return true;
+}
+
+// Runs func(0) ... func(numTasks - 1) on one thread each, the first one on the calling thread.
+template <typename Func>
+void runParallel(std::size_t numTasks, const Func& func)
+{
+  std::vector<std::thread> threads;
+  for (std::size_t task = 1u; task < numTasks; ++task)
+  {
+    threads.emplace_back(func, task);
+  }
+  func(0u);
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+bool readAsciiData(const char* pBegin, const char* pEnd, const PlyHeader& header, const VertexOutput& output)
+{
+  const std::size_t dataSize   = static_cast<std::size_t>(pEnd - pBegin);
+  const std::size_t numThreads = std::max<std::size_t>(
+    1u, std::min<std::size_t>(std::thread::hardware_concurrency(), dataSize / kMinAsciiRangeSize + 1u));
+
+  // split the data at line starts
+  std::vector<const char*> bounds(numThreads + 1u, pEnd);
+  bounds[0] = pBegin;
+  for (std::size_t range = 1u; range < numThreads; ++range)
+  {
+    const char* pSplit   = std::max(bounds[range - 1u], pBegin + range * (dataSize / numThreads));
+    const void* pNewline = std::memchr(pSplit, '\n', static_cast<std::size_t>(pEnd - pSplit));
+    bounds[range]        = (pNewline != nullptr) ? static_cast<const char*>(pNewline) + 1 : pEnd;
+  }
+
+  // the number of lines in front of each range gives the number of its first vertex
+  std::vector<std::size_t> numLines(numThreads, 0u);
+  runParallel(numThreads, [&](std::size_t range) {
+    numLines[range] = static_cast<std::size_t>(std::count(bounds[range], bounds[range + 1u], '\n'));
+  });
+  if ((pBegin != pEnd) && (pEnd[-1] != '\n'))
+  {
+    ++numLines.back(); // last line without line break
+  }
+  std::vector<std::size_t> firstIndex(numThreads, 0u);
+  for (std::size_t range = 1u; range < numThreads; ++range)
+  {
+    firstIndex[range] = firstIndex[range - 1u] + numLines[range - 1u];
+  }
+  if (firstIndex.back() + numLines.back() < header.numVertices)
+  {
+    return false;
+  }
+
+  std::vector<char> success(numThreads, 0);
+  runParallel(numThreads, [&](std::size_t range) {
+    success[range] = readAsciiVertices(bounds[range], bounds[range + 1u], firstIndex[range], header, output) ? 1 : 0;
+  });
+  return std::all_of(success.begin(), success.end(), [](char rangeSuccess) { return rangeSuccess != 0; });
+}
+
+bool readPly(const char*                 filename,
+             std::vector<PointXYZ>&      points,
+             std::vector<std::uint32_t>* pRgbaMap,
+             std::vector<std::uint16_t>* pIntensityMap)
+{
+  MappedFile file;
+  PlyHeader  header;
+  if (!file.open(filename) || !parseHeader(file.data(), file.size(), header))
+  {
+    return false;
+  }
+
+  // a binary vertex takes its stride, an ascii vertex at least a digit and a separator for each property
+  const std::size_t dataSize = file.size() - header.dataOffset;
+  const std::size_t maxVertices =
+    (header.format == PlyFormat::ASCII) ? (dataSize + 1u) / (2u * header.properties.size()) : dataSize / header.stride;
+  if (header.numVertices > maxVertices)
+  {
+    return false;
+  }
+
+  const bool hasColors = (header.field[Field::RED] >= 0) && (header.field[Field::GREEN] >= 0)
+                         && (header.field[Field::BLUE] >= 0);
+  const bool hasIntensities = header.field[Field::INTENSITY] >= 0;
+
+  points.resize(header.numVertices);
+  VertexOutput output{points.data(), nullptr, nullptr, false};
+  if (pRgbaMap != nullptr)
+  {
+    pRgbaMap->resize(hasColors ? header.numVertices : 0u);
+    output.pRgba = hasColors ? pRgbaMap->data() : nullptr;
+  }
+  if (pIntensityMap != nullptr)
+  {
+    pIntensityMap->resize(hasIntensities ? header.numVertices : 0u);
+    output.pIntensity = hasIntensities ? pIntensityMap->data() : nullptr;
+    if (hasIntensities)
+    {
+      const PlyType::Enum type = header.properties[static_cast<std::size_t>(header.field[Field::INTENSITY])].type;
+      output.floatIntensity    = (type == PlyType::FLOAT32) || (type == PlyType::FLOAT64);
+    }
+  }
+
+  const std::uint8_t* pDataPart = file.data() + header.dataOffset;
+  if (header.format == PlyFormat::ASCII)
+  {
+    const char* pText = reinterpret_cast<const char*>(pDataPart);
+    return readAsciiData(pText, pText + dataSize, header, output);
+  }
+
+  const bool nativeFloatXYZ =
+    (header.properties.size() == 3u) && (header.field[Field::X] == 0) && (header.field[Field::Y] == 1)
+    && (header.field[Field::Z] == 2)
+    && std::all_of(header.properties.begin(),
+                   header.properties.end(),
+                   [](const PlyProperty& property) { return property.type == PlyType::FLOAT32; })
+    && ((header.format == PlyFormat::BINARY_LITTLE_ENDIAN) == (endian::native == endian::little));
+  if (nativeFloatXYZ)
+  {
+    // the vertices already have the layout of the points
+    static_assert(sizeof(PointXYZ) == 3u * sizeof(float), "PointXYZ must not contain padding");
+    if (!points.empty())
+    {
+      std::memcpy(points.data(), pDataPart, points.size() * sizeof(PointXYZ));
+    }
+    return true;
+  }
+  readBinaryVertices(pDataPart, header, output);
+  return true;
+}
+
+} // namespace
+
+bool PointCloudPlyReader::ReadFormatPLY(const char* filename, std::vector<PointXYZ>& points)
+{
+  return readPly(filename, points, nullptr, nullptr);
+}
+
+bool PointCloudPlyReader::ReadFormatPLY(const char*                 filename,
+                                        std::vector<PointXYZ>&      points,
+                                        std::vector<std::uint32_t>& rgbaMap,
+                                        std::vector<std::uint16_t>& intensityMap)
+{
+  return readPly(filename, points, &rgbaMap, &intensityMap);
+}
+
+PointCloudPlyReader::PointCloudPlyReader() = default;
+
+PointCloudPlyReader::~PointCloudPlyReader() = default;
+
+} // namespace visionary
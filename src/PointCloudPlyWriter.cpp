@@ -5,13 +5,219 @@
 
 #include "PointCloudPlyWriter.h"
 
+#include "FloatFormat.h"
+#include "PointCloudWriterUtils.h"
 #include "VisionaryEndian.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
-#include <sstream>
+#include <memory>
+#include <thread>
 
 namespace visionary {
 
+namespace {
+
+// upper limit of an ASCII vertex line: four floats, three color components and the separators
+constexpr std::size_t kMaxVertexSize = 4u * (kMaxFloatChars + 1u) + 3u * 4u;
+// ASCII vertices are formatted in parallel in chunks of this number of points
+constexpr std::size_t kAsciiChunkSize = 16384u;
+
+void writeHeader(FileWriteBuffer& buffer, std::size_t numVertices, bool hasColors, bool hasIntensities, bool useBinary)
+{
+  char elementLine[64];
+  std::snprintf(elementLine, sizeof(elementLine), "element vertex %lu\n", static_cast<unsigned long>(numVertices));
+
+  buffer.append("ply\n");
+  buffer.append(useBinary ? "format binary_little_endian 1.0\n" : "format ascii 1.0\n");
+  buffer.append(elementLine);
+  buffer.append("property float x\n");
+  buffer.append("property float y\n");
+  buffer.append("property float z\n");
+  if (hasColors)
+  {
+    buffer.append("property uchar red\n");
+    buffer.append("property uchar green\n");
+    buffer.append("property uchar blue\n");
+  }
+  if (hasIntensities)
+  {
+    buffer.append("property float intensity\n");
+  }
+  buffer.append("end_header\n");
+}
+
+inline std::size_t formatColorComponent(char* pOut, uint8_t value)
+{
+  std::size_t size = 0u;
+  if (value >= 100u)
+  {
+    pOut[size++] = static_cast<char>('0' + value / 100u);
+  }
+  if (value >= 10u)
+  {
+    pOut[size++] = static_cast<char>('0' + (value / 10u) % 10u);
+  }
+  pOut[size++] = static_cast<char>('0' + value % 10u);
+  return size;
+}
+
+// formats one vertex line into pOut, which must have room for kMaxVertexSize characters
+std::size_t formatAsciiVertex(char*                    pOut,
+                              const PointXYZ&          point,
+                              const uint32_t*          pRgba,
+                              const uint16_t*          pIntensity,
+                              InvalidPointPresentation presentation)
+{
+  std::size_t size = 0u;
+
+  const float xyz[3] = {point.x, point.y, point.z};
+  for (std::size_t i = 0u; i < 3u; ++i)
+  {
+    if (i > 0u)
+    {
+      pOut[size++] = ' ';
+    }
+    if (presentation == INVALID_AS_ZERO && std::isnan(xyz[i]))
+    {
+      std::memcpy(pOut + size, "0.0", 3u);
+      size += 3u;
+    }
+    else
+    {
+      size += formatShortest(pOut + size, xyz[i]);
+    }
+  }
+  if (pRgba != nullptr)
+  {
+    const auto rgba = reinterpret_cast<const uint8_t*>(pRgba);
+    for (std::size_t i = 0u; i < 3u; ++i)
+    {
+      pOut[size++] = ' ';
+      size += formatColorComponent(pOut + size, rgba[i]);
+    }
+  }
+  if (pIntensity != nullptr)
+  {
+    pOut[size++] = ' ';
+    size += formatShortest(pOut + size, static_cast<float>(*pIntensity) / 65535.0f);
+  }
+  pOut[size++] = '\n';
+  return size;
+}
+
+/// Formats the ASCII vertices of a range of points.
+struct AsciiChunk
+{
+  std::unique_ptr<char[]> data{new char[kAsciiChunkSize * kMaxVertexSize]};
+  std::size_t             size = 0u;
+
+  void format(const std::vector<PointXYZ>& points,
+              const std::vector<uint32_t>& rgbaMap,
+              const std::vector<uint16_t>& intensityMap,
+              std::size_t                  begin,
+              std::size_t                  end,
+              bool                         hasColors,
+              bool                         hasIntensities,
+              InvalidPointPresentation     presentation)
+  {
+    size = 0u;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      if (presentation == INVALID_SKIP && !isValidPoint(points[i]))
+      {
+        continue;
+      }
+      size += formatAsciiVertex(data.get() + size,
+                                points[i],
+                                hasColors ? &rgbaMap[i] : nullptr,
+                                hasIntensities ? &intensityMap[i] : nullptr,
+                                presentation);
+    }
+  }
+};
+
+void writeAsciiVertices(FileWriteBuffer&             buffer,
+                        const std::vector<PointXYZ>& points,
+                        const std::vector<uint32_t>& rgbaMap,
+                        const std::vector<uint16_t>& intensityMap,
+                        bool                         hasColors,
+                        bool                         hasIntensities,
+                        InvalidPointPresentation     presentation)
+{
+  const std::size_t numChunks  = (points.size() + kAsciiChunkSize - 1u) / kAsciiChunkSize;
+  const std::size_t numThreads =
+    std::max<std::size_t>(1u, std::min<std::size_t>(std::thread::hardware_concurrency(), numChunks));
+
+  // each round formats one chunk per thread, the chunks are written in order after the round
+  std::vector<AsciiChunk> chunks(numThreads);
+  for (std::size_t firstChunk = 0u; firstChunk < numChunks; firstChunk += numThreads)
+  {
+    const std::size_t numRoundChunks = std::min(numThreads, numChunks - firstChunk);
+
+    const auto formatChunk = [&](std::size_t index) {
+      const std::size_t begin = (firstChunk + index) * kAsciiChunkSize;
+      const std::size_t end   = std::min(points.size(), begin + kAsciiChunkSize);
+      chunks[index].format(points, rgbaMap, intensityMap, begin, end, hasColors, hasIntensities, presentation);
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t index = 1u; index < numRoundChunks; ++index)
+    {
+      threads.emplace_back(formatChunk, index);
+    }
+    formatChunk(0u);
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    for (std::size_t index = 0u; index < numRoundChunks; ++index)
+    {
+      buffer.append(chunks[index].data.get(), chunks[index].size);
+    }
+  }
+}
+
+void writeBinaryVertex(FileWriteBuffer&         buffer,
+                       PointXYZ                 point,
+                       const uint32_t*          pRgba,
+                       const uint16_t*          pIntensity,
+                       InvalidPointPresentation presentation)
+{
+  if (presentation == INVALID_AS_ZERO)
+  {
+    if (std::isnan(point.x))
+      point.x = 0.0f;
+    if (std::isnan(point.y))
+      point.y = 0.0f;
+    if (std::isnan(point.z))
+      point.z = 0.0f;
+  }
+
+  char* pOut = buffer.reserve(3u * 4u + 3u + 4u);
+  writeUnalignLittleEndian<float>(pOut, 4u, point.x);
+  writeUnalignLittleEndian<float>(pOut + 4u, 4u, point.y);
+  writeUnalignLittleEndian<float>(pOut + 8u, 4u, point.z);
+  std::size_t size = 12u;
+
+  if (pRgba != nullptr)
+  {
+    std::memcpy(pOut + size, pRgba, 3u);
+    size += 3u;
+  }
+  if (pIntensity != nullptr)
+  {
+    writeUnalignLittleEndian<float>(pOut + size, 4u, static_cast<float>(*pIntensity) / 65535.0f);
+    size += 4u;
+  }
+  buffer.commit(size);
+}
+
+} // namespace
+
 bool PointCloudPlyWriter::WriteFormatPLY(const char*                  filename,
                                          const std::vector<PointXYZ>& points,
                                          bool                         useBinary,
@@ -45,216 +251,52 @@ bool PointCloudPlyWriter::WriteFormatPLY(const char*                  filename,
                                          bool                         useBinary,
                                          InvalidPointPresentation     presentation)
 {
-  bool success = true;
+  const bool hasColors      = points.size() == rgbaMap.size();
+  const bool hasIntensities = points.size() == intensityMap.size();
 
-  bool hasColors      = points.size() == rgbaMap.size();
-  bool hasIntensities = points.size() == intensityMap.size();
+  std::ofstream stream(filename, useBinary ? (std::ios_base::out | std::ios_base::binary) : std::ios_base::out);
+  if (!stream.is_open())
+  {
+    return false;
+  }
 
-  std::ofstream stream; // output file stream for PLY file
-  std::stringstream
-    strstream; // temporary data buffer stream
-               // Reason: On presentation mode INVALID_SKIP we only know the number of "element vertex ?"
-               //         in the header of the PLY file after iterating through the "vector<PointXYZ>& points"
-               //         and checking if it has the value NaN. The header has to be printed before and
-               //         therefore the data part has to be temprorarily buffered.
+  // On presentation mode INVALID_SKIP the number of vertices in the header is only known after checking all points
+  // for NaN. Counting them in a separate pass allows to stream the data part directly to the file.
+  const std::size_t numVertices = (presentation == INVALID_SKIP) ? countValidPoints(points) : points.size();
 
-  int numberOfValidPoints = 0;
-  if (useBinary == false)
-  {
-    // Write all points
-    for (size_t i = 0; i < points.size(); i++)
-    {
-      PointXYZ point = points.at(i);
+  FileWriteBuffer buffer(stream);
+  writeHeader(buffer, numVertices, hasColors, hasIntensities, useBinary);
 
-      // Handle PLY file presentation of X Y Z values (nan, 0.0 or SKIP)
-      if (presentation == INVALID_AS_NAN)
-      {
-        strstream << point.x << " " << point.y << " " << point.z;
-      }
-      if (presentation == INVALID_AS_ZERO)
-      {
-        if (std::isnan(point.x))
-          strstream << "0.0";
-        else
-          strstream << point.x;
-        strstream << " ";
-
-        if (std::isnan(point.y))
-          strstream << "0.0";
-        else
-          strstream << point.y;
-        strstream << " ";
-
-        if (std::isnan(point.z))
-          strstream << "0.0";
-        else
-          strstream << point.z;
-      }
-      if (presentation == INVALID_AS_NAN || presentation == INVALID_AS_ZERO)
-      {
-        if (hasColors)
-        {
-          const auto rgba = reinterpret_cast<const uint8_t*>(&rgbaMap.at(i));
-          strstream << " " << static_cast<uint32_t>(rgba[0]) << " " << static_cast<uint32_t>(rgba[1]) << " "
-                    << static_cast<uint32_t>(rgba[2]);
-        }
-        if (hasIntensities)
-        {
-          float intensity = static_cast<float>(intensityMap.at(i)) / 65535.0f;
-          strstream << " " << intensity;
-        }
-        strstream << "\n";
-      }
-      if (presentation == INVALID_SKIP)
-      {
-        // The X and Y values are calculated using the Z/distance value which is received by the device.
-        // So X and Y should only be NaN if Z/distance is NaN.
-        if (std::isnan(point.z))
-        {
-          continue;
-        }
-        else
-        {
-          strstream << point.x << " " << point.y << " " << point.z;
-
-          if (hasColors)
-          {
-            const auto rgba = reinterpret_cast<const uint8_t*>(&rgbaMap.at(i));
-            strstream << " " << static_cast<uint32_t>(rgba[0]) << " " << static_cast<uint32_t>(rgba[1]) << " "
-                      << static_cast<uint32_t>(rgba[2]);
-          }
-          if (hasIntensities)
-          {
-            float intensity = static_cast<float>(intensityMap.at(i)) / 65535.0f;
-            strstream << " " << intensity;
-          }
-          strstream << "\n";
-
-          numberOfValidPoints++;
-        }
-      }
-    }
+  if (useBinary && presentation == INVALID_AS_NAN && !hasColors && !hasIntensities && endian::native == endian::little)
+  {
+    // the points already have the layout of the vertices
+    static_assert(sizeof(PointXYZ) == 3u * sizeof(float), "PointXYZ must not contain padding");
+    buffer.append(points.data(), points.size() * sizeof(PointXYZ));
   }
-  else
+  else if (useBinary)
   {
-    // Write all points
-    for (size_t i = 0; i < points.size(); i++)
+    for (std::size_t i = 0u; i < points.size(); ++i)
     {
-      PointXYZ point = points.at(i);
-
-      // Handle PLY file presentation of X Y Z values (nan, 0.0 or SKIP)
-      if (presentation == INVALID_AS_NAN)
-      {
-        // Nothing to do, use values as they are available
-      }
-      if (presentation == INVALID_AS_ZERO)
+      if (presentation == INVALID_SKIP && !isValidPoint(points[i]))
       {
-        if (std::isnan(point.x))
-          point.x = 0.0f;
-        if (std::isnan(point.y))
-          point.y = 0.0f;
-        if (std::isnan(point.z))
-          point.z = 0.0f;
-      }
-      if (presentation == INVALID_AS_NAN || presentation == INVALID_AS_ZERO)
-      {
-        float x = nativeToLittleEndian(point.x);
-        float y = nativeToLittleEndian(point.y);
-        float z = nativeToLittleEndian(point.z);
-
-        strstream.write(reinterpret_cast<char*>(&x), 4);
-        strstream.write(reinterpret_cast<char*>(&y), 4);
-        strstream.write(reinterpret_cast<char*>(&z), 4);
-
-        if (hasColors)
-        {
-          strstream.write(reinterpret_cast<const char*>(&rgbaMap.at(i)), 3);
-        }
-        if (hasIntensities)
-        {
-          float intensity = static_cast<float>(intensityMap.at(i)) / 65535.0f;
-          strstream.write(reinterpret_cast<const char*>(&intensity), 4);
-        }
-      }
-      if (presentation == INVALID_SKIP)
-      {
-        // The X and Y values are calculated using the Z/distance value which is received by the device.
-        // So X and Y should only be NaN if Z/distance is NaN.
-        if (std::isnan(point.z))
-        {
-          continue;
-        }
-        else
-        {
-          float x = nativeToLittleEndian(point.x);
-          float y = nativeToLittleEndian(point.y);
-          float z = nativeToLittleEndian(point.z);
-
-          strstream.write(reinterpret_cast<char*>(&x), 4);
-          strstream.write(reinterpret_cast<char*>(&y), 4);
-          strstream.write(reinterpret_cast<char*>(&z), 4);
-
-          if (hasColors)
-          {
-            strstream.write(reinterpret_cast<const char*>(&rgbaMap.at(i)), 3);
-          }
-          if (hasIntensities)
-          {
-            float intensity = static_cast<float>(intensityMap.at(i)) / 65535.0f;
-            strstream.write(reinterpret_cast<const char*>(&intensity), 4);
-          }
-
-          numberOfValidPoints++;
-        }
+        continue;
       }
+      writeBinaryVertex(buffer,
+                        points[i],
+                        hasColors ? &rgbaMap[i] : nullptr,
+                        hasIntensities ? &intensityMap[i] : nullptr,
+                        presentation);
     }
   }
-
-  // Open file
-  stream.open(filename, useBinary ? (std::ios_base::out | std::ios_base::binary) : std::ios_base::out);
-
-  if (stream.is_open())
-  {
-    // Write header
-    stream << "ply\n";
-    stream << "format " << (useBinary ? "binary_little_endian" : "ascii") << " 1.0\n";
-
-    if (presentation == INVALID_SKIP)
-    {
-      stream << "element vertex " << numberOfValidPoints << "\n";
-    }
-    else
-    {
-      stream << "element vertex " << points.size() << "\n";
-    }
-
-    stream << "property float x\n";
-    stream << "property float y\n";
-    stream << "property float z\n";
-    if (hasColors)
-    {
-      stream << "property uchar red\n";
-      stream << "property uchar green\n";
-      stream << "property uchar blue\n";
-    }
-    if (hasIntensities)
-    {
-      stream << "property float intensity\n";
-    }
-    stream << "end_header\n";
-  }
   else
   {
-    success = false;
+    writeAsciiVertices(buffer, points, rgbaMap, intensityMap, hasColors, hasIntensities, presentation);
   }
+  buffer.flush();
 
-  // Add the temporarily buffered data part to the ofstream
-  stream << strstream.rdbuf();
-
-  // Close file
   stream.close();
 
-  return success;
+  return !stream.fail();
 }
 
 PointCloudPlyWriter::PointCloudPlyWriter() = default;
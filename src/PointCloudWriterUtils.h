@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <cstddef> // for size_t
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "PointXYZ.h"
+
+// Helpers shared by the point cloud file writers.
+
+namespace visionary {
+
+// the point cloud writers write their files in chunks of this size, independent of the size of the point cloud
+constexpr std::size_t kFileWriteBufferSize = 1024u * 1024u;
+
+/// Collects the output in a fixed size buffer and writes it to the file in large chunks.
+class FileWriteBuffer
+{
+public:
+  explicit FileWriteBuffer(std::ofstream& stream) : m_stream(stream), m_buffer(kFileWriteBufferSize), m_used(0u)
+  {
+  }
+
+  /// Returns room for at least \a numBytes bytes, to be committed by commit().
+  char* reserve(std::size_t numBytes)
+  {
+    if (m_used + numBytes > m_buffer.size())
+    {
+      flush();
+    }
+    return m_buffer.data() + m_used;
+  }
+
+  void commit(std::size_t numBytes)
+  {
+    m_used += numBytes;
+  }
+
+  void append(const void* pData, std::size_t numBytes)
+  {
+    if (numBytes > m_buffer.size())
+    {
+      // large blocks bypass the buffer
+      flush();
+      m_stream.write(static_cast<const char*>(pData), static_cast<std::streamsize>(numBytes));
+      return;
+    }
+    std::memcpy(reserve(numBytes), pData, numBytes);
+    commit(numBytes);
+  }
+
+  void append(const char* pString)
+  {
+    append(pString, std::strlen(pString));
+  }
+
+  void flush()
+  {
+    if (m_used > 0u)
+    {
+      m_stream.write(m_buffer.data(), static_cast<std::streamsize>(m_used));
+      m_used = 0u;
+    }
+  }
+
+private:
+  std::ofstream&    m_stream;
+  std::vector<char> m_buffer;
+  std::size_t       m_used;
+};
+
+// The X and Y values are calculated using the Z/distance value which is received by the device.
+// So X and Y should only be NaN if Z/distance is NaN.
+inline bool isValidPoint(const PointXYZ& point)
+{
+  return point.z == point.z;
+}
+
+inline std::size_t countValidPoints(const std::vector<PointXYZ>& points)
+{
+  // branch free, so the compiler can vectorize the loop
+  std::size_t numValid = 0u;
+  for (const auto& point : points)
+  {
+    numValid += isValidPoint(point) ? 1u : 0u;
+  }
+  return numValid;
+}
+
+} // namespace visionary
@@ -0,0 +1,28 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "ReconnectPolicy.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace visionary {
+
+std::chrono::milliseconds ReconnectPolicy::getBackoff(unsigned attempt, double random01) const
+{
+  if (attempt == 0u)
+  {
+    return std::chrono::milliseconds(0);
+  }
+  const double maxMs   = static_cast<double>(maxBackoff.count());
+  const double delayMs = std::min(maxMs,
+                                  static_cast<double>(initialBackoff.count())
+                                    * std::pow(std::max(1.0, backoffMultiplier), static_cast<double>(attempt - 1u)));
+  const double jitterMs = delayMs * jitter * (2.0 * random01 - 1.0);
+
+  return std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(std::max(0.0, delayMs + jitterMs)));
+}
+
+} // namespace visionary
@@ -0,0 +1,833 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "SequenceFile.h"
+
+#include <cstring>
+
+#include "DepthMapCodec.h"
+#include "MappedFile.h"
+#include "VisionaryEndian.h"
+#include "VisionarySData.h"
+#include "VisionaryTMiniData.h"
+
+namespace visionary {
+
+namespace {
+
+// All values are little endian.
+//
+// file header (kFileHeaderSize bytes):
+//   magic "VSEQ", u16 format version, u16 device type, u8 compression, 3 reserved bytes, f32 scaleZ,
+//   i32 width, i32 height, 16 f64 cam2world matrix, f64 fx, fy, cx, cy, k1, k2, p1, p2, k3, f2rc,
+//   u64 index offset (0 while recording), u64 frame count
+// frame record:
+//   magic "VFRM", u32 record size (including this header), u32 frame number, u16 data set version, u8 data quality,
+//   u8 device status, u64 timestamp (device format), u64 timestamp in ms, u8 map count, 7 reserved bytes,
+//   followed by the maps: u8 map id, u8 compression, 2 reserved bytes, u32 payload size, payload
+// index entry (kIndexEntrySize bytes):
+//   u64 record offset, u32 record size, u32 frame number, u64 timestamp, u64 timestamp in ms, u16 data set version,
+//   u8 data quality, u8 device status, 4 reserved bytes
+constexpr char          kFileMagic[4]          = {'V', 'S', 'E', 'Q'};
+constexpr char          kRecordMagic[4]        = {'V', 'F', 'R', 'M'};
+constexpr std::uint16_t kFormatVersion         = 1u;
+constexpr std::size_t   kFileHeaderSize        = 248u;
+constexpr std::size_t   kIndexOffsetPosition   = 232u;
+constexpr std::size_t   kRecordHeaderSize      = 40u;
+constexpr std::size_t   kIndexEntrySize        = 40u;
+constexpr std::size_t   kNumCameraMatrixValues = 16u;
+
+namespace MapId {
+enum Enum : std::uint8_t
+{
+  DEPTH = 1u,
+  INTENSITY,
+  STATE,
+  RGBA
+};
+}
+
+// Appends little endian values to a byte vector.
+class ByteWriter
+{
+public:
+  explicit ByteWriter(std::vector<std::uint8_t>& buffer) : m_buffer(buffer)
+  {
+  }
+
+  template <typename T>
+  void put(T value)
+  {
+    const std::size_t position = m_buffer.size();
+    m_buffer.resize(position + sizeof(T));
+    writeUnalignLittleEndian<T>(m_buffer.data() + position, sizeof(T), value);
+  }
+
+  void putBytes(const void* pData, std::size_t size)
+  {
+    const std::uint8_t* pBytes = static_cast<const std::uint8_t*>(pData);
+    m_buffer.insert(m_buffer.end(), pBytes, pBytes + size);
+  }
+
+  void putZeros(std::size_t size)
+  {
+    m_buffer.resize(m_buffer.size() + size, 0u);
+  }
+
+private:
+  std::vector<std::uint8_t>& m_buffer;
+};
+
+// Reads little endian values from a bounded range; reading past the end sets the failed flag and returns zeros.
+class ByteReader
+{
+public:
+  ByteReader(const std::uint8_t* pData, std::size_t size) : m_pData(pData), m_remaining(size), m_failed(false)
+  {
+  }
+
+  template <typename T>
+  T get()
+  {
+    if (!require(sizeof(T)))
+    {
+      return T();
+    }
+    const T value = readUnalignLittleEndian<T>(m_pData);
+    skip(sizeof(T));
+    return value;
+  }
+
+  const std::uint8_t* getBytes(std::size_t size)
+  {
+    if (!require(size))
+    {
+      return nullptr;
+    }
+    const std::uint8_t* pBytes = m_pData;
+    skip(size);
+    return pBytes;
+  }
+
+  void skip(std::size_t size)
+  {
+    if (require(size))
+    {
+      m_pData += size;
+      m_remaining -= size;
+    }
+  }
+
+  bool failed() const
+  {
+    return m_failed;
+  }
+
+private:
+  bool require(std::size_t size)
+  {
+    if (m_failed || (size > m_remaining))
+    {
+      m_failed = true;
+      return false;
+    }
+    return true;
+  }
+
+  const std::uint8_t* m_pData;
+  std::size_t         m_remaining;
+  bool                m_failed;
+};
+
+template <typename T>
+void appendRawMap(const std::vector<T>& map, ByteWriter& writer)
+{
+  if (endian::native == endian::little)
+  {
+    writer.putBytes(map.data(), map.size() * sizeof(T));
+  }
+  else
+  {
+    for (const T value : map)
+    {
+      writer.put<T>(value);
+    }
+  }
+}
+
+template <typename T>
+bool readRawMap(const std::uint8_t* pPayload, std::size_t payloadSize, std::size_t numPixels, std::vector<T>& map)
+{
+  if (payloadSize != numPixels * sizeof(T))
+  {
+    return false;
+  }
+  map.resize(numPixels);
+  if (endian::native == endian::little)
+  {
+    std::memcpy(map.data(), pPayload, payloadSize);
+  }
+  else
+  {
+    for (std::size_t i = 0u; i < numPixels; ++i)
+    {
+      map[i] = readUnalignLittleEndian<T>(pPayload + i * sizeof(T));
+    }
+  }
+  return true;
+}
+
+bool readMap16(const std::uint8_t*         pPayload,
+               std::size_t                 payloadSize,
+               std::uint8_t                compression,
+               std::size_t                 numPixels,
+               std::vector<std::uint16_t>& map)
+{
+  if (compression == SequenceCompression::NONE)
+  {
+    return readRawMap(pPayload, payloadSize, numPixels, map);
+  }
+  if (compression == SequenceCompression::DEPTH_MAP_CODEC)
+  {
+    std::uint32_t width  = 0u;
+    std::uint32_t height = 0u;
+    return DepthMapCodec::decode(pPayload, payloadSize, map, width, height)
+           && (static_cast<std::size_t>(width) * height == numPixels);
+  }
+  return false;
+}
+
+// Collects the maps of the supported frame types.
+struct FrameMaps
+{
+  VisionaryType::Enum               type;
+  const std::vector<std::uint16_t>* pDepth;
+  const std::vector<std::uint16_t>* pIntensity;
+  const std::vector<std::uint16_t>* pState;
+  const std::vector<std::uint32_t>* pRgba;
+};
+
+bool getFrameMaps(const VisionaryData& frame, FrameMaps& maps)
+{
+  if (const auto* pSData = dynamic_cast<const VisionarySData*>(&frame))
+  {
+    maps = FrameMaps{
+      VisionaryType::eVisionaryS, &pSData->getZMap(), nullptr, &pSData->getStateMap(), &pSData->getRGBAMap()};
+    return true;
+  }
+  if (const auto* pTMiniData = dynamic_cast<const VisionaryTMiniData*>(&frame))
+  {
+    maps = FrameMaps{VisionaryType::eVisionaryTMini,
+                     &pTMiniData->getDistanceMap(),
+                     &pTMiniData->getIntensityMap(),
+                     &pTMiniData->getStateMap(),
+                     nullptr};
+    return true;
+  }
+  if (const auto* pSequenceData = dynamic_cast<const SequenceFrameData*>(&frame))
+  {
+    maps = FrameMaps{pSequenceData->getVisionaryType(),
+                     &pSequenceData->getDepthMap(),
+                     &pSequenceData->getIntensityMap(),
+                     &pSequenceData->getStateMap(),
+                     &pSequenceData->getRGBAMap()};
+    return true;
+  }
+  return false;
+}
+
+// maps which were not extracted are empty and not recorded
+template <typename T>
+bool isRecorded(const std::vector<T>* pMap, std::size_t numPixels)
+{
+  return (pMap != nullptr) && (numPixels > 0u) && (pMap->size() == numPixels);
+}
+
+// field by field, the padding of the structure is not compared
+bool isSameCameraParameters(const CameraParameters& lhs, const CameraParameters& rhs)
+{
+  for (std::size_t i = 0u; i < kNumCameraMatrixValues; ++i)
+  {
+    if (lhs.cam2worldMatrix[i] != rhs.cam2worldMatrix[i])
+    {
+      return false;
+    }
+  }
+  return (lhs.height == rhs.height) && (lhs.width == rhs.width) && (lhs.fx == rhs.fx) && (lhs.fy == rhs.fy)
+         && (lhs.cx == rhs.cx) && (lhs.cy == rhs.cy) && (lhs.k1 == rhs.k1) && (lhs.k2 == rhs.k2) && (lhs.p1 == rhs.p1)
+         && (lhs.p2 == rhs.p2) && (lhs.k3 == rhs.k3) && (lhs.f2rc == rhs.f2rc);
+}
+
+} // namespace
+
+//-----------------------------------------------
+// SequenceFrameData
+
+SequenceFrameData::SequenceFrameData() : VisionaryData(), m_visionaryType(VisionaryType::eVisionaryS)
+{
+}
+
+SequenceFrameData::~SequenceFrameData() = default;
+
+VisionaryType::Enum SequenceFrameData::getVisionaryType() const
+{
+  return m_visionaryType;
+}
+
+const std::vector<std::uint16_t>& SequenceFrameData::getDepthMap() const
+{
+  return m_depthMap;
+}
+
+const std::vector<std::uint16_t>& SequenceFrameData::getIntensityMap() const
+{
+  return m_intensityMap;
+}
+
+const std::vector<std::uint32_t>& SequenceFrameData::getRGBAMap() const
+{
+  return m_rgbaMap;
+}
+
+const std::vector<std::uint16_t>& SequenceFrameData::getStateMap() const
+{
+  return m_stateMap;
+}
+
+void SequenceFrameData::generatePointCloud(std::vector<PointXYZ>& pointCloud)
+{
+  const ImageType imageType = (m_visionaryType == VisionaryType::eVisionaryTMini) ? RADIAL : PLANAR;
+  return VisionaryData::generatePointCloud(m_depthMap, imageType, pointCloud);
+}
+
+std::size_t SequenceFrameData::generatePackedPointCloud(const PointCloudLayout& layout,
+                                                        void*                   pBuffer,
+                                                        std::size_t             bufferSize)
+{
+  const ImageType imageType = (m_visionaryType == VisionaryType::eVisionaryTMini) ? RADIAL : PLANAR;
+  return VisionaryData::generatePackedPointCloud(m_depthMap, imageType, layout, pBuffer, bufferSize);
+}
+
+bool SequenceFrameData::filterDepthMap(const DepthFilterConfig& config)
+{
+  return VisionaryData::filterDepthMap(config, m_depthMap, m_stateMap);
+}
+
+bool SequenceFrameData::parseXML(const std::string&, std::uint32_t)
+{
+  return false;
+}
+
+bool SequenceFrameData::parseBinaryData(std::vector<uint8_t>::iterator, std::size_t)
+{
+  return false;
+}
+
+//-----------------------------------------------
+// SequenceWriter
+
+SequenceWriter::SequenceWriter()
+  : m_compression(SequenceCompression::DEPTH_MAP_CODEC)
+  , m_headerWritten(false)
+  , m_visionaryType(VisionaryType::eVisionaryS)
+  , m_width(0)
+  , m_height(0)
+  , m_offset(0u)
+{
+}
+
+SequenceWriter::~SequenceWriter()
+{
+  close();
+}
+
+bool SequenceWriter::open(const std::string& filename, SequenceCompression::Enum compression)
+{
+  close();
+  m_stream.open(filename, std::ios::binary | std::ios::trunc);
+  if (!m_stream.is_open())
+  {
+    return false;
+  }
+  m_compression   = compression;
+  m_headerWritten = false;
+  m_offset        = 0u;
+  m_index.clear();
+  return true;
+}
+
+bool SequenceWriter::isOpen() const
+{
+  return m_stream.is_open();
+}
+
+std::size_t SequenceWriter::getFrameCount() const
+{
+  return m_index.size() / kIndexEntrySize;
+}
+
+bool SequenceWriter::writeHeader(const VisionaryData& frame, VisionaryType::Enum type)
+{
+  const CameraParameters& params = frame.getCameraParameters();
+
+  m_record.clear();
+  ByteWriter writer(m_record);
+  writer.putBytes(kFileMagic, sizeof(kFileMagic));
+  writer.put<std::uint16_t>(kFormatVersion);
+  writer.put<std::uint16_t>(static_cast<std::uint16_t>(type));
+  writer.put<std::uint8_t>(static_cast<std::uint8_t>(m_compression));
+  writer.putZeros(3u);
+  writer.put<float>(frame.getScaleZ());
+  writer.put<std::int32_t>(params.width);
+  writer.put<std::int32_t>(params.height);
+  for (std::size_t i = 0u; i < kNumCameraMatrixValues; ++i)
+  {
+    writer.put<double>(params.cam2worldMatrix[i]);
+  }
+  for (const double value :
+       {params.fx, params.fy, params.cx, params.cy, params.k1, params.k2, params.p1, params.p2, params.k3, params.f2rc})
+  {
+    writer.put<double>(value);
+  }
+  // index offset and frame count are written by close()
+  writer.put<std::uint64_t>(0u);
+  writer.put<std::uint64_t>(0u);
+
+  m_stream.write(reinterpret_cast<const char*>(m_record.data()), static_cast<std::streamsize>(m_record.size()));
+  m_offset        = m_record.size();
+  m_headerWritten = true;
+  m_visionaryType = type;
+  m_width         = params.width;
+  m_height        = params.height;
+  return m_stream.good();
+}
+
+void SequenceWriter::appendMap(std::uint8_t mapId, const std::vector<std::uint16_t>& map)
+{
+  ByteWriter writer(m_record);
+  writer.put<std::uint8_t>(mapId);
+  writer.put<std::uint8_t>(static_cast<std::uint8_t>(m_compression));
+  writer.putZeros(2u);
+  if (m_compression == SequenceCompression::DEPTH_MAP_CODEC)
+  {
+    DepthMapCodec::encode(
+      map.data(), static_cast<std::uint32_t>(m_width), static_cast<std::uint32_t>(m_height), m_encoded);
+    writer.put<std::uint32_t>(static_cast<std::uint32_t>(m_encoded.size()));
+    writer.putBytes(m_encoded.data(), m_encoded.size());
+  }
+  else
+  {
+    writer.put<std::uint32_t>(static_cast<std::uint32_t>(map.size() * sizeof(std::uint16_t)));
+    appendRawMap(map, writer);
+  }
+}
+
+void SequenceWriter::appendMap(std::uint8_t mapId, const std::vector<std::uint32_t>& map)
+{
+  ByteWriter writer(m_record);
+  writer.put<std::uint8_t>(mapId);
+  writer.put<std::uint8_t>(static_cast<std::uint8_t>(SequenceCompression::NONE));
+  writer.putZeros(2u);
+  writer.put<std::uint32_t>(static_cast<std::uint32_t>(map.size() * sizeof(std::uint32_t)));
+  appendRawMap(map, writer);
+}
+
+bool SequenceWriter::append(const VisionaryData& frame)
+{
+  FrameMaps maps;
+  if (!m_stream.is_open() || !getFrameMaps(frame, maps))
+  {
+    return false;
+  }
+  if (!m_headerWritten && !writeHeader(frame, maps.type))
+  {
+    return false;
+  }
+  if ((maps.type != m_visionaryType) || (frame.getWidth() != m_width) || (frame.getHeight() != m_height))
+  {
+    return false;
+  }
+
+  const std::size_t numPixels    = static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height);
+  const bool        hasDepth     = isRecorded(maps.pDepth, numPixels);
+  const bool        hasIntensity = isRecorded(maps.pIntensity, numPixels);
+  const bool        hasState     = isRecorded(maps.pState, numPixels);
+  const bool        hasRgba      = isRecorded(maps.pRgba, numPixels);
+
+  const FrameMetadata& metadata = frame.getFrameMetadata();
+  m_record.clear();
+  ByteWriter writer(m_record);
+  writer.putBytes(kRecordMagic, sizeof(kRecordMagic));
+  writer.put<std::uint32_t>(0u); // record size, set below
+  writer.put<std::uint32_t>(frame.getFrameNum());
+  writer.put<std::uint16_t>(frame.getDataSetVersion());
+  writer.put<std::uint8_t>(metadata.dataQuality);
+  writer.put<std::uint8_t>(metadata.deviceStatus);
+  writer.put<std::uint64_t>(frame.getTimestamp());
+  writer.put<std::uint64_t>(frame.getTimestampMS());
+  writer.put<std::uint8_t>(static_cast<std::uint8_t>(hasDepth + hasIntensity + hasState + hasRgba));
+  writer.putZeros(7u);
+  if (hasDepth)
+  {
+    appendMap(MapId::DEPTH, *maps.pDepth);
+  }
+  if (hasIntensity)
+  {
+    appendMap(MapId::INTENSITY, *maps.pIntensity);
+  }
+  if (hasState)
+  {
+    appendMap(MapId::STATE, *maps.pState);
+  }
+  if (hasRgba)
+  {
+    appendMap(MapId::RGBA, *maps.pRgba);
+  }
+  writeUnalignLittleEndian<std::uint32_t>(m_record.data() + 4u, 4u, static_cast<std::uint32_t>(m_record.size()));
+
+  m_stream.write(reinterpret_cast<const char*>(m_record.data()), static_cast<std::streamsize>(m_record.size()));
+  if (!m_stream.good())
+  {
+    return false;
+  }
+
+  ByteWriter indexWriter(m_index);
+  indexWriter.put<std::uint64_t>(m_offset);
+  indexWriter.put<std::uint32_t>(static_cast<std::uint32_t>(m_record.size()));
+  indexWriter.put<std::uint32_t>(frame.getFrameNum());
+  indexWriter.put<std::uint64_t>(frame.getTimestamp());
+  indexWriter.put<std::uint64_t>(frame.getTimestampMS());
+  indexWriter.put<std::uint16_t>(frame.getDataSetVersion());
+  indexWriter.put<std::uint8_t>(metadata.dataQuality);
+  indexWriter.put<std::uint8_t>(metadata.deviceStatus);
+  indexWriter.putZeros(4u);
+  m_offset += m_record.size();
+  return true;
+}
+
+bool SequenceWriter::close()
+{
+  if (!m_stream.is_open())
+  {
+    return false;
+  }
+  bool success = m_stream.good();
+  if (m_headerWritten)
+  {
+    m_stream.write(reinterpret_cast<const char*>(m_index.data()), static_cast<std::streamsize>(m_index.size()));
+
+    std::uint8_t indexLocation[16];
+    writeUnalignLittleEndian<std::uint64_t>(indexLocation, 8u, m_offset);
+    writeUnalignLittleEndian<std::uint64_t>(indexLocation + 8u, 8u, getFrameCount());
+    m_stream.seekp(static_cast<std::streamoff>(kIndexOffsetPosition));
+    m_stream.write(reinterpret_cast<const char*>(indexLocation), sizeof(indexLocation));
+    success = success && m_stream.good();
+  }
+  m_stream.close();
+  m_headerWritten = false;
+  m_index.clear();
+  return success && !m_stream.fail();
+}
+
+//-----------------------------------------------
+// SequenceReader
+
+SequenceReader::SequenceReader()
+  : m_pFile(new MappedFile())
+  , m_visionaryType(VisionaryType::eVisionaryS)
+  , m_cameraParams()
+  , m_scaleZ(0.0f)
+  , m_pIndex(nullptr)
+  , m_frameCount(0u)
+  , m_indexRecovered(false)
+{
+}
+
+SequenceReader::~SequenceReader() = default;
+
+bool SequenceReader::open(const std::string& filename)
+{
+  close();
+  if (!m_pFile->open(filename) || !readHeader())
+  {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void SequenceReader::close()
+{
+  m_pFile->close();
+  m_cameraParams = CameraParameters();
+  m_scaleZ       = 0.0f;
+  m_pIndex       = nullptr;
+  m_frameCount   = 0u;
+  m_recoveredIndex.clear();
+  m_indexRecovered = false;
+}
+
+bool SequenceReader::isOpen() const
+{
+  return m_pFile->isOpen();
+}
+
+bool SequenceReader::isIndexRecovered() const
+{
+  return m_indexRecovered;
+}
+
+std::size_t SequenceReader::getFrameCount() const
+{
+  return m_frameCount;
+}
+
+VisionaryType::Enum SequenceReader::getVisionaryType() const
+{
+  return m_visionaryType;
+}
+
+const CameraParameters& SequenceReader::getCameraParameters() const
+{
+  return m_cameraParams;
+}
+
+float SequenceReader::getScaleZ() const
+{
+  return m_scaleZ;
+}
+
+bool SequenceReader::readHeader()
+{
+  ByteReader reader(m_pFile->data(), m_pFile->size());
+  const std::uint8_t* pMagic = reader.getBytes(sizeof(kFileMagic));
+  if ((pMagic == nullptr) || (std::memcmp(pMagic, kFileMagic, sizeof(kFileMagic)) != 0)
+      || (reader.get<std::uint16_t>() != kFormatVersion))
+  {
+    return false;
+  }
+  const std::uint16_t type = reader.get<std::uint16_t>();
+  if ((type != VisionaryType::eVisionaryS) && (type != VisionaryType::eVisionaryTMini))
+  {
+    return false;
+  }
+  m_visionaryType = static_cast<VisionaryType::Enum>(type);
+  reader.skip(4u); // compression (per map) and reserved bytes
+  m_scaleZ              = reader.get<float>();
+  m_cameraParams.width  = reader.get<std::int32_t>();
+  m_cameraParams.height = reader.get<std::int32_t>();
+  for (std::size_t i = 0u; i < kNumCameraMatrixValues; ++i)
+  {
+    m_cameraParams.cam2worldMatrix[i] = reader.get<double>();
+  }
+  for (double* pValue : {&m_cameraParams.fx,
+                         &m_cameraParams.fy,
+                         &m_cameraParams.cx,
+                         &m_cameraParams.cy,
+                         &m_cameraParams.k1,
+                         &m_cameraParams.k2,
+                         &m_cameraParams.p1,
+                         &m_cameraParams.p2,
+                         &m_cameraParams.k3,
+                         &m_cameraParams.f2rc})
+  {
+    *pValue = reader.get<double>();
+  }
+  const std::uint64_t indexOffset = reader.get<std::uint64_t>();
+  const std::uint64_t frameCount  = reader.get<std::uint64_t>();
+  if (reader.failed() || (m_cameraParams.width < 0) || (m_cameraParams.height < 0))
+  {
+    return false;
+  }
+
+  if (indexOffset == 0u)
+  {
+    return recoverIndex();
+  }
+  if ((indexOffset > m_pFile->size()) || (frameCount > (m_pFile->size() - indexOffset) / kIndexEntrySize))
+  {
+    return false;
+  }
+  m_pIndex     = m_pFile->data() + indexOffset;
+  m_frameCount = static_cast<std::size_t>(frameCount);
+  return true;
+}
+
+bool SequenceReader::recoverIndex()
+{
+  // the writer did not finish the file: walk the frame records and stop at the first incomplete one
+  std::size_t offset = kFileHeaderSize;
+  while (m_pFile->size() - offset >= kRecordHeaderSize)
+  {
+    const std::uint8_t* pRecord = m_pFile->data() + offset;
+    ByteReader          reader(pRecord, kRecordHeaderSize);
+    if (std::memcmp(reader.getBytes(sizeof(kRecordMagic)), kRecordMagic, sizeof(kRecordMagic)) != 0)
+    {
+      break;
+    }
+    const std::uint32_t recordSize     = reader.get<std::uint32_t>();
+    const std::uint32_t frameNum       = reader.get<std::uint32_t>();
+    const std::uint16_t dataSetVersion = reader.get<std::uint16_t>();
+    const std::uint8_t  dataQuality    = reader.get<std::uint8_t>();
+    const std::uint8_t  deviceStatus   = reader.get<std::uint8_t>();
+    const std::uint64_t timestamp      = reader.get<std::uint64_t>();
+    const std::uint64_t timestampMS    = reader.get<std::uint64_t>();
+    if ((recordSize < kRecordHeaderSize) || (recordSize > m_pFile->size() - offset))
+    {
+      break;
+    }
+
+    ByteWriter writer(m_recoveredIndex);
+    writer.put<std::uint64_t>(offset);
+    writer.put<std::uint32_t>(recordSize);
+    writer.put<std::uint32_t>(frameNum);
+    writer.put<std::uint64_t>(timestamp);
+    writer.put<std::uint64_t>(timestampMS);
+    writer.put<std::uint16_t>(dataSetVersion);
+    writer.put<std::uint8_t>(dataQuality);
+    writer.put<std::uint8_t>(deviceStatus);
+    writer.putZeros(4u);
+    offset += recordSize;
+  }
+  m_pIndex         = m_recoveredIndex.data();
+  m_frameCount     = m_recoveredIndex.size() / kIndexEntrySize;
+  m_indexRecovered = true;
+  return true;
+}
+
+bool SequenceReader::readIndexEntry(std::size_t        index,
+                                    std::uint64_t&     offset,
+                                    std::uint32_t&     size,
+                                    SequenceFrameInfo& info) const
+{
+  if (index >= m_frameCount)
+  {
+    return false;
+  }
+  ByteReader reader(m_pIndex + index * kIndexEntrySize, kIndexEntrySize);
+  offset              = reader.get<std::uint64_t>();
+  size                = reader.get<std::uint32_t>();
+  info.frameNum       = reader.get<std::uint32_t>();
+  info.timestamp      = reader.get<std::uint64_t>();
+  info.timestampMS    = reader.get<std::uint64_t>();
+  info.dataSetVersion = reader.get<std::uint16_t>();
+  info.dataQuality    = reader.get<std::uint8_t>();
+  info.deviceStatus   = reader.get<std::uint8_t>();
+  return true;
+}
+
+bool SequenceReader::getFrameInfo(std::size_t index, SequenceFrameInfo& info) const
+{
+  std::uint64_t offset = 0u;
+  std::uint32_t size   = 0u;
+  return readIndexEntry(index, offset, size, info);
+}
+
+std::size_t SequenceReader::findFrame(std::uint64_t timestampMS) const
+{
+  std::size_t first = 0u;
+  std::size_t count = m_frameCount;
+  while (count > 0u)
+  {
+    const std::size_t step = count / 2u;
+    // the timestamp in ms is at byte 24 of an index entry
+    const std::uint64_t entryTimestampMS =
+      readUnalignLittleEndian<std::uint64_t>(m_pIndex + (first + step) * kIndexEntrySize + 24u);
+    if (entryTimestampMS < timestampMS)
+    {
+      first += step + 1u;
+      count -= step + 1u;
+    }
+    else
+    {
+      count = step;
+    }
+  }
+  return first;
+}
+
+bool SequenceReader::readFrame(std::size_t index, SequenceFrameData& frame) const
+{
+  std::uint64_t     offset = 0u;
+  std::uint32_t     size   = 0u;
+  SequenceFrameInfo info;
+  if (!readIndexEntry(index, offset, size, info) || (offset > m_pFile->size())
+      || (size > m_pFile->size() - offset))
+  {
+    return false;
+  }
+
+  ByteReader          reader(m_pFile->data() + offset, size);
+  const std::uint8_t* pMagic = reader.getBytes(sizeof(kRecordMagic));
+  if ((pMagic == nullptr) || (std::memcmp(pMagic, kRecordMagic, sizeof(kRecordMagic)) != 0))
+  {
+    return false;
+  }
+  reader.skip(kRecordHeaderSize - sizeof(kRecordMagic) - 8u);
+  const std::uint8_t mapCount = reader.get<std::uint8_t>();
+  reader.skip(7u);
+
+  const std::size_t numPixels = static_cast<std::size_t>(m_cameraParams.width) * m_cameraParams.height;
+  frame.m_depthMap.clear();
+  frame.m_intensityMap.clear();
+  frame.m_stateMap.clear();
+  frame.m_rgbaMap.clear();
+  for (std::uint8_t map = 0u; map < mapCount; ++map)
+  {
+    const std::uint8_t mapId       = reader.get<std::uint8_t>();
+    const std::uint8_t compression = reader.get<std::uint8_t>();
+    reader.skip(2u);
+    const std::uint32_t payloadSize = reader.get<std::uint32_t>();
+    const std::uint8_t* pPayload    = reader.getBytes(payloadSize);
+    if (reader.failed())
+    {
+      return false;
+    }
+    bool valid = false;
+    switch (mapId)
+    {
+      case MapId::DEPTH:
+        valid = readMap16(pPayload, payloadSize, compression, numPixels, frame.m_depthMap);
+        break;
+      case MapId::INTENSITY:
+        valid = readMap16(pPayload, payloadSize, compression, numPixels, frame.m_intensityMap);
+        break;
+      case MapId::STATE:
+        valid = readMap16(pPayload, payloadSize, compression, numPixels, frame.m_stateMap);
+        break;
+      case MapId::RGBA:
+        valid = (compression == SequenceCompression::NONE)
+                && readRawMap(pPayload, payloadSize, numPixels, frame.m_rgbaMap);
+        break;
+      default:
+        // maps of later format versions are skipped
+        valid = true;
+        break;
+    }
+    if (!valid)
+    {
+      return false;
+    }
+  }
+
+  // the lookup table for the point cloud is only kept for frames of the same recording setup
+  if ((frame.m_visionaryType != m_visionaryType)
+      || !isSameCameraParameters(frame.m_cameraParams, m_cameraParams))
+  {
+    frame.m_preCalcCamInfoType = SequenceFrameData::UNKNOWN;
+  }
+  frame.m_visionaryType  = m_visionaryType;
+  frame.m_cameraParams   = m_cameraParams;
+  frame.m_scaleZ         = m_scaleZ;
+  frame.m_frameNum       = info.frameNum;
+  frame.m_dataSetVersion = info.dataSetVersion;
+  frame.setBlobTimestamp(info.timestamp);
+  frame.m_timestampMS   = info.timestampMS;
+  frame.m_frameMetadata = FrameMetadata{
+    info.dataSetVersion, info.frameNum, info.timestampMS, info.dataQuality, info.deviceStatus};
+  return true;
+}
+
+} // namespace visionary
@@ -0,0 +1,27 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "SocketOptions.h"
+
+namespace visionary {
+
+SocketOptions SocketOptions::controlChannel()
+{
+  SocketOptions options;
+  options.noDelay   = true;
+  options.quickAck  = true;
+  options.keepAlive = true;
+  return options;
+}
+
+SocketOptions SocketOptions::blobStream(std::size_t frameSize, std::size_t depth)
+{
+  SocketOptions options;
+  options.receiveBufferSize = frameSize * depth;
+  options.keepAlive         = true;
+  return options;
+}
+
+} // namespace visionary
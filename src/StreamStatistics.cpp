@@ -0,0 +1,171 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "StreamStatistics.h"
+
+namespace visionary {
+
+StreamStatisticsCollector::StreamStatisticsCollector()
+{
+  reset();
+}
+
+std::int64_t StreamStatisticsCollector::toNs(Clock::time_point timePoint)
+{
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timePoint.time_since_epoch()).count();
+  // 0 is reserved for "not set"
+  return ns != 0 ? static_cast<std::int64_t>(ns) : 1;
+}
+
+void StreamStatisticsCollector::onFrameReceived(std::uint64_t numBytes, Clock::time_point arrivalTime)
+{
+  const std::int64_t arrivalNs = toNs(arrivalTime);
+  const std::int64_t lastNs    = m_lastArrivalNs.load(std::memory_order_relaxed);
+
+  if (lastNs == 0)
+  {
+    m_firstArrivalNs.store(arrivalNs, std::memory_order_relaxed);
+  }
+  else if (m_skipInterval.exchange(false, std::memory_order_relaxed))
+  {
+    // first frame after a reconnect, the next interval starts here
+  }
+  else
+  {
+    const std::int64_t interval     = arrivalNs - lastNs;
+    const std::int64_t lastInterval = m_lastIntervalNs.exchange(interval, std::memory_order_relaxed);
+    if (lastInterval != 0)
+    {
+      // J += (|D| - J) / 16, kept scaled by 16 to stay in integer arithmetic
+      const std::int64_t deviation = interval > lastInterval ? interval - lastInterval : lastInterval - interval;
+      const std::int64_t jitter    = m_jitterScaledNs.load(std::memory_order_relaxed);
+      m_jitterScaledNs.store(jitter + deviation - ((jitter + 8) >> 4), std::memory_order_relaxed);
+    }
+  }
+  m_lastArrivalNs.store(arrivalNs, std::memory_order_relaxed);
+  m_bytesReceived.fetch_add(numBytes, std::memory_order_relaxed);
+  m_framesReceived.fetch_add(1u, std::memory_order_relaxed);
+}
+
+void StreamStatisticsCollector::onFrameParsed(std::uint16_t dataSetVersion, std::uint32_t frameNum)
+{
+  m_framesParsed.fetch_add(1u, std::memory_order_relaxed);
+  trackFrameNumber(dataSetVersion, frameNum);
+}
+
+void StreamStatisticsCollector::onFrameRejected(std::uint16_t dataSetVersion, std::uint32_t frameNum)
+{
+  m_framesRejected.fetch_add(1u, std::memory_order_relaxed);
+  trackFrameNumber(dataSetVersion, frameNum);
+}
+
+void StreamStatisticsCollector::trackFrameNumber(std::uint16_t dataSetVersion, std::uint32_t frameNum)
+{
+  // version 1 data sets have no device frame number, the data handler just counts
+  if (dataSetVersion < 2u)
+  {
+    m_hasLastFrameNum.store(false, std::memory_order_relaxed);
+    return;
+  }
+
+  if (m_hasLastFrameNum.load(std::memory_order_relaxed))
+  {
+    // unsigned arithmetic handles the wrap around of the frame counter; a step backwards (device restart)
+    // shows up as a huge distance and is not counted as a gap
+    const std::uint32_t distance = frameNum - m_lastFrameNum.load(std::memory_order_relaxed);
+    if (distance > 1u && distance < 0x80000000u)
+    {
+      m_frameNumberGaps.fetch_add(1u, std::memory_order_relaxed);
+      m_framesMissed.fetch_add(distance - 1u, std::memory_order_relaxed);
+    }
+  }
+  m_lastFrameNum.store(frameNum, std::memory_order_relaxed);
+  m_hasLastFrameNum.store(true, std::memory_order_relaxed);
+}
+
+void StreamStatisticsCollector::onFrameFailed()
+{
+  m_framesFailed.fetch_add(1u, std::memory_order_relaxed);
+}
+
+void StreamStatisticsCollector::onFrameDropped()
+{
+  m_framesDropped.fetch_add(1u, std::memory_order_relaxed);
+}
+
+void StreamStatisticsCollector::onReconnect()
+{
+  m_reconnects.fetch_add(1u, std::memory_order_relaxed);
+  // the arrival interval across the outage is meaningless, neither for the frame rate nor for the jitter
+  m_lastIntervalNs.store(0, std::memory_order_relaxed);
+  m_skipInterval.store(true, std::memory_order_relaxed);
+}
+
+void StreamStatisticsCollector::onBacklog(std::uint64_t depth)
+{
+  m_backlog.store(depth, std::memory_order_relaxed);
+  std::uint64_t maxDepth = m_maxBacklog.load(std::memory_order_relaxed);
+  while (depth > maxDepth && !m_maxBacklog.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed))
+  {
+  }
+}
+
+StreamStatistics StreamStatisticsCollector::getStatistics() const
+{
+  StreamStatistics stats{};
+  stats.framesReceived  = m_framesReceived.load(std::memory_order_relaxed);
+  stats.framesParsed    = m_framesParsed.load(std::memory_order_relaxed);
+  stats.framesFailed    = m_framesFailed.load(std::memory_order_relaxed);
+  stats.framesRejected  = m_framesRejected.load(std::memory_order_relaxed);
+  stats.framesDropped   = m_framesDropped.load(std::memory_order_relaxed);
+  stats.frameNumberGaps = m_frameNumberGaps.load(std::memory_order_relaxed);
+  stats.framesMissed    = m_framesMissed.load(std::memory_order_relaxed);
+  stats.reconnects      = m_reconnects.load(std::memory_order_relaxed);
+  stats.bytesReceived   = m_bytesReceived.load(std::memory_order_relaxed);
+  stats.backlog         = m_backlog.load(std::memory_order_relaxed);
+  stats.maxBacklog      = m_maxBacklog.load(std::memory_order_relaxed);
+  stats.jitter          = std::chrono::nanoseconds(m_jitterScaledNs.load(std::memory_order_relaxed) >> 4);
+
+  const std::int64_t lastInterval = m_lastIntervalNs.load(std::memory_order_relaxed);
+  if (lastInterval > 0)
+  {
+    stats.currentFps = 1.0e9 / static_cast<double>(lastInterval);
+  }
+
+  const std::int64_t span =
+    m_lastArrivalNs.load(std::memory_order_relaxed) - m_firstArrivalNs.load(std::memory_order_relaxed);
+  if (span > 0 && stats.framesReceived > 1u)
+  {
+    // n frames span n-1 intervals
+    stats.averageFps     = static_cast<double>(stats.framesReceived - 1u) * 1.0e9 / static_cast<double>(span);
+    stats.bytesPerSecond = stats.averageFps * static_cast<double>(stats.bytesReceived)
+                           / static_cast<double>(stats.framesReceived);
+  }
+  return stats;
+}
+
+void StreamStatisticsCollector::reset()
+{
+  m_framesReceived.store(0u, std::memory_order_relaxed);
+  m_framesParsed.store(0u, std::memory_order_relaxed);
+  m_framesFailed.store(0u, std::memory_order_relaxed);
+  m_framesRejected.store(0u, std::memory_order_relaxed);
+  m_framesDropped.store(0u, std::memory_order_relaxed);
+  m_frameNumberGaps.store(0u, std::memory_order_relaxed);
+  m_framesMissed.store(0u, std::memory_order_relaxed);
+  m_reconnects.store(0u, std::memory_order_relaxed);
+  m_bytesReceived.store(0u, std::memory_order_relaxed);
+  m_backlog.store(0u, std::memory_order_relaxed);
+  m_maxBacklog.store(0u, std::memory_order_relaxed);
+  m_firstArrivalNs.store(0, std::memory_order_relaxed);
+  m_lastArrivalNs.store(0, std::memory_order_relaxed);
+  m_lastIntervalNs.store(0, std::memory_order_relaxed);
+  m_skipInterval.store(false, std::memory_order_relaxed);
+  m_jitterScaledNs.store(0, std::memory_order_relaxed);
+  m_hasLastFrameNum.store(false, std::memory_order_relaxed);
+  m_lastFrameNum.store(0u, std::memory_order_relaxed);
+}
+
+} // namespace visionary
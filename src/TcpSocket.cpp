@@ -7,9 +7,22 @@
 
 #include <fcntl.h>
 
+#include <cerrno>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
 
+#ifndef _WIN32
+#  include <netinet/tcp.h>
+#endif
+
+#ifdef __linux__
+#  include <linux/errqueue.h>
+#  include <linux/net_tstamp.h>
+#  include <time.h>
+#endif
+
 #include "NumericConv.h"
 #include "SockRecord.h"
 
@@ -21,7 +34,13 @@ using bufsize_t = int;
 using bufsize_t = size_t;
 #endif
 
-TcpSocket::TcpSocket() : m_pSockRecord(new SockRecord())
+TcpSocket::TcpSocket()
+  : m_pSockRecord(new SockRecord())
+  , m_rxTimestamping(false)
+  , m_quickAck(false)
+  , m_receiveTimedOut(false)
+  , m_receiveBufferLimited(false)
+  , m_lastRxTimestampNs(0)
 {
 }
 
@@ -34,6 +53,14 @@ TcpSocket::~TcpSocket()
 }
 
 int TcpSocket::connect(const std::string& ipaddr, std::uint16_t port, std::chrono::milliseconds timeout)
+{
+  return connect(ipaddr, port, timeout, SocketOptions());
+}
+
+int TcpSocket::connect(const std::string&        ipaddr,
+                       std::uint16_t             port,
+                       std::chrono::milliseconds timeout,
+                       const SocketOptions&      options)
 {
   int iResult = 0;
 
@@ -64,6 +91,7 @@ int TcpSocket::connect(const std::string& ipaddr, std::uint16_t port, std::chron
   }
 
   m_pSockRecord->set(hsock);
+  applyPreConnectOptions(options);
 
   //-----------------------------------------------
   // Bind the socket to any address and the specified port.
@@ -208,20 +236,97 @@ int TcpSocket::connect(const std::string& ipaddr, std::uint16_t port, std::chron
 #endif
   }
   // Set the timeout for the socket
-#ifdef _WIN32
-  // On Windows timeout is a DWORD in milliseconds
-  // (https://docs.microsoft.com/en-us/windows/desktop/api/winsock/nf-winsock-setsockopt)
-  const DWORD timeoutMs = static_cast<DWORD>(std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count());
+  iResult = setReceiveTimeout(timeout) ? 0 : -1;
 
-  iResult = ::setsockopt(
-    m_pSockRecord->socket(), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeoutMs), sizeof(DWORD));
-#else
-  iResult = ::setsockopt(
-    m_pSockRecord->socket(), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(struct timeval));
+#ifdef TCP_QUICKACK
+  m_quickAck = options.quickAck;
+  if (m_quickAck)
+  {
+    const int on = 1;
+    ::setsockopt(m_pSockRecord->socket(), IPPROTO_TCP, TCP_QUICKACK, &on, sizeof(on));
+  }
 #endif
+  if (options.receiveTimestamps)
+  {
+    setReceiveTimestamping(true);
+  }
   return iResult;
 }
 
+void TcpSocket::applyPreConnectOptions(const SocketOptions& options)
+{
+  const SOCKET hsock = m_pSockRecord->socket();
+  const int    on    = 1;
+
+  if (options.receiveBufferSize > 0u)
+  {
+    m_receiveBufferLimited = !applyReceiveBufferSize(options.receiveBufferSize);
+  }
+  if (options.noDelay)
+  {
+    ::setsockopt(hsock, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&on), sizeof(on));
+  }
+  if (options.keepAlive)
+  {
+    ::setsockopt(hsock, SOL_SOCKET, SO_KEEPALIVE, reinterpret_cast<const char*>(&on), sizeof(on));
+#if defined(TCP_KEEPIDLE) && defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+    const int idle     = static_cast<int>(options.keepAliveIdle.count());
+    const int interval = static_cast<int>(options.keepAliveInterval.count());
+    const int count    = options.keepAliveCount;
+    ::setsockopt(hsock, IPPROTO_TCP, TCP_KEEPIDLE, reinterpret_cast<const char*>(&idle), sizeof(idle));
+    ::setsockopt(hsock, IPPROTO_TCP, TCP_KEEPINTVL, reinterpret_cast<const char*>(&interval), sizeof(interval));
+    ::setsockopt(hsock, IPPROTO_TCP, TCP_KEEPCNT, reinterpret_cast<const char*>(&count), sizeof(count));
+#endif
+  }
+#ifdef SO_BUSY_POLL
+  if (options.busyPollMicroseconds > 0)
+  {
+    ::setsockopt(hsock, SOL_SOCKET, SO_BUSY_POLL, &options.busyPollMicroseconds, sizeof(options.busyPollMicroseconds));
+  }
+#endif
+#ifdef SO_PRIORITY
+  if (options.priority >= 0)
+  {
+    ::setsockopt(hsock, SOL_SOCKET, SO_PRIORITY, &options.priority, sizeof(options.priority));
+  }
+#endif
+}
+
+bool TcpSocket::applyReceiveBufferSize(std::size_t size)
+{
+  const int requested = castClamped<int>(size);
+
+#ifdef __linux__
+  // privileged processes may exceed net.core.rmem_max
+  if (::setsockopt(m_pSockRecord->socket(), SOL_SOCKET, SO_RCVBUFFORCE, &requested, sizeof(requested)) == 0)
+  {
+    return true;
+  }
+  // setting SO_RCVBUF disables the receive buffer autotuning, so only do it if the size is not capped below the request
+  const std::size_t limit = getReceiveBufferLimit();
+  if (limit < static_cast<std::size_t>(requested))
+  {
+    return false;
+  }
+#endif
+  return ::setsockopt(
+           m_pSockRecord->socket(), SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&requested), sizeof(requested))
+         == 0;
+}
+
+std::size_t TcpSocket::getReceiveBufferLimit()
+{
+#ifdef __linux__
+  long          rmemMax = 0;
+  std::ifstream rmemMaxFile("/proc/sys/net/core/rmem_max");
+  if ((rmemMaxFile >> rmemMax) && rmemMax > 0)
+  {
+    return static_cast<std::size_t>(rmemMax);
+  }
+#endif
+  return 0u;
+}
+
 int TcpSocket::shutdown()
 {
   // Close the socket when finished receiving datagrams
@@ -232,6 +337,11 @@ int TcpSocket::shutdown()
   ::close(m_pSockRecord->socket());
 #endif
   m_pSockRecord->invalidate();
+  m_rxTimestamping       = false;
+  m_quickAck             = false;
+  m_receiveBufferLimited = false;
+  m_lastRxTimestampNs    = 0;
+  m_lastReceiveTime      = std::chrono::steady_clock::time_point();
   return 0;
 }
 
@@ -250,7 +360,7 @@ ITransport::recv_return_t TcpSocket::recv(ByteBuffer& buffer, std::size_t maxByt
   buffer.resize(static_cast<std::size_t>(eff_maxsize));
   char* pBuffer = reinterpret_cast<char*>(buffer.data());
 
-  const ITransport::recv_return_t retval = ::recv(m_pSockRecord->socket(), pBuffer, eff_maxsize, 0);
+  const ITransport::recv_return_t retval = receive(pBuffer, static_cast<std::size_t>(eff_maxsize));
 
   if (retval >= 0)
   {
@@ -260,6 +370,11 @@ ITransport::recv_return_t TcpSocket::recv(ByteBuffer& buffer, std::size_t maxByt
   return retval;
 }
 
+ITransport::recv_return_t TcpSocket::recvInto(std::uint8_t* pBuffer, std::size_t maxBytesToReceive)
+{
+  return receive(reinterpret_cast<char*>(pBuffer), maxBytesToReceive);
+}
+
 ITransport::recv_return_t TcpSocket::read(ByteBuffer& buffer, std::size_t nBytesToReceive)
 {
   // receive from TCP Socket
@@ -284,9 +399,7 @@ ITransport::recv_return_t TcpSocket::read(ByteBuffer& buffer, std::size_t nBytes
 
   while (nBytesToReceive > 0)
   {
-    const bufsize_t eff_maxsize = castClamped<bufsize_t>(nBytesToReceive);
-
-    const ITransport::recv_return_t bytesReceived = ::recv(m_pSockRecord->socket(), pBuffer, eff_maxsize, 0);
+    const ITransport::recv_return_t bytesReceived = receive(pBuffer, nBytesToReceive);
 
     if (bytesReceived == SOCKET_ERROR)
     {
@@ -306,6 +419,214 @@ ITransport::recv_return_t TcpSocket::read(ByteBuffer& buffer, std::size_t nBytes
   return static_cast<ITransport::recv_return_t>(buffer.size());
 }
 
+ITransport::recv_return_t TcpSocket::receive(char* pBuffer, std::size_t maxBytesToReceive)
+{
+  const bufsize_t eff_maxsize = castClamped<bufsize_t>(maxBytesToReceive);
+
+#ifdef __linux__
+  if (m_rxTimestamping)
+  {
+    iovec iov{};
+    iov.iov_base = pBuffer;
+    iov.iov_len  = eff_maxsize;
+
+    // room for either an SCM_TIMESTAMPING or an SCM_TIMESTAMPNS message
+    union
+    {
+      char    buf[CMSG_SPACE(sizeof(scm_timestamping))];
+      cmsghdr align;
+    } control;
+
+    msghdr msg{};
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    const ITransport::recv_return_t retval = ::recvmsg(m_pSockRecord->socket(), &msg, 0);
+    if (retval > 0)
+    {
+      for (cmsghdr* pCmsg = CMSG_FIRSTHDR(&msg); pCmsg != nullptr; pCmsg = CMSG_NXTHDR(&msg, pCmsg))
+      {
+        if (pCmsg->cmsg_level != SOL_SOCKET)
+        {
+          continue;
+        }
+        timespec ts{};
+        if (pCmsg->cmsg_type == SCM_TIMESTAMPING)
+        {
+          scm_timestamping tss;
+          std::memcpy(&tss, CMSG_DATA(pCmsg), sizeof(tss));
+          ts = tss.ts[0]; // software timestamp
+        }
+        else if (pCmsg->cmsg_type == SCM_TIMESTAMPNS)
+        {
+          std::memcpy(&ts, CMSG_DATA(pCmsg), sizeof(ts));
+        }
+        else
+        {
+          continue;
+        }
+        if (ts.tv_sec != 0 || ts.tv_nsec != 0)
+        {
+          m_lastRxTimestampNs =
+            static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + static_cast<std::int64_t>(ts.tv_nsec);
+        }
+      }
+    }
+    onReceived(retval);
+    return retval;
+  }
+#endif
+  const ITransport::recv_return_t retval = ::recv(m_pSockRecord->socket(), pBuffer, eff_maxsize, 0);
+  onReceived(retval);
+  return retval;
+}
+
+void TcpSocket::onReceived(recv_return_t retval)
+{
+  if (retval == SOCKET_ERROR)
+  {
+#ifdef _WIN32
+    m_receiveTimedOut = (::WSAGetLastError() == WSAETIMEDOUT);
+#else
+    m_receiveTimedOut = (errno == EAGAIN || errno == EWOULDBLOCK);
+#endif
+  }
+  else
+  {
+    m_receiveTimedOut = false;
+    if (retval > 0)
+    {
+      m_lastReceiveTime = std::chrono::steady_clock::now();
+    }
+  }
+  rearmQuickAck();
+}
+
+void TcpSocket::rearmQuickAck()
+{
+#ifdef TCP_QUICKACK
+  if (m_quickAck)
+  {
+    // the kernel falls back to delayed ACKs, so the flag has to be set again after each receive
+    const int on = 1;
+    ::setsockopt(m_pSockRecord->socket(), IPPROTO_TCP, TCP_QUICKACK, &on, sizeof(on));
+  }
+#endif
+}
+
+bool TcpSocket::setReceiveTimeout(std::chrono::milliseconds timeout)
+{
+#ifdef _WIN32
+  // On Windows timeout is a DWORD in milliseconds
+  // (https://docs.microsoft.com/en-us/windows/desktop/api/winsock/nf-winsock-setsockopt)
+  const DWORD timeoutMs = static_cast<DWORD>(timeout.count());
+
+  return ::setsockopt(
+           m_pSockRecord->socket(), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeoutMs), sizeof(DWORD))
+         == 0;
+#else
+  const auto     timeoutUSeconds = std::chrono::duration_cast<std::chrono::microseconds>(timeout).count();
+  struct timeval tv;
+  tv.tv_sec  = static_cast<time_t>(timeoutUSeconds / 1000000);
+  tv.tv_usec = static_cast<suseconds_t>(timeoutUSeconds % 1000000);
+
+  return ::setsockopt(
+           m_pSockRecord->socket(), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(struct timeval))
+         == 0;
+#endif
+}
+
+bool TcpSocket::hasReceiveTimedOut() const
+{
+  return m_receiveTimedOut;
+}
+
+bool TcpSocket::setReceiveTimestamping(bool enable)
+{
+  m_lastRxTimestampNs = 0;
+#ifdef __linux__
+  if (!m_pSockRecord->isValid())
+  {
+    return false;
+  }
+  if (enable)
+  {
+    const int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (::setsockopt(m_pSockRecord->socket(), SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) != 0)
+    {
+      // older kernels may not support SO_TIMESTAMPING on TCP sockets
+      const int on = 1;
+      if (::setsockopt(m_pSockRecord->socket(), SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) != 0)
+      {
+        return false;
+      }
+    }
+  }
+  else
+  {
+    const int off = 0;
+    ::setsockopt(m_pSockRecord->socket(), SOL_SOCKET, SO_TIMESTAMPING, &off, sizeof(off));
+    ::setsockopt(m_pSockRecord->socket(), SOL_SOCKET, SO_TIMESTAMPNS, &off, sizeof(off));
+  }
+  m_rxTimestamping = enable;
+  return true;
+#else
+  return !enable;
+#endif
+}
+
+bool TcpSocket::getLastReceiveTimestamp(std::chrono::steady_clock::time_point& timestamp) const
+{
+  if (!m_rxTimestamping || m_lastRxTimestampNs == 0)
+  {
+    return false;
+  }
+  // the kernel stamps with the realtime clock, move it into the steady clock domain
+  const auto systemNow = std::chrono::system_clock::now();
+  const auto steadyNow = std::chrono::steady_clock::now();
+  const auto age       = std::chrono::nanoseconds(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(systemNow.time_since_epoch()).count() - m_lastRxTimestampNs);
+  timestamp = steadyNow - std::chrono::duration_cast<std::chrono::steady_clock::duration>(age);
+  return true;
+}
+
+bool TcpSocket::getConnectionHealth(ConnectionHealth& health) const
+{
+  if (!m_pSockRecord->isValid())
+  {
+    return false;
+  }
+  health.lastReceiveTime      = m_lastReceiveTime;
+  health.receiveBufferLimited = m_receiveBufferLimited;
+  health.hasTcpInfo           = false;
+#ifdef __linux__
+  tcp_info  info{};
+  socklen_t infoSize = sizeof(info);
+  if (::getsockopt(m_pSockRecord->socket(), IPPROTO_TCP, TCP_INFO, &info, &infoSize) == 0)
+  {
+    health.hasTcpInfo            = true;
+    health.connected             = health.connected && (info.tcpi_state == TCP_ESTABLISHED);
+    health.rtt                   = std::chrono::microseconds(info.tcpi_rtt);
+    health.rttVariance           = std::chrono::microseconds(info.tcpi_rttvar);
+    health.receiveRtt            = std::chrono::microseconds(info.tcpi_rcv_rtt);
+    health.lastKernelReceiveTime =
+      std::chrono::steady_clock::now() - std::chrono::milliseconds(info.tcpi_last_data_recv);
+    health.totalRetransmits      = info.tcpi_total_retrans;
+    health.pendingRetransmits    = info.tcpi_retransmits;
+    health.keepAliveProbes       = info.tcpi_probes;
+  }
+  int       receiveBufferSize     = 0;
+  socklen_t receiveBufferSizeSize = sizeof(receiveBufferSize);
+  if (::getsockopt(m_pSockRecord->socket(), SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, &receiveBufferSizeSize) == 0)
+  {
+    health.receiveBufferSize = static_cast<std::size_t>(receiveBufferSize);
+  }
+#endif
+  return true;
+}
+
 int TcpSocket::getLastError()
 {
   int error_code;
@@ -44,17 +44,27 @@ std::shared_ptr<VisionaryData> VisionaryControl::createDataHandler() const
   throw std::runtime_error("Unknown Visionary type");
 }
 
-std::unique_ptr<FrameGrabberBase> VisionaryControl::createFrameGrabber()
+std::unique_ptr<FrameGrabberBase> VisionaryControl::createFrameGrabber(const PipelineOptions& pipelineOptions)
+{
+  // if the configuration cannot be read, the default data sets are assumed
+  BlobStreamConfig config;
+  (void)getBlobStreamConfig(config);
+
+  return createFrameGrabber(SocketOptions::blobStream(estimateFrameSize(m_visionaryType, config)), pipelineOptions);
+}
+
+std::unique_ptr<FrameGrabberBase> VisionaryControl::createFrameGrabber(const SocketOptions&   socketOptions,
+                                                                        const PipelineOptions& pipelineOptions)
 {
   switch (m_visionaryType)
   {
     case VisionaryType::eVisionaryS:
       return std::unique_ptr<FrameGrabberBase>(
-        new FrameGrabberBase(*this, m_hostname, getBlobPort(), m_sessionTimeout));
+        new FrameGrabberBase(*this, m_hostname, getBlobPort(), m_sessionTimeout, socketOptions, pipelineOptions));
 
     case VisionaryType::eVisionaryTMini:
       return std::unique_ptr<FrameGrabberBase>(
-        new FrameGrabberBase(*this, m_hostname, getBlobPort(), m_sessionTimeout));
+        new FrameGrabberBase(*this, m_hostname, getBlobPort(), m_sessionTimeout, socketOptions, pipelineOptions));
   }
   throw std::runtime_error("Unknown Visionary type");
 }
@@ -62,12 +72,14 @@ std::unique_ptr<FrameGrabberBase> VisionaryControl::createFrameGrabber()
 bool VisionaryControl::open(const std::string&        hostname,
                             std::chrono::seconds      sessionTimeout,
                             bool                      autoReconnect,
-                            std::chrono::milliseconds connectTimeout)
+                            std::chrono::milliseconds connectTimeout,
+                            const SocketOptions&      socketOptions)
 {
   m_hostname         = hostname;
   m_sessionTimeout   = sessionTimeout;
   m_connectTimeout   = connectTimeout;
   m_autoReconnect    = autoReconnect;
+  m_socketOptions    = socketOptions;
   m_pProtocolHandler = nullptr;
   m_pTransport       = nullptr;
 
@@ -91,7 +103,7 @@ bool VisionaryControl::open(const std::string&        hostname,
       throw std::runtime_error("Unknown Visionary type");
   }
 
-  if (pTransport->connect(hostname, m_controlPort, connectTimeout) != 0)
+  if (pTransport->connect(hostname, m_controlPort, connectTimeout, socketOptions) != 0)
   {
     return false;
   }
@@ -216,6 +228,66 @@ bool VisionaryControl::getDataStreamConfig()
   return response.getError() == CoLaError::OK;
 }
 
+namespace {
+
+// device variables enabling the data sets of the Visionary-T Mini blob stream
+const char kDepthMapVariable[]  = "enDepthAPI";
+const char kPolar2DVariable[]   = "enPolar2DAPI";
+const char kCartesianVariable[] = "enCartesianAPI";
+
+} // namespace
+
+bool VisionaryControl::getBlobStreamConfig(BlobStreamConfig& config)
+{
+  if (m_visionaryType != VisionaryType::eVisionaryTMini)
+  {
+    config = BlobStreamConfig();
+    return true;
+  }
+
+  BlobStreamConfig deviceConfig;
+  if (!readBoolVariable(kDepthMapVariable, deviceConfig.depthMap)
+      || !readBoolVariable(kPolar2DVariable, deviceConfig.polar2D)
+      || !readBoolVariable(kCartesianVariable, deviceConfig.cartesian))
+  {
+    return false;
+  }
+  config = deviceConfig;
+  return true;
+}
+
+bool VisionaryControl::setBlobStreamConfig(const BlobStreamConfig& config)
+{
+  if (m_visionaryType != VisionaryType::eVisionaryTMini)
+  {
+    // the image maps cannot be disabled and there are no other data sets
+    return config.depthMap && !config.polar2D && !config.cartesian;
+  }
+
+  return writeBoolVariable(kDepthMapVariable, config.depthMap) && writeBoolVariable(kPolar2DVariable, config.polar2D)
+         && writeBoolVariable(kCartesianVariable, config.cartesian);
+}
+
+bool VisionaryControl::readBoolVariable(const char* name, bool& value)
+{
+  const CoLaCommand command  = CoLaParameterWriter(CoLaCommandType::READ_VARIABLE, name).build();
+  CoLaCommand       response = sendCommand(command);
+  if (response.getError() != CoLaError::OK)
+  {
+    return false;
+  }
+  value = CoLaParameterReader(response).readBool();
+  return true;
+}
+
+bool VisionaryControl::writeBoolVariable(const char* name, bool value)
+{
+  const CoLaCommand command  = CoLaParameterWriter(CoLaCommandType::WRITE_VARIABLE, name).parameterBool(value).build();
+  CoLaCommand       response = sendCommand(command);
+
+  return response.getError() == CoLaError::OK;
+}
+
 CoLaCommand VisionaryControl::sendCommand(const CoLaCommand& command)
 {
   CoLaCommand response =
@@ -228,7 +300,7 @@ CoLaCommand VisionaryControl::sendCommand(const CoLaCommand& command)
     {
       m_pTransport->shutdown();
     }
-    const bool success = open(m_hostname, m_sessionTimeout, m_autoReconnect, m_connectTimeout);
+    const bool success = open(m_hostname, m_sessionTimeout, m_autoReconnect, m_connectTimeout, m_socketOptions);
     if (success)
     {
       response = m_pControlSession->send(command);
@@ -11,11 +11,14 @@
 #include <chrono>
 #include <cmath>
 #include <cstddef> // for size_t
-#include <ctime>
+#include <cstring>
 #include <iostream>
 #include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
+
+#include "VisionaryEndian.h"
 
 namespace visionary {
 
@@ -25,8 +28,25 @@ VisionaryData::VisionaryData()
   : m_scaleZ(0.0f)
   , m_changeCounter(0u)
   , m_frameNum(0u)
+  , m_mapSelection(MapSelection::ALL)
+  , m_crcValidation(CrcAlgorithm::NONE)
+  , m_frameFilter()
+  , m_frameMetadata()
+  , m_frameRejected(false)
+  , m_dataSetVersion(0u)
   , m_blobTimestamp(0u)
+  , m_timestampMS(0u)
+  , m_hostTimestamp()
+  , m_kernelReceiveTimestamp()
   , m_preCalcCamInfoType(VisionaryData::UNKNOWN)
+  , m_frameTimestamps()
+  , m_binaryPhase(BINARY_COLLECT)
+  , m_binaryLength(0u)
+  , m_binaryReceived(0u)
+  , m_binaryDataLength(0u)
+  , m_mapIndex(0u)
+  , m_mapOffset(0u)
+  , m_binaryCrc(0u)
 {
   m_cameraParams.width  = 0;
   m_cameraParams.height = 0;
@@ -61,6 +81,223 @@ std::size_t VisionaryData::getItemLength(const std::string& dataType)
   return 0;
 }
 
+void VisionaryData::beginBinaryData(std::size_t length)
+{
+  m_binaryPhase      = BINARY_HEADER;
+  m_binaryLength     = length;
+  m_binaryReceived   = 0u;
+  m_binaryDataLength = 0u;
+  m_binaryCollected.clear();
+  m_mapDestinations.clear();
+  m_mapIndex  = 0u;
+  m_mapOffset = 0u;
+  m_binaryCrc = 0u;
+}
+
+bool VisionaryData::continueBinaryData(const std::uint8_t* pData, std::size_t size)
+{
+  m_binaryReceived += size;
+  if (m_binaryReceived > m_binaryLength)
+  {
+    std::cout << "Malformed data, more binary data received than announced." << '\n';
+    m_binaryPhase = BINARY_FAILED;
+  }
+
+  // Length(32bit) + TimeStamp(64bit) + version(16bit), for version > 1 followed by
+  // Framenumber(32bit) + dataQuality(8bit) + deviceStatus(8bit)
+  const std::size_t headerSize         = 4u + 8u + 2u;
+  const std::size_t extendedHeaderSize = 4u + 1u + 1u;
+  const std::size_t footerSize         = 4u + 4u; // CRC(32bit) + LengthCopy(32bit)
+
+  while (size > 0u)
+  {
+    switch (m_binaryPhase)
+    {
+      case BINARY_HEADER:
+      {
+        std::size_t needed = headerSize;
+        if (m_binaryCollected.size() >= headerSize
+            && readUnalignLittleEndian<std::uint16_t>(m_binaryCollected.data() + 12u) > 1u)
+        {
+          needed += extendedHeaderSize;
+        }
+        const std::size_t take = std::min(size, needed - m_binaryCollected.size());
+        m_binaryCollected.insert(m_binaryCollected.end(), pData, pData + take);
+        updateCrc(pData, take);
+        pData += take;
+        size -= take;
+        if (m_binaryCollected.size() == needed
+            && (needed > headerSize || readUnalignLittleEndian<std::uint16_t>(m_binaryCollected.data() + 12u) <= 1u))
+        {
+          startMaps();
+        }
+        break;
+      }
+      case BINARY_MAPS:
+      {
+        const MapDestination& destination = m_mapDestinations[m_mapIndex];
+        const std::size_t     take        = std::min(size, destination.numBytes - m_mapOffset);
+        if (destination.pData != nullptr)
+        {
+          std::memcpy(static_cast<std::uint8_t*>(destination.pData) + m_mapOffset, pData, take);
+        }
+        updateCrc(pData, take);
+        pData += take;
+        size -= take;
+        m_mapOffset += take;
+        if (m_mapOffset == destination.numBytes)
+        {
+          m_mapOffset = 0u;
+          if (++m_mapIndex == m_mapDestinations.size())
+          {
+            m_binaryPhase = BINARY_FOOTER;
+          }
+        }
+        break;
+      }
+      case BINARY_FOOTER:
+      {
+        const std::size_t take = std::min(size, footerSize - m_binaryCollected.size());
+        m_binaryCollected.insert(m_binaryCollected.end(), pData, pData + take);
+        pData += take;
+        size -= take;
+        if (m_binaryCollected.size() == footerSize)
+        {
+          m_binaryPhase = BINARY_TRAILER;
+        }
+        break;
+      }
+      case BINARY_COLLECT:
+        m_binaryCollected.insert(m_binaryCollected.end(), pData, pData + size);
+        size = 0u;
+        break;
+      case BINARY_TRAILER:
+      case BINARY_FAILED:
+        size = 0u;
+        break;
+    }
+  }
+  return m_binaryPhase != BINARY_FAILED;
+}
+
+void VisionaryData::startMaps()
+{
+  // the maps are copied as they are, which needs a host with the little endian byte order of the blob
+  const std::uint16_t byteOrderProbe = 1u;
+  const bool          littleEndian   = *reinterpret_cast<const std::uint8_t*>(&byteOrderProbe) == 1u;
+
+  if (!littleEndian || !canPrepareMapDestinations())
+  {
+    // keep the collected header and let parseBinaryData() handle the data part
+    m_binaryPhase = BINARY_COLLECT;
+    return;
+  }
+
+  const std::uint8_t* pHeader = m_binaryCollected.data();
+  const auto          length  = readUnalignLittleEndian<std::uint32_t>(pHeader);
+  if (length > m_binaryLength)
+  {
+    std::cout << "Malformed data, length in depth map header does not match package size." << '\n';
+    m_binaryPhase = BINARY_FAILED;
+    return;
+  }
+
+  m_binaryDataLength = length;
+  setBlobTimestamp(readUnalignLittleEndian<std::uint64_t>(pHeader + 4u));
+  m_dataSetVersion = readUnalignLittleEndian<std::uint16_t>(pHeader + 12u);
+
+  std::uint8_t dataQuality  = 0u;
+  std::uint8_t deviceStatus = 0u;
+  if (m_dataSetVersion > 1u)
+  {
+    m_frameNum   = readUnalignLittleEndian<std::uint32_t>(pHeader + 14u);
+    dataQuality  = pHeader[18u];
+    deviceStatus = pHeader[19u];
+  }
+  else
+  {
+    ++m_frameNum;
+  }
+  // a rejected frame leaves the maps alone, like in parseBinaryData()
+  if (!acceptFrame(dataQuality, deviceStatus))
+  {
+    m_binaryPhase = BINARY_FAILED;
+    return;
+  }
+
+  m_mapDestinations.clear();
+  if (!prepareMapDestinations(m_mapDestinations))
+  {
+    // the frame was accepted already, so parseBinaryData() must not run on it again
+    m_binaryPhase = BINARY_FAILED;
+    return;
+  }
+  std::size_t imageSetSize = 0u;
+  for (const auto& destination : m_mapDestinations)
+  {
+    imageSetSize += destination.numBytes;
+  }
+  if (m_binaryLength < m_binaryCollected.size() + imageSetSize)
+  {
+    std::cout << "Malformed data. Did not receive enough data to parse images of binary segment" << '\n';
+    m_binaryPhase = BINARY_FAILED;
+    return;
+  }
+
+  // skip empty maps
+  m_mapDestinations.erase(std::remove_if(m_mapDestinations.begin(),
+                                         m_mapDestinations.end(),
+                                         [](const MapDestination& destination) { return destination.numBytes == 0u; }),
+                          m_mapDestinations.end());
+  m_binaryCollected.clear();
+  m_binaryPhase = m_mapDestinations.empty() ? BINARY_FOOTER : BINARY_MAPS;
+}
+
+bool VisionaryData::endBinaryData()
+{
+  switch (m_binaryPhase)
+  {
+    case BINARY_HEADER:
+      // too short for a header, parseBinaryData() decides whether this is valid
+    case BINARY_COLLECT:
+      return parseBinaryData(m_binaryCollected.begin(), m_binaryCollected.size());
+    case BINARY_MAPS:
+      std::cout << "Malformed data. Did not receive enough data to parse images of binary segment" << '\n';
+      return false;
+    case BINARY_FOOTER:
+      std::cout << "Malformed data. Did not receive enough data to parse footer of binary segment" << '\n';
+      return false;
+    case BINARY_TRAILER:
+      break;
+    case BINARY_FAILED:
+      return false;
+  }
+
+  if (!compareCrc(m_binaryCrc, readUnalignLittleEndian<std::uint32_t>(m_binaryCollected.data())))
+  {
+    return false;
+  }
+  const auto lengthCopy = readUnalignLittleEndian<std::uint32_t>(m_binaryCollected.data() + 4u);
+  if (m_binaryDataLength != lengthCopy)
+  {
+    std::cout << "Malformed data, length in header(" << m_binaryDataLength << ") does not match package size("
+              << lengthCopy << ")." << '\n';
+    return false;
+  }
+  return true;
+}
+
+bool VisionaryData::canPrepareMapDestinations() const
+{
+  return false;
+}
+
+bool VisionaryData::prepareMapDestinations(std::vector<MapDestination>& destinations)
+{
+  (void)destinations;
+  return false;
+}
+
 void VisionaryData::preCalcCamInfo(const ImageType& imgType)
 {
   // Unknown image type for the point cloud transformation
@@ -175,6 +412,106 @@ void VisionaryData::generatePointCloud(const std::vector<uint16_t>& map,
   return;
 }
 
+std::size_t VisionaryData::generatePackedPointCloud(const PointCloudLayout&, void*, std::size_t)
+{
+  return 0u;
+}
+
+std::size_t VisionaryData::generatePackedPointCloud(const std::vector<std::uint16_t>& map,
+                                                    const ImageType&                  imgType,
+                                                    const PointCloudLayout&           layout,
+                                                    void*                             pBuffer,
+                                                    std::size_t                       bufferSize)
+{
+  if (!layout.isValid())
+  {
+    throw std::invalid_argument("Invalid point cloud layout");
+  }
+  const std::size_t cloudSize = map.size();
+  if (layout.getBufferSize(cloudSize) > bufferSize)
+  {
+    throw std::invalid_argument("Point cloud buffer too small");
+  }
+
+  // Calculate disortion data from XML metadata once.
+  if (m_preCalcCamInfoType != imgType)
+  {
+    preCalcCamInfo(imgType);
+  }
+
+  const auto  f2rc       = static_cast<float>(m_cameraParams.f2rc / 1000.f); // PointCloud should be in [m]
+  const float pixelSizeZ = m_scaleZ;
+
+  // frames without intensities or colors write the neutral values
+  const std::vector<std::uint16_t>& intensityMap   = getIntensityMap();
+  const std::vector<std::uint32_t>& rgbaMap        = getRGBAMap();
+  const bool                        hasIntensity   = intensityMap.size() == cloudSize;
+  const bool                        hasRgba        = rgbaMap.size() == cloudSize;
+  const bool                        intensityAsU16 = layout.intensityType == PointFieldType::UINT16;
+
+  std::uint8_t* pPoint    = static_cast<std::uint8_t*>(pBuffer);
+  std::size_t   numPoints = 0u;
+  for (std::size_t i = 0u; i < cloudSize; ++i)
+  {
+    const std::uint16_t value   = map[i];
+    const bool          invalid = value == 0u || value == std::uint16_t(0xFFFF);
+    if (invalid && layout.isDense)
+    {
+      continue;
+    }
+
+    float xyz[3];
+    if (invalid)
+    {
+      xyz[0] = kBadPoint;
+      xyz[1] = kBadPoint;
+      xyz[2] = kBadPoint;
+    }
+    else
+    {
+      const PointXYZ& undistorted = m_preCalcCamInfo[i];
+      const float     distance    = static_cast<float>(value) * pixelSizeZ;
+      xyz[0]                      = undistorted.x * distance;
+      xyz[1]                      = undistorted.y * distance;
+      xyz[2]                      = undistorted.z * distance - f2rc;
+    }
+    std::memcpy(pPoint + layout.xyzOffset, xyz, sizeof(xyz));
+
+    if (layout.hasIntensity)
+    {
+      const std::uint16_t intensity = hasIntensity ? intensityMap[i] : std::uint16_t(0u);
+      if (intensityAsU16)
+      {
+        std::memcpy(pPoint + layout.intensityOffset, &intensity, sizeof(intensity));
+      }
+      else
+      {
+        const auto intensityFloat = static_cast<float>(intensity);
+        std::memcpy(pPoint + layout.intensityOffset, &intensityFloat, sizeof(intensityFloat));
+      }
+    }
+    if (layout.hasRgba)
+    {
+      // the map holds the bytes R, G, B, A, the field is packed as 0xAARRGGBB
+      std::uint32_t packed = 0xFFFFFFFFu;
+      if (hasRgba)
+      {
+        const auto          pRgba = reinterpret_cast<const std::uint8_t*>(&rgbaMap[i]);
+        const std::uint32_t red   = pRgba[0];
+        const std::uint32_t green = pRgba[1];
+        const std::uint32_t blue  = pRgba[2];
+        const std::uint32_t alpha = pRgba[3];
+        packed                    = (alpha << 24u) | (red << 16u) | (green << 8u) | blue;
+      }
+      std::memcpy(pPoint + layout.rgbaOffset, &packed, sizeof(packed));
+    }
+
+    pPoint += layout.pointStep;
+    ++numPoints;
+  }
+  return numPoints;
+}
+
 void VisionaryData::transformPointCloud(std::vector<PointXYZ>& pointCloud) const
 {
   // turn cam 2 world translations from [m] to [mm]
@@ -212,6 +549,11 @@ uint32_t VisionaryData::getFrameNum() const
   return m_frameNum;
 }
 
+uint16_t VisionaryData::getDataSetVersion() const
+{
+  return m_dataSetVersion;
+}
+
 uint64_t VisionaryData::getTimestamp() const
 {
   return m_blobTimestamp;
@@ -219,22 +561,52 @@ uint64_t VisionaryData::getTimestamp() const
 
 uint64_t VisionaryData::getTimestampMS() const
 {
-  std::tm tm{};
-  tm.tm_sec   = static_cast<int>((m_blobTimestamp & BITMASK_SECOND) >> 10);
-  tm.tm_min   = static_cast<int>((m_blobTimestamp & BITMASK_MINUTE) >> 16);
-  tm.tm_hour  = static_cast<int>((m_blobTimestamp & BITMASK_HOUR) >> 22);
-  tm.tm_mday  = static_cast<int>((m_blobTimestamp & BITMASK_DAY) >> 38);
-  tm.tm_mon   = static_cast<int>(((m_blobTimestamp & BITMASK_MONTH) >> 43) - 1u);
-  tm.tm_year  = static_cast<int>(((m_blobTimestamp & BITMASK_YEAR) >> 47u) - 1900);
-  tm.tm_isdst = -1; // Use DST value from local time zone
-#ifdef _WIN32
-  auto seconds{std::chrono::seconds{::_mkgmtime(&tm)}};
-#else
-  auto seconds{std::chrono::seconds{::timegm(&tm)}};
-#endif
-  const uint64_t timestamp = static_cast<uint64_t>(seconds.count()) * 1000u + (m_blobTimestamp & BITMASK_MILLISECOND);
+  return m_timestampMS;
+}
+
+void VisionaryData::setBlobTimestamp(std::uint64_t blobTimestamp)
+{
+  m_blobTimestamp = blobTimestamp;
+
+  const auto second = static_cast<std::int64_t>((blobTimestamp & BITMASK_SECOND) >> 10);
+  const auto minute = static_cast<std::int64_t>((blobTimestamp & BITMASK_MINUTE) >> 16);
+  const auto hour   = static_cast<std::int64_t>((blobTimestamp & BITMASK_HOUR) >> 22);
+  const auto day    = static_cast<std::int64_t>((blobTimestamp & BITMASK_DAY) >> 38);
+  const auto month  = static_cast<std::int64_t>((blobTimestamp & BITMASK_MONTH) >> 43);
+  const auto year   = static_cast<std::int64_t>((blobTimestamp & BITMASK_YEAR) >> 47u);
+
+  // days since 1970-01-01 of the proleptic Gregorian calendar (H. Hinnant's days_from_civil), this replaces the
+  // comparatively expensive and platform dependent timegm/_mkgmtime
+  const std::int64_t y    = (month <= 2) ? year - 1 : year;
+  const std::int64_t era  = (y >= 0 ? y : y - 399) / 400;
+  const std::int64_t yoe  = y - era * 400;
+  const std::int64_t doy  = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  const std::int64_t doe  = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  const std::int64_t days = era * 146097 + doe - 719468;
+
+  const std::int64_t seconds = ((days * 24 + hour) * 60 + minute) * 60 + second;
+  m_timestampMS =
+    static_cast<std::uint64_t>(seconds) * 1000u + static_cast<std::uint64_t>(blobTimestamp & BITMASK_MILLISECOND);
+}
+
+std::chrono::steady_clock::time_point VisionaryData::getHostTimestamp() const
+{
+  return m_hostTimestamp;
+}
+
+void VisionaryData::setHostTimestamp(std::chrono::steady_clock::time_point timestamp)
+{
+  m_hostTimestamp = timestamp;
+}
+
+std::chrono::steady_clock::time_point VisionaryData::getKernelReceiveTimestamp() const
+{
+  return m_kernelReceiveTimestamp;
+}
 
-  return timestamp;
+void VisionaryData::setKernelReceiveTimestamp(std::chrono::steady_clock::time_point timestamp)
+{
+  m_kernelReceiveTimestamp = timestamp;
 }
 
 const CameraParameters& VisionaryData::getCameraParameters() const
@@ -242,6 +614,36 @@ const CameraParameters& VisionaryData::getCameraParameters() const
   return m_cameraParams;
 }
 
+float VisionaryData::getScaleZ() const
+{
+  return m_scaleZ;
+}
+
+bool VisionaryData::filterDepthMap(const DepthFilterConfig&)
+{
+  return false;
+}
+
+bool VisionaryData::filterDepthMap(const DepthFilterConfig&          config,
+                                   std::vector<std::uint16_t>&       map,
+                                   const std::vector<std::uint16_t>& stateMap)
+{
+  const auto width  = static_cast<std::uint32_t>(std::max(m_cameraParams.width, 0));
+  const auto height = static_cast<std::uint32_t>(std::max(m_cameraParams.height, 0));
+  if (map.empty() || map.size() != static_cast<std::size_t>(width) * height)
+  {
+    return false;
+  }
+  const std::vector<std::uint16_t>& intensityMap = getIntensityMap();
+  DepthFilter::apply(config,
+                     map.data(),
+                     width,
+                     height,
+                     (stateMap.size() == map.size()) ? stateMap.data() : nullptr,
+                     (intensityMap.size() == map.size()) ? intensityMap.data() : nullptr);
+  return true;
+}
+
 const std::vector<std::uint32_t>& VisionaryData::getRGBAMap() const
 {
   static const std::vector<std::uint32_t> empty;
@@ -254,4 +656,99 @@ const std::vector<std::uint16_t>& VisionaryData::getIntensityMap() const
   return empty;
 }
 
+const FrameTimestamps& VisionaryData::getFrameTimestamps() const
+{
+  return m_frameTimestamps;
+}
+
+void VisionaryData::setFrameTimestamp(FrameStage::Enum stage, FrameTimestamps::TimePoint timestamp)
+{
+  m_frameTimestamps.stage[stage] = timestamp;
+}
+
+void VisionaryData::setMapSelection(std::uint32_t selection)
+{
+  m_mapSelection = selection;
+}
+
+std::uint32_t VisionaryData::getMapSelection() const
+{
+  return m_mapSelection;
+}
+
+bool VisionaryData::isMapSelected(MapSelection::Enum map) const
+{
+  return (m_mapSelection & map) != 0u;
+}
+
+void VisionaryData::setCrcValidation(CrcAlgorithm::Enum algorithm)
+{
+  m_crcValidation = algorithm;
+}
+
+CrcAlgorithm::Enum VisionaryData::getCrcValidation() const
+{
+  return m_crcValidation;
+}
+
+bool VisionaryData::checkCrc(const std::uint8_t* pData, std::size_t size, std::uint32_t storedCrc) const
+{
+  if (m_crcValidation == CrcAlgorithm::NONE || storedCrc == 0u)
+  {
+    return true;
+  }
+  return compareCrc(Crc32::compute(m_crcValidation, pData, size), storedCrc);
+}
+
+void VisionaryData::updateCrc(const std::uint8_t* pData, std::size_t size)
+{
+  if (m_crcValidation != CrcAlgorithm::NONE)
+  {
+    m_binaryCrc = Crc32::compute(m_crcValidation, pData, size, m_binaryCrc);
+  }
+}
+
+bool VisionaryData::compareCrc(std::uint32_t computedCrc, std::uint32_t storedCrc) const
+{
+  if (m_crcValidation == CrcAlgorithm::NONE || storedCrc == 0u || computedCrc == storedCrc)
+  {
+    return true;
+  }
+  std::cout << "Malformed data, CRC of binary segment(" << std::hex << storedCrc << ") does not match the data("
+            << computedCrc << ")." << std::dec << '\n';
+  return false;
+}
+
+void VisionaryData::setFrameFilter(FrameFilter filter)
+{
+  m_frameFilter = std::move(filter);
+}
+
+const FrameMetadata& VisionaryData::getFrameMetadata() const
+{
+  return m_frameMetadata;
+}
+
+bool VisionaryData::isFrameRejected() const
+{
+  return m_frameRejected;
+}
+
+void VisionaryData::resetFrameRejected()
+{
+  m_frameRejected = false;
+}
+
+bool VisionaryData::acceptFrame(std::uint8_t dataQuality, std::uint8_t deviceStatus)
+{
+  m_frameMetadata.dataSetVersion = m_dataSetVersion;
+  m_frameMetadata.frameNum       = static_cast<std::uint32_t>(m_frameNum);
+  m_frameMetadata.timestampMS    = m_timestampMS;
+  m_frameMetadata.dataQuality    = dataQuality;
+  m_frameMetadata.deviceStatus   = deviceStatus;
+
+  m_frameRejected = m_frameFilter && !m_frameFilter(m_frameMetadata);
+  return !m_frameRejected;
+}
+
 } // namespace visionary
@@ -5,18 +5,67 @@
 
 #include "VisionaryDataStream.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstddef> // for size_t
 #include <cstdio>
 
 #include <iostream>
 
+#include "LatencyTrace.h"
 #include "VisionaryEndian.h"
 
 namespace visionary {
 
+class VisionaryDataStream::PackageReceiver
+{
+public:
+  PackageReceiver(ITransport& transport, ByteBuffer& buffer)
+    : m_transport(transport), m_buffer(buffer), m_received(0u), m_failed(false)
+  {
+  }
+
+  // Receives at least up to \a target bytes (limited to the package size), taking whatever else is available.
+  bool receiveUpTo(std::size_t target)
+  {
+    target = std::min(target, m_buffer.size());
+    while (!m_failed && m_received < target)
+    {
+      const auto retval = m_transport.recvInto(m_buffer.data() + m_received, m_buffer.size() - m_received);
+      if (retval <= 0)
+      {
+        m_failed = true;
+      }
+      else
+      {
+        m_received += static_cast<std::size_t>(retval);
+      }
+    }
+    return !m_failed;
+  }
+
+  std::size_t received() const
+  {
+    return m_received;
+  }
+
+  ByteBuffer& buffer()
+  {
+    return m_buffer;
+  }
+
+private:
+  ITransport& m_transport;
+  ByteBuffer& m_buffer;
+  std::size_t m_received;
+  bool        m_failed;
+};
+
 VisionaryDataStream::VisionaryDataStream(std::shared_ptr<VisionaryData> dataHandler)
   : m_dataHandler(std::move(dataHandler))
+  , m_receiveTimestamping(false)
+  , m_connectionLost(false)
+  , m_incrementalParsing(false)
 {
 }
 
@@ -25,18 +74,29 @@ VisionaryDataStream::~VisionaryDataStream()
   close();
 }
 
-bool VisionaryDataStream::open(const std::string& hostname, std::uint16_t port, std::chrono::milliseconds timeout)
+bool VisionaryDataStream::open(const std::string&        hostname,
+                               std::uint16_t             port,
+                               std::chrono::milliseconds timeout,
+                               const SocketOptions&      options)
 {
   m_pTransport = nullptr;
+  if (options.receiveTimestamps)
+  {
+    m_receiveTimestamping = true;
+  }
 
   std::unique_ptr<TcpSocket> pTransport(new TcpSocket());
 
-  if (pTransport->connect(hostname, port, timeout) != 0)
+  if (pTransport->connect(hostname, port, timeout, options) != 0)
   {
     return false;
   }
 
   m_pTransport = std::move(pTransport);
+  if (m_receiveTimestamping)
+  {
+    applyReceiveTimestamping();
+  }
 
   return true;
 }
@@ -44,6 +104,26 @@ bool VisionaryDataStream::open(const std::string& hostname, std::uint16_t port,
 bool VisionaryDataStream::open(std::unique_ptr<ITransport>& pTransport)
 {
   m_pTransport = std::move(pTransport);
+  if (m_receiveTimestamping)
+  {
+    applyReceiveTimestamping();
+  }
+  return true;
+}
+
+bool VisionaryDataStream::setReceiveTimestamping(bool enable)
+{
+  m_receiveTimestamping = enable;
+  return !m_pTransport || applyReceiveTimestamping();
+}
+
+bool VisionaryDataStream::applyReceiveTimestamping()
+{
+  if (!m_pTransport->setReceiveTimestamping(m_receiveTimestamping))
+  {
+    std::cout << "Kernel receive timestamps are not supported by the transport" << '\n';
+    return false;
+  }
   return true;
 }
 
@@ -80,40 +160,173 @@ bool VisionaryDataStream::syncCoLa() const
   return true;
 }
 
+void VisionaryDataStream::setIncrementalParsing(bool enable)
+{
+  m_incrementalParsing = enable;
+}
+
 bool VisionaryDataStream::getNextFrame()
 {
-  if (!syncCoLa())
+  if (m_dataHandler != nullptr)
+  {
+    m_dataHandler->resetFrameRejected();
+  }
+  if (m_incrementalParsing && m_dataHandler != nullptr)
+  {
+    if (!receiveFrameStart(m_rawFrame))
+    {
+      return false;
+    }
+    bool parsed = false;
+    if (!receiveAndParseBlob(m_rawFrame, *m_dataHandler, parsed))
+    {
+      m_statistics.onFrameFailed();
+      return false;
+    }
+    applyReceiveTimes(m_rawFrame, *m_dataHandler);
+    finishFrame(m_rawFrame, parsed, *m_dataHandler);
+    return parsed;
+  }
+
+  if (!receiveRawFrame(m_rawFrame))
+  {
+    return false;
+  }
+  if (m_dataHandler == nullptr)
   {
+    std::cout << "No datahandler is set -> cant parse blob data" << '\n';
+    m_statistics.onFrameFailed();
     return false;
   }
+  const bool parsed = parseRawFrame(m_rawFrame, *m_dataHandler);
+  finishFrame(m_rawFrame, parsed, *m_dataHandler);
+  return parsed;
+}
 
-  std::vector<std::uint8_t> buffer;
+bool VisionaryDataStream::receiveRawFrame(RawFrame& frame)
+{
+  if (!receiveFrameStart(frame))
+  {
+    return false;
+  }
+  if (!receiveBlob(frame))
+  {
+    m_statistics.onFrameFailed();
+    return false;
+  }
+  return true;
+}
+
+bool VisionaryDataStream::receiveFrameStart(RawFrame& frame)
+{
+  m_connectionLost = false;
+  if (!syncCoLa())
+  {
+    m_connectionLost = !m_pTransport->hasReceiveTimedOut();
+    return false;
+  }
+  // the read of the framing returned the first packet of the blob
+  frame.arrivalTime = StreamStatisticsCollector::Clock::now();
+  if (m_receiveTimestamping)
+  {
+    m_pTransport->getLastReceiveTimestamp(frame.arrivalTime);
+  }
+  VISIONARY_TRACE_STAGE_OF(frame, FrameStage::FIRST_BYTE_RECEIVED);
+  return true;
+}
 
-  // Read package length
-  if (m_pTransport->read(buffer, sizeof(std::uint32_t)) < static_cast<TcpSocket::recv_return_t>(sizeof(std::uint32_t)))
+bool VisionaryDataStream::receivePackageLength(std::uint32_t& packageLength)
+{
+  if (m_pTransport->read(m_lengthBuffer, sizeof(std::uint32_t))
+      < static_cast<TcpSocket::recv_return_t>(sizeof(std::uint32_t)))
   {
     std::cout << "Received less than the required 4 package length bytes." << '\n';
+    m_connectionLost = !m_pTransport->hasReceiveTimedOut();
     return false;
   }
 
-  const auto packageLength = readUnalignBigEndian<std::uint32_t>(buffer.data());
+  packageLength = readUnalignBigEndian<std::uint32_t>(m_lengthBuffer.data());
 
   if (packageLength < 3u)
   {
     std::cout << "Invalid package length " << packageLength << ". Should be at least 3" << '\n';
     return false;
   }
+  return true;
+}
 
-  // Receive the frame data
-  std::size_t remainingBytesToReceive = packageLength;
-  if (m_pTransport->read(buffer, remainingBytesToReceive)
+bool VisionaryDataStream::receiveBlob(RawFrame& frame)
+{
+  std::uint32_t packageLength = 0u;
+  if (!receivePackageLength(packageLength))
+  {
+    return false;
+  }
+
+  // Receive the frame data into the buffer kept from the previous frame, so it is only reallocated if a frame is
+  // larger than all frames before
+  const std::size_t remainingBytesToReceive = packageLength;
+  if (m_pTransport->read(frame.buffer, remainingBytesToReceive)
       < static_cast<ITransport::recv_return_t>(remainingBytesToReceive))
   {
     std::cout << "Received less than the required " << remainingBytesToReceive << " bytes." << '\n';
+    m_connectionLost = !m_pTransport->hasReceiveTimedOut();
     return false;
   }
+  completeReceive(frame, packageLength);
+  return true;
+}
 
-  // Check that protocol version and packet type are correct
+bool VisionaryDataStream::receiveAndParseBlob(RawFrame& frame, VisionaryData& dataHandler, bool& parsed)
+{
+  std::uint32_t packageLength = 0u;
+  if (!receivePackageLength(packageLength))
+  {
+    return false;
+  }
+
+  frame.buffer.resize(packageLength);
+  PackageReceiver receiver(*m_pTransport, frame.buffer);
+
+  parsed = parseWhileReceiving(receiver, dataHandler);
+
+  // also after a parse error the rest of the package has to be consumed
+  if (!receiver.receiveUpTo(packageLength))
+  {
+    std::cout << "Received less than the required " << packageLength << " bytes." << '\n';
+    m_connectionLost = !m_pTransport->hasReceiveTimedOut();
+    return false;
+  }
+  completeReceive(frame, packageLength);
+  return true;
+}
+
+void VisionaryDataStream::completeReceive(RawFrame& frame, std::uint32_t packageLength)
+{
+  VISIONARY_TRACE_STAGE_OF(frame, FrameStage::LAST_BYTE_RECEIVED);
+  if (!m_receiveTimestamping || !m_pTransport->getLastReceiveTimestamp(frame.kernelReceiveTime))
+  {
+    frame.kernelReceiveTime = std::chrono::steady_clock::time_point();
+  }
+  // 4 bytes sync and 4 bytes package length precede the package
+  m_statistics.onFrameReceived(8u + packageLength, frame.arrivalTime);
+}
+
+bool VisionaryDataStream::parseWhileReceiving(PackageReceiver& receiver, VisionaryData& dataHandler)
+{
+  const ByteBuffer& buffer = receiver.buffer();
+
+  // protocol version, packet type, blob id and number of segments
+  const std::size_t segmentTableStart = 3u + 4u;
+  if (buffer.size() < segmentTableStart)
+  {
+    std::cout << "Received not enough data to parse segment description. Connection issues?" << '\n';
+    return false;
+  }
+  if (!receiver.receiveUpTo(segmentTableStart))
+  {
+    return false;
+  }
   const auto protocolVersion = readUnalignBigEndian<std::uint16_t>(buffer.data());
   const auto packetType      = readUnalignBigEndian<std::uint8_t>(buffer.data() + 2);
   if (protocolVersion != 0x001)
@@ -126,16 +339,143 @@ bool VisionaryDataStream::getNextFrame()
     std::cout << "Received unknown packet type " << packetType << "." << '\n';
     return false;
   }
-  return parseSegmentBinaryData(buffer.begin() + 3, buffer.size() - 3u); // Skip protocolVersion and packetType
+  const auto numSegments = readUnalignBigEndian<std::uint16_t>(buffer.data() + 5);
+  if (numSegments < 3)
+  {
+    std::cout << "Invalid number of segments. Connection issues?" << '\n';
+    return false;
+  }
+
+  // offset and changedCounter, 4 bytes each per segment; only the XML and the binary segment are parsed
+  const std::size_t segmentTableEnd = segmentTableStart + static_cast<std::size_t>(numSegments) * 8u;
+  if (buffer.size() < segmentTableEnd)
+  {
+    std::cout << "Received not enough data to parse segment description. Connection issues?" << '\n';
+    return false;
+  }
+  if (!receiver.receiveUpTo(segmentTableEnd))
+  {
+    return false;
+  }
+  const std::uint8_t* pTable        = buffer.data() + segmentTableStart;
+  const auto          xmlOffset     = readUnalignBigEndian<std::uint32_t>(pTable);
+  const auto          changeCounter = readUnalignBigEndian<std::uint32_t>(pTable + 4);
+  const auto          binaryOffset  = readUnalignBigEndian<std::uint32_t>(pTable + 8);
+  const auto          binaryEnd     = readUnalignBigEndian<std::uint32_t>(pTable + 16);
+
+  // the offsets count from the blob id, behind protocol version and packet type
+  const std::size_t xmlStart    = 3u + xmlOffset;
+  const std::size_t binaryStart = 3u + binaryOffset;
+  const std::size_t binaryStop  = 3u + binaryEnd;
+  if (xmlOffset > binaryOffset || binaryStart > buffer.size())
+  {
+    std::cout << "Received not enough data to parse xml Description. Connection issues?" << '\n';
+    return false;
+  }
+  if (binaryOffset > binaryEnd || binaryStop > buffer.size())
+  {
+    std::cout << "Received not enough data to parse binary Segment. Connection issues?" << '\n';
+    return false;
+  }
+
+  //-----------------------------------------------
+  // First segment contains the XML Metadata
+  if (!receiver.receiveUpTo(binaryStart))
+  {
+    return false;
+  }
+  const std::string xmlSegment(buffer.begin() + static_cast<std::ptrdiff_t>(xmlStart),
+                               buffer.begin() + static_cast<std::ptrdiff_t>(binaryStart));
+  if (!dataHandler.parseXML(xmlSegment, changeCounter))
+  {
+    return false;
+  }
+  VISIONARY_TRACE_STAGE_OF(dataHandler, FrameStage::XML_PARSED);
+
+  //-----------------------------------------------
+  // Second segment contains Binary data, parsed in the pieces as they arrive
+  dataHandler.beginBinaryData(binaryStop - binaryStart);
+  std::size_t parsedUpTo = binaryStart;
+  while (parsedUpTo < binaryStop)
+  {
+    if (!receiver.receiveUpTo(parsedUpTo + 1u))
+    {
+      return false;
+    }
+    const std::size_t available = std::min(receiver.received(), binaryStop);
+    if (!dataHandler.continueBinaryData(buffer.data() + parsedUpTo, available - parsedUpTo))
+    {
+      return false;
+    }
+    parsedUpTo = available;
+  }
+  const bool result = dataHandler.endBinaryData();
+  VISIONARY_TRACE_STAGE_OF(dataHandler, FrameStage::BINARY_PARSED);
+  return result;
 }
 
-bool VisionaryDataStream::parseSegmentBinaryData(std::vector<std::uint8_t>::iterator itBuf, std::size_t bufferSize)
+void VisionaryDataStream::applyReceiveTimes(const RawFrame& frame, VisionaryData& dataHandler)
 {
-  if (m_dataHandler == nullptr)
+  dataHandler.setKernelReceiveTimestamp(frame.kernelReceiveTime);
+  dataHandler.setFrameTimestamp(FrameStage::FIRST_BYTE_RECEIVED,
+                                frame.timestamps.stage[FrameStage::FIRST_BYTE_RECEIVED]);
+  dataHandler.setFrameTimestamp(FrameStage::LAST_BYTE_RECEIVED, frame.timestamps.stage[FrameStage::LAST_BYTE_RECEIVED]);
+}
+
+bool VisionaryDataStream::parseRawFrame(RawFrame& frame, VisionaryData& dataHandler) const
+{
+  dataHandler.resetFrameRejected();
+  applyReceiveTimes(frame, dataHandler);
+
+  ByteBuffer& buffer = frame.buffer;
+  if (buffer.size() < 3u)
   {
-    std::cout << "No datahandler is set -> cant parse blob data" << '\n';
+    std::cout << "Invalid package length " << buffer.size() << ". Should be at least 3" << '\n';
+    return false;
+  }
+
+  // Check that protocol version and packet type are correct
+  const auto protocolVersion = readUnalignBigEndian<std::uint16_t>(buffer.data());
+  const auto packetType      = readUnalignBigEndian<std::uint8_t>(buffer.data() + 2);
+  if (protocolVersion != 0x001)
+  {
+    std::cout << "Received unknown protocol version " << protocolVersion << "." << '\n';
+    return false;
+  }
+  if (packetType != 0x62)
+  {
+    std::cout << "Received unknown packet type " << packetType << "." << '\n';
     return false;
   }
+  return parseSegmentBinaryData(
+    dataHandler, buffer.begin() + 3, buffer.size() - 3u); // Skip protocolVersion and packetType
+}
+
+void VisionaryDataStream::finishFrame(const RawFrame& frame, bool parsed, VisionaryData& dataHandler)
+{
+  if (!parsed)
+  {
+    if (dataHandler.isFrameRejected())
+    {
+      m_statistics.onFrameRejected(dataHandler.getDataSetVersion(), dataHandler.getFrameNum());
+    }
+    else
+    {
+      m_statistics.onFrameFailed();
+    }
+    return;
+  }
+  m_statistics.onFrameParsed(dataHandler.getDataSetVersion(), dataHandler.getFrameNum());
+
+  const auto deviceTimeMs = dataHandler.getTimestampMS();
+  m_clockSynchronizer.addSample(deviceTimeMs, frame.arrivalTime);
+  dataHandler.setHostTimestamp(m_clockSynchronizer.toHostTime(deviceTimeMs));
+}
+
+bool VisionaryDataStream::parseSegmentBinaryData(VisionaryData&                      dataHandler,
+                                                 std::vector<std::uint8_t>::iterator itBuf,
+                                                 std::size_t                         bufferSize)
+{
   bool result               = false;
   using ItBufDifferenceType = std::vector<std::uint8_t>::iterator::difference_type;
   auto itBufSegment         = itBuf;
@@ -190,8 +530,10 @@ bool VisionaryDataStream::parseSegmentBinaryData(std::vector<std::uint8_t>::iter
   remainingSize -= xmlSize;
   const std::string xmlSegment((itBuf + static_cast<ItBufDifferenceType>(offset[0])),
                                (itBuf + static_cast<ItBufDifferenceType>(offset[1])));
-  if (m_dataHandler->parseXML(xmlSegment, changeCounter[0]))
+  if (dataHandler.parseXML(xmlSegment, changeCounter[0]))
   {
+    VISIONARY_TRACE_STAGE_OF(dataHandler, FrameStage::XML_PARSED);
+
     //-----------------------------------------------
     // Second segment contains Binary data
     std::size_t binarySegmentSize = offset[2] - offset[1];
@@ -200,8 +542,9 @@ bool VisionaryDataStream::parseSegmentBinaryData(std::vector<std::uint8_t>::iter
       std::cout << "Received not enough data to parse binary Segment. Connection issues?" << '\n';
       return false;
     }
-    result = m_dataHandler->parseBinaryData((itBuf + static_cast<ItBufDifferenceType>(offset[1])), binarySegmentSize);
+    result = dataHandler.parseBinaryData((itBuf + static_cast<ItBufDifferenceType>(offset[1])), binarySegmentSize);
     remainingSize -= binarySegmentSize;
+    VISIONARY_TRACE_STAGE_OF(dataHandler, FrameStage::BINARY_PARSED);
   }
   return result;
 }
@@ -216,6 +559,42 @@ void VisionaryDataStream::setDataHandler(std::shared_ptr<VisionaryData> dataHand
   m_dataHandler = std::move(dataHandler);
 }
 
+StreamStatistics VisionaryDataStream::getStatistics() const
+{
+  return m_statistics.getStatistics();
+}
+
+StreamStatisticsCollector& VisionaryDataStream::getStatisticsCollector()
+{
+  return m_statistics;
+}
+
+bool VisionaryDataStream::setReceiveTimeout(std::chrono::milliseconds timeout)
+{
+  return m_pTransport && m_pTransport->setReceiveTimeout(timeout);
+}
+
+bool VisionaryDataStream::isConnectionLost() const
+{
+  return m_connectionLost;
+}
+
+ConnectionHealth VisionaryDataStream::getConnectionHealth() const
+{
+  ConnectionHealth health;
+  if (m_pTransport)
+  {
+    health.connected = !m_connectionLost;
+    m_pTransport->getConnectionHealth(health);
+  }
+  return health;
+}
+
+ClockSynchronizer& VisionaryDataStream::getClockSynchronizer()
+{
+  return m_clockSynchronizer;
+}
+
 bool VisionaryDataStream::isConnected() const
 {
   const std::vector<char> data{'B', 'l', 'b', 'R', 'q', 's', 't'};
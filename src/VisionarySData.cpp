@@ -128,7 +128,8 @@ bool VisionarySData::parseBinaryData(std::vector<uint8_t>::iterator itBuf, size_
   //-----------------------------------------------
   // The binary part starts with entries for length, a timestamp
   // and a version identifier
-  const auto length = readUnalignLittleEndian<uint32_t>(&*itBuf);
+  const auto itDataSet = itBuf;
+  const auto length    = readUnalignLittleEndian<uint32_t>(&*itBuf);
   if (length > size)
   {
     std::cout << "Malformed data, length in depth map header does not match package size." << '\n';
@@ -137,14 +138,17 @@ bool VisionarySData::parseBinaryData(std::vector<uint8_t>::iterator itBuf, size_
 
   itBuf += sizeof(uint32_t);
 
-  m_blobTimestamp = readUnalignLittleEndian<uint64_t>(&*itBuf);
+  setBlobTimestamp(readUnalignLittleEndian<uint64_t>(&*itBuf));
   itBuf += sizeof(uint64_t);
 
   const auto version = readUnalignLittleEndian<uint16_t>(&*itBuf);
   itBuf += sizeof(uint16_t);
+  m_dataSetVersion = version;
 
   //-----------------------------------------------
   // The content of the Data part inside a data set has changed since the first released version.
+  std::uint8_t dataQuality  = 0u;
+  std::uint8_t deviceStatus = 0u;
   if (version > 1)
   {
     const size_t extendedHeaderSize = 4u + 1u + 1u; // Framenumber(32bit) + dataQuality(8bit) + deviceStatus(8bit)
@@ -158,10 +162,10 @@ bool VisionarySData::parseBinaryData(std::vector<uint8_t>::iterator itBuf, size_
     m_frameNum = readUnalignLittleEndian<uint32_t>(&*itBuf);
     itBuf += sizeof(uint32_t);
 
-    // const uint8_t dataQuality = readUnalignLittleEndian<uint8_t>(&*itBuf);
+    dataQuality = readUnalignLittleEndian<uint8_t>(&*itBuf);
     itBuf += sizeof(uint8_t);
 
-    // const uint8_t deviceStatus = readUnalignLittleEndian<uint8_t>(&*itBuf);
+    deviceStatus = readUnalignLittleEndian<uint8_t>(&*itBuf);
     itBuf += sizeof(uint8_t);
   }
   else
@@ -169,6 +173,12 @@ bool VisionarySData::parseBinaryData(std::vector<uint8_t>::iterator itBuf, size_
     ++m_frameNum;
   }
 
+  // skip the map extraction of frames the application does not want
+  if (!acceptFrame(dataQuality, deviceStatus))
+  {
+    return false;
+  }
+
   //-----------------------------------------------
   // Extract the Images depending on the informations extracted from the XML part
   const auto imageSetSize = (numBytesZ + numBytesRGBA + numBytesConfidence);
@@ -178,16 +188,37 @@ bool VisionarySData::parseBinaryData(std::vector<uint8_t>::iterator itBuf, size_
     return false;
   }
   remainingSize -= imageSetSize;
-  m_zMap.resize(numPixel);
-  memcpy((m_zMap).data(), &*itBuf, numBytesZ);
+  if (isMapSelected(MapSelection::DEPTH))
+  {
+    m_zMap.resize(numPixel);
+    memcpy((m_zMap).data(), &*itBuf, numBytesZ);
+  }
+  else
+  {
+    releaseMap(m_zMap);
+  }
   std::advance(itBuf, numBytesZ);
 
-  m_rgbaMap.resize(numPixel);
-  memcpy((m_rgbaMap).data(), &*itBuf, numBytesRGBA);
+  if (isMapSelected(MapSelection::INTENSITY))
+  {
+    m_rgbaMap.resize(numPixel);
+    memcpy((m_rgbaMap).data(), &*itBuf, numBytesRGBA);
+  }
+  else
+  {
+    releaseMap(m_rgbaMap);
+  }
   std::advance(itBuf, numBytesRGBA);
 
-  m_stateMap.resize(numPixel);
-  memcpy((m_stateMap).data(), &*itBuf, numBytesConfidence);
+  if (isMapSelected(MapSelection::STATE))
+  {
+    m_stateMap.resize(numPixel);
+    memcpy((m_stateMap).data(), &*itBuf, numBytesConfidence);
+  }
+  else
+  {
+    releaseMap(m_stateMap);
+  }
   std::advance(itBuf, numBytesConfidence);
 
   const auto footerSize = (4u + 4u); // CRC(32bit) + LengthCopy(32bit)
@@ -198,8 +229,12 @@ bool VisionarySData::parseBinaryData(std::vector<uint8_t>::iterator itBuf, size_
   }
 
   //-----------------------------------------------
-  // Data ends with a (unused) 4 Byte CRC field and a copy of the length byte
-  // const uint32_t unusedCrc = readUnalignLittleEndian<uint32_t>(&*itBuf);
+  // Data ends with a 4 Byte CRC field (only checked if enabled) and a copy of the length byte
+  const auto crc = readUnalignLittleEndian<uint32_t>(&*itBuf);
+  if (!checkCrc(&*itDataSet, static_cast<size_t>(std::distance(itDataSet, itBuf)), crc))
+  {
+    return false;
+  }
   itBuf += sizeof(uint32_t);
 
   const auto lengthCopy = readUnalignLittleEndian<uint32_t>(&*itBuf);
@@ -214,11 +249,44 @@ bool VisionarySData::parseBinaryData(std::vector<uint8_t>::iterator itBuf, size_
   return true;
 }
 
+bool VisionarySData::canPrepareMapDestinations() const
+{
+  // parseBinaryData() reports invalid metadata
+  return m_cameraParams.height > 0 && m_cameraParams.width > 0 && m_zByteDepth == sizeof(std::uint16_t)
+         && m_rgbaByteDepth == sizeof(std::uint32_t) && m_confidenceByteDepth == sizeof(std::uint16_t);
+}
+
+bool VisionarySData::prepareMapDestinations(std::vector<MapDestination>& destinations)
+{
+  if (!canPrepareMapDestinations())
+  {
+    return false;
+  }
+  const size_t numPixel = static_cast<size_t>(m_cameraParams.width * m_cameraParams.height);
+
+  addMapDestination(m_zMap, MapSelection::DEPTH, numPixel, destinations);
+  addMapDestination(m_rgbaMap, MapSelection::INTENSITY, numPixel, destinations);
+  addMapDestination(m_stateMap, MapSelection::STATE, numPixel, destinations);
+  return true;
+}
+
 void VisionarySData::generatePointCloud(std::vector<PointXYZ>& pointCloud)
 {
   return VisionaryData::generatePointCloud(m_zMap, VisionaryData::PLANAR, pointCloud);
 }
 
+std::size_t VisionarySData::generatePackedPointCloud(const PointCloudLayout& layout,
+                                                     void*                   pBuffer,
+                                                     std::size_t             bufferSize)
+{
+  return VisionaryData::generatePackedPointCloud(m_zMap, VisionaryData::PLANAR, layout, pBuffer, bufferSize);
+}
+
+bool VisionarySData::filterDepthMap(const DepthFilterConfig& config)
+{
+  return VisionaryData::filterDepthMap(config, m_zMap, m_stateMap);
+}
+
 const std::vector<uint16_t>& VisionarySData::getZMap() const
 {
   return m_zMap;
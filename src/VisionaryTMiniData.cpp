@@ -38,10 +38,27 @@ static const boost::property_tree::ptree& empty_ptree()
   return t;
 }
 
+namespace {
+// Length(32bit) + TimeStamp(64bit) + DeviceID(16bit) + ScanCounter(32bit) + SysCountScan(32bit)
+// + ScanFrequency, MeasurementFrequency, AngleFirstScanPoint, AngularResolution, Scale, Offset (float each)
+constexpr std::size_t kPolarHeaderSize = 4u + 8u + 2u + 4u + 4u + 6u * 4u;
+// AngleFirstScanPoint, AngularResolution, Scale, Offset (float each)
+constexpr std::size_t kPolarRssiHeaderSize = 4u * 4u;
+// CRC(32bit) + LengthCopy(32bit)
+constexpr std::size_t kDataSetFooterSize = 4u + 4u;
+} // namespace
+
 const float VisionaryTMiniData::DISTANCE_MAP_UNIT = 0.25f;
 
 VisionaryTMiniData::VisionaryTMiniData()
-  : VisionaryData(), m_dataSetsActive(), m_distanceByteDepth(0), m_intensityByteDepth(0), m_stateByteDepth(0)
+  : VisionaryData()
+  , m_dataSetsActive()
+  , m_distanceByteDepth(0)
+  , m_intensityByteDepth(0)
+  , m_stateByteDepth(0)
+  , m_numPolarValues(0)
+  , m_polarStartAngle(0.0f)
+  , m_polarAngularResolution(0.0f)
 {
 }
 
@@ -75,7 +92,17 @@ bool VisionaryTMiniData::parseXML(const std::string& xmlString, uint32_t changeC
   //-----------------------------------------------
   // Extract information stored in XML with boost::property_tree
   const boost::property_tree::ptree dataSetsTree = xmlTree.get_child("SickRecord.DataSets", empty_ptree());
-  m_dataSetsActive.hasDataSetDepthMap = static_cast<bool>(dataSetsTree.get_child_optional("DataSetDepthMap"));
+  m_dataSetsActive.hasDataSetDepthMap  = static_cast<bool>(dataSetsTree.get_child_optional("DataSetDepthMap"));
+  m_dataSetsActive.hasDataSetPolar2D   = static_cast<bool>(dataSetsTree.get_child_optional("DataSetPolar2D"));
+  m_dataSetsActive.hasDataSetCartesian = static_cast<bool>(dataSetsTree.get_child_optional("DataSetCartesian"));
+
+  // DataSetPolar2D specific data
+  m_numPolarValues = 0u;
+  if (m_dataSetsActive.hasDataSetPolar2D)
+  {
+    m_numPolarValues =
+      dataSetsTree.get<std::size_t>("DataSetPolar2D.FormatDescription.DataStream.<xmlattr>.datalength", 0u);
+  }
 
   // DataSetDepthMap specific data
   {
@@ -127,7 +154,7 @@ bool VisionaryTMiniData::parseXML(const std::string& xmlString, uint32_t changeC
 
 bool VisionaryTMiniData::parseBinaryData(std::vector<uint8_t>::iterator itBuf, size_t size)
 {
-  if (m_cameraParams.height < 1 || m_cameraParams.width < 1)
+  if (m_dataSetsActive.hasDataSetDepthMap && (m_cameraParams.height < 1 || m_cameraParams.width < 1))
   {
     std::cout << __FUNCTION__ << ": Invalid image size" << '\n';
     return false;
@@ -153,7 +180,8 @@ bool VisionaryTMiniData::parseBinaryData(std::vector<uint8_t>::iterator itBuf, s
     //-----------------------------------------------
     // The binary part starts with entries for length, a timestamp
     // and a version identifier
-    const auto length = readUnalignLittleEndian<uint32_t>(&*itBuf);
+    const auto itDataSet = itBuf;
+    const auto length    = readUnalignLittleEndian<uint32_t>(&*itBuf);
     dataSetslength += length;
     if (dataSetslength > size)
     {
@@ -162,14 +190,17 @@ bool VisionaryTMiniData::parseBinaryData(std::vector<uint8_t>::iterator itBuf, s
     }
     itBuf += sizeof(uint32_t);
 
-    m_blobTimestamp = readUnalignLittleEndian<uint64_t>(&*itBuf);
+    setBlobTimestamp(readUnalignLittleEndian<uint64_t>(&*itBuf));
     itBuf += sizeof(uint64_t);
 
     const auto version = readUnalignLittleEndian<uint16_t>(&*itBuf);
     itBuf += sizeof(uint16_t);
+    m_dataSetVersion = version;
 
     //-----------------------------------------------
     // The content of the Data part inside a data set has changed since the first released version.
+    std::uint8_t dataQuality  = 0u;
+    std::uint8_t deviceStatus = 0u;
     if (version > 1)
     {
       const size_t extendedHeaderSize = 4u + 1u + 1u; // Framenumber(32bit) + dataQuality(8bit) + deviceStatus(8bit)
@@ -183,10 +214,10 @@ bool VisionaryTMiniData::parseBinaryData(std::vector<uint8_t>::iterator itBuf, s
       m_frameNum = readUnalignLittleEndian<uint32_t>(&*itBuf);
       itBuf += sizeof(uint32_t);
 
-      // const uint8_t dataQuality = readUnalignLittleEndian<uint8_t>(&*itBuf);
+      dataQuality = readUnalignLittleEndian<uint8_t>(&*itBuf);
       itBuf += sizeof(uint8_t);
 
-      // const uint8_t deviceStatus = readUnalignLittleEndian<uint8_t>(&*itBuf);
+      deviceStatus = readUnalignLittleEndian<uint8_t>(&*itBuf);
       itBuf += sizeof(uint8_t);
     }
     else
@@ -194,6 +225,12 @@ bool VisionaryTMiniData::parseBinaryData(std::vector<uint8_t>::iterator itBuf, s
       ++m_frameNum;
     }
 
+    // skip the map extraction of frames the application does not want
+    if (!acceptFrame(dataQuality, deviceStatus))
+    {
+      return false;
+    }
+
     //-----------------------------------------------
     // Extract the Images depending on the informations extracted from the XML part
     const auto imageSetSize = (numBytesDistance + numBytesIntensity + numBytesState);
@@ -203,74 +240,293 @@ bool VisionaryTMiniData::parseBinaryData(std::vector<uint8_t>::iterator itBuf, s
       return false;
     }
     remainingSize -= imageSetSize;
-    if (numBytesDistance != 0)
+    if (numBytesDistance != 0 && isMapSelected(MapSelection::DEPTH))
     {
       m_distanceMap.resize(numPixel);
       memcpy((m_distanceMap).data(), &*itBuf, numBytesDistance);
-      std::advance(itBuf, numBytesDistance);
     }
     else
     {
-      m_distanceMap.clear();
+      releaseMap(m_distanceMap);
     }
-    if (numBytesIntensity != 0)
+    std::advance(itBuf, numBytesDistance);
+    if (numBytesIntensity != 0 && isMapSelected(MapSelection::INTENSITY))
     {
       m_intensityMap.resize(numPixel);
       memcpy((m_intensityMap).data(), &*itBuf, numBytesIntensity);
-      std::advance(itBuf, numBytesIntensity);
     }
     else
     {
-      m_intensityMap.clear();
+      releaseMap(m_intensityMap);
     }
-    if (numBytesState != 0)
+    std::advance(itBuf, numBytesIntensity);
+    if (numBytesState != 0 && isMapSelected(MapSelection::STATE))
     {
       m_stateMap.resize(numPixel);
       memcpy((m_stateMap).data(), &*itBuf, numBytesState);
-      std::advance(itBuf, numBytesState);
     }
     else
     {
-      m_stateMap.clear();
+      releaseMap(m_stateMap);
     }
+    std::advance(itBuf, numBytesState);
 
-    const auto footerSize = (4u + 4u); // CRC(32bit) + LengthCopy(32bit)
-    if (remainingSize < footerSize)
+    //-----------------------------------------------
+    // Data ends with a 4 Byte CRC field (only checked if enabled) and a copy of the length byte
+    if (!parseDataSetFooter(itDataSet, itBuf, remainingSize, length))
     {
-      std::cout << "Malformed data. Did not receive enough data to parse footer of binary segment" << '\n';
       return false;
     }
+  }
+  else
+  {
+    // the frame information comes from the other data sets, the frame filter decides before anything is extracted
+    if (!parseFrameInfoWithoutDepthMap(itBuf, remainingSize) || !acceptFrame(0u, 0u))
+    {
+      return false;
+    }
+    releaseMap(m_distanceMap);
+    releaseMap(m_intensityMap);
+    releaseMap(m_stateMap);
+  }
 
-    //-----------------------------------------------
-    // Data ends with a (unused) 4 Byte CRC field and a copy of the length byte
-    // const uint32_t unusedCrc = readUnalignLittleEndian<uint32_t>(&*itBuf);
-    itBuf += sizeof(uint32_t);
-
-    const auto lengthCopy = readUnalignLittleEndian<uint32_t>(&*itBuf);
-    itBuf += sizeof(uint32_t);
+  if (m_dataSetsActive.hasDataSetPolar2D)
+  {
+    if (!parsePolar2DDataSet(itBuf, remainingSize))
+    {
+      return false;
+    }
+  }
+  else
+  {
+    releaseMap(m_polarDistanceData);
+    releaseMap(m_polarConfidenceData);
+  }
 
-    if (length != lengthCopy)
+  if (m_dataSetsActive.hasDataSetCartesian)
+  {
+    if (!parseCartesianDataSet(itBuf, remainingSize))
     {
-      std::cout << "Malformed data, length in header(" << length << ") does not match package size(" << lengthCopy
-                << ")." << '\n';
       return false;
     }
   }
   else
   {
-    m_distanceMap.clear();
-    m_intensityMap.clear();
-    m_stateMap.clear();
+    releaseMap(m_cartesianData);
   }
 
   return true;
 }
 
+bool VisionaryTMiniData::parseFrameInfoWithoutDepthMap(std::vector<uint8_t>::iterator itBuf,
+                                                       std::size_t                    remainingSize)
+{
+  // the polar 2D data set carries the scan counter of the device, the cartesian data set a version
+  const size_t  counterOffset  = 4u + 8u + 2u; // Length(32bit) + TimeStamp(64bit) + DeviceID(16bit)
+  const size_t  versionOffset  = 4u + 8u;      // Length(32bit) + TimeStamp(64bit)
+  size_t        dataSetOffset  = 0u;
+  bool          hasTimestamp   = false;
+  bool          hasFrameNum    = false;
+  std::uint16_t dataSetVersion = 1u;
+
+  if (m_dataSetsActive.hasDataSetPolar2D)
+  {
+    if (remainingSize < counterOffset + sizeof(uint32_t))
+    {
+      std::cout << "Malformed data. Did not receive enough data to parse header of polar 2D data set" << '\n';
+      return false;
+    }
+    setBlobTimestamp(readUnalignLittleEndian<uint64_t>(&*(itBuf + 4)));
+    m_frameNum    = readUnalignLittleEndian<uint32_t>(&*(itBuf + static_cast<std::ptrdiff_t>(counterOffset)));
+    hasTimestamp  = true;
+    hasFrameNum   = true;
+    dataSetOffset = kPolarHeaderSize + 2u * m_numPolarValues * sizeof(float) + kPolarRssiHeaderSize
+                    + kDataSetFooterSize;
+  }
+  if (m_dataSetsActive.hasDataSetCartesian)
+  {
+    if (remainingSize < dataSetOffset + versionOffset + sizeof(uint16_t))
+    {
+      std::cout << "Malformed data. Did not receive enough data to parse header of cartesian data set" << '\n';
+      return false;
+    }
+    const auto itDataSet = itBuf + static_cast<std::ptrdiff_t>(dataSetOffset);
+    if (!hasTimestamp)
+    {
+      setBlobTimestamp(readUnalignLittleEndian<uint64_t>(&*(itDataSet + 4)));
+    }
+    dataSetVersion = readUnalignLittleEndian<uint16_t>(&*(itDataSet + static_cast<std::ptrdiff_t>(versionOffset)));
+  }
+  if (!hasFrameNum)
+  {
+    ++m_frameNum;
+  }
+  m_dataSetVersion = dataSetVersion;
+  return true;
+}
+
+bool VisionaryTMiniData::parseDataSetFooter(std::vector<uint8_t>::iterator  itDataSet,
+                                            std::vector<uint8_t>::iterator& itBuf,
+                                            std::size_t&                    remainingSize,
+                                            std::uint32_t                   length)
+{
+  if (remainingSize < kDataSetFooterSize)
+  {
+    std::cout << "Malformed data. Did not receive enough data to parse footer of binary segment" << '\n';
+    return false;
+  }
+  remainingSize -= kDataSetFooterSize;
+
+  const auto crc = readUnalignLittleEndian<uint32_t>(&*itBuf);
+  if (!checkCrc(&*itDataSet, static_cast<size_t>(std::distance(itDataSet, itBuf)), crc))
+  {
+    return false;
+  }
+  itBuf += sizeof(uint32_t);
+
+  const auto lengthCopy = readUnalignLittleEndian<uint32_t>(&*itBuf);
+  itBuf += sizeof(uint32_t);
+
+  if (length != lengthCopy)
+  {
+    std::cout << "Malformed data, length in header(" << length << ") does not match package size(" << lengthCopy
+              << ")." << '\n';
+    return false;
+  }
+  return true;
+}
+
+bool VisionaryTMiniData::parsePolar2DDataSet(std::vector<uint8_t>::iterator& itBuf, std::size_t& remainingSize)
+{
+  const size_t numBytesValues = m_numPolarValues * sizeof(float);
+  if (remainingSize < kPolarHeaderSize + numBytesValues + kPolarRssiHeaderSize + numBytesValues)
+  {
+    std::cout << "Malformed data. Did not receive enough data to parse polar 2D data set" << '\n';
+    return false;
+  }
+  remainingSize -= kPolarHeaderSize + numBytesValues + kPolarRssiHeaderSize + numBytesValues;
+
+  const auto itDataSet = itBuf;
+  const auto length    = readUnalignLittleEndian<uint32_t>(&*itBuf);
+  itBuf += sizeof(uint32_t);
+
+  // TimeStamp, DeviceID, ScanCounter, SysCountScan, ScanFrequency, MeasurementFrequency
+  itBuf += sizeof(uint64_t) + sizeof(uint16_t) + 2u * sizeof(uint32_t) + 2u * sizeof(float);
+
+  m_polarStartAngle = readUnalignLittleEndian<float>(&*itBuf);
+  itBuf += sizeof(float);
+  m_polarAngularResolution = readUnalignLittleEndian<float>(&*itBuf);
+  itBuf += sizeof(float);
+  // Scale, Offset
+  itBuf += 2u * sizeof(float);
+
+  m_polarDistanceData.resize(m_numPolarValues);
+  memcpy(m_polarDistanceData.data(), &*itBuf, numBytesValues);
+  std::advance(itBuf, numBytesValues);
+
+  // the confidence values share the angles of the distance values
+  itBuf += kPolarRssiHeaderSize;
+
+  m_polarConfidenceData.resize(m_numPolarValues);
+  memcpy(m_polarConfidenceData.data(), &*itBuf, numBytesValues);
+  std::advance(itBuf, numBytesValues);
+
+  return parseDataSetFooter(itDataSet, itBuf, remainingSize, length);
+}
+
+static_assert(sizeof(PointXYZC) == 4u * sizeof(float), "PointXYZC must match the layout of the cartesian data set");
+
+bool VisionaryTMiniData::parseCartesianDataSet(std::vector<uint8_t>::iterator& itBuf, std::size_t& remainingSize)
+{
+  const size_t headerSize = 4u + 8u + 2u + 4u; // Length(32bit) + TimeStamp(64bit) + version(16bit) + NumPoints(32bit)
+  if (remainingSize < headerSize)
+  {
+    std::cout << "Malformed data. Did not receive enough data to parse header of cartesian data set" << '\n';
+    return false;
+  }
+  remainingSize -= headerSize;
+
+  const auto itDataSet = itBuf;
+  const auto length    = readUnalignLittleEndian<uint32_t>(&*itBuf);
+  itBuf += sizeof(uint32_t);
+
+  // TimeStamp(64bit), already taken by parseBinaryData()
+  itBuf += sizeof(uint64_t);
+
+  // const uint16_t version = readUnalignLittleEndian<uint16_t>(&*itBuf);
+  itBuf += sizeof(uint16_t);
+
+  const auto   numPoints      = readUnalignLittleEndian<uint32_t>(&*itBuf);
+  const size_t numBytesPoints = static_cast<size_t>(numPoints) * sizeof(PointXYZC);
+  itBuf += sizeof(uint32_t);
+
+  if (remainingSize < numBytesPoints)
+  {
+    std::cout << "Malformed data. Did not receive enough data to parse cartesian data set" << '\n';
+    return false;
+  }
+  remainingSize -= numBytesPoints;
+
+  // x, y, z and confidence as float each, in the layout of PointXYZC
+  m_cartesianData.resize(numPoints);
+  memcpy(m_cartesianData.data(), &*itBuf, numBytesPoints);
+  std::advance(itBuf, numBytesPoints);
+
+  return parseDataSetFooter(itDataSet, itBuf, remainingSize, length);
+}
+
+bool VisionaryTMiniData::canPrepareMapDestinations() const
+{
+  // parseBinaryData() handles invalid metadata, blobs without depth map and blobs with further data sets
+  const auto isSupported = [](std::size_t byteDepth) {
+    return byteDepth == 0u || byteDepth == sizeof(std::uint16_t);
+  };
+  return m_cameraParams.height > 0 && m_cameraParams.width > 0 && m_dataSetsActive.hasDataSetDepthMap
+         && !m_dataSetsActive.hasDataSetPolar2D && !m_dataSetsActive.hasDataSetCartesian
+         && isSupported(m_distanceByteDepth) && isSupported(m_intensityByteDepth) && isSupported(m_stateByteDepth);
+}
+
+bool VisionaryTMiniData::prepareMapDestinations(std::vector<MapDestination>& destinations)
+{
+  if (!canPrepareMapDestinations())
+  {
+    return false;
+  }
+  const size_t numPixel = static_cast<size_t>(m_cameraParams.width * m_cameraParams.height);
+
+  const auto addMap = [&](std::vector<std::uint16_t>& map, std::size_t byteDepth, MapSelection::Enum selection) {
+    if (byteDepth == 0u)
+    {
+      releaseMap(map);
+    }
+    else
+    {
+      addMapDestination(map, selection, numPixel, destinations);
+    }
+  };
+  addMap(m_distanceMap, m_distanceByteDepth, MapSelection::DEPTH);
+  addMap(m_intensityMap, m_intensityByteDepth, MapSelection::INTENSITY);
+  addMap(m_stateMap, m_stateByteDepth, MapSelection::STATE);
+  return true;
+}
+
 void VisionaryTMiniData::generatePointCloud(std::vector<PointXYZ>& pointCloud)
 {
   return VisionaryData::generatePointCloud(m_distanceMap, VisionaryData::RADIAL, pointCloud);
 }
 
+std::size_t VisionaryTMiniData::generatePackedPointCloud(const PointCloudLayout& layout,
+                                                         void*                   pBuffer,
+                                                         std::size_t             bufferSize)
+{
+  return VisionaryData::generatePackedPointCloud(m_distanceMap, VisionaryData::RADIAL, layout, pBuffer, bufferSize);
+}
+
+bool VisionaryTMiniData::filterDepthMap(const DepthFilterConfig& config)
+{
+  return VisionaryData::filterDepthMap(config, m_distanceMap, m_stateMap);
+}
+
 const std::vector<uint16_t>& VisionaryTMiniData::getDistanceMap() const
 {
   return m_distanceMap;
@@ -286,4 +542,34 @@ const std::vector<uint16_t>& VisionaryTMiniData::getStateMap() const
   return m_stateMap;
 }
 
+const DataSetsActive& VisionaryTMiniData::getDataSetsActive() const
+{
+  return m_dataSetsActive;
+}
+
+const std::vector<float>& VisionaryTMiniData::getPolarDistanceData() const
+{
+  return m_polarDistanceData;
+}
+
+const std::vector<float>& VisionaryTMiniData::getPolarConfidenceData() const
+{
+  return m_polarConfidenceData;
+}
+
+float VisionaryTMiniData::getPolarStartAngle() const
+{
+  return m_polarStartAngle;
+}
+
+float VisionaryTMiniData::getPolarAngularResolution() const
+{
+  return m_polarAngularResolution;
+}
+
+const std::vector<PointXYZC>& VisionaryTMiniData::getCartesianData() const
+{
+  return m_cartesianData;
+}
+
 } // namespace visionary
@@ -0,0 +1,49 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include "gtest/gtest.h"
+
+#include "BlobStreamConfig.h"
+
+using namespace visionary;
+
+TEST(BlobStreamConfigTest, DefaultCoversImageMaps)
+{
+  const std::size_t sFrameSize     = estimateFrameSize(VisionaryType::eVisionaryS);
+  const std::size_t tMiniFrameSize = estimateFrameSize(VisionaryType::eVisionaryTMini);
+
+  EXPECT_GT(sFrameSize, 640u * 512u * (2u + 4u + 2u));
+  EXPECT_LT(sFrameSize, 640u * 512u * (2u + 4u + 2u) + 16u * 1024u);
+  EXPECT_GT(tMiniFrameSize, 512u * 424u * (2u + 2u + 2u));
+  EXPECT_LT(tMiniFrameSize, 512u * 424u * (2u + 2u + 2u) + 16u * 1024u);
+}
+
+TEST(BlobStreamConfigTest, DisabledDataSetsShrinkTheFrame)
+{
+  BlobStreamConfig polarOnly;
+  polarOnly.depthMap = false;
+  polarOnly.polar2D  = true;
+
+  BlobStreamConfig all;
+  all.polar2D   = true;
+  all.cartesian = true;
+
+  const std::size_t defaultSize   = estimateFrameSize(VisionaryType::eVisionaryTMini);
+  const std::size_t polarOnlySize = estimateFrameSize(VisionaryType::eVisionaryTMini, polarOnly);
+  const std::size_t allSize       = estimateFrameSize(VisionaryType::eVisionaryTMini, all);
+
+  EXPECT_LT(polarOnlySize, 16u * 1024u);
+  EXPECT_LT(polarOnlySize, defaultSize);
+  // the cartesian data set carries 16 bytes per point
+  EXPECT_GT(allSize, defaultSize + 512u * 424u * 16u);
+}
+
+TEST(BlobStreamConfigTest, VisionarySIgnoresTMiniDataSets)
+{
+  BlobStreamConfig config;
+  config.polar2D   = true;
+  config.cartesian = true;
+
+  EXPECT_EQ(estimateFrameSize(VisionaryType::eVisionaryS), estimateFrameSize(VisionaryType::eVisionaryS, config));
+}
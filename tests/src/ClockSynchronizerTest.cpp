@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <chrono>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+#include "ClockSynchronizer.h"
+#include "VisionaryTMiniData.h"
+
+using namespace visionary;
+using Clock = ClockSynchronizer::Clock;
+
+namespace {
+
+// exposes the timestamp decoding
+class TimestampData : public VisionaryTMiniData
+{
+public:
+  using VisionaryData::setBlobTimestamp;
+};
+
+std::uint64_t packTimestamp(int year, int month, int day, int hour, int minute, int second, int millisecond)
+{
+  return (static_cast<std::uint64_t>(year) << 47) | (static_cast<std::uint64_t>(month) << 43)
+         | (static_cast<std::uint64_t>(day) << 38) | (static_cast<std::uint64_t>(hour) << 22)
+         | (static_cast<std::uint64_t>(minute) << 16) | (static_cast<std::uint64_t>(second) << 10)
+         | static_cast<std::uint64_t>(millisecond);
+}
+
+double toMs(Clock::duration duration)
+{
+  return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(duration).count();
+}
+
+} // namespace
+
+TEST(ClockSynchronizerTest, TimestampDecoding)
+{
+  TimestampData data;
+
+  data.setBlobTimestamp(packTimestamp(1970, 1, 1, 0, 0, 0, 0));
+  EXPECT_EQ(0u, data.getTimestampMS());
+
+  data.setBlobTimestamp(packTimestamp(2024, 2, 29, 12, 34, 56, 789));
+  EXPECT_EQ(1709210096789u, data.getTimestampMS());
+
+  data.setBlobTimestamp(packTimestamp(2000, 3, 1, 0, 0, 0, 1));
+  EXPECT_EQ(951868800001u, data.getTimestampMS());
+
+  data.setBlobTimestamp(packTimestamp(2099, 12, 31, 23, 59, 59, 999));
+  EXPECT_EQ(4102444799999u, data.getTimestampMS());
+}
+
+TEST(ClockSynchronizerTest, NoSamples)
+{
+  ClockSynchronizer sync;
+
+  EXPECT_FALSE(sync.getEstimate().valid);
+  EXPECT_EQ(Clock::time_point(), sync.toHostTime(1000u));
+}
+
+TEST(ClockSynchronizerTest, OffsetAndDriftWithDelayNoise)
+{
+  ClockSynchronizer sync(std::chrono::milliseconds(500), 60u);
+
+  // device clock runs 50ppm slow, every frame is delayed by 2..9ms
+  const std::uint64_t     device0 = 1700000000000u;
+  const Clock::time_point host0   = Clock::now();
+  const double            drift   = 50.0e-6;
+
+  for (int i = 0; i < 30 * 60; ++i) // 60s at 30fps
+  {
+    const double deviceMs = static_cast<double>(i) * 1000.0 / 30.0;
+    const double delayMs  = 2.0 + static_cast<double>((i * 7) % 8);
+    const double hostMs   = deviceMs * (1.0 + drift) + delayMs;
+    sync.addSample(device0 + static_cast<std::uint64_t>(deviceMs),
+                   host0
+                     + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(hostMs)));
+  }
+
+  const auto estimate = sync.getEstimate();
+  EXPECT_TRUE(estimate.valid);
+  EXPECT_EQ(30u * 60u, estimate.numSamples);
+  EXPECT_NEAR(50.0, estimate.driftPpm, 10.0);
+
+  // the converted time contains the minimal delay only (device times are truncated to ms, hence the tolerance)
+  const std::uint64_t deviceMs = 59000u;
+  const double        expected = static_cast<double>(deviceMs) * (1.0 + drift) + 2.0;
+  EXPECT_NEAR(expected, toMs(sync.toHostTime(device0 + deviceMs) - host0), 1.0);
+}
+
+TEST(ClockSynchronizerTest, ResetOnClockJump)
+{
+  ClockSynchronizer sync;
+
+  const std::uint64_t     device0 = 1700000000000u;
+  const Clock::time_point host0   = Clock::now();
+  for (int i = 0; i < 100; ++i)
+  {
+    sync.addSample(device0 + static_cast<std::uint64_t>(i) * 10u, host0 + std::chrono::milliseconds(i * 10 + 3));
+  }
+  EXPECT_EQ(100u, sync.getEstimate().numSamples);
+
+  // device clock set one hour back
+  const std::uint64_t device1 = device0 - 3600u * 1000u;
+  sync.addSample(device1, host0 + std::chrono::milliseconds(1003));
+  EXPECT_EQ(1u, sync.getEstimate().numSamples);
+  EXPECT_NEAR(1003.0, toMs(sync.toHostTime(device1) - host0), 1e-3);
+
+  sync.reset();
+  EXPECT_FALSE(sync.getEstimate().valid);
+}
@@ -0,0 +1,167 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "BlobSimulator.h"
+#include "ConnectionHealth.h"
+#include "MockTransport.h"
+#include "SocketOptions.h"
+#include "TcpSocket.h"
+#include "VisionaryDataStream.h"
+#include "VisionaryTMiniData.h"
+
+#ifdef __linux__
+#  include <linux/capability.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+using namespace visionary;
+using Clock = ConnectionHealth::Clock;
+
+namespace {
+
+#ifdef __linux__
+// drops CAP_NET_ADMIN from the effective set of the calling thread, so SO_RCVBUFFORCE is refused
+bool dropNetAdmin()
+{
+  __user_cap_header_struct header{};
+  header.version = _LINUX_CAPABILITY_VERSION_3;
+  header.pid     = 0;
+  __user_cap_data_struct data[_LINUX_CAPABILITY_U32S_3]{};
+  if (::syscall(SYS_capget, &header, data) != 0)
+  {
+    return false;
+  }
+  data[CAP_TO_INDEX(CAP_NET_ADMIN)].effective &= ~CAP_TO_MASK(CAP_NET_ADMIN);
+  return ::syscall(SYS_capset, &header, data) == 0;
+}
+#endif
+
+} // namespace
+
+TEST(ConnectionHealthTest, NotAliveWithoutConnection)
+{
+  ConnectionHealth health;
+  health.lastReceiveTime = Clock::now();
+
+  EXPECT_FALSE(health.isAlive(std::chrono::seconds(1)));
+}
+
+TEST(ConnectionHealthTest, AliveWithinSilence)
+{
+  const auto       now = Clock::now();
+  ConnectionHealth health;
+  health.connected = true;
+
+  // nothing received yet
+  EXPECT_FALSE(health.isAlive(std::chrono::milliseconds(100), now));
+
+  health.lastReceiveTime = now - std::chrono::milliseconds(50);
+  EXPECT_TRUE(health.isAlive(std::chrono::milliseconds(100), now));
+  EXPECT_FALSE(health.isAlive(std::chrono::milliseconds(20), now));
+}
+
+TEST(ConnectionHealthTest, KernelReceiveTimeCounts)
+{
+  const auto       now = Clock::now();
+  ConnectionHealth health;
+  health.connected             = true;
+  health.lastReceiveTime       = now - std::chrono::milliseconds(500);
+  health.lastKernelReceiveTime = now - std::chrono::milliseconds(10);
+
+  // only used if the TCP info is valid
+  EXPECT_FALSE(health.isAlive(std::chrono::milliseconds(100), now));
+  health.hasTcpInfo = true;
+  EXPECT_TRUE(health.isAlive(std::chrono::milliseconds(100), now));
+}
+
+TEST(ConnectionHealthTest, DataStream)
+{
+  VisionaryDataStream stream(std::make_shared<VisionaryTMiniData>());
+
+  EXPECT_FALSE(stream.getConnectionHealth().connected);
+
+  std::unique_ptr<ITransport> pTransport(new visionary_test::MockTransport());
+  stream.open(pTransport);
+  const auto health = stream.getConnectionHealth();
+
+  EXPECT_TRUE(health.connected);
+  EXPECT_FALSE(health.hasTcpInfo);
+
+  // the mock transport does not deliver any data, so the connection is closed by the peer
+  EXPECT_FALSE(stream.getNextFrame());
+  EXPECT_FALSE(stream.getConnectionHealth().connected);
+}
+
+TEST(ConnectionHealthTest, ReceiveBufferWithinLimit)
+{
+  visionary_tools::BlobSimulator simulator(VisionaryType::eVisionaryTMini, 32, 24, 30.0);
+  ASSERT_TRUE(simulator.start());
+
+  std::size_t       size  = 64u * 1024u;
+  const std::size_t limit = TcpSocket::getReceiveBufferLimit();
+  if (limit > 0u)
+  {
+    size = std::min(size, limit);
+  }
+  SocketOptions options;
+  options.receiveBufferSize = size;
+
+  TcpSocket socket;
+  ASSERT_EQ(0, socket.connect("127.0.0.1", simulator.getPort(), std::chrono::seconds(2), options));
+  ConnectionHealth health;
+  ASSERT_TRUE(socket.getConnectionHealth(health));
+  EXPECT_FALSE(health.receiveBufferLimited);
+  socket.shutdown();
+}
+
+#ifdef __linux__
+TEST(ConnectionHealthTest, ReceiveBufferAboveLimitKeepsAutotuning)
+{
+  const std::size_t limit = TcpSocket::getReceiveBufferLimit();
+  if (limit == 0u)
+  {
+    // no known limit, nothing to check
+    return;
+  }
+  visionary_tools::BlobSimulator simulator(VisionaryType::eVisionaryTMini, 32, 24, 30.0);
+  ASSERT_TRUE(simulator.start());
+
+  SocketOptions options;
+  options.receiveBufferSize = 4u * limit;
+
+  // capabilities are per thread, so only this thread loses the right to exceed the limit
+  bool             dropped = false;
+  ConnectionHealth reference;
+  ConnectionHealth health;
+  std::thread      unprivileged([&] {
+    dropped = dropNetAdmin();
+    TcpSocket referenceSocket;
+    TcpSocket socket;
+    if (dropped && (referenceSocket.connect("127.0.0.1", simulator.getPort(), std::chrono::seconds(2)) == 0)
+        && (socket.connect("127.0.0.1", simulator.getPort(), std::chrono::seconds(2), options) == 0))
+    {
+      referenceSocket.getConnectionHealth(reference);
+      socket.getConnectionHealth(health);
+    }
+    referenceSocket.shutdown();
+    socket.shutdown();
+  });
+  unprivileged.join();
+  ASSERT_TRUE(dropped);
+
+  EXPECT_TRUE(health.receiveBufferLimited);
+  // SO_RCVBUF was left alone, so the buffer has the same (autotuned) size as on a socket without a requested size
+  EXPECT_GT(reference.receiveBufferSize, 0u);
+  EXPECT_EQ(reference.receiveBufferSize, health.receiveBufferSize);
+}
+#endif
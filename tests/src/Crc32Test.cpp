@@ -0,0 +1,73 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Crc32.h"
+
+using namespace visionary;
+
+namespace {
+const char kCheckInput[] = "123456789";
+
+std::vector<std::uint8_t> pseudoRandomData(std::size_t size)
+{
+  std::vector<std::uint8_t> data(size);
+  std::uint32_t             state = 0x12345678u;
+  for (auto& byte : data)
+  {
+    state = state * 1664525u + 1013904223u;
+    byte  = static_cast<std::uint8_t>(state >> 24);
+  }
+  return data;
+}
+} // namespace
+
+TEST(Crc32Test, CheckValues)
+{
+  const std::size_t size = std::strlen(kCheckInput);
+  EXPECT_EQ(0xCBF43926u, Crc32::compute(CrcAlgorithm::CRC32, kCheckInput, size));
+  EXPECT_EQ(0xE3069283u, Crc32::compute(CrcAlgorithm::CRC32C, kCheckInput, size));
+  EXPECT_EQ(0xCBF43926u, Crc32::computeSoftware(CrcAlgorithm::CRC32, kCheckInput, size));
+  EXPECT_EQ(0xE3069283u, Crc32::computeSoftware(CrcAlgorithm::CRC32C, kCheckInput, size));
+  EXPECT_EQ(0u, Crc32::compute(CrcAlgorithm::NONE, kCheckInput, size));
+}
+
+TEST(Crc32Test, PiecewiseMatchesWhole)
+{
+  const auto data = pseudoRandomData(100003u);
+
+  for (const auto algorithm : {CrcAlgorithm::CRC32, CrcAlgorithm::CRC32C})
+  {
+    const std::uint32_t whole = Crc32::compute(algorithm, data.data(), data.size());
+
+    std::uint32_t     crc      = 0u;
+    std::size_t       offset   = 0u;
+    const std::size_t pieces[] = {1u, 7u, 13u, 4096u, 12288u, 30000u};
+    for (std::size_t i = 0u; offset < data.size(); ++i)
+    {
+      const std::size_t size = std::min(pieces[i % 6u], data.size() - offset);
+      crc                    = Crc32::compute(algorithm, data.data() + offset, size, crc);
+      offset += size;
+    }
+    EXPECT_EQ(whole, crc);
+  }
+}
+
+TEST(Crc32Test, AcceleratedMatchesSoftware)
+{
+  // large enough for the interleaved streams, with an unaligned start and an odd tail
+  const auto data = pseudoRandomData(3u * 4096u * 5u + 123u);
+
+  for (const auto algorithm : {CrcAlgorithm::CRC32, CrcAlgorithm::CRC32C})
+  {
+    EXPECT_EQ(Crc32::computeSoftware(algorithm, data.data() + 1, data.size() - 1u),
+              Crc32::compute(algorithm, data.data() + 1, data.size() - 1u));
+  }
+}
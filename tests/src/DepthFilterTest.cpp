@@ -0,0 +1,297 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "DepthFilter.h"
+#include "VisionaryEndian.h"
+#include "VisionaryTMiniData.h"
+
+using namespace visionary;
+
+namespace {
+
+// depth map with invalid pixels and noise
+std::vector<std::uint16_t> randomMap(std::uint32_t width, std::uint32_t height, std::uint32_t seed)
+{
+  std::mt19937                                 generator(seed);
+  std::uniform_int_distribution<std::uint32_t> value(0u, 0xFFFFu);
+  std::vector<std::uint16_t>                   map(static_cast<std::size_t>(width) * height);
+  for (auto& pixel : map)
+  {
+    const std::uint32_t random = value(generator);
+    pixel = (random % 7u == 0u) ? 0u : static_cast<std::uint16_t>(3000u + (random & 0x3FFu) + (random >> 12u) * 40u);
+  }
+  return map;
+}
+
+std::vector<std::uint16_t> referenceMedian(const std::vector<std::uint16_t>& input,
+                                           std::uint32_t                     width,
+                                           std::uint32_t                     height,
+                                           unsigned                          size)
+{
+  const std::uint32_t        radius = size / 2u;
+  std::vector<std::uint16_t> output(input);
+  std::vector<std::uint16_t> window;
+  for (std::uint32_t y = radius; y + radius < height; ++y)
+  {
+    for (std::uint32_t x = radius; x + radius < width; ++x)
+    {
+      if (input[y * width + x] == 0u)
+      {
+        continue;
+      }
+      window.clear();
+      for (std::uint32_t wy = y - radius; wy <= y + radius; ++wy)
+      {
+        for (std::uint32_t wx = x - radius; wx <= x + radius; ++wx)
+        {
+          window.push_back(input[wy * width + wx]);
+        }
+      }
+      std::nth_element(window.begin(), window.begin() + window.size() / 2u, window.end());
+      output[y * width + x] = window[window.size() / 2u];
+    }
+  }
+  return output;
+}
+
+constexpr std::uint32_t kWidth  = 32u;
+constexpr std::uint32_t kHeight = 24u;
+
+const std::string kTMiniXml =
+  "<SickRecord><DataSets><DataSetDepthMap><FormatDescriptionDepthMap><DataStream>"
+  "<Width>32</Width><Height>24</Height><CameraToWorldTransform>"
+  "<value>1</value><value>0</value><value>0</value><value>0</value><value>0</value><value>1</value><value>0</value>"
+  "<value>0</value><value>0</value><value>0</value><value>1</value><value>0</value><value>0</value><value>0</value>"
+  "<value>0</value><value>1</value></CameraToWorldTransform>"
+  "<CameraMatrix><FX>-23.1</FX><FY>-23.2</FY><CX>15.5</CX><CY>11.5</CY></CameraMatrix>"
+  "<CameraDistortionParams><K1>-0.07</K1><K2>0.2</K2><P1>0</P1><P2>0</P2><K3>0</K3></CameraDistortionParams>"
+  "<FocalToRayCross>1.5</FocalToRayCross>"
+  "<Distance>uint16</Distance><Intensity>uint16</Intensity><Confidence>uint16</Confidence></DataStream>"
+  "</FormatDescriptionDepthMap></DataSetDepthMap></DataSets></SickRecord>";
+
+// binary data part of data set version 1 with the given maps
+std::vector<std::uint8_t> makeBinary(const std::vector<std::vector<std::uint16_t>>& maps)
+{
+  std::vector<std::uint8_t> binary(4u + 8u + 2u, 0u);
+  writeUnalignLittleEndian<std::uint16_t>(binary.data() + 12u, 2u, 1u);
+  for (const auto& map : maps)
+  {
+    const std::size_t offset = binary.size();
+    binary.resize(offset + 2u * map.size());
+    for (std::size_t i = 0u; i < map.size(); ++i)
+    {
+      writeUnalignLittleEndian<std::uint16_t>(binary.data() + offset + 2u * i, 2u, map[i]);
+    }
+  }
+  binary.resize(binary.size() + 4u + 4u, 0u);
+  const auto length = static_cast<std::uint32_t>(binary.size());
+  writeUnalignLittleEndian<std::uint32_t>(binary.data(), 4u, length);
+  writeUnalignLittleEndian<std::uint32_t>(binary.data() + binary.size() - 4u, 4u, length);
+  return binary;
+}
+
+class TestTMiniFrame : public VisionaryTMiniData
+{
+public:
+  bool load(const std::vector<std::uint16_t>& distance,
+            const std::vector<std::uint16_t>& intensity,
+            const std::vector<std::uint16_t>& state)
+  {
+    std::vector<std::uint8_t> binary = makeBinary({distance, intensity, state});
+    return parseXML(kTMiniXml, 1u) && parseBinaryData(binary.begin(), binary.size());
+  }
+};
+
+} // namespace
+
+TEST(DepthFilterTest, MedianMatchesReference)
+{
+  // widths below, at and above the vector width, with and without a partial last vector
+  const std::uint32_t sizes[][2] = {{4u, 4u}, {7u, 5u}, {16u, 6u}, {21u, 9u}, {64u, 7u}, {93u, 11u}};
+  std::uint32_t       seed       = 1u;
+  for (const auto& size : sizes)
+  {
+    const std::vector<std::uint16_t> input = randomMap(size[0], size[1], seed++);
+    std::vector<std::uint16_t>       output(input.size());
+    for (unsigned medianSize : {3u, 5u})
+    {
+      DepthFilter::median(input.data(), output.data(), size[0], size[1], medianSize, 1u);
+      EXPECT_EQ(referenceMedian(input, size[0], size[1], medianSize), output) << size[0] << 'x' << size[1];
+    }
+  }
+}
+
+TEST(DepthFilterTest, RemovesFlyingPixels)
+{
+  // vertical edge from 1000 to 2000 with a mixed pixel in column 8
+  const std::uint32_t        width = 20u, height = 6u;
+  std::vector<std::uint16_t> input(width * height);
+  for (std::uint32_t y = 0u; y < height; ++y)
+  {
+    for (std::uint32_t x = 0u; x < width; ++x)
+    {
+      input[y * width + x] = (x < 8u) ? 1000u : (x == 8u) ? 1500u : 2000u;
+    }
+  }
+  // isolated pixel in front of the background
+  input[3u * width + 15u] = 1200u;
+
+  std::vector<std::uint16_t> output(input.size());
+  DepthFilter::removeFlyingPixels(input.data(), output.data(), width, height, 100u, 0.0f);
+  for (std::uint32_t y = 0u; y < height; ++y)
+  {
+    for (std::uint32_t x = 0u; x < width; ++x)
+    {
+      const bool border  = (y == 0u || y == height - 1u || x == 0u || x == width - 1u);
+      const bool removed = !border && (x == 8u || (y == 3u && x == 15u));
+      EXPECT_EQ(removed ? 0u : input[y * width + x], output[y * width + x]) << x << ',' << y;
+    }
+  }
+
+  // the relative threshold of 40 % of 1500 keeps the mixed pixel, the isolated one is still removed
+  DepthFilter::removeFlyingPixels(input.data(), output.data(), width, height, 100u, 0.4f);
+  EXPECT_EQ(1500u, output[2u * width + 8u]);
+  EXPECT_EQ(0u, output[3u * width + 15u]);
+}
+
+TEST(DepthFilterTest, FillsHoles)
+{
+  // left half 1000, right half 2000, holes inside the halves and on the edge
+  const std::uint32_t        width = 40u, height = 8u;
+  std::vector<std::uint16_t> input(width * height);
+  for (std::uint32_t i = 0u; i < input.size(); ++i)
+  {
+    input[i] = ((i % width) < 20u) ? 1000u : 2000u;
+  }
+  input[2u * width + 5u]  = 0u;
+  input[2u * width + 30u] = 0u;
+  input[4u * width + 20u] = 0u;
+  input[5u * width + 10u] = 0u;
+  input[5u * width + 11u] = 0u;
+
+  std::vector<std::uint16_t> output(input.size());
+  DepthFilter::fillHoles(input.data(), output.data(), width, height, 8u, 50u);
+  EXPECT_EQ(1000u, output[2u * width + 5u]);
+  EXPECT_EQ(2000u, output[2u * width + 30u]);
+  // the neighbours of the edge hole differ by more than the spread
+  EXPECT_EQ(0u, output[4u * width + 20u]);
+  // the pixels of the two pixel hole have only 7 valid neighbours each
+  EXPECT_EQ(0u, output[5u * width + 10u]);
+  EXPECT_EQ(0u, output[5u * width + 11u]);
+
+  DepthFilter::fillHoles(input.data(), output.data(), width, height, 7u, 1000u);
+  EXPECT_EQ(1500u, output[4u * width + 20u]);
+  EXPECT_EQ(1000u, output[5u * width + 10u]);
+  EXPECT_EQ(1000u, output[5u * width + 11u]);
+
+  EXPECT_THROW(DepthFilter::fillHoles(input.data(), output.data(), width, height, 0u, 50u), std::invalid_argument);
+  EXPECT_THROW(DepthFilter::fillHoles(input.data(), output.data(), width, height, 9u, 50u), std::invalid_argument);
+}
+
+TEST(DepthFilterTest, MasksByConfidence)
+{
+  std::vector<std::uint16_t>       depth     = {100u, 200u, 300u, 400u, 500u};
+  const std::vector<std::uint16_t> state     = {0u, 0x4u, 0x1u, 0u, 0u};
+  const std::vector<std::uint16_t> intensity = {50u, 50u, 50u, 9u, 10u};
+
+  DepthFilter::maskByConfidence(depth.data(), depth.size(), state.data(), 0x4u, intensity.data(), 10u);
+  EXPECT_EQ((std::vector<std::uint16_t>{100u, 0u, 300u, 0u, 500u}), depth);
+
+  // without a state map only the intensity is checked
+  depth = {100u, 200u, 300u, 400u, 500u};
+  DepthFilter::maskByConfidence(depth.data(), depth.size(), nullptr, 0x4u, intensity.data(), 10u);
+  EXPECT_EQ((std::vector<std::uint16_t>{100u, 200u, 300u, 0u, 500u}), depth);
+}
+
+TEST(DepthFilterTest, ApplyRunsStagesInOrder)
+{
+  const std::uint32_t        width = 24u, height = 8u;
+  std::vector<std::uint16_t> depth(width * height, 1000u);
+  std::vector<std::uint16_t> state(depth.size(), 0u);
+  depth[3u * width + 6u] = 1234u;
+  state[3u * width + 6u] = 0x8u;
+
+  DepthFilterConfig config;
+  EXPECT_FALSE(config.isEnabled());
+  config.stateMask         = 0x8u;
+  config.holeFillNeighbors = 8u;
+  config.holeFillMaxSpread = 10u;
+  EXPECT_TRUE(config.isEnabled());
+
+  // the masked pixel is filled from its neighbours afterwards
+  DepthFilter::apply(config, depth.data(), width, height, state.data());
+  EXPECT_EQ(std::vector<std::uint16_t>(depth.size(), 1000u), depth);
+
+  EXPECT_TRUE(config.isValid());
+  config.medianSize = 4u;
+  EXPECT_FALSE(config.isValid());
+  EXPECT_THROW(DepthFilter::apply(config, depth.data(), width, height), std::invalid_argument);
+  config.medianSize        = 3u;
+  config.holeFillNeighbors = 9u;
+  EXPECT_FALSE(config.isValid());
+  EXPECT_THROW(DepthFilter::apply(config, depth.data(), width, height), std::invalid_argument);
+}
+
+TEST(DepthFilterTest, ThreadsGiveSameResult)
+{
+  // large enough to be split into several bands
+  const std::uint32_t              width = 320u, height = 240u;
+  const std::vector<std::uint16_t> input = randomMap(width, height, 99u);
+
+  DepthFilterConfig config;
+  config.minJump           = 200u;
+  config.jumpRatio         = 0.05f;
+  config.holeFillNeighbors = 5u;
+  config.holeFillMaxSpread = 400u;
+  config.medianSize        = 5u;
+
+  config.numThreads                 = 1u;
+  std::vector<std::uint16_t> single = input;
+  DepthFilter::apply(config, single.data(), width, height);
+
+  config.numThreads                   = 4u;
+  std::vector<std::uint16_t> parallel = input;
+  DepthFilter::apply(config, parallel.data(), width, height);
+  EXPECT_EQ(single, parallel);
+
+  // the stages called directly
+  std::vector<std::uint16_t> output(input.size());
+  DepthFilter::median(input.data(), output.data(), width, height, 3u, 4u);
+  EXPECT_EQ(referenceMedian(input, width, height, 3u), output);
+}
+
+TEST(DepthFilterTest, FiltersDistanceMapOfFrame)
+{
+  TestTMiniFrame    emptyFrame;
+  DepthFilterConfig config;
+  config.minIntensity = 100u;
+  config.medianSize   = 3u;
+  EXPECT_FALSE(emptyFrame.filterDepthMap(config));
+
+  const std::vector<std::uint16_t> distance = randomMap(kWidth, kHeight, 5u);
+  std::vector<std::uint16_t>       intensity(distance.size());
+  std::vector<std::uint16_t>       state(distance.size(), 0u);
+  for (std::size_t i = 0u; i < distance.size(); ++i)
+  {
+    intensity[i] = static_cast<std::uint16_t>((i * 37u) % 400u);
+  }
+  TestTMiniFrame frame;
+  ASSERT_TRUE(frame.load(distance, intensity, state));
+  ASSERT_EQ(distance, frame.getDistanceMap());
+
+  std::vector<std::uint16_t> expected = distance;
+  DepthFilter::apply(config, expected.data(), kWidth, kHeight, state.data(), intensity.data());
+  EXPECT_TRUE(frame.filterDepthMap(config));
+  EXPECT_EQ(expected, frame.getDistanceMap());
+  EXPECT_NE(distance, frame.getDistanceMap());
+}
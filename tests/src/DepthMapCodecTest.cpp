@@ -0,0 +1,120 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "DepthMapCodec.h"
+
+using namespace visionary;
+
+namespace {
+
+// sloped, slightly curved surface with sensor noise and rectangular patches of invalid pixels
+std::vector<std::uint16_t> makeDepthMap(std::uint32_t width, std::uint32_t height)
+{
+  std::vector<std::uint16_t>       map(static_cast<std::size_t>(width) * height);
+  std::mt19937                     generator(42u);
+  std::normal_distribution<double> noise(0.0, 3.0);
+  for (std::uint32_t y = 0u; y < height; ++y)
+  {
+    for (std::uint32_t x = 0u; x < width; ++x)
+    {
+      const double z     = 1500.0 + 0.8 * x + 0.3 * y + 200.0 * std::sin(0.01 * x) + noise(generator);
+      const bool   valid = ((x / 37u + y / 23u) % 11u) != 0u;
+
+      map[static_cast<std::size_t>(y) * width + x] = valid ? static_cast<std::uint16_t>(z) : 0u;
+    }
+  }
+  return map;
+}
+
+void expectRoundtrip(const std::vector<std::uint16_t>& map, std::uint32_t width, std::uint32_t height)
+{
+  std::vector<std::uint8_t> encoded;
+  DepthMapCodec::encode(map.data(), width, height, encoded);
+  EXPECT_LE(encoded.size(), DepthMapCodec::maxEncodedSize(width, height));
+
+  std::vector<std::uint16_t> decoded;
+  std::uint32_t              decodedWidth  = 0u;
+  std::uint32_t              decodedHeight = 0u;
+  ASSERT_TRUE(DepthMapCodec::decode(encoded.data(), encoded.size(), decoded, decodedWidth, decodedHeight));
+  EXPECT_EQ(width, decodedWidth);
+  EXPECT_EQ(height, decodedHeight);
+  EXPECT_EQ(map, decoded);
+}
+
+} // namespace
+
+TEST(DepthMapCodecTest, RoundtripDepthMap)
+{
+  const std::uint32_t              width  = 640u;
+  const std::uint32_t              height = 512u;
+  const std::vector<std::uint16_t> map    = makeDepthMap(width, height);
+  expectRoundtrip(map, width, height);
+
+  std::vector<std::uint8_t> encoded;
+  DepthMapCodec::encode(map.data(), width, height, encoded);
+  EXPECT_GE(map.size() * sizeof(std::uint16_t), 2u * encoded.size());
+}
+
+TEST(DepthMapCodecTest, RoundtripEdgeCases)
+{
+  // full value range, odd sizes not filling the last block, single rows and columns, empty maps
+  std::mt19937                                 generator(7u);
+  std::uniform_int_distribution<std::uint32_t> value(0u, 0xffffu);
+  for (const std::uint32_t width : {1u, 3u, 64u, 65u, 176u})
+  {
+    for (const std::uint32_t height : {1u, 2u, 17u})
+    {
+      std::vector<std::uint16_t> map(static_cast<std::size_t>(width) * height);
+      for (std::uint16_t& pixel : map)
+      {
+        pixel = static_cast<std::uint16_t>(value(generator));
+      }
+      expectRoundtrip(map, width, height);
+    }
+  }
+  expectRoundtrip(std::vector<std::uint16_t>(), 0u, 0u);
+  expectRoundtrip(std::vector<std::uint16_t>(4096u, 0u), 64u, 64u);
+}
+
+TEST(DepthMapCodecTest, RejectsCorruptData)
+{
+  const std::vector<std::uint16_t> map = makeDepthMap(64u, 32u);
+  std::vector<std::uint8_t>        encoded;
+  DepthMapCodec::encode(map.data(), 64u, 32u, encoded);
+
+  std::vector<std::uint16_t> decoded;
+  std::uint32_t              width  = 0u;
+  std::uint32_t              height = 0u;
+
+  // truncated
+  EXPECT_FALSE(DepthMapCodec::decode(encoded.data(), encoded.size() - 1u, decoded, width, height));
+  EXPECT_FALSE(DepthMapCodec::decode(encoded.data(), 8u, decoded, width, height));
+
+  // wrong magic
+  std::vector<std::uint8_t> corrupt = encoded;
+  corrupt[0]                        = 'X';
+  EXPECT_FALSE(DepthMapCodec::decode(corrupt.data(), corrupt.size(), decoded, width, height));
+
+  // invalid bit width of the first block
+  corrupt      = encoded;
+  corrupt[12u] = 17u;
+  EXPECT_FALSE(DepthMapCodec::decode(corrupt.data(), corrupt.size(), decoded, width, height));
+
+  // dimensions larger than the data
+  corrupt      = encoded;
+  corrupt[7u] = 0x7fu;
+  EXPECT_FALSE(DepthMapCodec::decode(corrupt.data(), corrupt.size(), decoded, width, height));
+
+  // trailing bytes
+  corrupt = encoded;
+  corrupt.push_back(0u);
+  EXPECT_FALSE(DepthMapCodec::decode(corrupt.data(), corrupt.size(), decoded, width, height));
+}
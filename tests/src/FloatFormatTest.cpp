@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "FloatFormat.h"
+
+using namespace visionary;
+
+namespace {
+
+std::string format(float value)
+{
+  char buffer[kMaxFloatChars];
+  return std::string(buffer, formatShortest(buffer, value));
+}
+
+} // namespace
+
+TEST(FloatFormatTest, FixedAndScientificNotation)
+{
+  EXPECT_EQ("0", format(0.0f));
+  EXPECT_EQ("-0", format(-0.0f));
+  EXPECT_EQ("1", format(1.0f));
+  EXPECT_EQ("0.5", format(0.5f));
+  EXPECT_EQ("-1.25", format(-1.25f));
+  EXPECT_EQ("0.1", format(0.1f));
+  EXPECT_EQ("1000", format(1000.0f));
+  EXPECT_EQ("123456", format(123456.0f));
+  EXPECT_EQ("1e+06", format(1.0e6f));
+  EXPECT_EQ("12345678", format(12345678.0f));
+  EXPECT_EQ("33554448", format(33554448.0f));
+  EXPECT_EQ("1.5e+10", format(1.5e10f));
+  EXPECT_EQ("0.001", format(0.001f));
+  EXPECT_EQ("1e-04", format(0.0001f));
+  EXPECT_EQ("3.4028235e+38", format(std::numeric_limits<float>::max()));
+  EXPECT_EQ("1e-45", format(std::numeric_limits<float>::denorm_min()));
+  EXPECT_EQ("1.1754944e-38", format(std::numeric_limits<float>::min()));
+}
+
+TEST(FloatFormatTest, SpecialValues)
+{
+  EXPECT_EQ("nan", format(std::numeric_limits<float>::quiet_NaN()));
+  EXPECT_EQ("inf", format(std::numeric_limits<float>::infinity()));
+  EXPECT_EQ("-inf", format(-std::numeric_limits<float>::infinity()));
+}
+
+TEST(FloatFormatTest, ShortestRoundtrip)
+{
+  std::mt19937                                 generator(42u);
+  std::uniform_int_distribution<std::uint32_t> distribution;
+
+  char buffer[kMaxFloatChars + 1u];
+  for (int i = 0; i < 100000; ++i)
+  {
+    const std::uint32_t bits = distribution(generator);
+    float               value;
+    std::memcpy(&value, &bits, sizeof(value));
+    if (value != value)
+    {
+      continue;
+    }
+
+    const std::size_t size = formatShortest(buffer, value);
+    ASSERT_LE(size, kMaxFloatChars);
+    buffer[size] = '\0';
+    ASSERT_EQ(value, std::strtof(buffer, nullptr)) << buffer;
+  }
+}
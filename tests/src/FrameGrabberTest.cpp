@@ -0,0 +1,191 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BlobSimulator.h"
+#include "Crc32.h"
+#include "FrameGrabber.h"
+#include "MapSelection.h"
+#include "PipelineOptions.h"
+#include "VisionaryControl.h"
+#include "VisionaryTMiniData.h"
+
+using namespace visionary;
+using visionary_tools::BlobSimulator;
+
+namespace {
+
+constexpr int         kWidth     = 32;
+constexpr int         kHeight    = 24;
+constexpr std::size_t kNumPixels = static_cast<std::size_t>(kWidth * kHeight);
+constexpr double      kFps       = 200.0;
+
+const std::chrono::milliseconds kTimeout(2000);
+
+using Grabber = FrameGrabber<VisionaryTMiniData>;
+
+// fetches frames into handlers created by the application, which the grabber fills after the exchange
+//
+// Returns the fetched frames; the handlers are kept alive so their addresses identify them.
+std::vector<std::shared_ptr<VisionaryTMiniData>> fetchIntoOwnHandlers(Grabber&     grabber,
+                                                                      std::size_t  numFrames,
+                                                                      std::size_t& numFromOwnHandlers)
+{
+  std::vector<std::shared_ptr<VisionaryTMiniData>> ownHandlers;
+  std::vector<std::shared_ptr<VisionaryTMiniData>> frames;
+  numFromOwnHandlers = 0u;
+  for (std::size_t i = 0u; i < numFrames; ++i)
+  {
+    auto pDataHandler = std::make_shared<VisionaryTMiniData>();
+    ownHandlers.push_back(pDataHandler);
+    if (!grabber.getNextFrame(pDataHandler, kTimeout))
+    {
+      break;
+    }
+    if (std::find(ownHandlers.begin(), ownHandlers.end(), pDataHandler) != ownHandlers.end())
+    {
+      ++numFromOwnHandlers;
+    }
+    frames.push_back(pDataHandler);
+  }
+  return frames;
+}
+
+// fails the depth filtering of every third frame
+class FailingFilterData : public VisionaryTMiniData
+{
+public:
+  explicit FailingFilterData(std::atomic<unsigned>& numFailures) : m_numFailures(numFailures)
+  {
+  }
+
+  bool filterDepthMap(const DepthFilterConfig& config) override
+  {
+    if (getFrameNum() % 3u == 0u)
+    {
+      ++m_numFailures;
+      throw std::runtime_error("depth filter failed");
+    }
+    return VisionaryTMiniData::filterDepthMap(config);
+  }
+
+private:
+  std::atomic<unsigned>& m_numFailures;
+};
+
+// fetches frames into handlers whose depth filtering fails now and then and checks how the failures are counted
+void checkFailedDepthFilterStatistics(unsigned parseThreads)
+{
+  BlobSimulator simulator(VisionaryType::eVisionaryTMini, kWidth, kHeight, kFps);
+  ASSERT_TRUE(simulator.start());
+  VisionaryControl control(VisionaryType::eVisionaryTMini);
+
+  PipelineOptions options;
+  options.parseThreads           = parseThreads;
+  options.depthFilter.medianSize = 3u;
+  options.depthFilter.numThreads = 1u;
+  Grabber grabber(control, "127.0.0.1", simulator.getPort(), kTimeout, SocketOptions(), options);
+
+  std::atomic<unsigned> numFailures(0u);
+  for (std::size_t i = 0u; i < 24u && numFailures < 2u; ++i)
+  {
+    std::shared_ptr<VisionaryTMiniData> pDataHandler = std::make_shared<FailingFilterData>(numFailures);
+    ASSERT_TRUE(grabber.getNextFrame(pDataHandler, kTimeout));
+  }
+  ASSERT_GE(numFailures.load(), 2u);
+
+  // the blobs were fine, so the frames count as parsed and dropped, but neither as failed nor as missed
+  const auto stats = grabber.getStatistics();
+  EXPECT_EQ(0u, stats.framesFailed);
+  EXPECT_EQ(0u, stats.frameNumberGaps);
+  EXPECT_EQ(0u, stats.framesMissed);
+  EXPECT_GE(stats.framesDropped, 2u);
+  EXPECT_GT(stats.framesParsed, 0u);
+}
+
+} // namespace
+
+TEST(FrameGrabberTest, FailedDepthFilterCountsAsDropped)
+{
+  checkFailedDepthFilterStatistics(0u);
+}
+
+TEST(FrameGrabberTest, FailedDepthFilterCountsAsDroppedWithParseThreads)
+{
+  checkFailedDepthFilterStatistics(2u);
+}
+
+TEST(FrameGrabberTest, OwnHandlerKeepsMapSelection)
+{
+  BlobSimulator simulator(VisionaryType::eVisionaryTMini, kWidth, kHeight, kFps);
+  ASSERT_TRUE(simulator.start());
+  VisionaryControl control(VisionaryType::eVisionaryTMini);
+
+  PipelineOptions options;
+  options.mapSelection = MapSelection::DEPTH;
+  Grabber grabber(control, "127.0.0.1", simulator.getPort(), kTimeout, SocketOptions(), options);
+
+  std::size_t numFromOwnHandlers = 0u;
+  const auto  frames             = fetchIntoOwnHandlers(grabber, 8u, numFromOwnHandlers);
+  ASSERT_EQ(8u, frames.size());
+  EXPECT_GT(numFromOwnHandlers, 0u);
+  for (const auto& pFrame : frames)
+  {
+    EXPECT_EQ(static_cast<std::uint32_t>(MapSelection::DEPTH), pFrame->getMapSelection());
+    EXPECT_EQ(kNumPixels, pFrame->getDistanceMap().size());
+    EXPECT_TRUE(pFrame->getIntensityMap().empty());
+    EXPECT_TRUE(pFrame->getStateMap().empty());
+  }
+}
+
+TEST(FrameGrabberTest, OwnHandlerKeepsFrameFilter)
+{
+  BlobSimulator simulator(VisionaryType::eVisionaryTMini, kWidth, kHeight, kFps);
+  ASSERT_TRUE(simulator.start());
+  VisionaryControl control(VisionaryType::eVisionaryTMini);
+
+  PipelineOptions options;
+  options.frameFilter = [](const FrameMetadata& metadata) { return metadata.frameNum % 2u == 0u; };
+  Grabber grabber(control, "127.0.0.1", simulator.getPort(), kTimeout, SocketOptions(), options);
+
+  std::size_t numFromOwnHandlers = 0u;
+  const auto  frames             = fetchIntoOwnHandlers(grabber, 8u, numFromOwnHandlers);
+  ASSERT_EQ(8u, frames.size());
+  EXPECT_GT(numFromOwnHandlers, 0u);
+  for (const auto& pFrame : frames)
+  {
+    EXPECT_EQ(0u, pFrame->getFrameNum() % 2u) << pFrame->getFrameNum();
+  }
+  EXPECT_GT(grabber.getStatistics().framesRejected, 0u);
+}
+
+TEST(FrameGrabberTest, OwnHandlerKeepsCrcValidation)
+{
+  BlobSimulator simulator(VisionaryType::eVisionaryTMini, kWidth, kHeight, kFps);
+  ASSERT_TRUE(simulator.start());
+  VisionaryControl control(VisionaryType::eVisionaryTMini);
+
+  // the simulator sends no CRC (0), so the frames are accepted
+  PipelineOptions options;
+  options.crcValidation = CrcAlgorithm::CRC32C;
+  Grabber grabber(control, "127.0.0.1", simulator.getPort(), kTimeout, SocketOptions(), options);
+
+  std::size_t numFromOwnHandlers = 0u;
+  const auto  frames             = fetchIntoOwnHandlers(grabber, 8u, numFromOwnHandlers);
+  ASSERT_EQ(8u, frames.size());
+  EXPECT_GT(numFromOwnHandlers, 0u);
+  for (const auto& pFrame : frames)
+  {
+    EXPECT_EQ(CrcAlgorithm::CRC32C, pFrame->getCrcValidation());
+  }
+}
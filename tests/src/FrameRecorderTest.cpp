@@ -0,0 +1,145 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "FrameRecorder.h"
+
+using namespace visionary;
+
+namespace {
+
+std::string readFile(const std::string& filename)
+{
+  std::ifstream stream(filename, std::ios_base::in | std::ios_base::binary);
+  return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+// data handler whose point cloud cannot be generated
+class FailingData : public VisionaryData
+{
+public:
+  void generatePointCloud(std::vector<PointXYZ>&) override
+  {
+    throw std::runtime_error("no point cloud");
+  }
+
+protected:
+  bool parseXML(const std::string&, std::uint32_t) override
+  {
+    return false;
+  }
+
+  bool parseBinaryData(std::vector<uint8_t>::iterator, std::size_t) override
+  {
+    return false;
+  }
+};
+
+} // namespace
+
+TEST(FrameRecorderTest, WritesPointCloudsAndBlobs)
+{
+  RecorderOptions options;
+  options.prefix = "FrameRecorderTest";
+
+  const std::vector<PointXYZ>          points{{1.0f, 2.0f, 3.0f}, {4.0f, 5.0f, 6.0f}};
+  const VisionaryDataStream::ByteBuffer blob{0x00u, 0x01u, 0x62u, 0xAAu};
+  {
+    FrameRecorder recorder(options);
+    EXPECT_TRUE(recorder.recordPointCloud(points));
+    EXPECT_TRUE(recorder.recordRawFrame(blob));
+  } // the destructor writes the queued records
+
+  const std::string cloud = readFile("./FrameRecorderTest_000000.ply");
+  EXPECT_EQ(0u, cloud.find("ply\nformat binary_little_endian 1.0\nelement vertex 2\n"));
+
+  const std::string raw = readFile("./FrameRecorderTest_000001.blob");
+  EXPECT_EQ(std::string("\x02\x02\x02\x02\x00\x00\x00\x04\x00\x01\x62\xAA", 12u), raw);
+
+  VisionaryDataStream::ByteBuffer readBack;
+  EXPECT_TRUE(FrameRecorder::readRawFrame("./FrameRecorderTest_000001.blob", readBack));
+  EXPECT_EQ(blob, readBack);
+  EXPECT_FALSE(FrameRecorder::readRawFrame("./FrameRecorderTest_000000.ply", readBack));
+
+  std::remove("./FrameRecorderTest_000000.ply");
+  std::remove("./FrameRecorderTest_000001.blob");
+}
+
+TEST(FrameRecorderTest, DropsWhenQueueIsFull)
+{
+  RecorderOptions options;
+  options.prefix           = "FrameRecorderTest_drop";
+  options.pointCloudFormat = RecordFormat::PLY_ASCII;
+  options.queueCapacity    = 2u;
+
+  const std::vector<PointXYZ> points(100000u, PointXYZ{1.5f, -2.5f, 1000.25f});
+  const unsigned              numRecords = 20u;
+
+  FrameRecorder recorder(options);
+  unsigned      numQueued = 0u;
+  for (unsigned i = 0u; i < numRecords; ++i)
+  {
+    numQueued += recorder.recordPointCloud(points) ? 1u : 0u;
+  }
+  recorder.flush();
+
+  const RecorderStatistics statistics = recorder.getStatistics();
+  EXPECT_EQ(numQueued, statistics.recordsAccepted);
+  EXPECT_EQ(numRecords, statistics.recordsAccepted + statistics.recordsDropped);
+  EXPECT_EQ(statistics.recordsAccepted, statistics.recordsWritten);
+  EXPECT_EQ(0u, statistics.writeErrors);
+  EXPECT_EQ(0u, statistics.queueDepth);
+  EXPECT_LE(statistics.maxQueueDepth, 2u);
+
+  for (unsigned i = 0u; i < numQueued; ++i)
+  {
+    char filename[64];
+    std::snprintf(filename, sizeof(filename), "./FrameRecorderTest_drop_%06u.ply", i);
+    EXPECT_EQ(0, std::remove(filename)) << filename;
+  }
+}
+
+TEST(FrameRecorderTest, CountsWriteErrors)
+{
+  RecorderOptions options;
+  options.directory = "no_such_directory";
+
+  FrameRecorder recorder(options);
+  EXPECT_TRUE(recorder.recordPointCloud(std::vector<PointXYZ>(1u, PointXYZ{0.0f, 0.0f, 1.0f})));
+  recorder.flush();
+
+  const RecorderStatistics statistics = recorder.getStatistics();
+  EXPECT_EQ(1u, statistics.writeErrors);
+  EXPECT_EQ(0u, statistics.recordsWritten);
+}
+
+TEST(FrameRecorderTest, FailedFillKeepsQueueEntry)
+{
+  RecorderOptions options;
+  options.directory     = "no_such_directory";
+  options.queueCapacity = 1u;
+
+  FrameRecorder recorder(options);
+  FailingData   data;
+  EXPECT_THROW(recorder.recordFrame(data), std::runtime_error);
+
+  // flush() does not wait for the failed record and its entry is free again
+  recorder.flush();
+  EXPECT_EQ(0u, recorder.getStatistics().queueDepth);
+  EXPECT_TRUE(recorder.recordPointCloud(std::vector<PointXYZ>(1u, PointXYZ{0.0f, 0.0f, 1.0f})));
+  recorder.flush();
+
+  const RecorderStatistics statistics = recorder.getStatistics();
+  EXPECT_EQ(1u, statistics.recordsAccepted);
+  EXPECT_EQ(0u, statistics.recordsDropped);
+  EXPECT_EQ(1u, statistics.writeErrors);
+}
@@ -0,0 +1,499 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Crc32.h"
+#include "Deflate.h"
+#include "ImageWriter.h"
+#include "VisionaryEndian.h"
+
+using namespace visionary;
+
+namespace {
+
+constexpr std::uint32_t kWidth  = 61u;
+constexpr std::uint32_t kHeight = 23u;
+
+std::string readFile(const char* filename)
+{
+  std::ifstream stream(filename, std::ios_base::in | std::ios_base::binary);
+  return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+// depth map with invalid pixels, flat areas and noise
+std::vector<std::uint16_t> testMap()
+{
+  std::mt19937               generator(11u);
+  std::vector<std::uint16_t> map(kWidth * kHeight);
+  for (std::size_t i = 0u; i < map.size(); ++i)
+  {
+    const std::size_t x = i % kWidth;
+    const std::size_t y = i / kWidth;
+    if (x < 5u)
+    {
+      map[i] = 0u;
+    }
+    else if (y < 10u)
+    {
+      map[i] = static_cast<std::uint16_t>(1000u + 3u * x);
+    }
+    else
+    {
+      map[i] = static_cast<std::uint16_t>(40000u + generator() % 5000u);
+    }
+  }
+  return map;
+}
+
+// Minimal inflate (RFC 1951) to check the streams independently of the encoder.
+class Inflater
+{
+public:
+  Inflater(const std::uint8_t* pData, std::size_t size) : m_pData(pData), m_size(size), m_position(0u), m_bit(0u) {}
+
+  std::vector<std::uint8_t> run()
+  {
+    std::vector<std::uint8_t> output;
+    bool                      last = false;
+    while (!last)
+    {
+      last                = bits(1u) != 0u;
+      const unsigned type = bits(2u);
+      if (type == 0u)
+      {
+        m_bit = 0u;
+        ++m_position;
+        if (m_position + 4u > m_size)
+        {
+          throw std::runtime_error("truncated");
+        }
+        const unsigned length = readUnalignLittleEndian<std::uint16_t>(m_pData + m_position);
+        if ((length ^ readUnalignLittleEndian<std::uint16_t>(m_pData + m_position + 2u)) != 0xFFFFu)
+        {
+          throw std::runtime_error("stored length");
+        }
+        m_position += 4u;
+        if (m_position + length > m_size)
+        {
+          throw std::runtime_error("truncated");
+        }
+        output.insert(output.end(), m_pData + m_position, m_pData + m_position + length);
+        m_position += length;
+      }
+      else if (type == 2u)
+      {
+        dynamicBlock(output);
+      }
+      else
+      {
+        throw std::runtime_error("unexpected block type");
+      }
+    }
+    return output;
+  }
+
+  std::size_t position() const
+  {
+    return m_position + (m_bit > 0u ? 1u : 0u);
+  }
+
+private:
+  struct Huffman
+  {
+    std::vector<unsigned> counts;
+    std::vector<unsigned> symbols;
+  };
+
+  unsigned bits(unsigned numBits)
+  {
+    unsigned value = 0u;
+    for (unsigned i = 0u; i < numBits; ++i)
+    {
+      if (m_position >= m_size)
+      {
+        throw std::runtime_error("truncated");
+      }
+      value |= ((m_pData[m_position] >> m_bit) & 1u) << i;
+      if (++m_bit == 8u)
+      {
+        m_bit = 0u;
+        ++m_position;
+      }
+    }
+    return value;
+  }
+
+  static Huffman build(const unsigned* pLengths, unsigned numSymbols)
+  {
+    Huffman huffman;
+    huffman.counts.assign(16u, 0u);
+    for (unsigned symbol = 0u; symbol < numSymbols; ++symbol)
+    {
+      ++huffman.counts[pLengths[symbol]];
+    }
+    std::vector<unsigned> offsets(16u, 0u);
+    for (unsigned length = 1u; length < 15u; ++length)
+    {
+      offsets[length + 1u] = offsets[length] + huffman.counts[length];
+    }
+    huffman.symbols.resize(numSymbols);
+    for (unsigned symbol = 0u; symbol < numSymbols; ++symbol)
+    {
+      if (pLengths[symbol] > 0u)
+      {
+        huffman.symbols[offsets[pLengths[symbol]]++] = symbol;
+      }
+    }
+    return huffman;
+  }
+
+  unsigned decode(const Huffman& huffman)
+  {
+    int code  = 0;
+    int first = 0;
+    int index = 0;
+    for (unsigned length = 1u; length < 16u; ++length)
+    {
+      code |= static_cast<int>(bits(1u));
+      const int count = static_cast<int>(huffman.counts[length]);
+      if (code - count < first)
+      {
+        return huffman.symbols[static_cast<std::size_t>(index + (code - first))];
+      }
+      index += count;
+      first += count;
+      first <<= 1;
+      code <<= 1;
+    }
+    throw std::runtime_error("invalid code");
+  }
+
+  void dynamicBlock(std::vector<std::uint8_t>& output)
+  {
+    static const unsigned kOrder[19]     = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    static const unsigned kLengthBase[]  = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                            31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const unsigned kLengthExtra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                            2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const unsigned kDistBase[]    = {1,    2,    3,    4,    5,    7,    9,    13,    17,    25,
+                                            33,   49,   65,   97,   129,  193,  257,  385,   513,   769,
+                                            1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static const unsigned kDistExtra[]   = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                            6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    const unsigned numLiteralLengths = bits(5u) + 257u;
+    const unsigned numDistances      = bits(5u) + 1u;
+    const unsigned numCodeLengths    = bits(4u) + 4u;
+    unsigned       lengths[320]      = {};
+    for (unsigned i = 0u; i < numCodeLengths; ++i)
+    {
+      lengths[kOrder[i]] = bits(3u);
+    }
+    const Huffman codeLengthCode = build(lengths, 19u);
+    unsigned      index          = 0u;
+    while (index < numLiteralLengths + numDistances)
+    {
+      const unsigned symbol = decode(codeLengthCode);
+      if (symbol < 16u)
+      {
+        lengths[index++] = symbol;
+        continue;
+      }
+      unsigned value = 0u;
+      unsigned count = 0u;
+      if (symbol == 16u)
+      {
+        if (index == 0u)
+        {
+          throw std::runtime_error("repeat without length");
+        }
+        value = lengths[index - 1u];
+        count = 3u + bits(2u);
+      }
+      else
+      {
+        count = (symbol == 17u) ? 3u + bits(3u) : 11u + bits(7u);
+      }
+      if (index + count > numLiteralLengths + numDistances)
+      {
+        throw std::runtime_error("too many lengths");
+      }
+      while (count-- > 0u)
+      {
+        lengths[index++] = value;
+      }
+    }
+    const Huffman literalLengthCode = build(lengths, numLiteralLengths);
+    const Huffman distanceCode      = build(lengths + numLiteralLengths, numDistances);
+
+    for (;;)
+    {
+      const unsigned symbol = decode(literalLengthCode);
+      if (symbol < 256u)
+      {
+        output.push_back(static_cast<std::uint8_t>(symbol));
+        continue;
+      }
+      if (symbol == 256u)
+      {
+        return;
+      }
+      const unsigned length   = kLengthBase[symbol - 257u] + bits(kLengthExtra[symbol - 257u]);
+      const unsigned code     = decode(distanceCode);
+      const unsigned distance = kDistBase[code] + bits(kDistExtra[code]);
+      if (distance > output.size())
+      {
+        throw std::runtime_error("distance too far back");
+      }
+      for (unsigned i = 0u; i < length; ++i)
+      {
+        output.push_back(output[output.size() - distance]);
+      }
+    }
+  }
+
+  const std::uint8_t* m_pData;
+  std::size_t         m_size;
+  std::size_t         m_position;
+  unsigned            m_bit;
+};
+
+// Decodes a zlib stream and checks its header and checksum.
+std::vector<std::uint8_t> zlibDecompress(const std::uint8_t* pData, std::size_t size)
+{
+  if (size < 6u || (pData[0] & 0x0Fu) != 8u || ((pData[0] << 8u) | pData[1]) % 31u != 0u)
+  {
+    throw std::runtime_error("zlib header");
+  }
+  Inflater                  inflater(pData + 2u, size - 6u);
+  std::vector<std::uint8_t> output = inflater.run();
+  if (inflater.position() != size - 6u
+      || readUnalignBigEndian<std::uint32_t>(pData + size - 4u) != adler32(output.data(), output.size()))
+  {
+    throw std::runtime_error("zlib trailer");
+  }
+  return output;
+}
+
+struct Png
+{
+  std::uint32_t             width;
+  std::uint32_t             height;
+  std::uint8_t              bitDepth;
+  std::uint8_t              colorType;
+  std::vector<std::uint8_t> scanlines;
+};
+
+// Splits a PNG file into its chunks, checking their CRCs, and decompresses the image data.
+Png readPng(const std::string& file)
+{
+  static const char kSignature[] = "\x89PNG\r\n\x1A\n";
+  if (file.compare(0u, 8u, kSignature, 8u) != 0)
+  {
+    throw std::runtime_error("signature");
+  }
+  const auto*               pFile    = reinterpret_cast<const std::uint8_t*>(file.data());
+  std::size_t               position = 8u;
+  Png                       png{};
+  std::vector<std::uint8_t> idat;
+  std::string               lastType;
+  while (position + 12u <= file.size())
+  {
+    const std::uint32_t length = readUnalignBigEndian<std::uint32_t>(pFile + position);
+    const std::string   type   = file.substr(position + 4u, 4u);
+    if (position + 12u + length > file.size())
+    {
+      throw std::runtime_error("truncated chunk");
+    }
+    const std::uint32_t crc = Crc32::compute(CrcAlgorithm::CRC32, pFile + position + 4u, length + 4u);
+    if (crc != readUnalignBigEndian<std::uint32_t>(pFile + position + 8u + length))
+    {
+      throw std::runtime_error("chunk crc");
+    }
+    const std::uint8_t* pChunk = pFile + position + 8u;
+    if (type == "IHDR")
+    {
+      png.width     = readUnalignBigEndian<std::uint32_t>(pChunk);
+      png.height    = readUnalignBigEndian<std::uint32_t>(pChunk + 4u);
+      png.bitDepth  = pChunk[8];
+      png.colorType = pChunk[9];
+    }
+    else if (type == "IDAT")
+    {
+      idat.insert(idat.end(), pChunk, pChunk + length);
+    }
+    lastType = type;
+    position += 12u + length;
+  }
+  if (lastType != "IEND" || position != file.size())
+  {
+    throw std::runtime_error("chunks");
+  }
+  png.scanlines = zlibDecompress(idat.data(), idat.size());
+  return png;
+}
+
+// Reverses the PNG filters None and Sub.
+std::vector<std::uint8_t> unfilter(const Png& png, std::size_t bytesPerPixel)
+{
+  const std::size_t         rowBytes = bytesPerPixel * png.width;
+  std::vector<std::uint8_t> pixels(rowBytes * png.height);
+  if (png.scanlines.size() != (1u + rowBytes) * png.height)
+  {
+    throw std::runtime_error("scanline size");
+  }
+  for (std::size_t y = 0u; y < png.height; ++y)
+  {
+    const std::uint8_t* pIn    = &png.scanlines[y * (1u + rowBytes)];
+    std::uint8_t*       pOut   = &pixels[y * rowBytes];
+    const std::uint8_t  filter = *pIn++;
+    for (std::size_t i = 0u; i < rowBytes; ++i)
+    {
+      const std::uint8_t left = (filter == 1u && i >= bytesPerPixel) ? pOut[i - bytesPerPixel] : 0u;
+      pOut[i]                 = static_cast<std::uint8_t>(pIn[i] + left);
+    }
+  }
+  return pixels;
+}
+
+std::vector<std::uint16_t> toMap16(const std::vector<std::uint8_t>& pixels)
+{
+  std::vector<std::uint16_t> map(pixels.size() / 2u);
+  for (std::size_t i = 0u; i < map.size(); ++i)
+  {
+    map[i] = readUnalignBigEndian<std::uint16_t>(&pixels[2u * i]);
+  }
+  return map;
+}
+
+} // namespace
+
+TEST(ImageWriterTest, PgmHeaderAndSamples)
+{
+  const std::vector<std::uint16_t> map = testMap();
+  ASSERT_TRUE(ImageWriter::WriteFormatPGM("ImageWriterTest.pgm", map.data(), kWidth, kHeight));
+  const std::string file   = readFile("ImageWriterTest.pgm");
+  const std::string header = "P5\n61 23\n65535\n";
+  ASSERT_EQ(header.size() + 2u * map.size(), file.size());
+  EXPECT_EQ(header, file.substr(0u, header.size()));
+  const auto* pSamples = reinterpret_cast<const std::uint8_t*>(file.data() + header.size());
+  for (std::size_t i = 0u; i < map.size(); ++i)
+  {
+    ASSERT_EQ(map[i], readUnalignBigEndian<std::uint16_t>(pSamples + 2u * i)) << i;
+  }
+}
+
+TEST(ImageWriterTest, PngRoundtrip)
+{
+  const std::vector<std::uint16_t> map = testMap();
+  for (const auto compression : {PngCompression::STORED, PngCompression::FAST})
+  {
+    ASSERT_TRUE(ImageWriter::WriteFormatPNG("ImageWriterTest.png", map.data(), kWidth, kHeight, compression));
+    const std::string file = readFile("ImageWriterTest.png");
+    const Png         png  = readPng(file);
+    EXPECT_EQ(kWidth, png.width);
+    EXPECT_EQ(kHeight, png.height);
+    EXPECT_EQ(16u, png.bitDepth);
+    EXPECT_EQ(0u, png.colorType);
+    EXPECT_EQ(map, toMap16(unfilter(png, 2u)));
+    if (compression == PngCompression::FAST)
+    {
+      EXPECT_LT(file.size(), 2u * map.size());
+    }
+  }
+  EXPECT_FALSE(ImageWriter::WriteFormatPNG("ImageWriterTest_empty.png", nullptr, 0u, kHeight));
+}
+
+TEST(ImageWriterTest, DeflateRoundtrip)
+{
+  std::mt19937              generator(3u);
+  std::vector<std::uint8_t> input(700000u);
+  for (std::size_t i = 0u; i < input.size(); ++i)
+  {
+    // runs longer than the longest match, short runs, a single symbol region and noise, over several blocks
+    const std::size_t section = i % 10000u;
+    input[i] = (section < 1000u)   ? 0u
+               : (section < 3000u) ? static_cast<std::uint8_t>(i / 5u)
+               : (section < 4000u) ? 7u
+                                   : static_cast<std::uint8_t>(generator() % 9u);
+  }
+  for (const auto mode : {DeflateMode::STORED, DeflateMode::HUFFMAN_RLE})
+  {
+    std::vector<std::uint8_t> stream = {0xAAu}; // the stream is appended
+    zlibCompress(input.data(), input.size(), mode, stream);
+    EXPECT_EQ(input, zlibDecompress(stream.data() + 1u, stream.size() - 1u));
+  }
+
+  // degenerate inputs, the empty one without data pointer
+  for (const auto mode : {DeflateMode::STORED, DeflateMode::HUFFMAN_RLE})
+  {
+    for (const std::vector<std::uint8_t>& small :
+         {std::vector<std::uint8_t>{}, std::vector<std::uint8_t>{42u}, std::vector<std::uint8_t>(1000u, 5u)})
+    {
+      std::vector<std::uint8_t> stream;
+      zlibCompress(small.data(), small.size(), mode, stream);
+      EXPECT_EQ(small, zlibDecompress(stream.data(), stream.size()));
+    }
+  }
+  EXPECT_EQ(0x11E60398u, adler32(reinterpret_cast<const std::uint8_t*>("Wikipedia"), 9u));
+}
+
+TEST(ImageWriterTest, ColorMap)
+{
+  // every value of the range plus invalid and clamped pixels; the length is no multiple of the vector width
+  std::vector<std::uint16_t> map = {0u, 100u, 1000u, 1100u, 60000u};
+  for (std::uint16_t value = 1000u; value <= 1100u; ++value)
+  {
+    map.push_back(value);
+  }
+  map.push_back(0u);
+
+  for (const auto colorMap : {ColorMap::GRAY, ColorMap::JET, ColorMap::TURBO})
+  {
+    std::vector<std::uint8_t> rgb(3u * map.size(), 0xEEu);
+    ImageWriter::applyColorMap(map.data(), map.size(), 1000u, 1100u, colorMap, rgb.data());
+    const std::uint8_t black[3] = {0u, 0u, 0u};
+    EXPECT_EQ(0, std::memcmp(&rgb[0], black, 3u));
+    EXPECT_EQ(0, std::memcmp(&rgb[3u * (map.size() - 1u)], black, 3u));
+    // clamped to the first and last color
+    EXPECT_EQ(0, std::memcmp(&rgb[3u], &rgb[6u], 3u));
+    EXPECT_EQ(0, std::memcmp(&rgb[9u], &rgb[12u], 3u));
+
+    // each pixel matches the conversion of the same value alone, which takes the scalar path
+    for (std::size_t i = 0u; i < map.size(); ++i)
+    {
+      std::uint8_t single[3];
+      ImageWriter::applyColorMap(&map[i], 1u, 1000u, 1100u, colorMap, single);
+      ASSERT_EQ(0, std::memcmp(&rgb[3u * i], single, 3u)) << i;
+    }
+  }
+
+  std::uint8_t rgb[6];
+  ImageWriter::applyColorMap(&map[2], 2u, 1000u, 1100u, ColorMap::GRAY, rgb);
+  const std::uint8_t expected[6] = {0u, 0u, 0u, 255u, 255u, 255u};
+  EXPECT_EQ(0, std::memcmp(rgb, expected, sizeof(rgb)));
+}
+
+TEST(ImageWriterTest, PreviewPng)
+{
+  const std::vector<std::uint16_t> map = testMap();
+  ASSERT_TRUE(ImageWriter::WritePreviewPNG("ImageWriterTest_preview.png", map.data(), kWidth, kHeight, 1000u, 45000u));
+  const Png png = readPng(readFile("ImageWriterTest_preview.png"));
+  EXPECT_EQ(8u, png.bitDepth);
+  EXPECT_EQ(2u, png.colorType);
+
+  std::vector<std::uint8_t> expected(3u * map.size());
+  ImageWriter::applyColorMap(map.data(), map.size(), 1000u, 45000u, ColorMap::TURBO, expected.data());
+  EXPECT_EQ(expected, unfilter(png, 3u));
+}
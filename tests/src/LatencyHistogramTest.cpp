@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <chrono>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+#include "FrameTiming.h"
+
+using namespace visionary;
+using std::chrono::nanoseconds;
+
+TEST(LatencyHistogramTest, Empty)
+{
+  LatencyHistogram histogram;
+  const auto       summary = histogram.getSummary();
+
+  EXPECT_EQ(0u, summary.count);
+  EXPECT_EQ(0, summary.max.count());
+  EXPECT_EQ(0, histogram.getPercentile(0.5).count());
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact)
+{
+  LatencyHistogram histogram;
+  for (int i = 1; i <= 10; ++i)
+  {
+    histogram.record(nanoseconds(i));
+  }
+  const auto summary = histogram.getSummary();
+
+  EXPECT_EQ(10u, summary.count);
+  EXPECT_EQ(1, summary.min.count());
+  EXPECT_EQ(10, summary.max.count());
+  EXPECT_EQ(5, summary.mean.count());
+  EXPECT_EQ(5, summary.p50.count());
+  EXPECT_EQ(9, summary.p90.count());
+}
+
+TEST(LatencyHistogramTest, PercentileRelativeError)
+{
+  LatencyHistogram histogram;
+  // 1us .. 1000us
+  for (std::int64_t i = 1; i <= 1000; ++i)
+  {
+    histogram.record(nanoseconds(i * 1000));
+  }
+
+  EXPECT_NEAR(500000.0, static_cast<double>(histogram.getPercentile(0.5).count()), 500000.0 * 0.0625);
+  EXPECT_NEAR(990000.0, static_cast<double>(histogram.getPercentile(0.99).count()), 990000.0 * 0.0625);
+  EXPECT_EQ(1000000, histogram.getPercentile(1.0).count());
+  EXPECT_EQ(1000, histogram.getPercentile(0.0).count());
+}
+
+TEST(LatencyHistogramTest, NegativeAndHugeValues)
+{
+  LatencyHistogram histogram;
+  histogram.record(nanoseconds(-5));
+  histogram.record(std::chrono::hours(24));
+
+  const auto summary = histogram.getSummary();
+  EXPECT_EQ(2u, summary.count);
+  EXPECT_EQ(0, summary.min.count());
+  EXPECT_EQ(std::chrono::duration_cast<nanoseconds>(std::chrono::hours(24)).count(), summary.max.count());
+}
+
+TEST(LatencyHistogramTest, Reset)
+{
+  LatencyHistogram histogram;
+  histogram.record(nanoseconds(42));
+  histogram.reset();
+
+  EXPECT_EQ(0u, histogram.getCount());
+  EXPECT_EQ(0u, histogram.getSummary().count);
+}
@@ -0,0 +1,275 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "PointCloudLayout.h"
+#include "VisionaryEndian.h"
+#include "VisionarySData.h"
+#include "VisionaryTMiniData.h"
+
+using namespace visionary;
+
+namespace {
+
+constexpr int kWidth  = 32;
+constexpr int kHeight = 24;
+
+const std::string kDataStream =
+  "<Width>32</Width><Height>24</Height><CameraToWorldTransform>"
+  "<value>1</value><value>0</value><value>0</value><value>0</value><value>0</value><value>1</value><value>0</value>"
+  "<value>0</value><value>0</value><value>0</value><value>1</value><value>0</value><value>0</value><value>0</value>"
+  "<value>0</value><value>1</value></CameraToWorldTransform>"
+  "<CameraMatrix><FX>-23.1</FX><FY>-23.2</FY><CX>15.5</CX><CY>11.5</CY></CameraMatrix>"
+  "<CameraDistortionParams><K1>-0.07</K1><K2>0.2</K2><P1>0</P1><P2>0</P2><K3>0</K3></CameraDistortionParams>"
+  "<FocalToRayCross>1.5</FocalToRayCross>";
+
+const std::string kTMiniXml =
+  "<SickRecord><DataSets><DataSetDepthMap><FormatDescriptionDepthMap><DataStream>" + kDataStream
+  + "<Distance>uint16</Distance><Intensity>uint16</Intensity><Confidence>uint16</Confidence></DataStream>"
+    "</FormatDescriptionDepthMap></DataSetDepthMap></DataSets></SickRecord>";
+
+const std::string kSXml =
+  "<SickRecord><DataSets><DataSetStereo><FormatDescriptionDepthMap><DataStream>" + kDataStream
+  + "<Z decimalexponent=\"0\">uint16</Z><Intensity>uint32</Intensity><Confidence>uint16</Confidence></DataStream>"
+    "</FormatDescriptionDepthMap></DataSetStereo></DataSets></SickRecord>";
+
+const std::size_t kNumPixels = static_cast<std::size_t>(kWidth * kHeight);
+
+// depth value of a pixel, 0 (invalid) in the top left corner and 0xFFFF (invalid) in the last row
+std::uint16_t depthAt(std::size_t i)
+{
+  const std::size_t x = i % kWidth;
+  const std::size_t y = i / kWidth;
+  if ((x < 4u && y < 4u) || y == kHeight - 1u)
+  {
+    return (y == kHeight - 1u) ? 0xFFFFu : 0u;
+  }
+  return static_cast<std::uint16_t>(2000u + 7u * x + 3u * y);
+}
+
+// binary data part of data set version 1 with the given maps
+std::vector<std::uint8_t> makeBinary(const std::vector<std::vector<std::uint8_t>>& maps)
+{
+  std::vector<std::uint8_t> binary(4u + 8u + 2u, 0u);
+  writeUnalignLittleEndian<std::uint16_t>(binary.data() + 12u, 2u, 1u);
+  for (const auto& map : maps)
+  {
+    binary.insert(binary.end(), map.begin(), map.end());
+  }
+  binary.resize(binary.size() + 4u + 4u, 0u);
+  const auto length = static_cast<std::uint32_t>(binary.size());
+  writeUnalignLittleEndian<std::uint32_t>(binary.data(), 4u, length);
+  writeUnalignLittleEndian<std::uint32_t>(binary.data() + binary.size() - 4u, 4u, length);
+  return binary;
+}
+
+std::vector<std::uint8_t> makeMap16(std::uint16_t (*valueAt)(std::size_t))
+{
+  std::vector<std::uint8_t> map(2u * kNumPixels);
+  for (std::size_t i = 0u; i < kNumPixels; ++i)
+  {
+    writeUnalignLittleEndian<std::uint16_t>(map.data() + 2u * i, 2u, valueAt(i));
+  }
+  return map;
+}
+
+std::uint16_t intensityAt(std::size_t i)
+{
+  return static_cast<std::uint16_t>(i * 11u);
+}
+
+std::uint16_t stateAt(std::size_t)
+{
+  return 0u;
+}
+
+class TestTMiniFrame : public VisionaryTMiniData
+{
+public:
+  bool load()
+  {
+    std::vector<std::uint8_t> binary = makeBinary({makeMap16(depthAt), makeMap16(intensityAt), makeMap16(stateAt)});
+    return parseXML(kTMiniXml, 1u) && parseBinaryData(binary.begin(), binary.size());
+  }
+};
+
+class TestSFrame : public VisionarySData
+{
+public:
+  bool load()
+  {
+    std::vector<std::uint8_t> rgba(4u * kNumPixels);
+    for (std::size_t i = 0u; i < kNumPixels; ++i)
+    {
+      rgba[4u * i]      = static_cast<std::uint8_t>(i);
+      rgba[4u * i + 1u] = static_cast<std::uint8_t>(i >> 8u);
+      rgba[4u * i + 2u] = 0x5Au;
+      rgba[4u * i + 3u] = 0xC3u;
+    }
+    std::vector<std::uint8_t> binary = makeBinary({makeMap16(depthAt), rgba, makeMap16(stateAt)});
+    return parseXML(kSXml, 1u) && parseBinaryData(binary.begin(), binary.size());
+  }
+};
+
+template <typename T>
+T readField(const std::vector<std::uint8_t>& buffer, std::size_t offset)
+{
+  T value;
+  std::memcpy(&value, buffer.data() + offset, sizeof(value));
+  return value;
+}
+
+// data handler of an application which does not know about packed point clouds
+class LegacyData : public VisionaryData
+{
+public:
+  void generatePointCloud(std::vector<PointXYZ>& pointCloud) override
+  {
+    pointCloud.clear();
+  }
+
+protected:
+  bool parseXML(const std::string&, std::uint32_t) override
+  {
+    return false;
+  }
+
+  bool parseBinaryData(std::vector<uint8_t>::iterator, std::size_t) override
+  {
+    return false;
+  }
+};
+
+} // namespace
+
+TEST(PointCloudLayoutTest, OrganizedCloudMatchesPointVector)
+{
+  TestTMiniFrame frame;
+  ASSERT_TRUE(frame.load());
+  std::vector<PointXYZ> expected;
+  frame.generatePointCloud(expected);
+  ASSERT_EQ(kNumPixels, expected.size());
+
+  // x, y, z and 4 bytes of padding, which must not be touched
+  PointCloudLayout          layout;
+  std::vector<std::uint8_t> buffer(layout.getBufferSize(kNumPixels), 0xABu);
+  ASSERT_EQ(kNumPixels, frame.generatePackedPointCloud(layout, buffer.data(), buffer.size()));
+  for (std::size_t i = 0u; i < kNumPixels; ++i)
+  {
+    EXPECT_EQ(0, std::memcmp(&expected[i], buffer.data() + 16u * i, sizeof(PointXYZ))) << i;
+    EXPECT_EQ(0xABABABABu, readField<std::uint32_t>(buffer, 16u * i + 12u)) << i;
+  }
+
+  // float intensities in the padding
+  layout.hasIntensity = true;
+  ASSERT_EQ(kNumPixels, frame.generatePackedPointCloud(layout, buffer.data(), buffer.size()));
+  for (std::size_t i = 0u; i < kNumPixels; ++i)
+  {
+    EXPECT_EQ(static_cast<float>(intensityAt(i)), readField<float>(buffer, 16u * i + 12u)) << i;
+  }
+}
+
+TEST(PointCloudLayoutTest, DenseCloudWithColors)
+{
+  TestSFrame frame;
+  ASSERT_TRUE(frame.load());
+  std::vector<PointXYZ> expected;
+  frame.generatePointCloud(expected);
+
+  // x, y, z at 4, rgba at 16 and a uint16 intensity at 20, which the Visionary-S does not have
+  PointCloudLayout layout;
+  layout.pointStep       = 24u;
+  layout.xyzOffset       = 4u;
+  layout.hasRgba         = true;
+  layout.rgbaOffset      = 16u;
+  layout.hasIntensity    = true;
+  layout.intensityType   = PointFieldType::UINT16;
+  layout.intensityOffset = 20u;
+  layout.isDense         = true;
+  ASSERT_TRUE(layout.isValid());
+
+  std::vector<std::uint8_t> buffer(layout.getBufferSize(kNumPixels));
+  const std::size_t         numPoints = frame.generatePackedPointCloud(layout, buffer.data(), buffer.size());
+  ASSERT_EQ(kNumPixels - 16u - kWidth, numPoints);
+
+  std::size_t point = 0u;
+  for (std::size_t i = 0u; i < kNumPixels; ++i)
+  {
+    if (std::isnan(expected[i].z))
+    {
+      continue;
+    }
+    ASSERT_LT(point, numPoints);
+    const std::size_t offset = 24u * point;
+    EXPECT_EQ(0, std::memcmp(&expected[i], buffer.data() + offset + 4u, sizeof(PointXYZ))) << i;
+    // packed as 0xAARRGGBB
+    const auto expectedRgba = static_cast<std::uint32_t>(0xC3000000u | ((i & 0xFFu) << 16u) | (i >> 8u << 8u) | 0x5Au);
+    EXPECT_EQ(expectedRgba, readField<std::uint32_t>(buffer, offset + 16u)) << i;
+    EXPECT_EQ(0u, readField<std::uint16_t>(buffer, offset + 20u)) << i;
+    ++point;
+  }
+  EXPECT_EQ(numPoints, point);
+}
+
+TEST(PointCloudLayoutTest, FieldsAndValidation)
+{
+  PointCloudLayout layout;
+  layout.pointStep    = 32u;
+  layout.hasIntensity = true;
+  layout.hasRgba      = true;
+  ASSERT_TRUE(layout.isValid());
+  const std::vector<PointField> fields = layout.getFields();
+  ASSERT_EQ(5u, fields.size());
+  EXPECT_EQ("x", fields[0].name);
+  EXPECT_EQ(0u, fields[0].offset);
+  EXPECT_EQ(PointFieldType::FLOAT32, fields[0].datatype);
+  EXPECT_EQ("z", fields[2].name);
+  EXPECT_EQ(8u, fields[2].offset);
+  EXPECT_EQ("intensity", fields[3].name);
+  EXPECT_EQ(12u, fields[3].offset);
+  EXPECT_EQ("rgba", fields[4].name);
+  EXPECT_EQ(16u, fields[4].offset);
+  EXPECT_EQ(PointFieldType::UINT32, fields[4].datatype);
+  EXPECT_EQ(1u, fields[4].count);
+  EXPECT_EQ(320u, layout.getBufferSize(10u));
+
+  PointCloudLayout invalid = layout;
+  invalid.rgbaOffset       = 14u; // overlaps the intensity
+  EXPECT_FALSE(invalid.isValid());
+
+  invalid           = layout;
+  invalid.xyzOffset = 24u; // beyond the point step
+  EXPECT_FALSE(invalid.isValid());
+
+  invalid               = layout;
+  invalid.intensityType = PointFieldType::FLOAT64;
+  EXPECT_FALSE(invalid.isValid());
+
+  invalid            = layout;
+  invalid.rgbaOffset = 0xFFFFFFFEu; // must not wrap around
+  EXPECT_FALSE(invalid.isValid());
+
+  TestTMiniFrame frame;
+  ASSERT_TRUE(frame.load());
+  std::vector<std::uint8_t> buffer(layout.getBufferSize(kNumPixels));
+  EXPECT_THROW(frame.generatePackedPointCloud(invalid, buffer.data(), buffer.size()), std::invalid_argument);
+  EXPECT_THROW(frame.generatePackedPointCloud(layout, buffer.data(), buffer.size() - 1u), std::invalid_argument);
+}
+
+TEST(PointCloudLayoutTest, DefaultForHandlersWithoutPackedCloud)
+{
+  LegacyData                frame;
+  PointCloudLayout          layout;
+  std::vector<std::uint8_t> buffer(layout.getBufferSize(kNumPixels), 0xABu);
+  EXPECT_EQ(0u, frame.generatePackedPointCloud(layout, buffer.data(), buffer.size()));
+  EXPECT_EQ(std::vector<std::uint8_t>(buffer.size(), 0xABu), buffer);
+}
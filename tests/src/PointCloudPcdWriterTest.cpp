@@ -0,0 +1,171 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Lzf.h"
+#include "PointCloudPcdWriter.h"
+
+using namespace visionary;
+
+namespace {
+
+const float kNaN = std::numeric_limits<float>::quiet_NaN();
+
+std::string readFile(const char* filename)
+{
+  std::ifstream stream(filename, std::ios_base::in | std::ios_base::binary);
+  return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+std::vector<PointXYZ> testCloud()
+{
+  return std::vector<PointXYZ>{{0.5f, -1.25f, 2.0f}, {kNaN, kNaN, kNaN}, {1.0f, 2.0f, 1000.0f}, {3.0f, 4.0f, 5.0f}};
+}
+
+} // namespace
+
+TEST(PointCloudPcdWriterTest, AsciiOrganized)
+{
+  const char* filename = "PointCloudPcdWriterTest_ascii.pcd";
+
+  const std::vector<uint32_t> colors{0x00030201u, 0x00060504u, 0x00090807u, 0x000c0b0au};
+  ASSERT_TRUE(PointCloudPcdWriter::WriteFormatPCD(
+    filename, testCloud(), colors, std::vector<uint16_t>(), 2u, 2u, PcdEncoding::ASCII, INVALID_AS_ZERO));
+
+  EXPECT_EQ("# .PCD v0.7 - Point Cloud Data file format\n"
+            "VERSION 0.7\n"
+            "FIELDS x y z rgb\n"
+            "SIZE 4 4 4 4\n"
+            "TYPE F F F U\n"
+            "COUNT 1 1 1 1\n"
+            "WIDTH 2\n"
+            "HEIGHT 2\n"
+            "VIEWPOINT 0 0 0 1 0 0 0\n"
+            "POINTS 4\n"
+            "DATA ascii\n"
+            "0.5 -1.25 2 66051\n"
+            "0 0 0 263430\n"
+            "1 2 1000 460809\n"
+            "3 4 5 658188\n",
+            readFile(filename));
+  std::remove(filename);
+}
+
+TEST(PointCloudPcdWriterTest, BinarySkipIsUnorganized)
+{
+  const char* filename = "PointCloudPcdWriterTest_binary.pcd";
+
+  const std::vector<uint16_t> intensities{0u, 0u, 65535u, 0u};
+  ASSERT_TRUE(PointCloudPcdWriter::WriteFormatPCD(
+    filename, testCloud(), std::vector<uint32_t>(), intensities, 2u, 2u, PcdEncoding::BINARY, INVALID_SKIP));
+
+  const std::string content = readFile(filename);
+  EXPECT_NE(std::string::npos, content.find("FIELDS x y z intensity\n"));
+  EXPECT_NE(std::string::npos, content.find("WIDTH 3\nHEIGHT 1\n"));
+  const std::size_t dataStart = content.find("DATA binary\n") + 12u;
+  ASSERT_EQ(dataStart + 3u * 16u, content.size());
+
+  float values[12];
+  std::memcpy(values, content.data() + dataStart, sizeof(values));
+  EXPECT_EQ(0.5f, values[0]);
+  EXPECT_EQ(1000.0f, values[6]);
+  EXPECT_EQ(1.0f, values[7]);
+  EXPECT_EQ(5.0f, values[10]);
+  std::remove(filename);
+}
+
+TEST(PointCloudPcdWriterTest, BinaryCompressed)
+{
+  const char* filename = "PointCloudPcdWriterTest_compressed.pcd";
+
+  const std::uint32_t   width  = 64u;
+  const std::uint32_t   height = 48u;
+  std::vector<PointXYZ> points(width * height);
+  for (std::size_t i = 0u; i < points.size(); ++i)
+  {
+    const float value = static_cast<float>(i % width);
+    points[i]         = (i % 7u == 0u) ? PointXYZ{kNaN, kNaN, kNaN} : PointXYZ{value, -value, 1000.0f};
+  }
+  ASSERT_TRUE(PointCloudPcdWriter::WriteFormatPCD(
+    filename, points, width, height, PcdEncoding::BINARY_COMPRESSED, INVALID_AS_NAN));
+
+  const std::string content   = readFile(filename);
+  const std::size_t dataStart = content.find("DATA binary_compressed\n") + 23u;
+  ASSERT_LT(dataStart + 8u, content.size());
+
+  std::uint32_t sizes[2];
+  std::memcpy(sizes, content.data() + dataStart, sizeof(sizes));
+  EXPECT_EQ(points.size() * 12u, sizes[1]);
+  EXPECT_LT(sizes[0], sizes[1] / 4u);
+  ASSERT_EQ(dataStart + 8u + sizes[0], content.size());
+
+  std::vector<std::uint8_t> fieldData(sizes[1]);
+  ASSERT_EQ(sizes[1],
+            lzfDecompress(reinterpret_cast<const std::uint8_t*>(content.data()) + dataStart + 8u,
+                          sizes[0],
+                          fieldData.data(),
+                          fieldData.size()));
+  for (std::size_t i = 0u; i < points.size(); ++i)
+  {
+    float x, z;
+    std::memcpy(&x, fieldData.data() + i * 4u, 4u);
+    std::memcpy(&z, fieldData.data() + (2u * points.size() + i) * 4u, 4u);
+    if (i % 7u == 0u)
+    {
+      EXPECT_TRUE(std::isnan(x));
+    }
+    else
+    {
+      EXPECT_EQ(points[i].x, x);
+      EXPECT_EQ(points[i].z, z);
+    }
+  }
+  std::remove(filename);
+}
+
+TEST(PointCloudPcdWriterTest, RejectsWrongSize)
+{
+  EXPECT_FALSE(PointCloudPcdWriter::WriteFormatPCD(
+    "PointCloudPcdWriterTest_size.pcd", testCloud(), 3u, 2u, PcdEncoding::BINARY, INVALID_AS_NAN));
+}
+
+TEST(LzfTest, Roundtrip)
+{
+  std::mt19937              generator(7u);
+  std::vector<std::uint8_t> input(100000u);
+  for (std::size_t i = 0u; i < input.size(); ++i)
+  {
+    // runs, repetitions with various distances and noise
+    input[i] = (i % 1000u < 300u) ? 0u : (i % 1000u < 600u) ? static_cast<std::uint8_t>(i % 37u)
+                                                            : static_cast<std::uint8_t>(generator());
+  }
+
+  std::vector<std::uint8_t> compressed(lzfMaxCompressedSize(input.size()));
+  const std::size_t         compressedSize =
+    lzfCompress(input.data(), input.size(), compressed.data(), compressed.size());
+  ASSERT_GT(compressedSize, 0u);
+  EXPECT_LT(compressedSize, input.size());
+
+  std::vector<std::uint8_t> output(input.size());
+  ASSERT_EQ(input.size(), lzfDecompress(compressed.data(), compressedSize, output.data(), output.size()));
+  EXPECT_EQ(input, output);
+
+  // incompressible data fits into the worst case size
+  for (auto& value : input)
+  {
+    value = static_cast<std::uint8_t>(generator());
+  }
+  ASSERT_GT(lzfCompress(input.data(), input.size(), compressed.data(), compressed.size()), 0u);
+}
@@ -0,0 +1,185 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "PointCloudPlyReader.h"
+#include "PointCloudPlyWriter.h"
+
+using namespace visionary;
+
+namespace {
+
+std::vector<PointXYZ> makePoints(std::size_t numPoints)
+{
+  std::mt19937                          generator(3u);
+  std::uniform_real_distribution<float> coordinate(-5.0f, 5.0f);
+  std::vector<PointXYZ>                 points(numPoints);
+  for (std::size_t i = 0u; i < numPoints; ++i)
+  {
+    points[i] = PointXYZ{coordinate(generator), coordinate(generator), coordinate(generator)};
+    if (i % 7u == 0u)
+    {
+      const float nan = std::numeric_limits<float>::quiet_NaN();
+      points[i]       = PointXYZ{nan, nan, nan};
+    }
+  }
+  return points;
+}
+
+void expectSamePoints(const std::vector<PointXYZ>& expected, const std::vector<PointXYZ>& actual)
+{
+  ASSERT_EQ(expected.size(), actual.size());
+  for (std::size_t i = 0u; i < expected.size(); ++i)
+  {
+    if (std::isnan(expected[i].z))
+    {
+      EXPECT_TRUE(std::isnan(actual[i].x) && std::isnan(actual[i].y) && std::isnan(actual[i].z)) << i;
+    }
+    else
+    {
+      // the ascii files contain round-trip representations, so both formats read back exactly
+      EXPECT_EQ(0, std::memcmp(&expected[i], &actual[i], sizeof(PointXYZ))) << i;
+    }
+  }
+}
+
+void writeFile(const char* filename, const std::string& content)
+{
+  std::ofstream stream(filename, std::ios_base::out | std::ios_base::binary);
+  stream.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+} // namespace
+
+TEST(PointCloudPlyReaderTest, ReadsWrittenPoints)
+{
+  const char*                 filename = "PointCloudPlyReaderTest.ply";
+  const std::vector<PointXYZ> points   = makePoints(100000u);
+  for (const bool useBinary : {true, false})
+  {
+    ASSERT_TRUE(PointCloudPlyWriter::WriteFormatPLY(filename, points, useBinary));
+
+    std::vector<PointXYZ> readPoints;
+    ASSERT_TRUE(PointCloudPlyReader::ReadFormatPLY(filename, readPoints));
+    expectSamePoints(points, readPoints);
+  }
+  std::remove(filename);
+}
+
+TEST(PointCloudPlyReaderTest, ReadsColorsAndIntensities)
+{
+  const char*                 filename = "PointCloudPlyReaderTest_colors.ply";
+  const std::vector<PointXYZ> points   = makePoints(1000u);
+  std::vector<std::uint32_t>  rgbaMap(points.size());
+  std::vector<std::uint16_t>  intensityMap(points.size());
+  for (std::size_t i = 0u; i < points.size(); ++i)
+  {
+    // alpha is not written, it reads back as 255
+    const std::uint8_t rgba[4] = {static_cast<std::uint8_t>(i), static_cast<std::uint8_t>(i * 3u), 200u, 255u};
+    std::memcpy(&rgbaMap[i], rgba, sizeof(rgba));
+    intensityMap[i] = static_cast<std::uint16_t>(i * 65u);
+  }
+
+  for (const bool useBinary : {true, false})
+  {
+    ASSERT_TRUE(PointCloudPlyWriter::WriteFormatPLY(filename, points, rgbaMap, intensityMap, useBinary));
+
+    std::vector<PointXYZ>      readPoints;
+    std::vector<std::uint32_t> readRgbaMap;
+    std::vector<std::uint16_t> readIntensityMap;
+    ASSERT_TRUE(PointCloudPlyReader::ReadFormatPLY(filename, readPoints, readRgbaMap, readIntensityMap));
+    expectSamePoints(points, readPoints);
+    EXPECT_EQ(rgbaMap, readRgbaMap);
+    EXPECT_EQ(intensityMap, readIntensityMap);
+  }
+
+  // without the properties the maps are empty
+  ASSERT_TRUE(PointCloudPlyWriter::WriteFormatPLY(filename, points, true));
+  std::vector<PointXYZ>      readPoints;
+  std::vector<std::uint32_t> readRgbaMap(3u);
+  std::vector<std::uint16_t> readIntensityMap(3u);
+  ASSERT_TRUE(PointCloudPlyReader::ReadFormatPLY(filename, readPoints, readRgbaMap, readIntensityMap));
+  EXPECT_TRUE(readRgbaMap.empty());
+  EXPECT_TRUE(readIntensityMap.empty());
+  std::remove(filename);
+}
+
+TEST(PointCloudPlyReaderTest, ReadsOtherLayouts)
+{
+  const char* filename = "PointCloudPlyReaderTest_layout.ply";
+
+  // double coordinates, an extra property in front, faces after the vertices and CRLF line ends
+  writeFile(filename,
+            "ply\r\nformat ascii 1.0\r\ncomment written by hand\r\nelement vertex 2\r\nproperty int id\r\n"
+            "property double x\r\nproperty double y\r\nproperty double z\r\nproperty ushort intensity\r\n"
+            "element face 1\r\nproperty list uchar int vertex_indices\r\nend_header\r\n"
+            "7 1.5 -2 3e2 1000\r\n8 0.25 0.5 nan 65535\r\n3 0 1 1\r\n");
+  std::vector<PointXYZ>      points;
+  std::vector<std::uint32_t> rgbaMap;
+  std::vector<std::uint16_t> intensityMap;
+  ASSERT_TRUE(PointCloudPlyReader::ReadFormatPLY(filename, points, rgbaMap, intensityMap));
+  ASSERT_EQ(2u, points.size());
+  EXPECT_EQ(1.5f, points[0].x);
+  EXPECT_EQ(-2.0f, points[0].y);
+  EXPECT_EQ(300.0f, points[0].z);
+  EXPECT_TRUE(std::isnan(points[1].z));
+  EXPECT_TRUE(rgbaMap.empty());
+  EXPECT_EQ((std::vector<std::uint16_t>{1000u, 65535u}), intensityMap);
+
+  // big endian binary
+  std::string binary = "ply\nformat binary_big_endian 1.0\nelement vertex 1\nproperty float x\nproperty float y\n"
+                       "property float z\nproperty uchar red\nproperty uchar green\nproperty uchar blue\nend_header\n";
+  binary.append("\x3f\x80\x00\x00\x40\x00\x00\x00\xc0\x40\x00\x00\x01\x02\x03", 15u);
+  writeFile(filename, binary);
+  ASSERT_TRUE(PointCloudPlyReader::ReadFormatPLY(filename, points, rgbaMap, intensityMap));
+  ASSERT_EQ(1u, points.size());
+  EXPECT_EQ(1.0f, points[0].x);
+  EXPECT_EQ(2.0f, points[0].y);
+  EXPECT_EQ(-3.0f, points[0].z);
+  ASSERT_EQ(1u, rgbaMap.size());
+  const std::uint8_t expectedRgba[4] = {1u, 2u, 3u, 255u};
+  EXPECT_EQ(0, std::memcmp(expectedRgba, &rgbaMap[0], sizeof(expectedRgba)));
+  EXPECT_TRUE(intensityMap.empty());
+  std::remove(filename);
+}
+
+TEST(PointCloudPlyReaderTest, RejectsInvalidFiles)
+{
+  const char*           filename = "PointCloudPlyReaderTest_invalid.ply";
+  std::vector<PointXYZ> points;
+
+  EXPECT_FALSE(PointCloudPlyReader::ReadFormatPLY("PointCloudPlyReaderTest_missing.ply", points));
+
+  writeFile(filename, "not a ply file\n");
+  EXPECT_FALSE(PointCloudPlyReader::ReadFormatPLY(filename, points));
+
+  // missing z
+  writeFile(filename, "ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nproperty float y\nend_header\n1 2\n");
+  EXPECT_FALSE(PointCloudPlyReader::ReadFormatPLY(filename, points));
+
+  // fewer vertices than announced
+  writeFile(filename, "ply\nformat ascii 1.0\nelement vertex 3\nproperty float x\nproperty float y\nproperty float z\n"
+                      "end_header\n1 2 3\n4 5 6\n");
+  EXPECT_FALSE(PointCloudPlyReader::ReadFormatPLY(filename, points));
+  writeFile(filename, "ply\nformat binary_little_endian 1.0\nelement vertex 3\nproperty float x\nproperty float y\n"
+                      "property float z\nend_header\n" + std::string(24u, '\0'));
+  EXPECT_FALSE(PointCloudPlyReader::ReadFormatPLY(filename, points));
+
+  // malformed number
+  writeFile(filename, "ply\nformat ascii 1.0\nelement vertex 1\nproperty float x\nproperty float y\nproperty float z\n"
+                      "end_header\n1 2 x3\n");
+  EXPECT_FALSE(PointCloudPlyReader::ReadFormatPLY(filename, points));
+  std::remove(filename);
+}
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "PointCloudPlyWriter.h"
+
+using namespace visionary;
+
+namespace {
+
+const float kNaN = std::numeric_limits<float>::quiet_NaN();
+
+std::string readFile(const char* filename)
+{
+  std::ifstream stream(filename, std::ios_base::in | std::ios_base::binary);
+  return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+std::vector<PointXYZ> testCloud()
+{
+  return std::vector<PointXYZ>{{0.5f, -1.25f, 2.0f}, {kNaN, kNaN, kNaN}, {1.0f, 2.0f, 1000.0f}};
+}
+
+} // namespace
+
+TEST(PointCloudPlyWriterTest, AsciiSkipsInvalidPoints)
+{
+  const char* filename = "PointCloudPlyWriterTest_ascii.ply";
+
+  const std::vector<uint16_t> intensities{65535u, 0u, 0u};
+  ASSERT_TRUE(PointCloudPlyWriter::WriteFormatPLY(filename, testCloud(), intensities, false, INVALID_SKIP));
+
+  EXPECT_EQ("ply\n"
+            "format ascii 1.0\n"
+            "element vertex 2\n"
+            "property float x\n"
+            "property float y\n"
+            "property float z\n"
+            "property float intensity\n"
+            "end_header\n"
+            "0.5 -1.25 2 1\n"
+            "1 2 1000 0\n",
+            readFile(filename));
+  std::remove(filename);
+}
+
+TEST(PointCloudPlyWriterTest, AsciiInvalidAsZero)
+{
+  const char* filename = "PointCloudPlyWriterTest_zero.ply";
+
+  const std::vector<uint32_t> colors{0x00030201u, 0x00060504u, 0x00090807u};
+  ASSERT_TRUE(PointCloudPlyWriter::WriteFormatPLY(filename, testCloud(), colors, false, INVALID_AS_ZERO));
+
+  const std::string content = readFile(filename);
+  EXPECT_NE(std::string::npos, content.find("element vertex 3\n"));
+  EXPECT_NE(std::string::npos, content.find("end_header\n0.5 -1.25 2 1 2 3\n0.0 0.0 0.0 4 5 6\n1 2 1000 7 8 9\n"));
+  std::remove(filename);
+}
+
+TEST(PointCloudPlyWriterTest, BinaryLargeCloud)
+{
+  const char* filename = "PointCloudPlyWriterTest_binary.ply";
+
+  // larger than the write buffer, with every third point invalid
+  std::vector<PointXYZ> points(200000u);
+  for (std::size_t i = 0u; i < points.size(); ++i)
+  {
+    const float value = static_cast<float>(i);
+    points[i]         = (i % 3u == 1u) ? PointXYZ{kNaN, kNaN, kNaN} : PointXYZ{value, -value, 0.5f * value};
+  }
+
+  const std::string header = "ply\n"
+                             "format binary_little_endian 1.0\n"
+                             "element vertex 200000\n"
+                             "property float x\n"
+                             "property float y\n"
+                             "property float z\n"
+                             "end_header\n";
+
+  ASSERT_TRUE(PointCloudPlyWriter::WriteFormatPLY(filename, points, true, INVALID_AS_NAN));
+  std::string content = readFile(filename);
+  ASSERT_EQ(header.size() + points.size() * 12u, content.size());
+  EXPECT_EQ(header, content.substr(0u, header.size()));
+
+  ASSERT_TRUE(PointCloudPlyWriter::WriteFormatPLY(filename, points, true, INVALID_SKIP));
+  content = readFile(filename);
+  const std::size_t numValid = 133333u;
+  ASSERT_EQ(header.size() + numValid * 12u, content.size());
+  EXPECT_NE(std::string::npos, content.find("element vertex 133333\n"));
+
+  // point 199999 is invalid, so the last one is 199998
+  float last[3];
+  std::memcpy(last, content.data() + content.size() - 12u, 12u);
+  EXPECT_EQ(199998.0f, last[0]);
+  EXPECT_EQ(-199998.0f, last[1]);
+  EXPECT_EQ(99999.0f, last[2]);
+  std::remove(filename);
+}
+
+TEST(PointCloudPlyWriterTest, FailsOnUnwritableFile)
+{
+  EXPECT_FALSE(PointCloudPlyWriter::WriteFormatPLY("no_such_directory/cloud.ply", testCloud(), true));
+}
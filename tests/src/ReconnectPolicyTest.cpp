@@ -0,0 +1,46 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <chrono>
+
+#include "gtest/gtest.h"
+
+#include "ReconnectPolicy.h"
+
+using namespace visionary;
+
+TEST(ReconnectPolicyTest, FirstAttemptIsImmediate)
+{
+  ReconnectPolicy policy;
+
+  EXPECT_EQ(0, policy.getBackoff(0u, 0.0).count());
+  EXPECT_EQ(0, policy.getBackoff(0u, 1.0).count());
+}
+
+TEST(ReconnectPolicyTest, ExponentialGrowthUpToLimit)
+{
+  ReconnectPolicy policy;
+  policy.initialBackoff    = std::chrono::milliseconds(50);
+  policy.maxBackoff        = std::chrono::milliseconds(1000);
+  policy.backoffMultiplier = 2.0;
+  policy.jitter            = 0.0;
+
+  EXPECT_EQ(50, policy.getBackoff(1u, 0.5).count());
+  EXPECT_EQ(100, policy.getBackoff(2u, 0.5).count());
+  EXPECT_EQ(400, policy.getBackoff(4u, 0.5).count());
+  EXPECT_EQ(1000, policy.getBackoff(6u, 0.5).count());
+  EXPECT_EQ(1000, policy.getBackoff(1000u, 0.5).count());
+}
+
+TEST(ReconnectPolicyTest, JitterBounds)
+{
+  ReconnectPolicy policy;
+  policy.initialBackoff = std::chrono::milliseconds(100);
+  policy.jitter         = 0.2;
+
+  EXPECT_EQ(80, policy.getBackoff(1u, 0.0).count());
+  EXPECT_EQ(100, policy.getBackoff(1u, 0.5).count());
+  EXPECT_GE(120, policy.getBackoff(1u, 0.999999).count());
+  EXPECT_LE(119, policy.getBackoff(1u, 0.999999).count());
+}
@@ -0,0 +1,203 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "SequenceFile.h"
+#include "VisionaryEndian.h"
+#include "VisionaryTMiniData.h"
+
+using namespace visionary;
+
+namespace {
+
+constexpr int kWidth  = 64;
+constexpr int kHeight = 48;
+
+const std::string kXml =
+  "<SickRecord><DataSets><DataSetDepthMap><FormatDescriptionDepthMap><DataStream>"
+  "<Width>64</Width><Height>48</Height><CameraToWorldTransform>"
+  "<value>1</value><value>0</value><value>0</value><value>0</value><value>0</value><value>1</value><value>0</value>"
+  "<value>0</value><value>0</value><value>0</value><value>1</value><value>-10</value><value>0</value><value>0</value>"
+  "<value>0</value><value>1</value></CameraToWorldTransform>"
+  "<CameraMatrix><FX>-46.1</FX><FY>-46.2</FY><CX>31.5</CX><CY>23.5</CY></CameraMatrix>"
+  "<CameraDistortionParams><K1>-0.07</K1><K2>0.2</K2><P1>0</P1><P2>0</P2><K3>0</K3></CameraDistortionParams>"
+  "<Distance>uint16</Distance><Intensity>uint16</Intensity><Confidence>uint16</Confidence>"
+  "</DataStream></FormatDescriptionDepthMap></DataSetDepthMap></DataSets></SickRecord>";
+
+// device timestamp of 2024-05-01 10:00:<second>.000
+std::uint64_t makeTimestamp(std::uint64_t second)
+{
+  return (2024ull << 46) | (5ull << 42) | (1ull << 37) | (10ull << 22) | (second << 10);
+}
+
+// a Visionary-T Mini frame parsed from a generated binary data part
+class TestFrame : public VisionaryTMiniData
+{
+public:
+  bool load(std::uint32_t frameNum, std::uint64_t timestamp)
+  {
+    const std::size_t         numPixels = static_cast<std::size_t>(kWidth * kHeight);
+    std::vector<std::uint8_t> binary(4u + 8u + 2u + 6u + 3u * 2u * numPixels + 4u + 4u, 0u);
+    const auto                length = static_cast<std::uint32_t>(binary.size());
+
+    std::uint8_t* pData = binary.data();
+    writeUnalignLittleEndian<std::uint32_t>(pData, 4u, length);
+    writeUnalignLittleEndian<std::uint64_t>(pData + 4u, 8u, timestamp);
+    writeUnalignLittleEndian<std::uint16_t>(pData + 12u, 2u, 2u);
+    writeUnalignLittleEndian<std::uint32_t>(pData + 14u, 4u, frameNum);
+    pData[18] = 3u; // data quality
+    pData += 20u;
+    for (std::size_t i = 0u; i < numPixels; ++i)
+    {
+      const std::size_t x = i % kWidth;
+      const std::size_t y = i / kWidth;
+      // distance with an invalid region, intensity and state
+      const std::uint16_t distance =
+        ((x < 8u) && (y < 8u)) ? 0u : static_cast<std::uint16_t>(4000u + 3u * x + y + frameNum);
+      writeUnalignLittleEndian<std::uint16_t>(pData + 2u * i, 2u, distance);
+      writeUnalignLittleEndian<std::uint16_t>(pData + 2u * (numPixels + i), 2u, static_cast<std::uint16_t>(x * y));
+      writeUnalignLittleEndian<std::uint16_t>(pData + 2u * (2u * numPixels + i), 2u, (distance == 0u) ? 1u : 0u);
+    }
+    writeUnalignLittleEndian<std::uint32_t>(binary.data() + binary.size() - 4u, 4u, length);
+
+    return parseXML(kXml, 1u) && parseBinaryData(binary.begin(), binary.size());
+  }
+};
+
+std::vector<std::uint8_t> readFile(const std::string& filename)
+{
+  std::ifstream stream(filename, std::ios_base::in | std::ios_base::binary);
+  return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& filename, const std::vector<std::uint8_t>& content)
+{
+  std::ofstream stream(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  stream.write(reinterpret_cast<const char*>(content.data()), static_cast<std::streamsize>(content.size()));
+}
+
+} // namespace
+
+TEST(SequenceFileTest, WriteAndReadFrames)
+{
+  for (const auto compression : {SequenceCompression::NONE, SequenceCompression::DEPTH_MAP_CODEC})
+  {
+    const std::string      filename = "SequenceFileTest.vseq";
+    std::vector<TestFrame> frames(5u);
+    {
+      SequenceWriter writer;
+      ASSERT_TRUE(writer.open(filename, compression));
+      for (std::size_t i = 0u; i < frames.size(); ++i)
+      {
+        ASSERT_TRUE(frames[i].load(static_cast<std::uint32_t>(100u + i), makeTimestamp(i)));
+        ASSERT_TRUE(writer.append(frames[i]));
+      }
+      EXPECT_EQ(frames.size(), writer.getFrameCount());
+      EXPECT_TRUE(writer.close());
+    }
+
+    SequenceReader reader;
+    ASSERT_TRUE(reader.open(filename));
+    EXPECT_FALSE(reader.isIndexRecovered());
+    ASSERT_EQ(frames.size(), reader.getFrameCount());
+    EXPECT_EQ(VisionaryType::eVisionaryTMini, reader.getVisionaryType());
+    EXPECT_EQ(kWidth, reader.getCameraParameters().width);
+    EXPECT_DOUBLE_EQ(-46.1, reader.getCameraParameters().fx);
+    EXPECT_DOUBLE_EQ(-10.0, reader.getCameraParameters().cam2worldMatrix[11]);
+    EXPECT_FLOAT_EQ(VisionaryTMiniData::DISTANCE_MAP_UNIT, reader.getScaleZ());
+
+    // random access in reverse order, reusing one frame object
+    SequenceFrameData frame;
+    for (std::size_t i = frames.size(); i-- > 0u;)
+    {
+      SequenceFrameInfo info;
+      ASSERT_TRUE(reader.getFrameInfo(i, info));
+      EXPECT_EQ(100u + i, info.frameNum);
+      EXPECT_EQ(frames[i].getTimestampMS(), info.timestampMS);
+      EXPECT_EQ(3u, info.dataQuality);
+
+      ASSERT_TRUE(reader.readFrame(i, frame));
+      EXPECT_EQ(frames[i].getFrameNum(), frame.getFrameNum());
+      EXPECT_EQ(frames[i].getTimestamp(), frame.getTimestamp());
+      EXPECT_EQ(frames[i].getTimestampMS(), frame.getTimestampMS());
+      EXPECT_EQ(frames[i].getDistanceMap(), frame.getDepthMap());
+      EXPECT_EQ(frames[i].getIntensityMap(), frame.getIntensityMap());
+      EXPECT_EQ(frames[i].getStateMap(), frame.getStateMap());
+
+      std::vector<PointXYZ> expected;
+      std::vector<PointXYZ> actual;
+      frames[i].generatePointCloud(expected);
+      frame.generatePointCloud(actual);
+      ASSERT_EQ(expected.size(), actual.size());
+      EXPECT_EQ(0, std::memcmp(expected.data(), actual.data(), expected.size() * sizeof(PointXYZ)));
+    }
+    EXPECT_FALSE(reader.readFrame(frames.size(), frame));
+
+    EXPECT_EQ(0u, reader.findFrame(0u));
+    EXPECT_EQ(2u, reader.findFrame(frames[2].getTimestampMS()));
+    EXPECT_EQ(3u, reader.findFrame(frames[2].getTimestampMS() + 1u));
+    EXPECT_EQ(frames.size(), reader.findFrame(frames.back().getTimestampMS() + 1u));
+  }
+}
+
+TEST(SequenceFileTest, RecoversIndexOfUnfinishedFile)
+{
+  const std::string filename = "SequenceFileTest_unfinished.vseq";
+  TestFrame         source;
+  {
+    SequenceWriter writer;
+    ASSERT_TRUE(writer.open(filename));
+    for (std::uint32_t i = 0u; i < 3u; ++i)
+    {
+      ASSERT_TRUE(source.load(i, makeTimestamp(i)));
+      ASSERT_TRUE(writer.append(source));
+    }
+    ASSERT_TRUE(writer.close());
+  }
+
+  // as if the recording was interrupted while writing the third frame: no index and a truncated last record
+  std::vector<std::uint8_t> content = readFile(filename);
+  std::fill(content.begin() + 232, content.begin() + 248, 0u);
+  content.resize(content.size() - 3u * 40u - 10u);
+  writeFile(filename, content);
+
+  SequenceReader reader;
+  ASSERT_TRUE(reader.open(filename));
+  EXPECT_TRUE(reader.isIndexRecovered());
+  ASSERT_EQ(2u, reader.getFrameCount());
+  SequenceFrameData frame;
+  ASSERT_TRUE(reader.readFrame(1u, frame));
+  EXPECT_EQ(1u, frame.getFrameNum());
+  EXPECT_EQ(static_cast<std::size_t>(kWidth * kHeight), frame.getDepthMap().size());
+}
+
+TEST(SequenceFileTest, RejectsInvalidInput)
+{
+  const std::string filename = "SequenceFileTest_invalid.vseq";
+
+  // frames without camera data do not match the first frame
+  SequenceWriter writer;
+  ASSERT_TRUE(writer.open(filename));
+  TestFrame frame;
+  ASSERT_TRUE(frame.load(1u, makeTimestamp(1u)));
+  EXPECT_TRUE(writer.append(frame));
+  EXPECT_FALSE(writer.append(VisionaryTMiniData()));
+  EXPECT_TRUE(writer.close());
+  EXPECT_FALSE(writer.append(frame));
+
+  writeFile(filename, std::vector<std::uint8_t>(300u, 0u));
+  SequenceReader reader;
+  EXPECT_FALSE(reader.open(filename));
+  EXPECT_FALSE(reader.open("SequenceFileTest_missing.vseq"));
+  EXPECT_FALSE(reader.isOpen());
+}
@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+#include <chrono>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+#include "StreamStatistics.h"
+
+using namespace visionary;
+using Clock = StreamStatisticsCollector::Clock;
+
+TEST(StreamStatisticsTest, Empty)
+{
+  StreamStatisticsCollector collector;
+  const auto                stats = collector.getStatistics();
+
+  EXPECT_EQ(0u, stats.framesReceived);
+  EXPECT_EQ(0u, stats.framesParsed);
+  EXPECT_EQ(0.0, stats.currentFps);
+  EXPECT_EQ(0.0, stats.averageFps);
+  EXPECT_EQ(0, stats.jitter.count());
+}
+
+TEST(StreamStatisticsTest, RatesOfRegularStream)
+{
+  StreamStatisticsCollector collector;
+  const auto                start = Clock::now();
+
+  // 11 frames of 1000 bytes at 10ms intervals
+  for (int i = 0; i <= 10; ++i)
+  {
+    collector.onFrameReceived(1000u, start + std::chrono::milliseconds(10 * i));
+    collector.onFrameParsed(2u, static_cast<std::uint32_t>(i));
+  }
+  const auto stats = collector.getStatistics();
+
+  EXPECT_EQ(11u, stats.framesReceived);
+  EXPECT_EQ(11u, stats.framesParsed);
+  EXPECT_EQ(11000u, stats.bytesReceived);
+  EXPECT_NEAR(100.0, stats.currentFps, 1e-6);
+  EXPECT_NEAR(100.0, stats.averageFps, 1e-6);
+  EXPECT_NEAR(100000.0, stats.bytesPerSecond, 1e-3);
+  EXPECT_EQ(0, stats.jitter.count());
+  EXPECT_EQ(0u, stats.frameNumberGaps);
+}
+
+TEST(StreamStatisticsTest, JitterOfIrregularStream)
+{
+  StreamStatisticsCollector collector;
+  auto                      arrival = Clock::now();
+
+  // intervals alternate between 9ms and 11ms, the estimator converges to the 2ms deviation
+  for (int i = 0; i < 200; ++i)
+  {
+    collector.onFrameReceived(1u, arrival);
+    arrival += std::chrono::milliseconds((i % 2 == 0) ? 9 : 11);
+  }
+  const auto stats = collector.getStatistics();
+
+  EXPECT_NEAR(2.0e6, static_cast<double>(stats.jitter.count()), 0.05e6);
+  EXPECT_NEAR(100.0, stats.averageFps, 0.5);
+}
+
+TEST(StreamStatisticsTest, ReconnectSkipsOutageInterval)
+{
+  StreamStatisticsCollector collector;
+  auto                      arrival = Clock::now();
+  const auto                period  = std::chrono::milliseconds(33);
+
+  for (int i = 0; i < 10; ++i)
+  {
+    collector.onFrameReceived(1u, arrival);
+    arrival += period;
+  }
+  collector.onReconnect();
+
+  // the first frame after the outage does not form an interval
+  arrival += std::chrono::seconds(5);
+  collector.onFrameReceived(1u, arrival);
+  auto stats = collector.getStatistics();
+  EXPECT_EQ(0.0, stats.currentFps);
+  EXPECT_EQ(0, stats.jitter.count());
+
+  for (int i = 0; i < 3; ++i)
+  {
+    arrival += period;
+    collector.onFrameReceived(1u, arrival);
+  }
+  stats = collector.getStatistics();
+  EXPECT_NEAR(1000.0 / 33.0, stats.currentFps, 1e-6);
+  EXPECT_EQ(0, stats.jitter.count());
+}
+
+TEST(StreamStatisticsTest, FrameNumberGaps)
+{
+  StreamStatisticsCollector collector;
+
+  collector.onFrameParsed(2u, 10u);
+  collector.onFrameParsed(2u, 11u);
+  collector.onFrameParsed(2u, 14u); // 12, 13 missing
+  collector.onFrameParsed(2u, 15u);
+  collector.onFrameParsed(2u, 20u); // 16..19 missing
+  collector.onFrameParsed(2u, 3u);  // device restart, no gap
+
+  auto stats = collector.getStatistics();
+  EXPECT_EQ(2u, stats.frameNumberGaps);
+  EXPECT_EQ(6u, stats.framesMissed);
+
+  // wrap around of the frame counter
+  collector.reset();
+  collector.onFrameParsed(2u, 0xFFFFFFFEu);
+  collector.onFrameParsed(2u, 0xFFFFFFFFu);
+  collector.onFrameParsed(2u, 1u);
+  stats = collector.getStatistics();
+  EXPECT_EQ(1u, stats.frameNumberGaps);
+  EXPECT_EQ(1u, stats.framesMissed);
+}
+
+TEST(StreamStatisticsTest, NoGapDetectionForVersion1)
+{
+  StreamStatisticsCollector collector;
+
+  collector.onFrameParsed(1u, 1u);
+  collector.onFrameParsed(1u, 5u);
+
+  EXPECT_EQ(0u, collector.getStatistics().frameNumberGaps);
+}
+
+TEST(StreamStatisticsTest, CountersAndReset)
+{
+  StreamStatisticsCollector collector;
+
+  collector.onFrameFailed();
+  collector.onFrameDropped();
+  collector.onFrameDropped();
+  collector.onReconnect();
+  collector.onBacklog(3u);
+  collector.onBacklog(1u);
+
+  auto stats = collector.getStatistics();
+  EXPECT_EQ(1u, stats.framesFailed);
+  EXPECT_EQ(2u, stats.framesDropped);
+  EXPECT_EQ(1u, stats.reconnects);
+  EXPECT_EQ(1u, stats.backlog);
+  EXPECT_EQ(3u, stats.maxBacklog);
+
+  collector.reset();
+  stats = collector.getStatistics();
+  EXPECT_EQ(0u, stats.framesFailed);
+  EXPECT_EQ(0u, stats.framesDropped);
+  EXPECT_EQ(0u, stats.reconnects);
+  EXPECT_EQ(0u, stats.maxBacklog);
+}
@@ -240,7 +240,8 @@ TEST(VisionaryTMiniDataTest, InvalidBlobData)
 }
 
 //---------------------------------------------------------------------------------------
-TEST(VisionaryTMiniDataTest, ValidBlobData)
+namespace {
+ByteBuffer buildValidBlob()
 {
   ByteBuffer buffer{kMagicBytes};
   ByteBuffer length = {0x0u, 0x0u, 0x00u, 0x00u};
@@ -271,9 +272,316 @@ TEST(VisionaryTMiniDataTest, ValidBlobData)
   appendToVector(binLengthVec, buffer);
   setBlobLength(buffer);
 
+  return buffer;
+}
+} // namespace
+
+//---------------------------------------------------------------------------------------
+TEST(VisionaryTMiniDataTest, ValidBlobData)
+{
+  const ByteBuffer buffer = buildValidBlob();
+
   std::unique_ptr<ITransport> pTransport{new visionary_test::MockTransport{buffer}};
   VisionaryDataStream         dataStream{std::make_shared<VisionaryTMiniData>()};
 
   dataStream.open(pTransport);
   EXPECT_TRUE(dataStream.getNextFrame());
 }
+
+//---------------------------------------------------------------------------------------
+TEST(VisionaryTMiniDataTest, SeparateReceiveAndParse)
+{
+  const ByteBuffer buffer = buildValidBlob();
+
+  std::unique_ptr<ITransport> pTransport{new visionary_test::MockTransport{buffer}};
+  VisionaryDataStream         dataStream{std::make_shared<VisionaryTMiniData>()};
+  dataStream.open(pTransport);
+
+  VisionaryDataStream::RawFrame frame;
+  ASSERT_TRUE(dataStream.receiveRawFrame(frame));
+  EXPECT_EQ(1u, dataStream.getStatistics().framesReceived);
+  EXPECT_EQ(0u, dataStream.getStatistics().framesParsed);
+
+  // parse into a handler the stream does not know
+  VisionaryTMiniData dataHandler;
+  const bool         parsed = dataStream.parseRawFrame(frame, dataHandler);
+  EXPECT_TRUE(parsed);
+  EXPECT_EQ(512, dataHandler.getWidth());
+
+  dataStream.finishFrame(frame, parsed, dataHandler);
+  EXPECT_EQ(1u, dataStream.getStatistics().framesParsed);
+}
+
+//---------------------------------------------------------------------------------------
+namespace {
+// delivers the received data in small pieces, like packets arriving from the network
+class ChunkedTransport : public visionary_test::MockTransport
+{
+public:
+  ChunkedTransport(const ByteBuffer& buffer, std::size_t chunkSize) : MockTransport(buffer), m_chunkSize(chunkSize)
+  {
+  }
+
+  recv_return_t recvInto(std::uint8_t* pBuffer, std::size_t maxBytesToReceive) override
+  {
+    return MockTransport::recvInto(pBuffer, std::min(maxBytesToReceive, m_chunkSize));
+  }
+
+private:
+  std::size_t m_chunkSize;
+};
+} // namespace
+
+TEST(VisionaryTMiniDataTest, IncrementalParsing)
+{
+  // two frames back to back, each arriving in pieces which split pixels and segments
+  ByteBuffer buffer = buildValidBlob();
+  appendToVector(buildValidBlob(), buffer);
+
+  std::unique_ptr<ITransport> pTransport{new ChunkedTransport{buffer, 1001u}};
+  auto                        pDataHandler = std::make_shared<VisionaryTMiniData>();
+  VisionaryDataStream         dataStream{pDataHandler};
+  dataStream.open(pTransport);
+  dataStream.setIncrementalParsing(true);
+
+  for (int i = 0; i < 2; ++i)
+  {
+    ASSERT_TRUE(dataStream.getNextFrame());
+    EXPECT_EQ(512, pDataHandler->getWidth());
+    EXPECT_EQ(static_cast<std::size_t>(512 * 424), pDataHandler->getDistanceMap().size());
+  }
+  EXPECT_EQ(2u, dataStream.getStatistics().framesParsed);
+  EXPECT_EQ(0u, dataStream.getStatistics().framesFailed);
+}
+
+//---------------------------------------------------------------------------------------
+TEST(VisionaryTMiniDataTest, MapSelection)
+{
+  const ByteBuffer buffer = buildValidBlob();
+
+  for (const bool incremental : {false, true})
+  {
+    std::unique_ptr<ITransport> pTransport{new visionary_test::MockTransport{buffer}};
+    auto                        pDataHandler = std::make_shared<VisionaryTMiniData>();
+    VisionaryDataStream         dataStream{pDataHandler};
+    dataStream.open(pTransport);
+    dataStream.setIncrementalParsing(incremental);
+    pDataHandler->setMapSelection(MapSelection::DEPTH);
+
+    ASSERT_TRUE(dataStream.getNextFrame());
+    EXPECT_EQ(static_cast<std::size_t>(512 * 424), pDataHandler->getDistanceMap().size());
+    EXPECT_TRUE(pDataHandler->getIntensityMap().empty());
+    EXPECT_TRUE(pDataHandler->getStateMap().empty());
+    EXPECT_EQ(0u, pDataHandler->getIntensityMap().capacity());
+  }
+}
+
+//---------------------------------------------------------------------------------------
+TEST(VisionaryTMiniDataTest, FrameFilter)
+{
+  const ByteBuffer buffer = buildValidBlob();
+
+  for (const bool incremental : {false, true})
+  {
+    std::unique_ptr<ITransport> pTransport{new visionary_test::MockTransport{buffer}};
+    auto                        pDataHandler = std::make_shared<VisionaryTMiniData>();
+    VisionaryDataStream         dataStream{pDataHandler};
+    dataStream.open(pTransport);
+    dataStream.setIncrementalParsing(incremental);
+
+    // reject frames of bad quality
+    FrameMetadata seenMetadata{};
+    pDataHandler->setFrameFilter([&seenMetadata](const FrameMetadata& metadata) {
+      seenMetadata = metadata;
+      return metadata.dataQuality != 0u;
+    });
+
+    EXPECT_FALSE(dataStream.getNextFrame());
+    EXPECT_TRUE(pDataHandler->isFrameRejected());
+    EXPECT_EQ(pDataHandler->getDataSetVersion(), seenMetadata.dataSetVersion);
+    EXPECT_EQ(0u, pDataHandler->getFrameMetadata().dataQuality);
+    // the maps were not extracted
+    EXPECT_TRUE(pDataHandler->getDistanceMap().empty());
+    EXPECT_EQ(0u, pDataHandler->getDistanceMap().capacity());
+
+    const StreamStatistics stats = dataStream.getStatistics();
+    EXPECT_EQ(1u, stats.framesReceived);
+    EXPECT_EQ(1u, stats.framesRejected);
+    EXPECT_EQ(0u, stats.framesFailed);
+    EXPECT_EQ(0u, stats.framesParsed);
+  }
+}
+
+//---------------------------------------------------------------------------------------
+TEST(VisionaryTMiniDataTest, CrcValidation)
+{
+  ByteBuffer buffer = buildValidBlob();
+
+  // the CRC covers the binary data set from its length field up to the CRC field
+  const std::size_t crcOffset     = buffer.size() - 8u;
+  const std::size_t dataSetOffset = crcOffset - (4u + 8u + 2u + 6u + kDataSetSize);
+  buffer[dataSetOffset + 100u]    = 0x55u;
+  const std::uint32_t crc =
+    Crc32::compute(CrcAlgorithm::CRC32C, buffer.data() + dataSetOffset, crcOffset - dataSetOffset);
+  for (std::size_t i = 0u; i < 4u; ++i)
+  {
+    buffer[crcOffset + i] = static_cast<std::uint8_t>(crc >> (8u * i));
+  }
+  ByteBuffer corrupted = buffer;
+  corrupted[dataSetOffset + 1000u] ^= 0x01u;
+
+  for (const bool incremental : {false, true})
+  {
+    ByteBuffer stream = buffer;
+    appendToVector(corrupted, stream);
+
+    std::unique_ptr<ITransport> pTransport{new visionary_test::MockTransport{stream}};
+    auto                        pDataHandler = std::make_shared<VisionaryTMiniData>();
+    VisionaryDataStream         dataStream{pDataHandler};
+    dataStream.open(pTransport);
+    dataStream.setIncrementalParsing(incremental);
+    pDataHandler->setCrcValidation(CrcAlgorithm::CRC32C);
+
+    EXPECT_TRUE(dataStream.getNextFrame());
+    EXPECT_FALSE(dataStream.getNextFrame());
+    EXPECT_EQ(1u, dataStream.getStatistics().framesParsed);
+    EXPECT_EQ(1u, dataStream.getStatistics().framesFailed);
+  }
+}
+
+//---------------------------------------------------------------------------------------
+namespace {
+template <typename T>
+void appendLittleEndian(T value, ByteBuffer& dst)
+{
+  ByteBuffer bytes(sizeof(T));
+  writeUnalignLittleEndian<T>(bytes.data(), sizeof(T), value);
+  appendToVector(bytes, dst);
+}
+
+ByteBuffer buildBlob(const std::string& xml, const ByteBuffer& binary)
+{
+  ByteBuffer buffer{kMagicBytes};
+  ByteBuffer length = {0x0u, 0x0u, 0x00u, 0x00u};
+  appendToVector(length, buffer);
+  appendToVector(kProtocolVersion, buffer);
+  appendToVector(kPackageType, buffer);
+  appendToVector(kBlobId, buffer);
+  appendToVector(kNumSegements, buffer);
+  appendToVector(kXMLOffset, buffer);
+  buffer.insert(buffer.end(), 3u, 0x0u);
+  buffer.push_back(0x1u); // set change counter to 1
+  const auto binaryOffset = static_cast<std::uint32_t>(xml.size() + 28u);
+  appendToVector(uint32ToBEVector(binaryOffset), buffer);
+  buffer.insert(buffer.end(), 4u, 0x0u);
+  appendToVector(uint32ToBEVector(binaryOffset + static_cast<std::uint32_t>(binary.size())), buffer);
+  buffer.insert(buffer.end(), 4u, 0x0u);
+  buffer.insert(buffer.end(), xml.begin(), xml.end());
+  appendToVector(binary, buffer);
+  setBlobLength(buffer);
+  return buffer;
+}
+
+const std::string kPolarAndCartesianXml = "<SickRecord><DataSets><DataSetPolar2D><FormatDescription>"
+                                          "<DataStream datalength=\"3\"></DataStream></FormatDescription>"
+                                          "</DataSetPolar2D><DataSetCartesian/></DataSets></SickRecord>";
+
+// binary part with a polar 2D data set of 3 values and a cartesian data set of 2 points
+ByteBuffer buildPolarAndCartesianBinary(std::uint32_t scanCounter)
+{
+  ByteBuffer binary;
+  // polar 2D data set
+  appendLittleEndian<std::uint32_t>(90u, binary);         // length
+  appendLittleEndian<std::uint64_t>(0u, binary);          // timestamp
+  appendLittleEndian<std::uint16_t>(0u, binary);          // device id
+  appendLittleEndian<std::uint32_t>(scanCounter, binary); // scan counter
+  appendLittleEndian<std::uint32_t>(0u, binary);          // sys count scan
+  appendLittleEndian<float>(0.f, binary);                 // scan frequency
+  appendLittleEndian<float>(0.f, binary);                 // measurement frequency
+  appendLittleEndian<float>(-45.f, binary);               // angle of the first scan point
+  appendLittleEndian<float>(45.f, binary);                // angular resolution
+  appendLittleEndian<float>(1.f, binary);                 // scale
+  appendLittleEndian<float>(0.f, binary);                 // offset
+  for (const float distance : {1000.f, 2000.f, 3000.f})
+  {
+    appendLittleEndian<float>(distance, binary);
+  }
+  binary.insert(binary.end(), 4u * sizeof(float), 0x0u); // rssi angles, scale and offset
+  for (const float confidence : {0.25f, 0.5f, 1.f})
+  {
+    appendLittleEndian<float>(confidence, binary);
+  }
+  appendLittleEndian<std::uint32_t>(0u, binary);  // CRC
+  appendLittleEndian<std::uint32_t>(90u, binary); // length copy
+
+  // cartesian data set
+  appendLittleEndian<std::uint32_t>(50u, binary); // length
+  appendLittleEndian<std::uint64_t>(0u, binary);  // timestamp
+  appendLittleEndian<std::uint16_t>(2u, binary);  // version
+  appendLittleEndian<std::uint32_t>(2u, binary);  // number of points
+  for (const float value : {1.f, 2.f, 3.f, 0.5f, -1.f, -2.f, 4.f, 1.f})
+  {
+    appendLittleEndian<float>(value, binary);
+  }
+  appendLittleEndian<std::uint32_t>(0u, binary);  // CRC
+  appendLittleEndian<std::uint32_t>(50u, binary); // length copy
+  return binary;
+}
+} // namespace
+
+TEST(VisionaryTMiniDataTest, Polar2DAndCartesianDataSets)
+{
+  const ByteBuffer            blob = buildBlob(kPolarAndCartesianXml, buildPolarAndCartesianBinary(41u));
+  std::unique_ptr<ITransport> pTransport{new visionary_test::MockTransport{blob}};
+  auto                        pDataHandler = std::make_shared<VisionaryTMiniData>();
+  VisionaryDataStream         dataStream{pDataHandler};
+  dataStream.open(pTransport);
+
+  ASSERT_TRUE(dataStream.getNextFrame());
+  EXPECT_FALSE(pDataHandler->getDataSetsActive().hasDataSetDepthMap);
+  EXPECT_TRUE(pDataHandler->getDistanceMap().empty());
+  // the frame number is the scan counter, the version that of the cartesian data set
+  EXPECT_EQ(41u, pDataHandler->getFrameNum());
+  EXPECT_EQ(2u, pDataHandler->getDataSetVersion());
+
+  EXPECT_EQ(-45.f, pDataHandler->getPolarStartAngle());
+  EXPECT_EQ(45.f, pDataHandler->getPolarAngularResolution());
+  ASSERT_EQ(3u, pDataHandler->getPolarDistanceData().size());
+  EXPECT_EQ(2000.f, pDataHandler->getPolarDistanceData()[1]);
+  ASSERT_EQ(3u, pDataHandler->getPolarConfidenceData().size());
+  EXPECT_EQ(1.f, pDataHandler->getPolarConfidenceData()[2]);
+
+  const auto& points = pDataHandler->getCartesianData();
+  ASSERT_EQ(2u, points.size());
+  EXPECT_EQ(3.f, points[0].z);
+  EXPECT_EQ(0.5f, points[0].c);
+  EXPECT_EQ(-2.f, points[1].y);
+}
+
+
+TEST(VisionaryTMiniDataTest, FrameFilterWithoutDepthMap)
+{
+  ByteBuffer stream = buildBlob(kPolarAndCartesianXml, buildPolarAndCartesianBinary(41u));
+  appendToVector(buildBlob(kPolarAndCartesianXml, buildPolarAndCartesianBinary(42u)), stream);
+
+  std::unique_ptr<ITransport> pTransport{new visionary_test::MockTransport{stream}};
+  auto                        pDataHandler = std::make_shared<VisionaryTMiniData>();
+  VisionaryDataStream         dataStream{pDataHandler};
+  dataStream.open(pTransport);
+  pDataHandler->setFrameFilter([](const FrameMetadata& metadata) { return metadata.frameNum % 2u == 0u; });
+
+  // rejected before the polar and cartesian data are extracted
+  EXPECT_FALSE(dataStream.getNextFrame());
+  EXPECT_TRUE(pDataHandler->isFrameRejected());
+  EXPECT_TRUE(pDataHandler->getPolarDistanceData().empty());
+  EXPECT_TRUE(pDataHandler->getCartesianData().empty());
+
+  ASSERT_TRUE(dataStream.getNextFrame());
+  EXPECT_EQ(42u, pDataHandler->getFrameNum());
+  EXPECT_EQ(3u, pDataHandler->getPolarDistanceData().size());
+
+  const auto statistics = dataStream.getStatistics();
+  EXPECT_EQ(1u, statistics.framesRejected);
+  EXPECT_EQ(1u, statistics.framesParsed);
+  EXPECT_EQ(0u, statistics.frameNumberGaps);
+}
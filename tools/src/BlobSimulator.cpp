@@ -0,0 +1,342 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#include "BlobSimulator.h"
+
+#include <ctime>
+#include <sstream>
+#include <string>
+
+#include "VisionaryEndian.h"
+
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+using socklen_t = int;
+#else
+#  include <arpa/inet.h>
+#  include <netinet/in.h>
+#  include <sys/select.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+namespace visionary_tools {
+
+namespace {
+
+#ifdef _WIN32
+using SocketHandle                          = SOCKET;
+constexpr SocketHandle kInvalidSocketHandle = INVALID_SOCKET;
+constexpr int          kSendFlags           = 0;
+
+void closeSocket(SocketHandle s)
+{
+  ::closesocket(s);
+}
+#else
+using SocketHandle                          = int;
+constexpr SocketHandle kInvalidSocketHandle = -1;
+constexpr int          kSendFlags           = MSG_NOSIGNAL;
+
+void closeSocket(SocketHandle s)
+{
+  ::close(s);
+}
+#endif
+
+constexpr std::size_t kNumSegments        = 3u;
+constexpr std::size_t kSegmentTableSize   = kNumSegments * (4u + 4u);
+// offsets in the segment table are relative to the blob id
+constexpr std::size_t kSegmentBase = 4u + 4u + 2u + 1u;
+
+std::string buildXml(visionary::VisionaryType type, int width, int height)
+{
+  const bool        isS = (type == visionary::VisionaryType::eVisionaryS);
+  std::stringstream xml;
+  xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?><SickRecord><DataSets>";
+  xml << (isS ? "<DataSetStereo>" : "<DataSetDepthMap>");
+  xml << "<FormatDescriptionDepthMap><DataStream>";
+  xml << "<Width>" << width << "</Width><Height>" << height << "</Height>";
+  xml << "<CameraToWorldTransform>";
+  for (int i = 0; i < 16; ++i)
+  {
+    xml << "<value>" << ((i % 5 == 0) ? 1.0 : 0.0) << "</value>";
+  }
+  xml << "</CameraToWorldTransform>";
+  xml << "<CameraMatrix><FX>" << -0.7 * width << "</FX><FY>" << -0.7 * width << "</FY><CX>" << width / 2.0
+      << "</CX><CY>" << height / 2.0 << "</CY></CameraMatrix>";
+  xml << "<CameraDistortionParams><K1>0</K1><K2>0</K2><P1>0</P1><P2>0</P2><K3>0</K3></CameraDistortionParams>";
+  xml << "<FocalToRayCross>0</FocalToRayCross>";
+  if (isS)
+  {
+    xml << "<Z decimalexponent=\"0\">uint16</Z><Intensity>uint32</Intensity><Confidence>uint16</Confidence>";
+  }
+  else
+  {
+    xml << "<Distance>uint16</Distance><Intensity>uint16</Intensity><Confidence>uint16</Confidence>";
+  }
+  xml << "</DataStream></FormatDescriptionDepthMap>";
+  xml << (isS ? "</DataSetStereo>" : "</DataSetDepthMap>");
+  xml << "</DataSets></SickRecord>";
+  return xml.str();
+}
+
+template <typename T>
+void appendBigEndian(BlobSimulator::ByteBuffer& buffer, T value)
+{
+  const std::size_t pos = buffer.size();
+  buffer.resize(pos + sizeof(T));
+  visionary::writeUnalignBigEndian<T>(&buffer[pos], sizeof(T), value);
+}
+
+template <typename T>
+void appendLittleEndian(BlobSimulator::ByteBuffer& buffer, T value)
+{
+  const std::size_t pos = buffer.size();
+  buffer.resize(pos + sizeof(T));
+  visionary::writeUnalignLittleEndian<T>(&buffer[pos], sizeof(T), value);
+}
+
+} // namespace
+
+BlobSimulator::BlobSimulator(visionary::VisionaryType type, int width, int height, double fps)
+  : m_type(type)
+  , m_width(width)
+  , m_height(height)
+  , m_framePeriod(std::chrono::nanoseconds(static_cast<std::int64_t>(1e9 / fps)))
+  , m_timestampOffset(0u)
+  , m_frameNumOffset(0u)
+  , m_listenSocket(static_cast<std::intptr_t>(kInvalidSocketHandle))
+  , m_port(0u)
+  , m_isRunning(false)
+  , m_framesSent(0u)
+{
+  m_blobTemplate = buildBlobTemplate();
+}
+
+BlobSimulator::~BlobSimulator()
+{
+  stop();
+}
+
+BlobSimulator::ByteBuffer BlobSimulator::buildBlobTemplate()
+{
+  const std::string xml       = buildXml(m_type, m_width, m_height);
+  const std::size_t numPixel  = static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height);
+  const bool        isS       = (m_type == visionary::VisionaryType::eVisionaryS);
+  const std::size_t mapsSize  = numPixel * (isS ? (2u + 4u + 2u) : (2u + 2u + 2u));
+  const std::size_t binSize   = 4u + 8u + 2u + 4u + 1u + 1u + mapsSize + 4u + 4u;
+  const std::size_t xmlOffset = 4u + kSegmentTableSize;
+  const std::size_t binOffset = xmlOffset + xml.size();
+  const std::size_t endOffset = binOffset + binSize;
+
+  ByteBuffer blob;
+  blob.reserve(kSegmentBase + endOffset);
+  blob.insert(blob.end(), 4u, 0x02u);
+  appendBigEndian<std::uint32_t>(blob, static_cast<std::uint32_t>(3u + endOffset)); // version + type + segments
+  appendBigEndian<std::uint16_t>(blob, 0x0001u);                                    // protocol version
+  blob.push_back(0x62u);                                                            // packet type
+  appendBigEndian<std::uint16_t>(blob, 0u);                                         // blob id
+  appendBigEndian<std::uint16_t>(blob, static_cast<std::uint16_t>(kNumSegments));
+  appendBigEndian<std::uint32_t>(blob, static_cast<std::uint32_t>(xmlOffset));
+  appendBigEndian<std::uint32_t>(blob, 1u); // change counter
+  appendBigEndian<std::uint32_t>(blob, static_cast<std::uint32_t>(binOffset));
+  appendBigEndian<std::uint32_t>(blob, 1u);
+  appendBigEndian<std::uint32_t>(blob, static_cast<std::uint32_t>(endOffset));
+  appendBigEndian<std::uint32_t>(blob, 1u);
+  blob.insert(blob.end(), xml.begin(), xml.end());
+
+  const auto dataSetLength = static_cast<std::uint32_t>(mapsSize);
+  appendLittleEndian<std::uint32_t>(blob, dataSetLength);
+  m_timestampOffset = blob.size();
+  appendLittleEndian<std::uint64_t>(blob, 0u);
+  appendLittleEndian<std::uint16_t>(blob, 2u); // data set version with frame number
+  m_frameNumOffset = blob.size();
+  appendLittleEndian<std::uint32_t>(blob, 0u);
+  blob.push_back(0u); // data quality
+  blob.push_back(0u); // device status
+
+  // depth map: tilted plane, every 97th pixel invalid
+  for (std::size_t i = 0u; i < numPixel; ++i)
+  {
+    const auto row = i / static_cast<std::size_t>(m_width);
+    const auto col = i % static_cast<std::size_t>(m_width);
+    appendLittleEndian<std::uint16_t>(blob, (i % 97u == 0u) ? 0u : static_cast<std::uint16_t>(1000u + row + col));
+  }
+  // intensity/rgba map
+  for (std::size_t i = 0u; i < numPixel; ++i)
+  {
+    if (isS)
+    {
+      appendLittleEndian<std::uint32_t>(blob, static_cast<std::uint32_t>(0xFF000000u | (i & 0xFFFFFFu)));
+    }
+    else
+    {
+      appendLittleEndian<std::uint16_t>(blob, static_cast<std::uint16_t>(i & 0xFFFFu));
+    }
+  }
+  // state/confidence map
+  blob.insert(blob.end(), numPixel * 2u, 0u);
+
+  appendLittleEndian<std::uint32_t>(blob, 0u); // CRC (unused)
+  appendLittleEndian<std::uint32_t>(blob, dataSetLength);
+
+  return blob;
+}
+
+std::uint64_t BlobSimulator::packTimestamp(std::chrono::system_clock::time_point tp)
+{
+  const auto        msSinceEpoch = std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+  const std::time_t seconds      = static_cast<std::time_t>(msSinceEpoch / 1000);
+  std::tm           tm{};
+#ifdef _WIN32
+  ::gmtime_s(&tm, &seconds);
+#else
+  ::gmtime_r(&seconds, &tm);
+#endif
+  std::uint64_t packed = static_cast<std::uint64_t>(msSinceEpoch % 1000);
+  packed |= static_cast<std::uint64_t>(tm.tm_sec) << 10;
+  packed |= static_cast<std::uint64_t>(tm.tm_min) << 16;
+  packed |= static_cast<std::uint64_t>(tm.tm_hour) << 22;
+  packed |= static_cast<std::uint64_t>(tm.tm_mday) << 38;
+  packed |= static_cast<std::uint64_t>(tm.tm_mon + 1) << 43;
+  packed |= static_cast<std::uint64_t>(tm.tm_year + 1900) << 47;
+  return packed;
+}
+
+bool BlobSimulator::start()
+{
+#ifdef _WIN32
+  WSADATA wsaData;
+  if (::WSAStartup(MAKEWORD(2, 2), &wsaData) != NO_ERROR)
+  {
+    return false;
+  }
+#endif
+  SocketHandle s = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (s == kInvalidSocketHandle)
+  {
+    return false;
+  }
+  const int reuse = 1;
+  ::setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+  sockaddr_in addr{};
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = 0; // ephemeral
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addrLen    = sizeof(addr);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  if (::bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(s, 16) != 0
+      || ::getsockname(s, reinterpret_cast<sockaddr*>(&addr), &addrLen) != 0)
+  {
+    closeSocket(s);
+    return false;
+  }
+  m_port         = ntohs(addr.sin_port);
+  m_listenSocket = static_cast<std::intptr_t>(s);
+  m_isRunning    = true;
+  m_acceptThread = std::thread(&BlobSimulator::acceptLoop, this);
+  return true;
+}
+
+void BlobSimulator::stop()
+{
+  if (!m_isRunning.exchange(false))
+  {
+    return;
+  }
+  m_acceptThread.join();
+  closeSocket(static_cast<SocketHandle>(m_listenSocket));
+  m_listenSocket = static_cast<std::intptr_t>(kInvalidSocketHandle);
+
+  std::lock_guard<std::mutex> guard(m_clientMutex);
+  for (auto& t : m_clientThreads)
+  {
+    t.join();
+  }
+  m_clientThreads.clear();
+#ifdef _WIN32
+  ::WSACleanup();
+#endif
+}
+
+std::uint16_t BlobSimulator::getPort() const
+{
+  return m_port;
+}
+
+std::size_t BlobSimulator::getFrameSize() const
+{
+  return m_blobTemplate.size();
+}
+
+std::uint64_t BlobSimulator::getFramesSent() const
+{
+  return m_framesSent;
+}
+
+void BlobSimulator::acceptLoop()
+{
+  const auto listenSocket = static_cast<SocketHandle>(m_listenSocket);
+  while (m_isRunning)
+  {
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(listenSocket, &readSet);
+    timeval tv{0, 100000}; // re-check the running flag every 100ms
+    if (::select(static_cast<int>(listenSocket + 1), &readSet, nullptr, nullptr, &tv) <= 0)
+    {
+      continue;
+    }
+    const SocketHandle client = ::accept(listenSocket, nullptr, nullptr);
+    if (client == kInvalidSocketHandle)
+    {
+      continue;
+    }
+    std::lock_guard<std::mutex> guard(m_clientMutex);
+    m_clientThreads.emplace_back(&BlobSimulator::serveClient, this, static_cast<std::intptr_t>(client));
+  }
+}
+
+void BlobSimulator::serveClient(std::intptr_t clientSocket)
+{
+  const auto    s = static_cast<SocketHandle>(clientSocket);
+  ByteBuffer    blob(m_blobTemplate);
+  std::uint32_t frameNum = 0u;
+  auto          nextSend = std::chrono::steady_clock::now();
+
+  while (m_isRunning)
+  {
+    std::this_thread::sleep_until(nextSend);
+    nextSend += m_framePeriod;
+
+    visionary::writeUnalignLittleEndian<std::uint64_t>(
+      &blob[m_timestampOffset], sizeof(std::uint64_t), packTimestamp(std::chrono::system_clock::now()));
+    visionary::writeUnalignLittleEndian<std::uint32_t>(&blob[m_frameNumOffset], sizeof(std::uint32_t), ++frameNum);
+
+    const char* pData     = reinterpret_cast<const char*>(blob.data());
+    std::size_t remaining = blob.size();
+    while (remaining > 0u && m_isRunning)
+    {
+      const auto sent = ::send(s, pData, static_cast<int>(remaining), kSendFlags);
+      if (sent <= 0)
+      {
+        closeSocket(s);
+        return;
+      }
+      pData += sent;
+      remaining -= static_cast<std::size_t>(sent);
+    }
+    ++m_framesSent;
+  }
+  closeSocket(s);
+}
+
+} // namespace visionary_tools
@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "VisionaryType.h"
+
+namespace visionary_tools {
+
+/// Local blob stream server emulating the data channel of a Visionary device.
+///
+/// Listens on the loopback interface and sends synthetic blobs with the configured image size and frame rate to every
+/// connected client. The blob timestamps are taken from the host clock (UTC) and the frame numbers are incremented per
+/// client, so receivers can measure end-to-end latency and detect lost frames.
+class BlobSimulator
+{
+public:
+  using ByteBuffer = std::vector<std::uint8_t>;
+
+  /// Constructor
+  ///
+  /// \param[in] type   product type whose blob format is emulated.
+  /// \param[in] width  image width in pixels.
+  /// \param[in] height image height in pixels.
+  /// \param[in] fps    frame rate per client connection.
+  BlobSimulator(visionary::VisionaryType type, int width, int height, double fps);
+  ~BlobSimulator();
+
+  BlobSimulator(const BlobSimulator&)            = delete;
+  BlobSimulator& operator=(const BlobSimulator&) = delete;
+
+  /// Starts listening on an ephemeral loopback port.
+  ///
+  /// \retval true the server is running, see getPort()
+  /// \retval false the listening socket could not be set up
+  bool start();
+
+  /// Stops the server and all client connections.
+  void stop();
+
+  /// Returns the listening port (in host byte order).
+  std::uint16_t getPort() const;
+
+  /// Returns the size of a single blob package in bytes (including the framing).
+  std::size_t getFrameSize() const;
+
+  /// Returns the number of frames sent to all clients.
+  std::uint64_t getFramesSent() const;
+
+private:
+  void       acceptLoop();
+  void       serveClient(std::intptr_t clientSocket);
+  ByteBuffer buildBlobTemplate();
+
+  static std::uint64_t packTimestamp(std::chrono::system_clock::time_point tp);
+
+  const visionary::VisionaryType m_type;
+  const int                      m_width;
+  const int                      m_height;
+  const std::chrono::nanoseconds m_framePeriod;
+
+  ByteBuffer  m_blobTemplate;
+  std::size_t m_timestampOffset;
+  std::size_t m_frameNumOffset;
+
+  std::intptr_t              m_listenSocket;
+  std::uint16_t              m_port;
+  std::atomic<bool>          m_isRunning;
+  std::atomic<std::uint64_t> m_framesSent;
+
+  std::thread              m_acceptThread;
+  std::mutex               m_clientMutex;
+  std::vector<std::thread> m_clientThreads;
+};
+
+} // namespace visionary_tools
@@ -0,0 +1,295 @@
+//
+// Copyright (c) 2024 SICK AG, Waldkirch
+//
+// SPDX-License-Identifier: Unlicense
+
+// End-to-end throughput and latency benchmark.
+//
+// Opens N frame grabbers, either against real devices or against a local blob simulator, consumes frames for a fixed
+// duration and reports frame rate, data rate, lost and dropped frames, arrival jitter and the latency from device
+// timestamp to consumer delivery. The device timestamp is converted into the host steady clock by the clock
+// synchronization of the grabber (see VisionaryData::getHostTimestamp()), so device and host need no common clock.
+//
+// usage: visionary_benchmark [--type=Visionary-S|Visionary-T_Mini] [--host=<ip>]... [--grabbers=N] [--duration=<s>]
+//                            [--fps=<f>] [--width=<w>] [--height=<h>] [--parse-threads=N] [--incremental]
+//                            [--depth-only]
+//
+// Without --host the given number of grabbers is connected to a local simulator. With --parse-threads each grabber
+// receives in one thread and parses in N further threads, with --incremental each blob is parsed while it arrives.
+// With --depth-only only the depth map is extracted.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BlobSimulator.h"
+#include "FrameGrabber.h"
+#include "FrameTiming.h"
+#include "StreamStatistics.h"
+#include "VisionaryControl.h"
+#include "VisionaryData.h"
+#include "VisionaryType.h"
+
+using namespace visionary;
+
+namespace {
+
+struct Config
+{
+  std::string              type         = VisionaryType::kVisionaryS;
+  std::vector<std::string> hosts;
+  unsigned                 grabbers     = 1u;
+  double                   duration     = 10.0;
+  double                   fps          = 30.0;
+  int                      width        = 640;
+  int                      height       = 512;
+  unsigned                 parseThreads = 0u;
+  bool                     incremental  = false;
+  bool                     depthOnly    = false;
+};
+
+struct GrabberResult
+{
+  std::uint64_t       frames = 0u;
+  std::vector<double> latenciesMs; // device timestamp in the host clock -> consumer delivery
+  StreamStatistics    stats{};
+};
+
+void printUsage()
+{
+  std::cout << "usage: visionary_benchmark [--type=" << VisionaryType::kVisionaryS << '|'
+            << VisionaryType::kVisionaryTMini << "] [--host=<ip>]... [--grabbers=N] [--duration=<s>]\n"
+            << "                           [--fps=<f>] [--width=<w>] [--height=<h>] [--parse-threads=N]\n"
+            << "                           [--incremental] [--depth-only]\n"
+            << "Without --host the grabbers are connected to a local blob simulator.\n"
+            << "The latency is measured from the device timestamp, converted into the host clock by the clock\n"
+            << "synchronization, to the delivery of the frame.\n";
+}
+
+bool parseArgs(int argc, char* argv[], Config& config)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg(argv[i]);
+    const auto        eq    = arg.find('=');
+    const std::string key   = arg.substr(0, eq);
+    const std::string value = (eq == std::string::npos) ? std::string() : arg.substr(eq + 1);
+
+    if (key == "--type")
+      config.type = value;
+    else if (key == "--host")
+      config.hosts.push_back(value);
+    else if (key == "--grabbers")
+      config.grabbers = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+    else if (key == "--duration")
+      config.duration = std::strtod(value.c_str(), nullptr);
+    else if (key == "--fps")
+      config.fps = std::strtod(value.c_str(), nullptr);
+    else if (key == "--width")
+      config.width = std::atoi(value.c_str());
+    else if (key == "--height")
+      config.height = std::atoi(value.c_str());
+    else if (key == "--parse-threads")
+      config.parseThreads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+    else if (key == "--incremental")
+      config.incremental = true;
+    else if (key == "--depth-only")
+      config.depthOnly = true;
+    else
+      return false;
+  }
+  return config.grabbers > 0u && config.duration > 0.0 && config.fps > 0.0 && config.width > 0 && config.height > 0;
+}
+
+double percentile(std::vector<double>& sorted, double p)
+{
+  if (sorted.empty())
+  {
+    return 0.0;
+  }
+  const auto idx = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1u) + 0.5);
+  return sorted[std::min(idx, sorted.size() - 1u)];
+}
+
+void consume(FrameGrabberBase& grabber, std::chrono::steady_clock::time_point deadline, GrabberResult& result)
+{
+  std::shared_ptr<VisionaryData> pData;
+
+  grabber.resetStatistics();
+  while (std::chrono::steady_clock::now() < deadline)
+  {
+    if (!grabber.genGetNextFrame(pData, false, std::chrono::milliseconds(200)))
+    {
+      continue;
+    }
+    ++result.frames;
+
+    // the device clock is unrelated to the host clock, so compare the synchronized host timestamp
+    const auto hostTimestamp = pData->getHostTimestamp();
+    if (hostTimestamp != std::chrono::steady_clock::time_point())
+    {
+      const std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - hostTimestamp;
+      result.latenciesMs.push_back(latency.count());
+    }
+  }
+  result.stats = grabber.getStatistics();
+}
+
+void printResult(const std::string& name, GrabberResult& result, double seconds)
+{
+  std::sort(result.latenciesMs.begin(), result.latenciesMs.end());
+  const double maxLatency = result.latenciesMs.empty() ? 0.0 : result.latenciesMs.back();
+
+  std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(1) << std::setw(10)
+            << static_cast<double>(result.frames) / seconds << std::setw(12)
+            << result.stats.bytesPerSecond / (1024.0 * 1024.0) << std::setw(8) << result.stats.framesMissed
+            << std::setw(8) << result.stats.framesDropped << std::setw(8) << result.stats.framesFailed << std::setw(8)
+            << result.stats.maxBacklog << std::setprecision(2) << std::setw(12)
+            << static_cast<double>(result.stats.jitter.count()) / 1.0e6 << std::setw(10)
+            << percentile(result.latenciesMs, 0.5) << std::setw(10) << percentile(result.latenciesMs, 0.99)
+            << std::setw(10) << maxLatency << '\n';
+}
+
+void printStageLatencies(const FrameGrabberBase& grabber, const std::string& name)
+{
+  static const char* const kStageNames[FrameStage::NUM_STAGES] = {
+    "first byte", "last byte", "xml parsed", "binary parsed", "handed off", "consumed"};
+
+  const auto toMs = [](std::chrono::nanoseconds ns) { return static_cast<double>(ns.count()) / 1.0e6; };
+
+  std::cout << "pipeline latency " << name << " (time since previous stage):\n";
+  for (int stage = FrameStage::LAST_BYTE_RECEIVED; stage <= FrameStage::NUM_STAGES; ++stage)
+  {
+    const bool           isTotal = (stage == FrameStage::NUM_STAGES);
+    const LatencySummary summary =
+      isTotal ? grabber.getTotalLatency().getSummary()
+              : grabber.getStageLatency(static_cast<FrameStage::Enum>(stage)).getSummary();
+    std::cout << "  " << std::left << std::setw(14) << (isTotal ? "total" : kStageNames[stage]) << std::right
+              << std::fixed << std::setprecision(3) << std::setw(10) << toMs(summary.p50) << std::setw(10)
+              << toMs(summary.p99) << std::setw(10) << toMs(summary.max) << '\n';
+  }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  Config config;
+  if (!parseArgs(argc, argv, config))
+  {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  const VisionaryType type = VisionaryType::fromString(config.type);
+
+  // one control instance per device; in simulator mode it is only used as data handler factory
+  std::vector<std::unique_ptr<VisionaryControl>> controls;
+  std::vector<std::unique_ptr<FrameGrabberBase>> grabbers;
+  std::unique_ptr<visionary_tools::BlobSimulator> pSimulator;
+
+  const auto      timeout = std::chrono::milliseconds(1000);
+  PipelineOptions pipelineOptions;
+  pipelineOptions.parseThreads       = config.parseThreads;
+  pipelineOptions.incrementalParsing = config.incremental;
+  pipelineOptions.mapSelection       = config.depthOnly ? MapSelection::DEPTH : MapSelection::ALL;
+
+  if (config.hosts.empty())
+  {
+    pSimulator.reset(new visionary_tools::BlobSimulator(type, config.width, config.height, config.fps));
+    if (!pSimulator->start())
+    {
+      std::cerr << "Failed to start blob simulator\n";
+      return EXIT_FAILURE;
+    }
+    controls.emplace_back(new VisionaryControl(type));
+    for (unsigned i = 0u; i < config.grabbers; ++i)
+    {
+      grabbers.emplace_back(new FrameGrabberBase(*controls.back(),
+                                                 "127.0.0.1",
+                                                 pSimulator->getPort(),
+                                                 timeout,
+                                                 SocketOptions::blobStream(pSimulator->getFrameSize()),
+                                                 pipelineOptions));
+    }
+  }
+  else
+  {
+    for (const auto& host : config.hosts)
+    {
+      controls.emplace_back(new VisionaryControl(type));
+      if (!controls.back()->open(host))
+      {
+        std::cerr << "Failed to open control connection to " << host << '\n';
+        return EXIT_FAILURE;
+      }
+      controls.back()->stopAcquisition();
+      grabbers.emplace_back(controls.back()->createFrameGrabber(pipelineOptions));
+      controls.back()->startAcquisition();
+    }
+  }
+
+  std::cout << "Running " << grabbers.size() << " grabber(s) for " << config.duration << " s\n";
+
+  const auto deadline =
+    std::chrono::steady_clock::now()
+    + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(config.duration));
+
+  std::vector<GrabberResult> results(grabbers.size());
+  std::vector<std::thread>   consumers;
+  for (std::size_t i = 0u; i < grabbers.size(); ++i)
+  {
+    consumers.emplace_back(consume, std::ref(*grabbers[i]), deadline, std::ref(results[i]));
+  }
+  for (auto& t : consumers)
+  {
+    t.join();
+  }
+
+  std::cout << std::left << std::setw(10) << "grabber" << std::right << std::setw(10) << "frames/s" << std::setw(12)
+            << "MiB/s" << std::setw(8) << "lost" << std::setw(8) << "dropped" << std::setw(8) << "failed"
+            << std::setw(8) << "backlog" << std::setw(12) << "jitter[ms]" << std::setw(10) << "p50[ms]" << std::setw(10)
+            << "p99[ms]" << std::setw(10) << "max[ms]" << '\n';
+
+  GrabberResult total;
+  for (std::size_t i = 0u; i < results.size(); ++i)
+  {
+    total.frames += results[i].frames;
+    total.stats.bytesPerSecond += results[i].stats.bytesPerSecond;
+    total.stats.framesMissed += results[i].stats.framesMissed;
+    total.stats.framesDropped += results[i].stats.framesDropped;
+    total.stats.framesFailed += results[i].stats.framesFailed;
+    total.stats.maxBacklog = std::max(total.stats.maxBacklog, results[i].stats.maxBacklog);
+    total.stats.jitter = std::max(total.stats.jitter, results[i].stats.jitter);
+    total.latenciesMs.insert(total.latenciesMs.end(), results[i].latenciesMs.begin(), results[i].latenciesMs.end());
+    printResult("#" + std::to_string(i), results[i], config.duration);
+  }
+  printResult("total", total, config.duration);
+
+  if (isLatencyTraceEnabled())
+  {
+    for (std::size_t i = 0u; i < grabbers.size(); ++i)
+    {
+      printStageLatencies(*grabbers[i], "#" + std::to_string(i));
+    }
+  }
+
+  grabbers.clear();
+  for (auto& pControl : controls)
+  {
+    pControl->close();
+  }
+  if (pSimulator)
+  {
+    pSimulator->stop();
+  }
+
+  return EXIT_SUCCESS;
+}